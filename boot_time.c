@@ -0,0 +1,68 @@
+/**
+ * \file boot_time.c
+ * \brief Start-up milestones in milliseconds since the scheduler started
+ */
+
+#include "boot_time.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include <stdbool.h>
+
+static const char *const mark_names[BOOT_MARK_COUNT] = {
+    [BOOT_MARK_NETIF] = "netif",
+    [BOOT_MARK_LINK] = "link",
+    [BOOT_MARK_ADDRESS] = "address",
+    [BOOT_MARK_DOIP] = "first DoIP message",
+};
+
+static uint32_t mark_ms[BOOT_MARK_COUNT];
+static uint32_t marks_reached;      /* One bit per boot_mark_t */
+
+void boot_time_mark(boot_mark_t mark)
+{
+    uint32_t now = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    bool first = false;
+
+    if (mark >= BOOT_MARK_COUNT) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if ((marks_reached & (1u << mark)) == 0) {
+        mark_ms[mark] = now;
+        marks_reached |= 1u << mark;
+        first = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (first) {
+        printf("[BOOT] %s after %lu ms\r\n", mark_names[mark], (unsigned long)now);
+        if (mark == BOOT_MARK_DOIP) {
+            boot_time_print();
+        }
+    }
+}
+
+uint32_t boot_time_ms(boot_mark_t mark)
+{
+    if (mark >= BOOT_MARK_COUNT || (marks_reached & (1u << mark)) == 0) {
+        return BOOT_TIME_NONE;
+    }
+    return mark_ms[mark];
+}
+
+void boot_time_print(void)
+{
+    printf("[BOOT]");
+    for (uint32_t i = 0; i < BOOT_MARK_COUNT; i++) {
+        uint32_t ms = boot_time_ms((boot_mark_t)i);
+
+        if (ms == BOOT_TIME_NONE) {
+            printf(" %s -", mark_names[i]);
+        } else {
+            printf(" %s %lu ms", mark_names[i], (unsigned long)ms);
+        }
+        printf((i + 1 < BOOT_MARK_COUNT) ? "," : "\r\n");
+    }
+}
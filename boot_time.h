@@ -0,0 +1,51 @@
+/**
+ * \file boot_time.h
+ * \brief Start-up milestones in milliseconds since the scheduler started
+ *
+ * Each milestone is recorded, and printed as a "[BOOT]" line, the first
+ * time it is reached; later calls are ignored. Together they show how
+ * long a reflash or power cycle takes to get back to a DoIP session:
+ * interface created, PHY link up, IPv4 address bound, first DoIP message
+ * received.
+ */
+
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* boot_time_ms() of a milestone not reached yet */
+#define BOOT_TIME_NONE          UINT32_MAX
+
+typedef enum {
+    BOOT_MARK_NETIF,            ///< Network interface added, MAC enabled
+    BOOT_MARK_LINK,             ///< PHY reports link up
+    BOOT_MARK_ADDRESS,          ///< IPv4 address bound (DHCP or static)
+    BOOT_MARK_DOIP,             ///< First DoIP message received
+    BOOT_MARK_COUNT
+} boot_mark_t;
+
+/**
+ * \brief Record a milestone if it is the first time; any task
+ */
+void boot_time_mark(boot_mark_t mark);
+
+/**
+ * \brief Milliseconds from scheduler start to a milestone, BOOT_TIME_NONE if not reached
+ */
+uint32_t boot_time_ms(boot_mark_t mark);
+
+/**
+ * \brief Print every milestone on one "[BOOT]" line
+ */
+void boot_time_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_TIME_H
@@ -127,7 +127,7 @@ void assert_triggered(const char *file, uint32_t line);
 
 /* configNUM_THREAD_LOCAL_STORAGE_POINTERS for thread local storage */
 #ifndef configNUM_THREAD_LOCAL_STORAGE_POINTERS
-#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    1   /* 0: rtt_printf line buffer */
 #endif
 
 /* configUSE_MINI_LIST_ITEM optimization */
@@ -191,9 +191,14 @@ void assert_triggered(const char *file, uint32_t line);
 /* Memory allocation related definitions. *************************************/
 /******************************************************************************/
 
-/* Set configSUPPORT_STATIC_ALLOCATION to include static allocation */
+/* Set configSUPPORT_STATIC_ALLOCATION - long-lived tasks and kernel objects are static */
 #ifndef configSUPPORT_STATIC_ALLOCATION
-#define configSUPPORT_STATIC_ALLOCATION              0
+#define configSUPPORT_STATIC_ALLOCATION              1
+#endif
+
+/* Let the kernel provide the idle and timer task memory */
+#ifndef configKERNEL_PROVIDED_STATIC_MEMORY
+#define configKERNEL_PROVIDED_STATIC_MEMORY          1
 #endif
 
 /* Set configSUPPORT_DYNAMIC_ALLOCATION to include dynamic allocation */
@@ -201,9 +206,11 @@ void assert_triggered(const char *file, uint32_t line);
 #define configSUPPORT_DYNAMIC_ALLOCATION             1
 #endif
 
-/* configTOTAL_HEAP_SIZE sets the total size of the FreeRTOS heap - preserve 42KB */
+/* configTOTAL_HEAP_SIZE sets the size of the heap in rtos_heap.c. Only lwIP's
+ * threads, mailboxes and the start-up task allocate from it; check the [HEAP]
+ * peak printed at start-up when changing it. */
 #ifndef configTOTAL_HEAP_SIZE
-#define configTOTAL_HEAP_SIZE                        42000
+#define configTOTAL_HEAP_SIZE                        24576
 #endif
 
 /* Set configAPPLICATION_ALLOCATED_HEAP to 0 to have the linker allocate heap */
@@ -274,9 +281,9 @@ void assert_triggered(const char *file, uint32_t line);
 #define configUSE_SB_COMPLETED_CALLBACK       0
 #endif
 
-/* Set configCHECK_FOR_STACK_OVERFLOW to 0 - preserve original setting */
+/* Set configCHECK_FOR_STACK_OVERFLOW to 2 - check the stack fill pattern on each switch (hook in sys_stats.c) */
 #ifndef configCHECK_FOR_STACK_OVERFLOW
-#define configCHECK_FOR_STACK_OVERFLOW        0
+#define configCHECK_FOR_STACK_OVERFLOW        2
 #endif
 
 /******************************************************************************/
@@ -285,7 +292,12 @@ void assert_triggered(const char *file, uint32_t line);
 
 /* Set configGENERATE_RUN_TIME_STATS to collect processing time data */
 #ifndef configGENERATE_RUN_TIME_STATS
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
+#endif
+
+/* 64-bit run time counter so the high resolution timestamp does not wrap */
+#ifndef configRUN_TIME_COUNTER_TYPE
+#define configRUN_TIME_COUNTER_TYPE             uint64_t
 #endif
 
 /* Set configUSE_TRACE_FACILITY for trace and visualisation functions */
@@ -376,7 +388,7 @@ void assert_triggered(const char *file, uint32_t line);
 #endif
 
 #ifndef INCLUDE_xTaskGetSchedulerState
-#define INCLUDE_xTaskGetSchedulerState         0
+#define INCLUDE_xTaskGetSchedulerState         1
 #endif
 
 #ifndef INCLUDE_xTaskGetCurrentTaskHandle
@@ -384,7 +396,7 @@ void assert_triggered(const char *file, uint32_t line);
 #endif
 
 #ifndef INCLUDE_uxTaskGetStackHighWaterMark
-#define INCLUDE_uxTaskGetStackHighWaterMark    0
+#define INCLUDE_uxTaskGetStackHighWaterMark    1
 #endif
 
 #ifndef INCLUDE_xTaskGetIdleTaskHandle
@@ -440,10 +452,10 @@ void assert_triggered(const char *file, uint32_t line);
 /* Run time stats configuration. **********************************************/
 /******************************************************************************/
 
-/* Used when configGENERATE_RUN_TIME_STATS is 1 */
+/* Used when configGENERATE_RUN_TIME_STATS is 1; implemented in sys_stats.c on bsp_timestamp */
 #if configGENERATE_RUN_TIME_STATS
 extern void     vConfigureTimerForRunTimeStats(void);
-extern uint32_t vGetRunTimeCounterValue(void);
+extern uint64_t vGetRunTimeCounterValue(void);
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureTimerForRunTimeStats()
 #define portGET_RUN_TIME_COUNTER_VALUE() vGetRunTimeCounterValue()
 #endif
@@ -98,9 +98,10 @@
 
 // <q> Multicast Hash Enable
 // <i> Multicast frames will be accepted when the 6-bit hash function of the destination address points to a bit that is set in the Hash Register.
+// <i> ethif_gmac.c sets the hash bits of the joined groups and drops collisions in software.
 // <id> gmac_arch_ncfgr_mtihen
 #ifndef CONF_GMAC_NCFGR_MTIHEN
-#define CONF_GMAC_NCFGR_MTIHEN 0
+#define CONF_GMAC_NCFGR_MTIHEN 1
 #endif
 
 // <q> Unicast Hash Enable
@@ -140,8 +141,9 @@
 // <i> Indicates the number of bytes by which the received data is offset from
 // <i> the start of the receive buffer.
 // <id> gmac_arch_ncfgr_rxbufo
+// <i> Must equal ETH_PAD_SIZE: ethif_gmac.c hands receive buffers to lwIP as they are.
 #ifndef CONF_GMAC_NCFGR_RXBUFO
-#define CONF_GMAC_NCFGR_RXBUFO 0
+#define CONF_GMAC_NCFGR_RXBUFO 2
 #endif
 
 // <q> Length Field Error Frame Discard
@@ -217,9 +219,10 @@
 // <q> Receive Checksum Offload Enable
 // <i> When set, the receive checksum engine is enabled. Frames with bad IP,
 // <i> TCP or UDP checksums are discarded.
+// <i> ethif_gmac.c then skips lwIP's receive checksum checks.
 // <id> gmac_arch_ncfgr_rxcoen
 #ifndef CONF_GMAC_NCFGR_RXCOEN
-#define CONF_GMAC_NCFGR_RXCOEN 0
+#define CONF_GMAC_NCFGR_RXCOEN 1
 #endif
 
 // <q> Enable Frames Received in Half Duplex
@@ -368,10 +371,11 @@
 // <i> Transmitter IP, TCP and UDP checksum generation offload enable. When
 // <i> set, the transmitter checksum generation engine is enabled to calculate
 // <i> and substitute checksums for transmit frames. When clear, frame data is
-// <i> unaffected
+// <i> unaffected. Needs full store and forward (TXPBMS, TPSF off);
+// <i> ethif_gmac.c then skips lwIP's checksum generation.
 // <id> gmac_arch_dcfgr_txcoen
 #ifndef CONF_GMAC_DCFGR_TXCOEN
-#define CONF_GMAC_DCFGR_TXCOEN 0
+#define CONF_GMAC_DCFGR_TXCOEN 1
 #endif
 
 // <o> DMA Receive Buffer Size <1-255>
@@ -381,8 +385,9 @@
 // <i> thus a value of 0x01 corresponds to buffers of 64 bytes, 0x02
 // <i> corresponds to 128 bytes etc.
 // <id> gmac_arch_dcfgr_drbs
+// <i> 24 (1536 bytes) holds a whole frame per buffer, as ethif_gmac.c requires.
 #ifndef CONF_GMAC_DCFGR_DRBS
-#define CONF_GMAC_DCFGR_DRBS 2
+#define CONF_GMAC_DCFGR_DRBS 24
 #endif
 
 // <q> DMA Discard Received Packets
@@ -406,22 +411,25 @@
 // <o> Number of Transmit Buffer Descriptor <1-255>
 // <i> Number of Transmit Buffer Descriptor
 // <id> gmac_arch_txdescr_num
+// <i> Only used until ethif_gmac.c installs its own transmit ring (GMAC_TX_DESC_COUNT).
 #ifndef CONF_GMAC_TXDESCR_NUM
-#define CONF_GMAC_TXDESCR_NUM 2
+#define CONF_GMAC_TXDESCR_NUM 1
 #endif
 
 // <o> Number of Receive Buffer Descriptor <1-255>
 // <i> Number of Receive Buffer Descriptor
 // <id> gmac_arch_rxdescr_num
+// <i> Only used until ethif_gmac.c installs its own receive ring (GMAC_RX_DESC_COUNT).
 #ifndef CONF_GMAC_RXDESCR_NUM
-#define CONF_GMAC_RXDESCR_NUM 16
+#define CONF_GMAC_RXDESCR_NUM 1
 #endif
 
 // <o> Byte size of Transmit Buffer <64-10240>
 // <i> Byte size of buffer for each transmit buffer descriptor.
 // <id> gmac_arch_txbuf_size
+// <i> Unused: ethif_gmac.c transmits straight from the pbufs.
 #ifndef CONF_GMAC_TXBUF_SIZE
-#define CONF_GMAC_TXBUF_SIZE 1500
+#define CONF_GMAC_TXBUF_SIZE 64
 #endif
 
 #ifndef CONF_GMAC_RXBUF_SIZE
@@ -2,6 +2,21 @@
 #ifndef LWIPOPTS_H
 #define LWIPOPTS_H
 
+/* A profile generated by pc/python/lwip_pools_gen.py from measured pool
+ * peaks (LWIP_PROFILE=<header> in the Makefiles). Included first, so its
+ * values take the place of the defaults below. */
+#ifdef LWIP_OPTS_PROFILE
+#include LWIP_OPTS_PROFILE
+#endif
+
+/* LWIP_MEM_PROFILE=1 builds the pools and heap below at twice their size,
+ * so a measurement run records the workload's demand rather than these
+ * limits; net_stats_print_pools() reports the peaks. */
+#ifndef LWIP_MEM_PROFILE
+#define LWIP_MEM_PROFILE 0
+#endif
+#define LWIP_MEM_SCALE (LWIP_MEM_PROFILE ? 2 : 1)
+
 // <<< Use Configuration Wizard in Context Menu >>>
 
 // <h> Basic Configuration
@@ -29,7 +44,7 @@
 // <i> Default: 4096
 // <id> lwip_mem_size
 #ifndef MEM_SIZE
-#define MEM_SIZE 14336
+#define MEM_SIZE (14336 * LWIP_MEM_SCALE)
 #endif
 
 // <q> Enables TCP
@@ -155,15 +170,19 @@
 // <i> Default: 5
 // <id> lwip_memp_num_tcp_pcb
 #ifndef MEMP_NUM_TCP_PCB
+#if defined(DOIP_CLIENT_SESSIONS) && DOIP_CLIENT_SESSIONS > 4
+#define MEMP_NUM_TCP_PCB (DOIP_CLIENT_SESSIONS + 1)  /* One per concurrent DoIP session */
+#else
 #define MEMP_NUM_TCP_PCB 5
 #endif
+#endif
 
 // <o> the number of listening TCP connections<0-1000>
 // <i> the number of listening TCP connections
 // <i> Default: 8
 // <id> lwip_memp_num_tcp_pcb_listen
 #ifndef MEMP_NUM_TCP_PCB_LISTEN
-#define MEMP_NUM_TCP_PCB_LISTEN 8
+#define MEMP_NUM_TCP_PCB_LISTEN 1  /* The DoIP client never listens */
 #endif
 
 // <o> the number of simultaneously queued TCP segments<0-1000>
@@ -171,7 +190,7 @@
 // <i> Default: 16
 // <id> lwip_memp_num_tcp_seg
 #ifndef MEMP_NUM_TCP_SEG
-#define MEMP_NUM_TCP_SEG 16
+#define MEMP_NUM_TCP_SEG (16 * LWIP_MEM_SCALE)
 #endif
 
 // <o> Number of bytes added before the ethernet header CPU<0-100000>
@@ -219,6 +238,9 @@
 #define SYS_LIGHTWEIGHT_PROT 0
 #endif
 
+/* The Makefiles' LWIP_SOCKETS=0 profile sets LWIP_NETCONN, LWIP_SOCKET and
+ * LWIP_COMPAT_SOCKETS to 0 on the command line; the DoIP client then runs on
+ * the raw API alone. */
 // <q> Enables Netconn API(not available when using "NO_SYS")
 // <id> lwip_netconn
 #ifndef LWIP_NETCONN
@@ -262,7 +284,7 @@
 // <i> Default: 5
 // <id> lwip_memp_num_reassdata
 #ifndef MEMP_NUM_REASSDATA
-#define MEMP_NUM_REASSDATA 5
+#define MEMP_NUM_REASSDATA (1 * LWIP_MEM_SCALE)  /* DoIP traffic is never fragmented */
 #endif
 
 // <o> the number of IP fragments simultaneously sent<0-1000>
@@ -270,7 +292,7 @@
 // <i> Default: 15
 // <id> lwip_memp_num_frag_pbuf
 #ifndef MEMP_NUM_FRAG_PBUF
-#define MEMP_NUM_FRAG_PBUF 15
+#define MEMP_NUM_FRAG_PBUF (2 * LWIP_MEM_SCALE)
 #endif
 
 // <o> the number of simulateously queued outgoing packets<0-1000>
@@ -278,7 +300,7 @@
 // <i> Default: 30
 // <id> lwip_memp_num_arp_queue
 #ifndef MEMP_NUM_ARP_QUEUE
-#define MEMP_NUM_ARP_QUEUE 30
+#define MEMP_NUM_ARP_QUEUE (4 * LWIP_MEM_SCALE)  /* One peer, resolved once per connection */
 #endif
 
 // <o> the number of struct netbufs<0-1000>
@@ -302,7 +324,13 @@
 // <i> Default: 16
 // <id> lwip_pbuf_pool_size
 #ifndef PBUF_POOL_SIZE
-#define PBUF_POOL_SIZE 16
+#define PBUF_POOL_SIZE (16 * LWIP_MEM_SCALE)
+#endif
+
+// <o> the number of PBUF_REF/PBUF_ROM pbufs from pbuf_alloc() (custom pbufs bring their own)<0-1000>
+// <id> lwip_memp_num_pbuf
+#ifndef MEMP_NUM_PBUF
+#define MEMP_NUM_PBUF (16 * LWIP_MEM_SCALE)
 #endif
 
 // <o> the number of bytes that should be allocated for a link level header<0-1000>
@@ -325,6 +353,20 @@
 
 #define PBUF_POOL_BUFSIZE LWIP_MEM_ALIGN_SIZE(TCP_MSS + 40 + PBUF_LINK_HLEN + PBUF_POOL_BUFSIZE_ADDED)
 
+// <q> Enable pbuf_custom (PBUF_REF pbufs with a free callback)
+// <i> The SAME54 netif lends GMAC receive buffers to lwIP this way
+// <id> lwip_support_custom_pbuf
+#ifndef LWIP_SUPPORT_CUSTOM_PBUF
+#define LWIP_SUPPORT_CUSTOM_PBUF 1
+#endif
+
+// <q> Per-netif checksum control (NETIF_SET_CHECKSUM_CTRL)
+// <i> Lets the SAME54 netif skip checksums the GMAC generates and checks
+// <id> lwip_checksum_ctrl_per_netif
+#ifndef LWIP_CHECKSUM_CTRL_PER_NETIF
+#define LWIP_CHECKSUM_CTRL_PER_NETIF 1
+#endif
+
 // <o> the number of multicast groups<0-1000>
 // <i> the number of multicast groups
 // <i> Default: 8
@@ -409,7 +451,7 @@
 // <q> Enables statistics collection in lwip_stats
 // <id> lwip_stats
 #ifndef LWIP_STATS
-#define LWIP_STATS 0
+#define LWIP_STATS 1
 #endif
 
 // <q> Compile in the statistics output functions
@@ -421,7 +463,7 @@
 // <q> Compile in the statistics output functions
 // <id> lwip_link_stats
 #ifndef LINK_STATS
-#define LINK_STATS 0
+#define LINK_STATS 1
 #endif
 
 // <q> Enable etharp stats
@@ -433,7 +475,7 @@
 // <q> Enable IP stats
 // <id> lwip_ip_stats
 #ifndef IP_STATS
-#define IP_STATS 0
+#define IP_STATS 1
 #endif
 
 // <q> Enable IP fragmentation stats
@@ -457,19 +499,19 @@
 // <q> Enable UDP stats
 // <id> lwip_udp_stats
 #ifndef UDP_STATS
-#define UDP_STATS 0
+#define UDP_STATS 1
 #endif
 
 // <q> Enable TCP stats
 // <id> lwip_tcp_stats
 #ifndef TCP_STATS
-#define TCP_STATS 0
+#define TCP_STATS 1
 #endif
 
 // <q> Enable memp.c stats
 // <id> lwip_memp_stats
 #ifndef MEMP_STATS
-#define MEMP_STATS 0
+#define MEMP_STATS 1
 #endif
 
 // <q> Enable system stats
@@ -478,6 +520,18 @@
 #define SYS_STATS 0
 #endif
 
+// <q> 32-bit statistics counters instead of 16-bit ones
+// <id> lwip_stats_large
+#ifndef LWIP_STATS_LARGE
+#define LWIP_STATS_LARGE 1
+#endif
+
+// <q> Enable MIB2 stats (TCP retransmitted segments, IP discards)
+// <id> lwip_mib2_stats
+#ifndef MIB2_STATS
+#define MIB2_STATS 1
+#endif
+
 // <q> Disable LwIP Assert
 // <id> lwip_assert
 #ifndef LWIP_NOASSERT
@@ -807,6 +861,42 @@
 
 // </e>
 
+/*
+ * DoIP size classes in place of the lwIP heap (LWIP_POOLS=1 in the
+ * Makefiles). mem_malloc() then takes the smallest of the pools listed in
+ * config/lwippools.h that fits, so PBUF_RAM allocations come from fixed
+ * blocks and MEM_SIZE is unused. Sizes include the pbuf header and the
+ * link, IP and TCP headers in front of the data (72 bytes):
+ *   MSG    control and UDS messages, ACK-only segments, ARP, struct dhcp
+ *   DGRAM  DHCP messages (548 bytes), vehicle announcements, long UDS responses
+ *   FRAME  full-MSS segments and frames the netif copies for the MAC
+ */
+#ifndef LWIP_DOIP_POOLS
+#define LWIP_DOIP_POOLS 0
+#endif
+
+#if LWIP_DOIP_POOLS
+#define MEM_USE_POOLS 1
+#define MEMP_USE_CUSTOM_POOLS 1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL 1
+#endif
+
+#define DOIP_POOL_MSG_SIZE 160
+#define DOIP_POOL_DGRAM_SIZE 640
+#define DOIP_POOL_FRAME_SIZE LWIP_MEM_ALIGN_SIZE(72 + TCP_MSS)
+
+#ifndef DOIP_POOL_MSG_NUM
+#define DOIP_POOL_MSG_NUM (16 * LWIP_MEM_SCALE)
+#endif
+
+#ifndef DOIP_POOL_DGRAM_NUM
+#define DOIP_POOL_DGRAM_NUM (4 * LWIP_MEM_SCALE)
+#endif
+
+#ifndef DOIP_POOL_FRAME_NUM
+#define DOIP_POOL_FRAME_NUM (6 * LWIP_MEM_SCALE)
+#endif
+
 /*
  * Network Event Logging Configuration
  * Enhanced debugging and event logging for lwIP network stack
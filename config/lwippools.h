@@ -0,0 +1,16 @@
+/**
+ * \file lwippools.h
+ * \brief DoIP size classes for mem_malloc() (LWIP_DOIP_POOLS=1)
+ *
+ * Included by lwIP's memp_std.h each time it builds the pool list, so
+ * there is no include guard. Sizes and counts are set in lwipopts.h;
+ * the classes must stay in ascending order of size.
+ */
+
+#if MEM_USE_POOLS
+LWIP_MALLOC_MEMPOOL_START
+LWIP_MALLOC_MEMPOOL(DOIP_POOL_MSG_NUM, DOIP_POOL_MSG_SIZE)
+LWIP_MALLOC_MEMPOOL(DOIP_POOL_DGRAM_NUM, DOIP_POOL_DGRAM_SIZE)
+LWIP_MALLOC_MEMPOOL(DOIP_POOL_FRAME_NUM, DOIP_POOL_FRAME_SIZE)
+LWIP_MALLOC_MEMPOOL_END
+#endif
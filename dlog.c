@@ -0,0 +1,269 @@
+/**
+ * \file dlog.c
+ * \brief Deferred binary logging
+ *
+ * Producers claim a slot by advancing head with a compare-and-swap, fill
+ * it and publish it by writing the slot's sequence number last. The drain
+ * task is the only consumer: it reads a slot once its sequence matches
+ * and releases it by advancing tail. No locks are taken and interrupts
+ * stay enabled, so logging is usable from lwIP callbacks and ISRs.
+ *
+ * The drain task and dlog_flush() are serialized with a mutex; only the
+ * consumer side ever blocks. It copies runs of published entries out of
+ * the ring with bsp_dma_copy(), two blocks when the run wraps, so a full
+ * line's worth goes to the DMAC.
+ */
+
+#include "dlog.h"
+#include "bsp_timestamp.h"
+#include "bsp_dma_copy.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "printf.h"
+#include "rtt_printf.h"
+#include <string.h>
+
+#define DLOG_TASK_PRIORITY      (tskIDLE_PRIORITY + 1)
+#define DLOG_TASK_STACK_SIZE    (512)
+
+#ifndef DLOG_DRAIN_PERIOD_MS
+#define DLOG_DRAIN_PERIOD_MS    10
+#endif
+
+/* 0: format entries on the target, 1: emit "[DLOG] <hex>" for the host decoder */
+#ifndef DLOG_DRAIN_BINARY
+#define DLOG_DRAIN_BINARY       0
+#endif
+
+/* Entries per "[DLOG]" line in binary mode */
+#define DLOG_ENTRIES_PER_LINE   16
+
+#if (DLOG_RING_SIZE & (DLOG_RING_SIZE - 1)) != 0
+#error "DLOG_RING_SIZE must be a power of two"
+#endif
+
+typedef struct {
+    volatile uint32_t seq;      /* Ticket + 1 once the entry is published */
+    const char *fmt;
+    uint32_t timestamp;         /* bsp_timestamp_now() ticks */
+    uint8_t level;
+    uint8_t module;
+    uint8_t argc;
+    uintptr_t args[DLOG_MAX_ARGS];
+} dlog_entry_t;
+
+static dlog_entry_t ring[DLOG_RING_SIZE];
+static dlog_entry_t drain_batch[DLOG_ENTRIES_PER_LINE];    /* Drain side only */
+static uint32_t ring_head;      /* Next ticket to hand out */
+static uint32_t ring_tail;      /* Next ticket to drain */
+static uint32_t ring_dropped;
+static SemaphoreHandle_t drain_mutex;
+static StaticSemaphore_t drain_mutex_buffer;
+static StaticTask_t drain_task_tcb;
+static StackType_t drain_task_stack[DLOG_TASK_STACK_SIZE];
+
+/* Known address in the format section; lets the decoder relocate fmt pointers */
+const char dlog_anchor[] __attribute__((section(DLOG_FMT_SECTION))) = "dlog";
+
+void dlog_write(const char *fmt, uint8_t level, uint8_t module, size_t argc, const uintptr_t *args)
+{
+    uint32_t ticket = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+
+    do {
+        if (ticket - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) >= DLOG_RING_SIZE) {
+            __atomic_fetch_add(&ring_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&ring_head, &ticket, ticket + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    dlog_entry_t *entry = &ring[ticket & (DLOG_RING_SIZE - 1)];
+
+    if (argc > DLOG_MAX_ARGS) {
+        argc = DLOG_MAX_ARGS;
+    }
+    entry->fmt = fmt;
+    entry->timestamp = bsp_timestamp_now();
+    entry->level = level;
+    entry->module = module;
+    entry->argc = (uint8_t)argc;
+    for (size_t i = 0; i < argc; i++) {
+        entry->args[i] = args[i];
+    }
+
+    __atomic_store_n(&entry->seq, ticket + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t dlog_dropped(void)
+{
+    return __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+}
+
+#if DLOG_DRAIN_BINARY
+
+static void put_hex(const uint8_t *data, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < len; i++) {
+        _putchar(hex[data[i] >> 4]);
+        _putchar(hex[data[i] & 0x0F]);
+    }
+}
+
+static void put_le(uintptr_t value, size_t size)
+{
+    uint8_t bytes[sizeof(uintptr_t)];
+
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    put_hex(bytes, size);
+}
+
+/*
+ * Line format, all integers little-endian:
+ *   'L' ptr_size anchor(ptr) dropped(u32)
+ *   then per entry: fmt(ptr) ts_us(u32) level(u8) module(u8) argc(u8) args(argc * ptr)
+ */
+static rtt_printf_channel_t output_previous;
+
+static void output_begin(void)
+{
+    static const uint8_t magic[2] = { 'L', sizeof(uintptr_t) };
+
+    output_previous = rtt_printf_select(RTT_PRINTF_CH_TRACE);
+    printf("[DLOG] ");
+    put_hex(magic, sizeof(magic));
+    put_le((uintptr_t)dlog_anchor, sizeof(uintptr_t));
+    put_le(dlog_dropped(), sizeof(uint32_t));
+}
+
+static void output_entry(const dlog_entry_t *entry)
+{
+    const uint8_t info[3] = { entry->level, entry->module, entry->argc };
+
+    put_le((uintptr_t)entry->fmt, sizeof(uintptr_t));
+    put_le(bsp_timestamp_to_us(entry->timestamp), sizeof(uint32_t));
+    put_hex(info, sizeof(info));
+    for (uint8_t i = 0; i < entry->argc; i++) {
+        put_le(entry->args[i], sizeof(uintptr_t));
+    }
+}
+
+static void output_end(void)
+{
+    printf("\r\n");
+    rtt_printf_select(output_previous);
+}
+
+#else
+
+static void output_begin(void)
+{
+}
+
+static void output_entry(const dlog_entry_t *entry)
+{
+    const uintptr_t *a = entry->args;
+    uint32_t us = bsp_timestamp_to_us(entry->timestamp);
+
+    /* Unused trailing words are zero and ignored by the format */
+    printf("%6lu.%06lu ", (unsigned long)(us / 1000000u), (unsigned long)(us % 1000000u));
+    printf(entry->fmt, a[0], a[1], a[2], a[3], a[4], a[5]);
+    printf("\r\n");
+}
+
+static void output_end(void)
+{
+}
+
+#endif /* DLOG_DRAIN_BINARY */
+
+/* Copy out and print every published entry, a line's worth at a time;
+ * single consumer only */
+static uint32_t dlog_drain(void)
+{
+    uint32_t count = 0;
+
+    for (;;) {
+        uint32_t tail = ring_tail;
+        uint32_t run = 0;
+
+        while (run < DLOG_ENTRIES_PER_LINE &&
+               __atomic_load_n(&ring[(tail + run) & (DLOG_RING_SIZE - 1)].seq, __ATOMIC_ACQUIRE) == tail + run + 1) {
+            run++;
+        }
+        if (run == 0) {
+            break;
+        }
+
+        uint32_t first = tail & (DLOG_RING_SIZE - 1);
+        uint32_t split = (run < DLOG_RING_SIZE - first) ? run : DLOG_RING_SIZE - first;
+        bsp_dma_copy_desc_t copy[2] = {
+            { drain_batch, &ring[first], split * sizeof(dlog_entry_t), NULL },
+            { &drain_batch[split], &ring[0], (run - split) * sizeof(dlog_entry_t), NULL },
+        };
+
+        if (split < run) {
+            copy[0].next = &copy[1];
+        }
+        bsp_dma_copy(&copy[0]);
+
+        /* Release the slots before the slow output so producers are not held up */
+        __atomic_store_n(&ring_tail, tail + run, __ATOMIC_RELEASE);
+
+        output_begin();
+        for (uint32_t i = 0; i < run; i++) {
+            dlog_entry_t *entry = &drain_batch[i];
+
+            memset(&entry->args[entry->argc], 0, (DLOG_MAX_ARGS - entry->argc) * sizeof(uintptr_t));
+            output_entry(entry);
+        }
+        output_end();
+        count += run;
+    }
+
+    return count;
+}
+
+void dlog_flush(void)
+{
+    if (drain_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(drain_mutex, portMAX_DELAY);
+    (void)dlog_drain();
+    xSemaphoreGive(drain_mutex);
+}
+
+static void dlog_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;) {
+        xSemaphoreTake(drain_mutex, portMAX_DELAY);
+        (void)dlog_drain();
+        xSemaphoreGive(drain_mutex);
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+    }
+}
+
+bool dlog_start(void)
+{
+    drain_mutex = xSemaphoreCreateMutexStatic(&drain_mutex_buffer);
+    if (drain_mutex == NULL) {
+        printf("DLog: Failed to create mutex\r\n");
+        return false;
+    }
+
+    if (xTaskCreateStatic(dlog_task, "DLog", DLOG_TASK_STACK_SIZE, NULL,
+                          DLOG_TASK_PRIORITY, drain_task_stack, &drain_task_tcb) == NULL) {
+        printf("DLog: Failed to create task\r\n");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * \file dlog.h
+ * \brief Deferred binary logging
+ *
+ * A log call stores only the address of its format string, a timestamp
+ * and the raw argument words in a lock-free ring; no formatting happens
+ * at the call site. A low priority task drains the ring and either
+ * formats the entries with printf() or, with DLOG_DRAIN_BINARY, writes
+ * them as "[DLOG] <hex>" lines on the RTT trace channel for
+ * pc/python/dlog_decode.py, which looks the format strings up in the ELF.
+ *
+ * Calls below DLOG_LEVEL or outside DLOG_MODULES compile to nothing,
+ * format string included.
+ *
+ * Arguments are captured as uintptr_t words: integers up to the pointer
+ * size, and %s only for string literals or other static strings (the
+ * pointer is dereferenced when the entry is formatted, not when logged).
+ * Pointer arguments need an explicit (uintptr_t) cast. Format strings
+ * carry no line ending; one is added per entry.
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Levels */
+#define DLOG_LVL_ERROR      1
+#define DLOG_LVL_WARN       2
+#define DLOG_LVL_INFO       3
+#define DLOG_LVL_DEBUG      4
+
+/* Modules */
+#define DLOG_MOD_DOIP       0   /* DOIP client task */
+#define DLOG_MOD_TCP        1   /* DOIP raw lwIP callbacks (tcpip thread) */
+#define DLOG_MOD_NET        2   /* Network interface and stack */
+#define DLOG_MOD_ETH        3   /* Ethernet MAC/PHY driver */
+
+/* Compile-time filters */
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL          DLOG_LVL_DEBUG
+#endif
+#ifndef DLOG_MODULES
+#define DLOG_MODULES        0xFFFFFFFFu     /* Bit per DLOG_MOD_x */
+#endif
+
+/* Ring entries; must be a power of two */
+#ifndef DLOG_RING_SIZE
+#define DLOG_RING_SIZE      64
+#endif
+#define DLOG_MAX_ARGS       6
+
+/* Format strings get their own section so the ELF decoder can find them */
+#define DLOG_FMT_SECTION    ".rodata.dlog"
+
+#define DLOG_ENABLED(level, module) \
+    ((level) <= DLOG_LEVEL && ((DLOG_MODULES >> (module)) & 1u))
+
+#define DLOG(level, module, fmt, ...)                                          \
+    do {                                                                       \
+        if (DLOG_ENABLED(level, module)) {                                     \
+            static const char dlog_fmt_[]                                      \
+                __attribute__((section(DLOG_FMT_SECTION))) = fmt;              \
+            const uintptr_t dlog_args_[] = { 0, ##__VA_ARGS__ };               \
+            dlog_write(dlog_fmt_, (level), (module),                           \
+                       sizeof(dlog_args_) / sizeof(uintptr_t) - 1,             \
+                       &dlog_args_[1]);                                        \
+        }                                                                      \
+    } while (0)
+
+#define DLOG_ERR(module, fmt, ...)  DLOG(DLOG_LVL_ERROR, module, fmt, ##__VA_ARGS__)
+#define DLOG_WRN(module, fmt, ...)  DLOG(DLOG_LVL_WARN, module, fmt, ##__VA_ARGS__)
+#define DLOG_INF(module, fmt, ...)  DLOG(DLOG_LVL_INFO, module, fmt, ##__VA_ARGS__)
+#define DLOG_DBG(module, fmt, ...)  DLOG(DLOG_LVL_DEBUG, module, fmt, ##__VA_ARGS__)
+
+/**
+ * \brief Append an entry to the ring (use the DLOG macros)
+ *
+ * Lock-free and safe from any task or interrupt. The entry is dropped
+ * and counted if the ring is full.
+ *
+ * \param[in] fmt Format string in DLOG_FMT_SECTION
+ * \param[in] level DLOG_LVL_x
+ * \param[in] module DLOG_MOD_x
+ * \param[in] argc Number of argument words, at most DLOG_MAX_ARGS
+ * \param[in] args Argument words
+ */
+void dlog_write(const char *fmt, uint8_t level, uint8_t module, size_t argc, const uintptr_t *args);
+
+/**
+ * \brief Create the drain task
+ * \return true if the task was created
+ */
+bool dlog_start(void);
+
+/**
+ * \brief Drain and output all committed entries from the calling task
+ *
+ * Used before the scheduler stops, so the tail of the log is not lost.
+ */
+void dlog_flush(void);
+
+/**
+ * \brief Number of entries dropped because the ring was full
+ */
+uint32_t dlog_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DLOG_H */
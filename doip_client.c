@@ -6,6 +6,18 @@
  */
 
 #include "doip_client.h"
+#include "doip_protocol.h"
+#include "doip_session.h"
+#include "doip_metrics.h"
+#include "doip_telemetry.h"
+#include "sys_stats.h"
+#include "net_stats.h"
+#include "housekeeping.h"
+#include "bsp_timestamp.h"
+#include "bsp_dma_copy.h"
+#include "dlog.h"
+#include "boot_time.h"
+#include "network_events.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "stream_buffer.h"
@@ -14,7 +26,11 @@
 #include "lwip/tcp.h"
 #include "lwip/err.h"
 #include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/tcpip.h"
+#if LWIP_SOCKET
 #include "lwip/sockets.h"
+#endif
 #include "lwip/ip_addr.h"
 #include "lwip/ip4_addr.h"
 #include "lwip/ip4_frag.h"
@@ -31,6 +47,33 @@
 #define DOIP_STREAM_BUFFER_SIZE      (4096)
 #define DOIP_STREAM_TRIGGER_LEVEL    (1)
 
+/* Vehicle identification response or announcement: header + 33-byte payload */
+#define DOIP_DISCOVERY_RX_SIZE       (DOIP_HEADER_SIZE + 64)
+
+/* Diagnostic cycle pacing - overridable so host builds can run cycles back to back */
+#ifndef DOIP_CLIENT_REQUEST_GAP_MS
+#define DOIP_CLIENT_REQUEST_GAP_MS   500     /* Delay between DID requests */
+#endif
+#ifndef DOIP_CLIENT_LISTEN_MS
+#define DOIP_CLIENT_LISTEN_MS        DOIP_ALIVE_CHECK_TIMEOUT_MS /* Listen window after alive check */
+#endif
+#ifndef DOIP_CLIENT_CYCLE_PERIOD_MS
+#define DOIP_CLIENT_CYCLE_PERIOD_MS  10000   /* Delay between diagnostic cycles */
+#endif
+#ifndef DOIP_CLIENT_MAX_CYCLES
+#define DOIP_CLIENT_MAX_CYCLES       0       /* Stop the scheduler after N cycles, 0 = run forever */
+#endif
+
+/* Concurrent sessions per cycle on the session scheduler (doip_session.h)
+ * in place of the blocking sequence, 0 = blocking sequence only. Each
+ * session holds a TCP pcb; MEMP_NUM_TCP_PCB follows in lwipopts.h */
+#ifndef DOIP_CLIENT_SESSIONS
+#define DOIP_CLIENT_SESSIONS         0
+#endif
+
+/* Start-up: the link is waited for at most this long once there is an address */
+#define DOIP_CLIENT_LINK_WAIT_MS     10000
+
 /* Global variables for socket-based implementation */
 static TaskHandle_t doip_client_task_handle = NULL;
 static doip_status_t doip_status = DOIP_STATUS_IDLE;
@@ -39,7 +82,40 @@ static int tcp_socket = -1;
 static bool doip_client_initialized = false;
 
 /* Global system monitoring data */
-static doip_system_monitoring_t system_monitoring_data;
+
+/* System monitoring: the identification strings are constant. The runtime
+ * fields are double-buffered: monitoring_runtime[monitoring_version & 1]
+ * is current, and an update is written to the other slot before the
+ * version moves readers over to it. */
+static const doip_monitoring_ident_t monitoring_ident = {
+    .spare_part_number = "SAME54-XPRO-DEV-001",
+    .ecu_sw_number = "ECU-SW-SAME54-001",
+    .ecu_sw_version_detailed = "v1.2.3-beta-20240729",
+    .system_supplier_id = "MICROCHIP",
+    .ecu_manufacturing_date = "2024-07-29",
+    .ecu_serial_number = "SAME54P20A-SN001234",
+    .kit_assembly_part_number = "ATSAME54-XPRO",
+    .ecu_network_name = "DOIP_SAME54_NET",
+    .ecu_network_address = "192.168.100.50",
+    .identification_data_traceability = "SAME54-DOIP-TRACE-001",
+    .ecu_pin_traceability = "PIN-TRACE-SAME54-001",
+    .boot_software_id = "BOOTLOADER-V2.1.0",
+    .application_sw_fingerprint = "SHA256:A1B2C3D4E5F67890ABCDEF1234567890FEDCBA0987654321",
+};
+static doip_monitoring_runtime_t monitoring_runtime[2] = {
+    {
+        .ecu_operating_hours = 1247,        /* Hours since manufacturing */
+        .vehicle_speed_kmh = 0,             /* Will be updated dynamically */
+        .engine_rpm = 800,                  /* Idle RPM */
+        .battery_voltage_mv = 12750,        /* 12.75V */
+        .temperature_celsius = 250,         /* 25.0°C */
+        .fuel_level_percent = 85,           /* 85% */
+        .active_diagnostic_session = 0x01,  /* Default session */
+        .error_memory_status = 0x00,        /* No errors */
+        .last_reset_reason = 0x01,          /* Power-on reset */
+    },
+};
+static uint32_t monitoring_version = 0;
 
 /* Global variables for raw lwIP implementation */
 static struct tcp_pcb *doip_pcb = NULL;
@@ -48,14 +124,32 @@ static SemaphoreHandle_t doip_connected_sem = NULL;
 static SemaphoreHandle_t doip_send_sem = NULL;
 static bool use_raw_lwip = false;
 
+/* Storage for the long-lived kernel objects */
+static StaticTask_t doip_client_task_tcb;
+static StackType_t doip_client_task_stack[DOIP_CLIENT_TASK_STACK_SIZE];
+static StaticStreamBuffer_t doip_stream_buffer_struct;
+static uint8_t doip_stream_buffer_storage[DOIP_STREAM_BUFFER_SIZE + 1];   /* One byte is never used */
+static StaticSemaphore_t doip_connected_sem_buffer;
+static StaticSemaphore_t doip_send_sem_buffer;
+
+/* Discovery on the raw UDP API: the pcb stays bound to the discovery port,
+ * so vehicle announcements arriving during a discovery are taken as well */
+static struct udp_pcb *doip_udp_pcb = NULL;
+static SemaphoreHandle_t doip_discovery_sem = NULL;
+static StaticSemaphore_t doip_discovery_sem_buffer;
+static uint8_t doip_discovery_rx[DOIP_DISCOVERY_RX_SIZE];
+static uint16_t doip_discovery_len;
+static uint32_t doip_discovery_ip;
+static bool doip_discovery_waiting = false;     /* Guarded by the tcpip core lock */
+
 /* Raw lwIP callback functions */
 
 static err_t doip_tcp_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
 {
-    printf("DOIP Client: Raw TCP connection callback - err=%d\r\n", err);
+    DLOG_DBG(DLOG_MOD_TCP, "DOIP Client: Raw TCP connection callback - err=%d", err);
     
     if (err == ERR_OK) {
-        printf("DOIP Client: Raw TCP connection established successfully\r\n");
+        DLOG_INF(DLOG_MOD_TCP, "DOIP Client: Raw TCP connection established successfully");
         doip_status = DOIP_STATUS_CONNECTED;
         
         /* Signal connection completion */
@@ -65,7 +159,7 @@ static err_t doip_tcp_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
             portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
     } else {
-        printf("DOIP Client: Raw TCP connection failed - err=%d\r\n", err);
+        DLOG_ERR(DLOG_MOD_TCP, "DOIP Client: Raw TCP connection failed - err=%d", err);
         doip_status = DOIP_STATUS_ERROR;
     }
     
@@ -76,13 +170,13 @@ static err_t doip_tcp_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
 {
     if (p == NULL) {
         /* Connection closed by peer */
-        printf("DOIP Client: Raw TCP connection closed by peer\r\n");
+        DLOG_INF(DLOG_MOD_TCP, "DOIP Client: Raw TCP connection closed by peer");
         doip_status = DOIP_STATUS_IDLE;
         return ERR_OK;
     }
     
     if (err != ERR_OK) {
-        printf("DOIP Client: Raw TCP receive error - err=%d\r\n", err);
+        DLOG_ERR(DLOG_MOD_TCP, "DOIP Client: Raw TCP receive error - err=%d", err);
         pbuf_free(p);
         return err;
     }
@@ -100,10 +194,11 @@ static err_t doip_tcp_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
         if (sent == p->len) {
             /* OPTIMIZATION: Only ACK data we successfully buffered */
             tcp_recved(tpcb, p->len);
-            printf("DOIP Client: Raw TCP received %d bytes, buffered and ACK sent\r\n", p->len);
+            DLOG_DBG(DLOG_MOD_TCP, "DOIP Client: Raw TCP received %u bytes, buffered and ACK sent", p->len);
         } else {
             /* Don't ACK data we couldn't buffer - this will trigger retransmission */
-            printf("DOIP Client: Stream buffer full, dropped %d bytes (buffered only %d) - no ACK\r\n", p->len, sent);
+            DLOG_WRN(DLOG_MOD_TCP, "DOIP Client: Stream buffer full, dropped %u bytes (buffered only %u) - no ACK",
+                     p->len, sent);
         }
         
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
@@ -115,7 +210,7 @@ static err_t doip_tcp_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_
 
 static err_t doip_tcp_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
 {
-    printf("DOIP Client: Raw TCP sent %d bytes acknowledged\r\n", len);
+    DLOG_DBG(DLOG_MOD_TCP, "DOIP Client: Raw TCP sent %u bytes acknowledged", len);
     
     /* Signal send completion */
     if (doip_send_sem != NULL) {
@@ -129,7 +224,7 @@ static err_t doip_tcp_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
 
 static void doip_tcp_err(void *arg, err_t err)
 {
-    printf("DOIP Client: Raw TCP error callback - err=%d\r\n", err);
+    DLOG_ERR(DLOG_MOD_TCP, "DOIP Client: Raw TCP error callback - err=%d", err);
     
     /* PCB is already freed by lwIP */
     doip_pcb = NULL;
@@ -143,6 +238,26 @@ static void doip_tcp_err(void *arg, err_t err)
     }
 }
 
+/* Runs in the tcpip thread with the core lock held */
+static void doip_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    (void)arg;
+    (void)pcb;
+    (void)port;
+
+    /* Other testers' identification requests reach this port too; only
+     * responses and announcements (same payload type) end the wait */
+    if (doip_discovery_waiting && p->tot_len >= DOIP_HEADER_SIZE &&
+        pbuf_get_at(p, 2) == (DOIP_VEHICLE_IDENTIFICATION_RESPONSE >> 8) &&
+        pbuf_get_at(p, 3) == (DOIP_VEHICLE_IDENTIFICATION_RESPONSE & 0xFF)) {
+        doip_discovery_len = pbuf_copy_partial(p, doip_discovery_rx, sizeof(doip_discovery_rx), 0);
+        doip_discovery_ip = ip4_addr_get_u32(ip_2_ip4(addr));
+        doip_discovery_waiting = false;
+        xSemaphoreGive(doip_discovery_sem);
+    }
+    pbuf_free(p);
+}
+
 /* Raw lwIP connection management functions */
 
 static bool doip_raw_init(void)
@@ -150,14 +265,15 @@ static bool doip_raw_init(void)
     printf("DOIP Client: Initializing raw lwIP resources\r\n");
     
     /* Create stream buffer for received data */
-    doip_stream_buffer = xStreamBufferCreate(DOIP_STREAM_BUFFER_SIZE, DOIP_STREAM_TRIGGER_LEVEL);
+    doip_stream_buffer = xStreamBufferCreateStatic(sizeof(doip_stream_buffer_storage), DOIP_STREAM_TRIGGER_LEVEL,
+                                                   doip_stream_buffer_storage, &doip_stream_buffer_struct);
     if (doip_stream_buffer == NULL) {
         printf("DOIP Client: Failed to create stream buffer\r\n");
         return false;
     }
     
     /* Create semaphores for synchronization */
-    doip_connected_sem = xSemaphoreCreateBinary();
+    doip_connected_sem = xSemaphoreCreateBinaryStatic(&doip_connected_sem_buffer);
     if (doip_connected_sem == NULL) {
         printf("DOIP Client: Failed to create connection semaphore\r\n");
         vStreamBufferDelete(doip_stream_buffer);
@@ -165,7 +281,7 @@ static bool doip_raw_init(void)
         return false;
     }
     
-    doip_send_sem = xSemaphoreCreateBinary();
+    doip_send_sem = xSemaphoreCreateBinaryStatic(&doip_send_sem_buffer);
     if (doip_send_sem == NULL) {
         printf("DOIP Client: Failed to create send semaphore\r\n");
         vSemaphoreDelete(doip_connected_sem);
@@ -269,27 +385,27 @@ static bool doip_raw_connect(uint32_t server_ip, uint16_t server_port)
 static bool doip_raw_send(const uint8_t *data, size_t len)
 {
     if (doip_pcb == NULL) {
-        printf("DOIP Client: Raw send - no connection\r\n");
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Raw send - no connection");
         return false;
     }
     
-    printf("DOIP Client: Raw TCP sending %d bytes\r\n", len);
+    DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw TCP sending %u bytes", len);
     
     /* OPTIMIZATION 4: Use TCP_WRITE_FLAG_MORE for better TCP efficiency */
     err_t err = tcp_write(doip_pcb, data, len, TCP_WRITE_FLAG_COPY);
     if (err != ERR_OK) {
-        printf("DOIP Client: tcp_write failed - err=%d\r\n", err);
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: tcp_write failed - err=%d", err);
         return false;
     }
     
     /* OPTIMIZATION 5: Immediate output without waiting for ACK */
     err = tcp_output(doip_pcb);
     if (err != ERR_OK) {
-        printf("DOIP Client: tcp_output failed - err=%d\r\n", err);
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: tcp_output failed - err=%d", err);
         return false;
     }
     
-    printf("DOIP Client: Raw TCP send initiated (non-blocking)\r\n");
+    DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw TCP send initiated (non-blocking)");
     return true;
 }
 
@@ -310,57 +426,166 @@ static void doip_raw_disconnect(void)
     }
 }
 
-/* System monitoring functions */
+/* Bind the discovery pcb on first use; the tcpip thread is running by then */
+static bool doip_udp_open(void)
+{
+    struct udp_pcb *pcb;
+
+    if (doip_udp_pcb != NULL) {
+        return true;
+    }
+    if (doip_discovery_sem == NULL) {
+        doip_discovery_sem = xSemaphoreCreateBinaryStatic(&doip_discovery_sem_buffer);
+    }
+
+    LOCK_TCPIP_CORE();
+    pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    if (pcb != NULL) {
+        ip_set_option(pcb, SOF_BROADCAST);
+        if (udp_bind(pcb, IP4_ADDR_ANY, DOIP_UDP_DISCOVERY_PORT) == ERR_OK) {
+            udp_recv(pcb, doip_udp_recv, NULL);
+            doip_udp_pcb = pcb;
+        } else {
+            udp_remove(pcb);
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+
+    return doip_udp_pcb != NULL;
+}
+
+/* Vehicle identification request to the broadcast address; arms the receive callback */
+static bool doip_udp_send_identification(void)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, DOIP_HEADER_SIZE, PBUF_RAM);
+    err_t err;
+
+    if (p == NULL) {
+        return false;
+    }
+    doip_serialize_header(p->payload, DOIP_VEHICLE_IDENTIFICATION_REQUEST, 0);
+
+    /* Drop a give left over from a response that raced the last timeout */
+    xSemaphoreTake(doip_discovery_sem, 0);
+
+    LOCK_TCPIP_CORE();
+    doip_discovery_waiting = true;
+    err = udp_sendto(doip_udp_pcb, p, IP_ADDR_BROADCAST, DOIP_UDP_DISCOVERY_PORT);
+    if (err != ERR_OK) {
+        doip_discovery_waiting = false;
+    }
+    UNLOCK_TCPIP_CORE();
+
+    pbuf_free(p);
+    if (err != ERR_OK) {
+        printf("DOIP Client: udp_sendto failed - err=%d\r\n", err);
+    }
+    return err == ERR_OK;
+}
+
+/* Socket fallback, used when the raw lwIP resources could not be set up.
+ * Built without LWIP_SOCKET (Makefile LWIP_SOCKETS=0) every call fails and
+ * doip_client_init() refuses to run without the raw path. */
+#if LWIP_SOCKET
+static int doip_socket_connect(uint32_t server_ip, uint16_t server_port)
+{
+    struct sockaddr_in server_addr;
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (s < 0) {
+        printf("DOIP Client: Failed to create TCP socket\r\n");
+        return -1;
+    }
+
+    /* Socket configuration for lwIP 2.2.2 - minimal setup to avoid compatibility issues */
+    printf("DOIP Client: Socket created, using manual timeout control\r\n");
+
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(server_port);
+    server_addr.sin_addr.s_addr = server_ip;
+
+    if (connect(s, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static int doip_socket_send(int s, const void *data, size_t len)
+{
+    return send(s, data, len, 0);
+}
+
+static int doip_socket_recv(int s, void *buffer, size_t len, bool wait)
+{
+    return recv(s, buffer, len, wait ? 0 : MSG_DONTWAIT);
+}
+
+static void doip_socket_close(int s)
+{
+    close(s);
+}
+#else
+static int doip_socket_connect(uint32_t server_ip, uint16_t server_port)
+{
+    (void)server_ip;
+    (void)server_port;
+    return -1;
+}
+
+static int doip_socket_send(int s, const void *data, size_t len)
+{
+    (void)s;
+    (void)data;
+    (void)len;
+    return -1;
+}
 
-static void doip_init_system_monitoring_data(void)
+static int doip_socket_recv(int s, void *buffer, size_t len, bool wait)
 {
-    /* Initialize system information */
-    system_monitoring_data.active_diagnostic_session = 0x01; /* Default session */
-    strcpy(system_monitoring_data.spare_part_number, "SAME54-XPRO-DEV-001");
-    strcpy(system_monitoring_data.ecu_sw_number, "ECU-SW-SAME54-001");
-    strcpy(system_monitoring_data.ecu_sw_version_detailed, "v1.2.3-beta-20240729");
-    strcpy(system_monitoring_data.system_supplier_id, "MICROCHIP");
-    strcpy(system_monitoring_data.ecu_manufacturing_date, "2024-07-29");
-    strcpy(system_monitoring_data.ecu_serial_number, "SAME54P20A-SN001234");
-    strcpy(system_monitoring_data.kit_assembly_part_number, "ATSAME54-XPRO");
-    
-    /* Initialize network information */
-    strcpy(system_monitoring_data.ecu_network_name, "DOIP_SAME54_NET");
-    strcpy(system_monitoring_data.ecu_network_address, "192.168.100.50");
-    strcpy(system_monitoring_data.identification_data_traceability, "SAME54-DOIP-TRACE-001");
-    strcpy(system_monitoring_data.ecu_pin_traceability, "PIN-TRACE-SAME54-001");
-    
-    /* Initialize runtime monitoring with mock values */
-    system_monitoring_data.ecu_operating_hours = 1247; /* Hours since manufacturing */
-    system_monitoring_data.vehicle_speed_kmh = 0;      /* Will be updated dynamically */
-    system_monitoring_data.engine_rpm = 800;           /* Idle RPM */
-    system_monitoring_data.battery_voltage_mv = 12750; /* 12.75V */
-    system_monitoring_data.temperature_celsius = 250;  /* 25.0°C */
-    system_monitoring_data.fuel_level_percent = 85;    /* 85% */
-    
-    /* Initialize diagnostic status */
-    system_monitoring_data.error_memory_status = 0x00; /* No errors */
-    system_monitoring_data.last_reset_reason = 0x01;   /* Power-on reset */
-    strcpy(system_monitoring_data.boot_software_id, "BOOTLOADER-V2.1.0");
-    strcpy(system_monitoring_data.application_sw_fingerprint, "SHA256:A1B2C3D4E5F67890ABCDEF1234567890FEDCBA0987654321");
+    (void)s;
+    (void)buffer;
+    (void)len;
+    (void)wait;
+    return -1;
 }
 
+static void doip_socket_close(int s)
+{
+    (void)s;
+}
+#endif
+
+/* System monitoring functions */
+
+/* Publish one update of the runtime fields; DOIP client task only */
 static void doip_update_dynamic_monitoring_data(void)
 {
     static uint32_t cycle_count = 0;
+    uint32_t version = monitoring_version;
+    doip_monitoring_runtime_t *next = &monitoring_runtime[(version + 1) & 1];
+    
     cycle_count++;
     
+    /* Readers of the previous version may still be copying this slot;
+     * they see the version change and retry */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    *next = monitoring_runtime[version & 1];
+    
     /* Simulate dynamic vehicle data */
-    system_monitoring_data.vehicle_speed_kmh = (cycle_count % 2) ? 45 + (cycle_count % 30) : 0;
-    system_monitoring_data.engine_rpm = 800 + (cycle_count % 1000);
-    system_monitoring_data.battery_voltage_mv = 12500 + (cycle_count % 500);
-    system_monitoring_data.temperature_celsius = 200 + (cycle_count % 300); /* 20-50°C range */
-    system_monitoring_data.fuel_level_percent = 85 - (cycle_count % 85);
+    next->vehicle_speed_kmh = (cycle_count % 2) ? 45 + (cycle_count % 30) : 0;
+    next->engine_rpm = 800 + (cycle_count % 1000);
+    next->battery_voltage_mv = 12500 + (cycle_count % 500);
+    next->temperature_celsius = 200 + (cycle_count % 300); /* 20-50°C range */
+    next->fuel_level_percent = 85 - (cycle_count % 85);
     
     /* Update operating hours periodically */
     if (cycle_count % 3600 == 0) { /* Every hour equivalent in cycles */
-        system_monitoring_data.ecu_operating_hours++;
+        next->ecu_operating_hours++;
     }
+    
+    __atomic_store_n(&monitoring_version, version + 1, __ATOMIC_RELEASE);
 }
 
 /* Function implementations */
@@ -375,19 +600,27 @@ bool doip_client_init(void)
     doip_status = DOIP_STATUS_IDLE;
     tcp_socket = -1;
     memset(&current_vehicle, 0, sizeof(current_vehicle));
-    
-    /* Initialize system monitoring data */
-    doip_init_system_monitoring_data();
 
     /* Try to initialize raw lwIP resources */
     if (doip_raw_init()) {
         use_raw_lwip = true;
         printf("DOIP Client: Initialized with raw lwIP API\r\n");
     } else {
+#if LWIP_SOCKET
         use_raw_lwip = false;
         printf("DOIP Client: Initialized with socket API (raw lwIP init failed)\r\n");
+#else
+        printf("DOIP Client: Raw lwIP init failed and the build has no socket API\r\n");
+        return false;
+#endif
     }
 
+#if DOIP_CLIENT_SESSIONS > 0
+    if (!doip_session_init()) {
+        return false;
+    }
+#endif
+
     doip_client_initialized = true;
     return true;
 }
@@ -404,16 +637,17 @@ bool doip_client_start_task(void)
         return true;
     }
 
-    BaseType_t result = xTaskCreate(
+    doip_client_task_handle = xTaskCreateStatic(
         doip_client_task,
         "DOIP_Client",
         DOIP_CLIENT_TASK_STACK_SIZE,
         NULL,
         DOIP_CLIENT_TASK_PRIORITY,
-        &doip_client_task_handle
+        doip_client_task_stack,
+        &doip_client_task_tcb
     );
 
-    if (result != pdPASS) {
+    if (doip_client_task_handle == NULL) {
         printf("DOIP Client: Failed to create task\r\n");
         return false;
     }
@@ -422,318 +656,180 @@ bool doip_client_start_task(void)
     return true;
 }
 
-void doip_create_header(doip_message_t *msg, uint16_t payload_type, uint32_t payload_length)
-{
-    msg->protocol_version = DOIP_PROTOCOL_VERSION;
-    msg->inverse_protocol_version = DOIP_INVERSE_PROTOCOL_VERSION;
-    msg->payload_type = payload_type;
-    msg->payload_length = payload_length;
-}
-
-bool doip_parse_header(const uint8_t *data, size_t data_len, doip_message_t *msg)
-{
-    if (data_len < DOIP_HEADER_SIZE) {
-        return false;
-    }
-
-    msg->protocol_version = data[0];
-    msg->inverse_protocol_version = data[1];
-    msg->payload_type = (data[2] << 8) | data[3];
-    msg->payload_length = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
-
-    if (msg->protocol_version != DOIP_PROTOCOL_VERSION ||
-        msg->inverse_protocol_version != DOIP_INVERSE_PROTOCOL_VERSION) {
-        return false;
-    }
-
-    if (msg->payload_length > DOIP_MAX_PAYLOAD_SIZE) {
-        return false;
-    }
-
-    /* Copy payload if available */
-    if (data_len >= DOIP_HEADER_SIZE + msg->payload_length) {
-        /* We have the complete message including payload */
-        if (msg->payload_length > 0) {
-            memcpy(msg->payload, &data[DOIP_HEADER_SIZE], msg->payload_length);
-        }
-    } else if (data_len > DOIP_HEADER_SIZE && msg->payload_length > 0) {
-        /* We have partial payload data */
-        size_t copy_len = (data_len - DOIP_HEADER_SIZE);
-        if (copy_len > msg->payload_length) {
-            copy_len = msg->payload_length;
-        }
-        memcpy(msg->payload, &data[DOIP_HEADER_SIZE], copy_len);
-    }
-    /* Don't reset payload_length to 0 - keep the length from header parsing */
-
-    return true;
-}
-
 bool doip_send_tcp_message(int socket, const doip_message_t *msg)
 {
     uint8_t buffer[DOIP_HEADER_SIZE + DOIP_MAX_PAYLOAD_SIZE];
-    size_t total_length = DOIP_HEADER_SIZE + msg->payload_length;
+    size_t total_length = doip_serialize_message(msg, buffer, sizeof(buffer));
     
-    /* Serialize message */
-    buffer[0] = msg->protocol_version;
-    buffer[1] = msg->inverse_protocol_version;
-    buffer[2] = (msg->payload_type >> 8) & 0xFF;
-    buffer[3] = msg->payload_type & 0xFF;
-    buffer[4] = (msg->payload_length >> 24) & 0xFF;
-    buffer[5] = (msg->payload_length >> 16) & 0xFF;
-    buffer[6] = (msg->payload_length >> 8) & 0xFF;
-    buffer[7] = msg->payload_length & 0xFF;
-    memcpy(&buffer[8], msg->payload, msg->payload_length);
+    if (total_length == 0) {
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Message too large to serialize (len=%u)", msg->payload_length);
+        return false;
+    }
     
     if (use_raw_lwip) {
         /* Raw lwIP implementation */
-        printf("DOIP Client: Raw lwIP - sending message (type=0x%04X, len=%lu)\r\n",
-               msg->payload_type, msg->payload_length);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - sending message (type=0x%04X, len=%u)",
+                 msg->payload_type, msg->payload_length);
         return doip_raw_send(buffer, total_length);
     } else {
         /* Socket-based implementation */
-        int result = send(socket, buffer, total_length, 0);
-        printf("DOIP Client: Socket - sent %d bytes (expected %d)\r\n", result, total_length);
+        int result = doip_socket_send(socket, buffer, total_length);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Socket - sent %d bytes (expected %u)", result, total_length);
         return (result >= 0);
     }
 }
 
+static void doip_report_reasm_error(const char *path, doip_reasm_status_t status, const doip_message_t *msg)
+{
+    if (status == DOIP_REASM_ERR_VERSION) {
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: %s - invalid protocol version in header", (uintptr_t)path);
+    } else if (status == DOIP_REASM_ERR_LENGTH) {
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: %s - payload too large (%u bytes)", (uintptr_t)path,
+                 msg->payload_length);
+    }
+}
+
 bool doip_receive_tcp_message(int socket, doip_message_t *msg, uint32_t timeout_ms)
 {
+    /* Header goes to the reassembler, payload is received straight into msg */
+    doip_reassembler_t reasm;
+    doip_reasm_status_t status = DOIP_REASM_INCOMPLETE;
+    TickType_t start_time = xTaskGetTickCount();
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    uint8_t *dst;
+    size_t want;
+    
+    doip_reasm_reset(&reasm, msg);
+    
     if (use_raw_lwip) {
         /* Raw lwIP implementation using stream buffer */
-        uint8_t buffer[DOIP_HEADER_SIZE + DOIP_MAX_PAYLOAD_SIZE];
-        size_t received;
-        
-        /* First, receive the DOIP header (8 bytes) */
-        printf("DOIP Client: Raw lwIP - waiting for header (%lu ms timeout)...\r\n", timeout_ms);
-        received = xStreamBufferReceive(
-            doip_stream_buffer,
-            buffer,
-            DOIP_HEADER_SIZE,
-            pdMS_TO_TICKS(timeout_ms)
-        );
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - waiting for message (%u ms timeout)...", timeout_ms);
         
-        if (received != DOIP_HEADER_SIZE) {
+        while (status == DOIP_REASM_INCOMPLETE) {
+            TickType_t elapsed = xTaskGetTickCount() - start_time;
+            TickType_t remaining = (elapsed < timeout_ticks) ? (timeout_ticks - elapsed) : 0;
+            
+            want = doip_reasm_next(&reasm, &dst);
+            size_t received = xStreamBufferReceive(doip_stream_buffer, dst, want, remaining);
+            
             if (received == 0) {
-                /* Normal timeout - no data available */
-                printf("DOIP Client: Raw lwIP - timeout waiting for header\r\n");
-                return false;
-            } else {
-                printf("DOIP Client: Raw lwIP - partial header received (%d bytes)\r\n", received);
+                if (reasm.header_len == 0) {
+                    /* Normal timeout - no data available */
+                    DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - timeout waiting for header");
+                } else if (reasm.header_len < DOIP_HEADER_SIZE) {
+                    DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - partial header received (%u bytes)",
+                             reasm.header_len);
+                } else {
+                    DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - failed to receive payload (%u/%u bytes)",
+                             reasm.payload_len, msg->payload_length);
+                }
                 return false;
             }
+            
+            status = doip_reasm_commit(&reasm, received);
         }
         
-        printf("DOIP Client: Raw lwIP - header received successfully\r\n");
-        
-        /* Parse header to determine payload length */
-        msg->protocol_version = buffer[0];
-        msg->inverse_protocol_version = buffer[1];
-        msg->payload_type = (buffer[2] << 8) | buffer[3];
-        msg->payload_length = (buffer[4] << 24) | (buffer[5] << 16) | 
-                             (buffer[6] << 8) | buffer[7];
-        
-        /* Validate header */
-        if (msg->protocol_version != DOIP_PROTOCOL_VERSION ||
-            msg->inverse_protocol_version != DOIP_INVERSE_PROTOCOL_VERSION) {
-            printf("DOIP Client: Raw lwIP - invalid protocol version in header\r\n");
-            return false;
-        }
-        
-        if (msg->payload_length > DOIP_MAX_PAYLOAD_SIZE) {
-            printf("DOIP Client: Raw lwIP - payload too large (%lu bytes)\r\n", msg->payload_length);
+        if (status != DOIP_REASM_COMPLETE) {
+            doip_report_reasm_error("Raw lwIP", status, msg);
             return false;
         }
         
-        /* Receive payload if present */
-        if (msg->payload_length > 0) {
-            received = xStreamBufferReceive(
-                doip_stream_buffer,
-                msg->payload,
-                msg->payload_length,
-                pdMS_TO_TICKS(timeout_ms)
-            );
-            
-            if (received != msg->payload_length) {
-                printf("DOIP Client: Raw lwIP - failed to receive payload (%d/%lu bytes)\r\n", 
-                       received, msg->payload_length);
-                return false;
-            }
-        }
-        
-        printf("DOIP Client: Raw lwIP - received complete message (type=0x%04X, len=%lu)\r\n",
-               msg->payload_type, msg->payload_length);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Raw lwIP - received complete message (type=0x%04X, len=%u)",
+                 msg->payload_type, msg->payload_length);
         return true;
         
     } else {
-        /* Socket-based implementation (existing polling approach) */
-        uint8_t buffer[DOIP_HEADER_SIZE + DOIP_MAX_PAYLOAD_SIZE];
-        int bytes_received;
-        int total_received = 0;
-        TickType_t start_time = xTaskGetTickCount();
-        TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-        
-        /* First, try to receive at least the DOIP header */
-        while (total_received < DOIP_HEADER_SIZE) {
-            bytes_received = recv(socket, buffer + total_received, 
-                                 DOIP_HEADER_SIZE - total_received, MSG_DONTWAIT);
+        /* Socket-based implementation (polling approach) */
+        while (status == DOIP_REASM_INCOMPLETE) {
+            want = doip_reasm_next(&reasm, &dst);
+            int bytes_received = doip_socket_recv(socket, dst, want, false);
             
             if (bytes_received > 0) {
-                total_received += bytes_received;
+                status = doip_reasm_commit(&reasm, (size_t)bytes_received);
             } else if (bytes_received == 0) {
                 /* Connection closed */
-                printf("DOIP Client: Socket - connection closed during header reception\r\n");
+                DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Socket - connection closed during %s reception",
+                         (uintptr_t)((reasm.header_len < DOIP_HEADER_SIZE) ? "header" : "payload"));
                 return false;
             } else {
                 /* No data available or error */
                 if ((xTaskGetTickCount() - start_time) >= timeout_ticks) {
-                    /* Timeout occurred */
-                    if (total_received == 0) {
+                    if (reasm.header_len == 0) {
                         /* No data received at all - this is normal timeout */
-                        return false;
-                    } else {
+                    } else if (reasm.header_len < DOIP_HEADER_SIZE) {
                         /* Partial header received - this is an error */
-                        printf("DOIP Client: Socket - timeout during header reception (%d bytes)\r\n", total_received);
-                        return false;
+                        DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Socket - timeout during header reception (%u bytes)",
+                                 reasm.header_len);
+                    } else {
+                        DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Socket - timeout during payload reception (%u/%u bytes)",
+                                 reasm.payload_len, msg->payload_length);
                     }
+                    return false;
                 }
                 /* Brief delay before retry */
                 vTaskDelay(pdMS_TO_TICKS(10));
             }
         }
         
-        /* Parse header to determine payload length */
-        msg->protocol_version = buffer[0];
-        msg->inverse_protocol_version = buffer[1];
-        msg->payload_type = (buffer[2] << 8) | buffer[3];
-        msg->payload_length = (buffer[4] << 24) | (buffer[5] << 16) | 
-                             (buffer[6] << 8) | buffer[7];
-        
-        /* Validate header */
-        if (msg->protocol_version != DOIP_PROTOCOL_VERSION ||
-            msg->inverse_protocol_version != DOIP_INVERSE_PROTOCOL_VERSION) {
-            printf("DOIP Client: Socket - invalid protocol version in header\r\n");
+        if (status != DOIP_REASM_COMPLETE) {
+            doip_report_reasm_error("Socket", status, msg);
             return false;
         }
         
-        if (msg->payload_length > DOIP_MAX_PAYLOAD_SIZE) {
-            printf("DOIP Client: Socket - payload too large (%lu bytes)\r\n", msg->payload_length);
-            return false;
-        }
-        
-        /* Receive payload if present */
-        if (msg->payload_length > 0) {
-            size_t target_total = DOIP_HEADER_SIZE + msg->payload_length;
-            
-            while (total_received < target_total) {
-                bytes_received = recv(socket, buffer + total_received,
-                                     target_total - total_received, MSG_DONTWAIT);
-                
-                if (bytes_received > 0) {
-                    total_received += bytes_received;
-                } else if (bytes_received == 0) {
-                    /* Connection closed */
-                    printf("DOIP Client: Socket - connection closed during payload reception\r\n");
-                    return false;
-                } else {
-                    /* No data available or error */
-                    if ((xTaskGetTickCount() - start_time) >= timeout_ticks) {
-                        printf("DOIP Client: Socket - timeout during payload reception (%d/%lu bytes)\r\n", 
-                               total_received - DOIP_HEADER_SIZE, msg->payload_length);
-                        return false;
-                    }
-                    /* Brief delay before retry */
-                    vTaskDelay(pdMS_TO_TICKS(10));
-                }
-            }
-            
-            /* Copy payload to message structure */
-            memcpy(msg->payload, &buffer[DOIP_HEADER_SIZE], msg->payload_length);
-        }
-        
         return true;
     }
 }
 
+/* Close a phase latency sample started with bsp_timestamp_now() */
+static void doip_phase_done(doip_phase_t phase, uint32_t start, bool ok)
+{
+    doip_metrics_record_phase(phase, bsp_timestamp_elapsed_us(start), ok);
+}
+
 bool doip_discover_vehicles(doip_vehicle_info_t *vehicle_info)
 {
-    int udp_socket = -1;
-    struct sockaddr_in broadcast_addr;
-    struct sockaddr_in response_addr;
-    socklen_t addr_len = sizeof(response_addr);
-    doip_message_t request_msg, response_msg;
-    uint8_t buffer[1024];
-    int result;
-    struct timeval timeout;
+    doip_message_t response_msg;
+    ip4_addr_t vehicle_addr;
+    bool received;
 
     printf("DOIP Client: Starting vehicle discovery\r\n");
     doip_status = DOIP_STATUS_DISCOVERING;
 
-    /* Create UDP socket */
-    udp_socket = socket(AF_INET, SOCK_DGRAM, 0);
-    if (udp_socket < 0) {
-        printf("DOIP Client: Failed to create UDP socket (error: %d)\r\n", udp_socket);
+    if (!doip_udp_open()) {
+        printf("DOIP Client: Failed to bind UDP port %d\r\n", DOIP_UDP_DISCOVERY_PORT);
         doip_status = DOIP_STATUS_ERROR;
         return false;
     }
-    
-    printf("DOIP Client: UDP socket created successfully\r\n");
-
-    /* Enable broadcast */
-    int broadcast_enable = 1;
-    setsockopt(udp_socket, SOL_SOCKET, SO_BROADCAST, &broadcast_enable, sizeof(broadcast_enable));
-
-    /* Set receive timeout */
-    timeout.tv_sec = DOIP_DISCOVERY_TIMEOUT_MS / 1000;
-    timeout.tv_usec = (DOIP_DISCOVERY_TIMEOUT_MS % 1000) * 1000;
-    setsockopt(udp_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
-    /* Prepare broadcast address */
-    memset(&broadcast_addr, 0, sizeof(broadcast_addr));
-    broadcast_addr.sin_family = AF_INET;
-    broadcast_addr.sin_port = htons(DOIP_UDP_DISCOVERY_PORT);
-    broadcast_addr.sin_addr.s_addr = INADDR_BROADCAST;
-
-    /* Create vehicle identification request */
-    doip_create_header(&request_msg, DOIP_VEHICLE_IDENTIFICATION_REQUEST, 0);
-
-    /* Serialize header */
-    buffer[0] = request_msg.protocol_version;
-    buffer[1] = request_msg.inverse_protocol_version;
-    buffer[2] = (request_msg.payload_type >> 8) & 0xFF;
-    buffer[3] = request_msg.payload_type & 0xFF;
-    buffer[4] = (request_msg.payload_length >> 24) & 0xFF;
-    buffer[5] = (request_msg.payload_length >> 16) & 0xFF;
-    buffer[6] = (request_msg.payload_length >> 8) & 0xFF;
-    buffer[7] = request_msg.payload_length & 0xFF;
-
-    /* Send broadcast request */
-    result = sendto(udp_socket, buffer, DOIP_HEADER_SIZE, 0,
-                   (struct sockaddr*)&broadcast_addr, sizeof(broadcast_addr));
-    if (result < 0) {
-        printf("DOIP Client: Failed to send discovery request (error: %d)\r\n", result);
-        close(udp_socket);
+
+    /* Send broadcast request (header only) */
+    uint32_t t_start = bsp_timestamp_now();
+    if (!doip_udp_send_identification()) {
+        printf("DOIP Client: Failed to send discovery request\r\n");
         doip_status = DOIP_STATUS_ERROR;
         return false;
     }
 
     printf("DOIP Client: Discovery request sent\r\n");
 
-    /* Wait for response */
-    result = recvfrom(udp_socket, buffer, sizeof(buffer), 0,
-                     (struct sockaddr*)&response_addr, &addr_len);
-    
-    close(udp_socket);
+    /* Wait for response; the callback has copied it by the time the semaphore is given */
+    received = xSemaphoreTake(doip_discovery_sem, pdMS_TO_TICKS(DOIP_DISCOVERY_TIMEOUT_MS)) == pdTRUE;
+    if (!received) {
+        LOCK_TCPIP_CORE();
+        doip_discovery_waiting = false;
+        UNLOCK_TCPIP_CORE();
+    }
+
+    doip_phase_done(DOIP_PHASE_DISCOVERY, t_start, received);
 
-    if (result < 0) {
+    if (!received) {
         printf("DOIP Client: No discovery response received\r\n");
         doip_status = DOIP_STATUS_IDLE;
         return false;
     }
+    boot_time_mark(BOOT_MARK_DOIP);
 
     /* Parse response */
-    if (!doip_parse_header(buffer, result, &response_msg)) {
+    if (!doip_parse_header(doip_discovery_rx, doip_discovery_len, &response_msg)) {
         printf("DOIP Client: Invalid discovery response header\r\n");
         doip_status = DOIP_STATUS_ERROR;
         return false;
@@ -775,7 +871,7 @@ bool doip_discover_vehicles(doip_vehicle_info_t *vehicle_info)
         memset(vehicle_info->group_id, 0x00, 6);
     }
     
-    vehicle_info->ip_address = response_addr.sin_addr.s_addr;
+    vehicle_info->ip_address = doip_discovery_ip;
     vehicle_info->tcp_port = DOIP_TCP_DATA_PORT;
 
     /* Store current vehicle info */
@@ -786,8 +882,8 @@ bool doip_discover_vehicles(doip_vehicle_info_t *vehicle_info)
     printf("  VIN: %s\r\n", vehicle_info->vin);
     printf("  Logical Address: 0x%04X\r\n", vehicle_info->logical_address);
     
-    struct in_addr addr_copy = response_addr.sin_addr;
-    printf("  IP Address: %s\r\n", inet_ntoa(addr_copy));
+    ip4_addr_set_u32(&vehicle_addr, doip_discovery_ip);
+    printf("  IP Address: %s\r\n", ip4addr_ntoa(&vehicle_addr));
 
     return true;
 }
@@ -797,13 +893,17 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
     doip_message_t request_msg, response_msg;
     uint8_t buffer[1024];
     int result;
+    uint32_t t_start;
 
     printf("DOIP Client: Connecting to vehicle\r\n");
     doip_status = DOIP_STATUS_CONNECTING;
 
     if (use_raw_lwip) {
         /* Raw lwIP implementation */
-        if (!doip_raw_connect(vehicle_info->ip_address, vehicle_info->tcp_port)) {
+        t_start = bsp_timestamp_now();
+        bool connected = doip_raw_connect(vehicle_info->ip_address, vehicle_info->tcp_port);
+        doip_phase_done(DOIP_PHASE_CONNECT, t_start, connected);
+        if (!connected) {
             printf("DOIP Client: Raw lwIP connection failed\r\n");
             doip_status = DOIP_STATUS_ERROR;
             return false;
@@ -811,30 +911,11 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
         printf("DOIP Client: Raw lwIP connection established\r\n");
     } else {
         /* Socket-based implementation */
-        struct sockaddr_in server_addr;
-        
-        /* Create TCP socket */
-        tcp_socket = socket(AF_INET, SOCK_STREAM, 0);
+        t_start = bsp_timestamp_now();
+        tcp_socket = doip_socket_connect(vehicle_info->ip_address, vehicle_info->tcp_port);
+        doip_phase_done(DOIP_PHASE_CONNECT, t_start, tcp_socket >= 0);
         if (tcp_socket < 0) {
-            printf("DOIP Client: Failed to create TCP socket\r\n");
-            doip_status = DOIP_STATUS_ERROR;
-            return false;
-        }
-
-        /* Socket configuration for lwIP 2.2.2 - minimal setup to avoid compatibility issues */
-        printf("DOIP Client: Socket created, using manual timeout control\r\n");
-
-        /* Connect to vehicle */
-        memset(&server_addr, 0, sizeof(server_addr));
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(vehicle_info->tcp_port);
-        server_addr.sin_addr.s_addr = vehicle_info->ip_address;
-
-        result = connect(tcp_socket, (struct sockaddr*)&server_addr, sizeof(server_addr));
-        if (result < 0) {
             printf("DOIP Client: TCP connection failed\r\n");
-            close(tcp_socket);
-            tcp_socket = -1;
             doip_status = DOIP_STATUS_ERROR;
             return false;
         }
@@ -853,6 +934,7 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
     memset(&request_msg.payload[3], 0x00, 4);  /* Reserved */
 
     /* Send routing activation request using hybrid approach */
+    t_start = bsp_timestamp_now();
     if (use_raw_lwip) {
         /* Raw lwIP mode */
         if (!doip_send_tcp_message(-1, &request_msg)) {
@@ -863,20 +945,12 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
         }
     } else {
         /* Socket mode - serialize and send message */
-        buffer[0] = request_msg.protocol_version;
-        buffer[1] = request_msg.inverse_protocol_version;
-        buffer[2] = (request_msg.payload_type >> 8) & 0xFF;
-        buffer[3] = request_msg.payload_type & 0xFF;
-        buffer[4] = (request_msg.payload_length >> 24) & 0xFF;
-        buffer[5] = (request_msg.payload_length >> 16) & 0xFF;
-        buffer[6] = (request_msg.payload_length >> 8) & 0xFF;
-        buffer[7] = request_msg.payload_length & 0xFF;
-        memcpy(&buffer[8], request_msg.payload, request_msg.payload_length);
-
-        result = send(tcp_socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length, 0);
+        doip_serialize_message(&request_msg, buffer, sizeof(buffer));
+
+        result = doip_socket_send(tcp_socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length);
         if (result < 0) {
             printf("DOIP Client: Failed to send routing activation request (socket)\r\n");
-            close(tcp_socket);
+            doip_socket_close(tcp_socket);
             tcp_socket = -1;
             doip_status = DOIP_STATUS_ERROR;
             return false;
@@ -886,7 +960,9 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
     /* Receive routing activation response using hybrid approach */
     if (use_raw_lwip) {
         /* Raw lwIP mode */
-        if (!doip_receive_tcp_message(-1, &response_msg, DOIP_TCP_TIMEOUT_MS)) {
+        bool received = doip_receive_tcp_message(-1, &response_msg, DOIP_TCP_TIMEOUT_MS);
+        doip_phase_done(DOIP_PHASE_ACTIVATION, t_start, received);
+        if (!received) {
             printf("DOIP Client: Failed to receive routing activation response (raw lwIP)\r\n");
             doip_raw_disconnect();
             doip_status = DOIP_STATUS_ERROR;
@@ -894,10 +970,11 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
         }
     } else {
         /* Socket mode */
-        result = recv(tcp_socket, buffer, sizeof(buffer), 0);
+        result = doip_socket_recv(tcp_socket, buffer, sizeof(buffer), true);
+        doip_phase_done(DOIP_PHASE_ACTIVATION, t_start, result >= 0);
         if (result < 0) {
             printf("DOIP Client: Failed to receive routing activation response (socket)\r\n");
-            close(tcp_socket);
+            doip_socket_close(tcp_socket);
             tcp_socket = -1;
             doip_status = DOIP_STATUS_ERROR;
             return false;
@@ -905,7 +982,7 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
         
         if (!doip_parse_header(buffer, result, &response_msg)) {
             printf("DOIP Client: Invalid routing activation response\r\n");
-            close(tcp_socket);
+            doip_socket_close(tcp_socket);
             tcp_socket = -1;
             doip_status = DOIP_STATUS_ERROR;
             return false;
@@ -917,7 +994,7 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
         if (use_raw_lwip) {
             doip_raw_disconnect();
         } else {
-            close(tcp_socket);
+            doip_socket_close(tcp_socket);
             tcp_socket = -1;
         }
         doip_status = DOIP_STATUS_ERROR;
@@ -939,7 +1016,7 @@ bool doip_connect_to_vehicle(const doip_vehicle_info_t *vehicle_info)
     if (use_raw_lwip) {
         doip_raw_disconnect();
     } else {
-        close(tcp_socket);
+        doip_socket_close(tcp_socket);
         tcp_socket = -1;
     }
     doip_status = DOIP_STATUS_ERROR;
@@ -981,52 +1058,50 @@ int doip_send_diagnostic_request(uint8_t service_id, uint16_t data_id,
     request_msg.payload[6] = data_id & 0xFF;
 
     /* Send diagnostic request using hybrid approach */
+    uint32_t t_start = bsp_timestamp_now();
     if (use_raw_lwip) {
         /* Raw lwIP mode */
         if (!doip_send_tcp_message(-1, &request_msg)) {
-            printf("DOIP Client: Failed to send diagnostic request (raw lwIP)\r\n");
+            DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Failed to send diagnostic request (raw lwIP)");
+            doip_metrics_record_did(data_id, 0, false);
             return -1;
         }
-        printf("DOIP Client: Sent diagnostic request - Service: 0x%02X, DID: 0x%04X (raw lwIP)\r\n", 
-               service_id, data_id);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Sent diagnostic request - Service: 0x%02X, DID: 0x%04X (raw lwIP)",
+                 service_id, data_id);
     } else {
         /* Socket mode - serialize and send message */
-        buffer[0] = request_msg.protocol_version;
-        buffer[1] = request_msg.inverse_protocol_version;
-        buffer[2] = (request_msg.payload_type >> 8) & 0xFF;
-        buffer[3] = request_msg.payload_type & 0xFF;
-        buffer[4] = (request_msg.payload_length >> 24) & 0xFF;
-        buffer[5] = (request_msg.payload_length >> 16) & 0xFF;
-        buffer[6] = (request_msg.payload_length >> 8) & 0xFF;
-        buffer[7] = request_msg.payload_length & 0xFF;
-        memcpy(&buffer[8], request_msg.payload, request_msg.payload_length);
-
-        result = send(tcp_socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length, 0);
+        doip_serialize_message(&request_msg, buffer, sizeof(buffer));
+
+        result = doip_socket_send(tcp_socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length);
         if (result < 0) {
-            printf("DOIP Client: Failed to send diagnostic request (socket, error: %d)\r\n", result);
+            DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Failed to send diagnostic request (socket, error: %d)", result);
+            doip_metrics_record_did(data_id, 0, false);
             return -1;
         }
         if (result != (DOIP_HEADER_SIZE + request_msg.payload_length)) {
-            printf("DOIP Client: Partial send - sent %d of %d bytes\r\n", 
-                   result, DOIP_HEADER_SIZE + request_msg.payload_length);
+            DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Partial send - sent %d of %u bytes",
+                     result, DOIP_HEADER_SIZE + request_msg.payload_length);
+            doip_metrics_record_did(data_id, 0, false);
             return -1;
         }
-        printf("DOIP Client: Sent diagnostic request - Service: 0x%02X, DID: 0x%04X (%d bytes sent)\r\n", 
-               service_id, data_id, result);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Sent diagnostic request - Service: 0x%02X, DID: 0x%04X (%d bytes sent)",
+                 service_id, data_id, result);
     }
 
     /* Receive response using hybrid approach */
     doip_message_t response_msg;
     int socket_handle = use_raw_lwip ? -1 : tcp_socket;
-    if (!doip_receive_tcp_message(socket_handle, &response_msg, DOIP_TCP_TIMEOUT_MS)) {
-        printf("DOIP Client: Failed to receive diagnostic response (timeout or error)\r\n");
+    bool received = doip_receive_tcp_message(socket_handle, &response_msg, DOIP_TCP_TIMEOUT_MS);
+    doip_metrics_record_did(data_id, bsp_timestamp_elapsed_us(t_start), received);
+    if (!received) {
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Failed to receive diagnostic response (timeout or error)");
         return -1;
     }
 
     /* Validate response type */
     if (response_msg.payload_type != DOIP_DIAGNOSTIC_MESSAGE) {
-        printf("DOIP Client: Unexpected diagnostic response type: 0x%04X (expected 0x%04X)\r\n", 
-               response_msg.payload_type, DOIP_DIAGNOSTIC_MESSAGE);
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Unexpected diagnostic response type: 0x%04X (expected 0x%04X)",
+                 response_msg.payload_type, DOIP_DIAGNOSTIC_MESSAGE);
         return -1;
     }
 
@@ -1035,12 +1110,14 @@ int doip_send_diagnostic_request(uint8_t service_id, uint16_t data_id,
         size_t uds_data_len = response_msg.payload_length - 4;
         size_t copy_len = (uds_data_len < max_response_len) ? uds_data_len : max_response_len;
         
-        memcpy(response, &response_msg.payload[4], copy_len);
+        /* Up to a kilobyte; long responses go to the DMAC while other tasks run */
+        bsp_dma_memcpy(response, &response_msg.payload[4], copy_len);
         
-        printf("DOIP Client: Received diagnostic response (%zu bytes UDS data)\r\n", uds_data_len);
+        DLOG_DBG(DLOG_MOD_DOIP, "DOIP Client: Received diagnostic response (%u bytes UDS data)", uds_data_len);
         return (int)copy_len;
     } else {
-        printf("DOIP Client: Diagnostic response payload too short (%lu bytes)\r\n", response_msg.payload_length);
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Client: Diagnostic response payload too short (%u bytes)",
+                 response_msg.payload_length);
         return -1;
     }
 }
@@ -1052,14 +1129,8 @@ bool doip_read_vin(char *vin_buffer)
 
     response_len = doip_send_diagnostic_request(UDS_READ_DATA_BY_IDENTIFIER, DID_VIN, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        /* Extract VIN from positive response */
-        size_t vin_len = response_len - 3;  /* Skip service ID and DID */
-        if (vin_len > 17) vin_len = 17;
-        
-        memcpy(vin_buffer, &response[3], vin_len);
-        vin_buffer[vin_len] = '\0';
-        
+    /* VIN is 17 characters plus terminator */
+    if (doip_uds_decode_string(response, response_len, vin_buffer, 18)) {
         printf("DOIP Client: VIN: %s\r\n", vin_buffer);
         return true;
     }
@@ -1075,14 +1146,7 @@ bool doip_read_ecu_software_version(char *version_buffer, size_t buffer_size)
 
     response_len = doip_send_diagnostic_request(UDS_READ_DATA_BY_IDENTIFIER, DID_ECU_SOFTWARE_VERSION, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        /* Extract version from positive response */
-        size_t version_len = response_len - 3;  /* Skip service ID and DID */
-        if (version_len >= buffer_size) version_len = buffer_size - 1;
-        
-        memcpy(version_buffer, &response[3], version_len);
-        version_buffer[version_len] = '\0';
-        
+    if (doip_uds_decode_string(response, response_len, version_buffer, buffer_size)) {
         printf("DOIP Client: ECU SW Version: %s\r\n", version_buffer);
         return true;
     }
@@ -1098,14 +1162,7 @@ bool doip_read_ecu_hardware_version(char *version_buffer, size_t buffer_size)
 
     response_len = doip_send_diagnostic_request(UDS_READ_DATA_BY_IDENTIFIER, DID_ECU_HARDWARE_VERSION, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        /* Extract version from positive response */
-        size_t version_len = response_len - 3;  /* Skip service ID and DID */
-        if (version_len >= buffer_size) version_len = buffer_size - 1;
-        
-        memcpy(version_buffer, &response[3], version_len);
-        version_buffer[version_len] = '\0';
-        
+    if (doip_uds_decode_string(response, response_len, version_buffer, buffer_size)) {
         printf("DOIP Client: ECU HW Version: %s\r\n", version_buffer);
         return true;
     }
@@ -1128,14 +1185,29 @@ bool doip_get_system_monitoring_data(doip_system_monitoring_t *monitoring_data)
         return false;
     }
     
-    /* Update dynamic data */
-    doip_update_dynamic_monitoring_data();
-    
-    /* Copy current monitoring data */
-    memcpy(monitoring_data, &system_monitoring_data, sizeof(doip_system_monitoring_t));
+    monitoring_data->ident = monitoring_ident;
+    doip_get_monitoring_runtime(&monitoring_data->runtime);
     return true;
 }
 
+void doip_get_monitoring_runtime(doip_monitoring_runtime_t *runtime)
+{
+    uint32_t version;
+    
+    /* Never waits for the writer: the slot being read is only rewritten
+     * after a newer version was published, which the second load sees */
+    do {
+        version = __atomic_load_n(&monitoring_version, __ATOMIC_ACQUIRE);
+        *runtime = monitoring_runtime[version & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&monitoring_version, __ATOMIC_RELAXED) != version);
+}
+
+const doip_monitoring_ident_t *doip_get_monitoring_ident(void)
+{
+    return &monitoring_ident;
+}
+
 bool doip_read_active_diagnostic_session(uint8_t *session_buffer, size_t buffer_size)
 {
     uint8_t response[32];
@@ -1143,13 +1215,10 @@ bool doip_read_active_diagnostic_session(uint8_t *session_buffer, size_t buffer_
 
     response_len = doip_read_monitoring_data(DID_ACTIVE_DIAGNOSTIC_SESSION, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        size_t data_len = response_len - 3;
-        if (data_len > 0 && buffer_size > 0) {
-            session_buffer[0] = response[3]; /* First byte contains session type */
-            printf("DOIP Client: Active Diagnostic Session: 0x%02X\r\n", session_buffer[0]);
-            return true;
-        }
+    /* First data byte contains session type */
+    if (buffer_size > 0 && doip_uds_decode_u8(response, response_len, &session_buffer[0])) {
+        printf("DOIP Client: Active Diagnostic Session: 0x%02X\r\n", session_buffer[0]);
+        return true;
     }
 
     printf("DOIP Client: Failed to read active diagnostic session\r\n");
@@ -1163,13 +1232,7 @@ bool doip_read_ecu_serial_number(char *serial_buffer, size_t buffer_size)
 
     response_len = doip_read_monitoring_data(DID_ECU_SERIAL_NUMBER, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        size_t serial_len = response_len - 3;
-        if (serial_len >= buffer_size) serial_len = buffer_size - 1;
-        
-        memcpy(serial_buffer, &response[3], serial_len);
-        serial_buffer[serial_len] = '\0';
-        
+    if (doip_uds_decode_string(response, response_len, serial_buffer, buffer_size)) {
         printf("DOIP Client: ECU Serial Number: %s\r\n", serial_buffer);
         return true;
     }
@@ -1185,8 +1248,7 @@ bool doip_read_vehicle_speed(uint16_t *speed_kmh)
 
     response_len = doip_read_monitoring_data(DID_VEHICLE_SPEED_INFORMATION, response, sizeof(response));
     
-    if (response_len > 4 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        *speed_kmh = (response[3] << 8) | response[4];
+    if (doip_uds_decode_u16(response, response_len, speed_kmh)) {
         printf("DOIP Client: Vehicle Speed: %d km/h\r\n", *speed_kmh);
         return true;
     }
@@ -1202,8 +1264,7 @@ bool doip_read_engine_rpm(uint16_t *rpm)
 
     response_len = doip_read_monitoring_data(DID_ENGINE_RPM_INFORMATION, response, sizeof(response));
     
-    if (response_len > 4 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        *rpm = (response[3] << 8) | response[4];
+    if (doip_uds_decode_u16(response, response_len, rpm)) {
         printf("DOIP Client: Engine RPM: %d\r\n", *rpm);
         return true;
     }
@@ -1219,8 +1280,7 @@ bool doip_read_battery_voltage(uint16_t *voltage_mv)
 
     response_len = doip_read_monitoring_data(DID_BATTERY_VOLTAGE_INFORMATION, response, sizeof(response));
     
-    if (response_len > 4 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        *voltage_mv = (response[3] << 8) | response[4];
+    if (doip_uds_decode_u16(response, response_len, voltage_mv)) {
         printf("DOIP Client: Battery Voltage: %d mV (%.2f V)\r\n", *voltage_mv, *voltage_mv / 1000.0);
         return true;
     }
@@ -1236,8 +1296,9 @@ bool doip_read_temperature_data(int16_t *temperature_celsius)
 
     response_len = doip_read_monitoring_data(DID_TEMPERATURE_SENSOR_DATA, response, sizeof(response));
     
-    if (response_len > 4 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        *temperature_celsius = (int16_t)((response[3] << 8) | response[4]);
+    uint16_t raw_temperature;
+    if (doip_uds_decode_u16(response, response_len, &raw_temperature)) {
+        *temperature_celsius = (int16_t)raw_temperature;
         printf("DOIP Client: Temperature: %d (%.1f °C)\r\n", *temperature_celsius, *temperature_celsius / 10.0);
         return true;
     }
@@ -1253,8 +1314,7 @@ bool doip_read_fuel_level(uint8_t *fuel_percent)
 
     response_len = doip_read_monitoring_data(DID_FUEL_LEVEL_INFORMATION, response, sizeof(response));
     
-    if (response_len > 3 && response[0] == (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)) {
-        *fuel_percent = response[3];
+    if (doip_uds_decode_u8(response, response_len, fuel_percent)) {
         printf("DOIP Client: Fuel Level: %d%%\r\n", *fuel_percent);
         return true;
     }
@@ -1278,15 +1338,7 @@ bool doip_send_alive_check_request(int socket)
     request_msg.payload[1] = DOIP_CLIENT_SOURCE_ADDRESS & 0xFF;
     
     /* Serialize message */
-    buffer[0] = request_msg.protocol_version;
-    buffer[1] = request_msg.inverse_protocol_version;
-    buffer[2] = (request_msg.payload_type >> 8) & 0xFF;
-    buffer[3] = request_msg.payload_type & 0xFF;
-    buffer[4] = (request_msg.payload_length >> 24) & 0xFF;
-    buffer[5] = (request_msg.payload_length >> 16) & 0xFF;
-    buffer[6] = (request_msg.payload_length >> 8) & 0xFF;
-    buffer[7] = request_msg.payload_length & 0xFF;
-    memcpy(&buffer[8], request_msg.payload, request_msg.payload_length);
+    doip_serialize_message(&request_msg, buffer, sizeof(buffer));
     
     /* Send request */
     if (socket == -1) {
@@ -1298,7 +1350,7 @@ bool doip_send_alive_check_request(int socket)
         printf("DOIP Client: Alive check request sent (raw lwIP)\r\n");
     } else {
         /* Socket mode */
-        int result = send(socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length, 0);
+        int result = doip_socket_send(socket, buffer, DOIP_HEADER_SIZE + request_msg.payload_length);
         if (result < 0) {
             printf("DOIP Client: Failed to send alive check request (socket)\r\n");
             return false;
@@ -1351,15 +1403,7 @@ bool doip_handle_alive_check_request(int socket, const doip_message_t *msg)
     response_msg.payload[1] = msg->payload[1];
     
     /* Serialize message */
-    buffer[0] = response_msg.protocol_version;
-    buffer[1] = response_msg.inverse_protocol_version;
-    buffer[2] = (response_msg.payload_type >> 8) & 0xFF;
-    buffer[3] = response_msg.payload_type & 0xFF;
-    buffer[4] = (response_msg.payload_length >> 24) & 0xFF;
-    buffer[5] = (response_msg.payload_length >> 16) & 0xFF;
-    buffer[6] = (response_msg.payload_length >> 8) & 0xFF;
-    buffer[7] = response_msg.payload_length & 0xFF;
-    memcpy(&buffer[8], response_msg.payload, response_msg.payload_length);
+    doip_serialize_message(&response_msg, buffer, sizeof(buffer));
     
     /* Send response */
     if (socket == -1) {
@@ -1371,7 +1415,7 @@ bool doip_handle_alive_check_request(int socket, const doip_message_t *msg)
         printf("DOIP Client: Alive check response sent (raw lwIP)\r\n");
     } else {
         /* Socket mode */
-        int result = send(socket, buffer, DOIP_HEADER_SIZE + response_msg.payload_length, 0);
+        int result = doip_socket_send(socket, buffer, DOIP_HEADER_SIZE + response_msg.payload_length);
         if (result < 0) {
             printf("DOIP Client: Failed to send alive check response (socket)\r\n");
             return false;
@@ -1401,15 +1445,7 @@ bool doip_send_diagnostic_ack(int socket, uint8_t ack_type)
     ack_msg.payload[4] = ack_type;
     
     /* Serialize message */
-    buffer[0] = ack_msg.protocol_version;
-    buffer[1] = ack_msg.inverse_protocol_version;
-    buffer[2] = (ack_msg.payload_type >> 8) & 0xFF;
-    buffer[3] = ack_msg.payload_type & 0xFF;
-    buffer[4] = (ack_msg.payload_length >> 24) & 0xFF;
-    buffer[5] = (ack_msg.payload_length >> 16) & 0xFF;
-    buffer[6] = (ack_msg.payload_length >> 8) & 0xFF;
-    buffer[7] = ack_msg.payload_length & 0xFF;
-    memcpy(&buffer[8], ack_msg.payload, ack_msg.payload_length);
+    doip_serialize_message(&ack_msg, buffer, sizeof(buffer));
     
     /* Send ACK */
     if (socket == -1) {
@@ -1421,7 +1457,7 @@ bool doip_send_diagnostic_ack(int socket, uint8_t ack_type)
         printf("DOIP Client: Diagnostic ACK sent (raw lwIP, type 0x%02X)\r\n", ack_type);
     } else {
         /* Socket mode */
-        int result = send(socket, buffer, DOIP_HEADER_SIZE + ack_msg.payload_length, 0);
+        int result = doip_socket_send(socket, buffer, DOIP_HEADER_SIZE + ack_msg.payload_length);
         if (result < 0) {
             printf("DOIP Client: Failed to send diagnostic ACK (socket)\r\n");
             return false;
@@ -1462,7 +1498,7 @@ void doip_disconnect(void)
     } else {
         /* Socket-based implementation */
         if (tcp_socket >= 0) {
-            close(tcp_socket);
+            doip_socket_close(tcp_socket);
             tcp_socket = -1;
         }
         doip_status = DOIP_STATUS_IDLE;
@@ -1470,70 +1506,211 @@ void doip_disconnect(void)
     }
 }
 
+#if DOIP_CLIENT_SESSIONS > 0
+/* One diagnostic conversation; the session is first so the scheduler's
+ * doip_session_t pointer is the whole context */
+typedef struct {
+    doip_session_t session;
+    uint16_t source_address;        /* Own tester address per session */
+    uint8_t did_index;
+    uint8_t dids_ok;
+    bool activated;
+    uint32_t t_start;
+    uint8_t tx[7];
+} doip_client_session_t;
+
+/* What a blocking cycle reads, in the same order */
+static const uint16_t session_dids[] = {
+    DID_VIN,
+    DID_ECU_SOFTWARE_VERSION,
+    DID_ECU_HARDWARE_VERSION,
+    DID_ECU_SERIAL_NUMBER,
+    DID_ACTIVE_DIAGNOSTIC_SESSION,
+    DID_VEHICLE_SPEED_INFORMATION,
+    DID_ENGINE_RPM_INFORMATION,
+    DID_BATTERY_VOLTAGE_INFORMATION,
+    DID_TEMPERATURE_SENSOR_DATA,
+    DID_FUEL_LEVEL_INFORMATION,
+};
+#define SESSION_DID_COUNT   (sizeof(session_dids) / sizeof(session_dids[0]))
+
+static doip_client_session_t client_sessions[DOIP_CLIENT_SESSIONS];
+
+/* Connect, activate routing and read session_dids from current_vehicle.
+ * Runs in the session scheduler; the client task waits meanwhile, so the
+ * metrics still have one writer at a time. */
+static doip_pt_status_t doip_client_session(doip_session_t *s)
+{
+    doip_client_session_t *cs = (doip_client_session_t *)s;
+    uint16_t did;
+    bool ok;
+
+    DOIP_PT_BEGIN(s);
+
+    cs->t_start = bsp_timestamp_now();
+    DOIP_SESSION_CONNECT(s, current_vehicle.ip_address, current_vehicle.tcp_port, DOIP_TCP_TIMEOUT_MS);
+    doip_phase_done(DOIP_PHASE_CONNECT, cs->t_start, s->error == DOIP_SESSION_OK);
+    if (s->error != DOIP_SESSION_OK) {
+        DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Session 0x%04X connect failed (%u)", cs->source_address, s->error);
+        DOIP_PT_EXIT(s);
+    }
+
+    /* Routing activation: Source Address (2) + Activation Type (1) + Reserved (4) */
+    cs->tx[0] = (uint8_t)(cs->source_address >> 8);
+    cs->tx[1] = (uint8_t)cs->source_address;
+    memset(&cs->tx[2], 0x00, 5);
+    cs->t_start = bsp_timestamp_now();
+    DOIP_SESSION_SEND(s, DOIP_ROUTING_ACTIVATION_REQUEST, cs->tx, 7);
+    DOIP_SESSION_RECEIVE(s, DOIP_TCP_TIMEOUT_MS);
+    cs->activated = s->error == DOIP_SESSION_OK && s->rx_type == DOIP_ROUTING_ACTIVATION_RESPONSE &&
+                    s->rx_length >= 5 && s->rx[4] == 0x10;
+    doip_phase_done(DOIP_PHASE_ACTIVATION, cs->t_start, cs->activated);
+    if (!cs->activated) {
+        DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Session 0x%04X routing activation failed (%u)",
+                 cs->source_address, s->error);
+        DOIP_PT_EXIT(s);
+    }
+
+    for (cs->did_index = 0; cs->did_index < SESSION_DID_COUNT; cs->did_index++) {
+        if (cs->did_index > 0) {
+            DOIP_SESSION_SLEEP(s, DOIP_CLIENT_REQUEST_GAP_MS);
+        }
+
+        /* Diagnostic payload: Source Address (2) + Target Address (2) + UDS Data (3) */
+        did = session_dids[cs->did_index];
+        cs->tx[0] = (uint8_t)(cs->source_address >> 8);
+        cs->tx[1] = (uint8_t)cs->source_address;
+        cs->tx[2] = (uint8_t)(current_vehicle.logical_address >> 8);
+        cs->tx[3] = (uint8_t)current_vehicle.logical_address;
+        cs->tx[4] = UDS_READ_DATA_BY_IDENTIFIER;
+        cs->tx[5] = (uint8_t)(did >> 8);
+        cs->tx[6] = (uint8_t)did;
+        cs->t_start = bsp_timestamp_now();
+        DOIP_SESSION_SEND(s, DOIP_DIAGNOSTIC_MESSAGE, cs->tx, 7);
+
+        /* Skip ACKs, answer alive checks, and drop a late response to an
+         * earlier DID, until this DID's response or a negative response */
+        while (s->error == DOIP_SESSION_OK) {
+            DOIP_SESSION_RECEIVE(s, DOIP_TCP_TIMEOUT_MS);
+            did = session_dids[cs->did_index];
+            if (s->error != DOIP_SESSION_OK || s->rx_type == DOIP_DIAGNOSTIC_MESSAGE_NEGATIVE_ACK) {
+                break;
+            }
+            if (s->rx_type == DOIP_DIAGNOSTIC_MESSAGE && s->rx_length >= 7 &&
+                (s->rx[4] == UDS_NEGATIVE_RESPONSE ||
+                 (s->rx[4] == (UDS_READ_DATA_BY_IDENTIFIER | UDS_POSITIVE_RESPONSE_MASK) &&
+                  s->rx[5] == (uint8_t)(did >> 8) && s->rx[6] == (uint8_t)did))) {
+                break;
+            }
+            if (s->rx_type == DOIP_ALIVE_CHECK_REQUEST) {
+                cs->tx[0] = (uint8_t)(cs->source_address >> 8);
+                cs->tx[1] = (uint8_t)cs->source_address;
+                DOIP_SESSION_SEND(s, DOIP_ALIVE_CHECK_RESPONSE, cs->tx, 2);
+            }
+        }
+
+        did = session_dids[cs->did_index];
+        ok = s->error == DOIP_SESSION_OK && s->rx_type == DOIP_DIAGNOSTIC_MESSAGE &&
+                  s->rx[4] != UDS_NEGATIVE_RESPONSE;
+        doip_metrics_record_did(did, bsp_timestamp_elapsed_us(cs->t_start), ok);
+        if (ok) {
+            cs->dids_ok++;
+        } else if (s->error != DOIP_SESSION_OK && s->error != DOIP_SESSION_ERR_TIMEOUT) {
+            DLOG_WRN(DLOG_MOD_DOIP, "DOIP Client: Session 0x%04X lost the connection (%u)",
+                     cs->source_address, s->error);
+            DOIP_PT_EXIT(s);
+        }
+    }
+
+    DOIP_PT_END(s);
+}
+
+/* Run DOIP_CLIENT_SESSIONS sessions against current_vehicle at once and
+ * wait for all of them */
+static bool doip_client_run_sessions(void)
+{
+    uint32_t started = xTaskGetTickCount();
+    uint32_t activated = 0;
+    uint32_t dids_ok = 0;
+
+    printf("DOIP Client: Running %u concurrent sessions\r\n", (unsigned)DOIP_CLIENT_SESSIONS);
+    for (uint32_t i = 0; i < DOIP_CLIENT_SESSIONS; i++) {
+        client_sessions[i].source_address = (uint16_t)(DOIP_CLIENT_SOURCE_ADDRESS + i);
+        client_sessions[i].did_index = 0;
+        client_sessions[i].dids_ok = 0;
+        client_sessions[i].activated = false;
+        doip_session_start(&client_sessions[i].session, doip_client_session);
+    }
+
+    /* Each session notifies this task once as it ends */
+    for (uint32_t i = 0; i < DOIP_CLIENT_SESSIONS; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+
+    for (uint32_t i = 0; i < DOIP_CLIENT_SESSIONS; i++) {
+        activated += client_sessions[i].activated ? 1 : 0;
+        dids_ok += client_sessions[i].dids_ok;
+    }
+    printf("DOIP Client: %lu/%u sessions activated, %lu/%lu DIDs read in %lu ms\r\n",
+           (unsigned long)activated, (unsigned)DOIP_CLIENT_SESSIONS, (unsigned long)dids_ok,
+           (unsigned long)(DOIP_CLIENT_SESSIONS * SESSION_DID_COUNT),
+           (unsigned long)((xTaskGetTickCount() - started) * portTICK_PERIOD_MS));
+
+    return dids_ok == DOIP_CLIENT_SESSIONS * SESSION_DID_COUNT;
+}
+#endif
+
 void doip_client_task(void *pvParameters)
 {
     (void)pvParameters;
     
     doip_vehicle_info_t vehicle_info;
+#if DOIP_CLIENT_SESSIONS == 0
     char vin_buffer[32];
     char version_buffer[64];
+#endif
+    uint32_t cycles_run = 0;
+    uint32_t cycles_ok = 0;
     
     printf("DOIP Client: Task started\r\n");
     
-    /* Initialize raw lwIP mode */
-    printf("DOIP Client: Initializing raw lwIP mode...\r\n");
-    if (!doip_raw_init()) {
-        printf("DOIP Client: Failed to initialize raw lwIP mode\r\n");
-        /* Continue with socket-based mode as fallback */
-        use_raw_lwip = false;
-    } else {
-        printf("DOIP Client: Raw lwIP mode initialized successfully\r\n");
-        use_raw_lwip = true;
-    }
+    /* Raw lwIP resources were set up once by doip_client_init() */
+    printf("DOIP Client: Using %s\r\n", use_raw_lwip ? "raw lwIP API" : "socket API");
     
-    /* Wait for network to be ready and do initial network check */
+    /* Wait for an address and the link; both come up asynchronously after start-up
+     * and network_events wakes this task as soon as they do */
     printf("DOIP Client: Starting network initialization check...\r\n");
+    const uint32_t net_ready = NET_EVENT_IP_BOUND | NET_EVENT_LINK_UP;
+    uint32_t net_state = network_events_state();
     
-    /* Wait for network stack to initialize */
-    vTaskDelay(pdMS_TO_TICKS(3000));
+    if ((net_state & net_ready) != net_ready) {
+        printf("DOIP Client: Waiting for %s...\r\n",
+               (net_state & NET_EVENT_IP_BOUND) ? "link" : "network interface to get IP address");
+        net_state = network_events_wait(net_ready, true, DOIP_CLIENT_LINK_WAIT_MS);
+    }
     
-    /* One-time network readiness check */
-    while (1) {
-        /* Check if network interface has valid IP address */
-        if (TCPIP_STACK_INTERFACE_0_desc.ip_addr.addr == 0) {
-            printf("DOIP Client: Waiting for network interface to get IP address...\r\n");
-            vTaskDelay(pdMS_TO_TICKS(5000));  /* Wait 5 seconds before retrying */
-            continue;
-        }
-        
-        /* Check if link is stable - do this once at startup */
-        bool link_up = netif_is_link_up(&TCPIP_STACK_INTERFACE_0_desc);
-        bool netif_up = netif_is_up(&TCPIP_STACK_INTERFACE_0_desc);
-        
-        printf("DOIP Client: Initial network check - Link UP: %s, Interface UP: %s\r\n", 
-               link_up ? "YES" : "NO", netif_up ? "YES" : "NO");
-        
-        /* If interface is UP but link is not detected as UP, proceed anyway */
-        /* This handles cases where PHY link detection is unreliable but connectivity works */
-        if (!link_up && !netif_up) {
-            printf("DOIP Client: Both link and interface are down, waiting...\r\n");
-            vTaskDelay(pdMS_TO_TICKS(2000));  /* Wait 2 seconds before retrying */
-            continue;
-        } else if (!link_up && netif_up) {
-            printf("DOIP Client: Interface UP but link detection unreliable, proceeding...\r\n");
-            vTaskDelay(pdMS_TO_TICKS(1000));  /* Wait 1 second for stability */
-        } else {
-            printf("DOIP Client: Link and interface both UP, network ready!\r\n");
-        }
-        
-        /* Network is ready - break out of initialization loop */
-        printf("DOIP Client: Network initialization complete, starting diagnostic cycles...\r\n");
-        break;
+    /* After that an address is enough: PHY link detection can be unreliable
+     * while connectivity works */
+    while (!(net_state & NET_EVENT_IP_BOUND)) {
+        net_state = network_events_wait(NET_EVENT_IP_BOUND, true, DOIP_CLIENT_LINK_WAIT_MS);
     }
     
+    if (net_state & NET_EVENT_LINK_UP) {
+        printf("DOIP Client: Link and interface both UP, network ready!\r\n");
+    } else {
+        printf("DOIP Client: Interface UP but link detection unreliable, proceeding...\r\n");
+    }
+    
+    /* Network is ready */
+    printf("DOIP Client: Network initialization complete, starting diagnostic cycles...\r\n");
+    
     /* Main diagnostic loop - no more network checks needed */
+#if DOIP_CLIENT_MAX_CYCLES > 0
+    TickType_t first_cycle_tick = xTaskGetTickCount();
+#endif
     while (1) {
         
+        cycles_run++;
         printf("\r\n=== DOIP Client Diagnostic Cycle ===\r\n");
         
         /* Display current network configuration */
@@ -1545,6 +1722,13 @@ void doip_client_task(void *pvParameters)
         
         /* Discover vehicles */
         if (doip_discover_vehicles(&vehicle_info)) {
+#if DOIP_CLIENT_SESSIONS > 0
+            /* All sessions at once on the session scheduler, in place of
+             * the blocking sequence below */
+            if (doip_client_run_sessions()) {
+                cycles_ok++;
+            }
+#else
             /* Connect to discovered vehicle */
             printf("DOIP Client: Connection mode: %s\r\n", use_raw_lwip ? "Raw lwIP" : "Socket-based");
             if (doip_connect_to_vehicle(&vehicle_info)) {
@@ -1556,14 +1740,14 @@ void doip_client_task(void *pvParameters)
                     printf("VIN: %s\r\n", vin_buffer);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read ECU software version */
                 if (doip_read_ecu_software_version(version_buffer, sizeof(version_buffer))) {
                     printf("ECU Software Version: %s\r\n", version_buffer);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read ECU hardware version */
                 if (doip_read_ecu_hardware_version(version_buffer, sizeof(version_buffer))) {
@@ -1577,7 +1761,7 @@ void doip_client_task(void *pvParameters)
                     printf("ECU Serial Number: %s\r\n", version_buffer);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read active diagnostic session */
                 uint8_t session_info;
@@ -1593,7 +1777,7 @@ void doip_client_task(void *pvParameters)
                     printf("Vehicle Speed: %d km/h\r\n", speed);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read engine RPM */
                 uint16_t rpm;
@@ -1601,7 +1785,7 @@ void doip_client_task(void *pvParameters)
                     printf("Engine RPM: %d\r\n", rpm);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read battery voltage */
                 uint16_t voltage;
@@ -1609,7 +1793,7 @@ void doip_client_task(void *pvParameters)
                     printf("Battery Voltage: %d mV (%.2f V)\r\n", voltage, voltage / 1000.0);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read temperature */
                 int16_t temperature;
@@ -1617,7 +1801,7 @@ void doip_client_task(void *pvParameters)
                     printf("Temperature: %.1f °C\r\n", temperature / 10.0);
                 }
                 
-                vTaskDelay(pdMS_TO_TICKS(500));
+                vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_REQUEST_GAP_MS));
                 
                 /* Read fuel level */
                 uint8_t fuel_level;
@@ -1647,7 +1831,7 @@ void doip_client_task(void *pvParameters)
                 printf("\r\n--- Listening for ECU Messages ---\r\n");
                 doip_message_t incoming_msg;
                 TickType_t start_time = xTaskGetTickCount();
-                TickType_t timeout_ticks = pdMS_TO_TICKS(DOIP_ALIVE_CHECK_TIMEOUT_MS);
+                TickType_t timeout_ticks = pdMS_TO_TICKS(DOIP_CLIENT_LISTEN_MS);
                 
                 while ((xTaskGetTickCount() - start_time) < timeout_ticks) {
                     bool message_received = false;
@@ -1703,16 +1887,36 @@ void doip_client_task(void *pvParameters)
                 printf("DOIP Client: Closing connection for next cycle...\r\n");
                 doip_disconnect();
                 
-                printf("DOIP Client: Diagnostic cycle completed successfully\r\n");
+                cycles_ok++;
+                printf("DOIP Client: Diagnostic cycle completed successfully (%lu/%lu)\r\n",
+                       (unsigned long)cycles_ok, (unsigned long)cycles_run);
             } else {
                 printf("DOIP Client: Failed to connect to vehicle, will retry in next cycle\r\n");
             }
+#endif
         } else {
             printf("DOIP Client: Vehicle discovery failed, will retry in next cycle\r\n");
         }
         
+#if DOIP_CLIENT_MAX_CYCLES > 0
+        if (cycles_run >= DOIP_CLIENT_MAX_CYCLES) {
+            uint32_t elapsed_ms = (uint32_t)((xTaskGetTickCount() - first_cycle_tick) * portTICK_PERIOD_MS);
+            dlog_flush();
+            printf("DOIP Client: %lu/%lu cycles OK in %lu ms (%lu ms/cycle)\r\n",
+                   (unsigned long)cycles_ok, (unsigned long)cycles_run,
+                   (unsigned long)elapsed_ms, (unsigned long)(elapsed_ms / cycles_run));
+            doip_telemetry_print_summary();
+            doip_telemetry_dump();
+            boot_time_print();
+            sys_stats_print();
+            net_stats_print_pools();
+            housekeeping_print();
+            vTaskEndScheduler();
+        }
+#endif
+
         /* Wait before next cycle */
         printf("DOIP Client: Waiting for next cycle...\r\n");
-        vTaskDelay(pdMS_TO_TICKS(10000));  /* 10 second cycle */
+        vTaskDelay(pdMS_TO_TICKS(DOIP_CLIENT_CYCLE_PERIOD_MS));
     }
 }
\ No newline at end of file
@@ -40,6 +40,7 @@ extern "C" {
 /* UDS Service IDs */
 #define UDS_READ_DATA_BY_IDENTIFIER     0x22
 #define UDS_POSITIVE_RESPONSE_MASK      0x40
+#define UDS_NEGATIVE_RESPONSE           0x7F
 
 /* Data Identifiers (DIDs) - AUTOSAR Standard */
 #define DID_VIN                         0xF190
@@ -103,10 +104,9 @@ typedef struct {
     uint16_t tcp_port;          /* TCP data port */
 } doip_vehicle_info_t;
 
-/* System Monitoring Data Structure */
+/* ECU identification: constant after build, read in place */
 typedef struct {
     /* System Information */
-    uint8_t  active_diagnostic_session;
     char     spare_part_number[32];
     char     ecu_sw_number[32];
     char     ecu_sw_version_detailed[32];
@@ -121,19 +121,30 @@ typedef struct {
     char     identification_data_traceability[64];
     char     ecu_pin_traceability[32];
     
-    /* Runtime Monitoring */
+    /* Software Identification */
+    char     boot_software_id[32];
+    char     application_sw_fingerprint[64];
+} doip_monitoring_ident_t;
+
+/* Runtime monitoring: updated by the DOIP client task, read as a snapshot */
+typedef struct {
     uint32_t ecu_operating_hours;
     uint16_t vehicle_speed_kmh;         /* km/h */
     uint16_t engine_rpm;                /* RPM */
     uint16_t battery_voltage_mv;        /* millivolts */
     int16_t  temperature_celsius;       /* Celsius * 10 */
     uint8_t  fuel_level_percent;        /* Percentage */
+    uint8_t  active_diagnostic_session;
     
     /* Diagnostic Status */
     uint8_t  error_memory_status;
     uint8_t  last_reset_reason;
-    char     boot_software_id[32];
-    char     application_sw_fingerprint[64];
+} doip_monitoring_runtime_t;
+
+/* System Monitoring Data Structure */
+typedef struct {
+    doip_monitoring_ident_t   ident;
+    doip_monitoring_runtime_t runtime;
 } doip_system_monitoring_t;
 
 /* DOIP Client Status */
@@ -222,9 +233,27 @@ int doip_read_monitoring_data(uint16_t did, uint8_t *response, size_t max_respon
  * \brief Get current system monitoring data
  * \param[out] monitoring_data Pointer to store monitoring data
  * \return true if data retrieved successfully, false otherwise
+ *
+ * Copies the identification strings as well; pollers that only need the
+ * runtime fields should use doip_get_monitoring_runtime().
  */
 bool doip_get_system_monitoring_data(doip_system_monitoring_t *monitoring_data);
 
+/**
+ * \brief Get a consistent copy of the runtime monitoring fields
+ * \param[out] runtime Snapshot of one update, never a mix of two
+ *
+ * Lock-free and callable from any task: the copy is retried if the DOIP
+ * client task publishes an update while it is being made.
+ */
+void doip_get_monitoring_runtime(doip_monitoring_runtime_t *runtime);
+
+/**
+ * \brief ECU identification strings
+ * \return Constant data, valid for the lifetime of the program
+ */
+const doip_monitoring_ident_t *doip_get_monitoring_ident(void);
+
 /**
  * \brief Read active diagnostic session
  * \param[out] session_buffer Buffer to store session info
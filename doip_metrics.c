@@ -0,0 +1,266 @@
+/**
+ * \file doip_metrics.c
+ * \brief Per-phase latency histograms for the DOIP client
+ *
+ * Kept free of RTOS and network stack dependencies so it can be built
+ * on the host alongside doip_protocol.c.
+ */
+
+#include "doip_metrics.h"
+#include <string.h>
+
+#define SUB_COUNT   (1u << DOIP_HIST_SUB_BITS)
+#define SUB_MASK    (SUB_COUNT - 1u)
+
+/* Dump sizes: fixed header, and a histogram without its bucket entries,
+ * with varints at their maximum length */
+#define DUMP_HEADER_MAX     (6 + 5)
+#define DUMP_HIST_FIXED_MAX (3 + 4 * 5 + 10 + 1)
+#define DUMP_BUCKET_MAX     (1 + 5)
+
+enum {
+    DUMP_KIND_PHASE = 0,
+    DUMP_KIND_DID = 1
+};
+
+typedef struct {
+    uint16_t did;
+    doip_hist_t hist;
+} did_hist_t;
+
+static doip_hist_t phase_hist[DOIP_PHASE_COUNT];
+static did_hist_t did_hist[DOIP_METRICS_MAX_DIDS];
+static uint32_t did_count;
+static uint32_t did_overflow;
+
+uint32_t doip_hist_bucket(uint32_t us)
+{
+    if (us < SUB_COUNT) {
+        return us;
+    }
+
+    uint32_t exp = 31u - (uint32_t)__builtin_clz(us);
+    uint32_t bucket = ((exp - DOIP_HIST_SUB_BITS + 1u) << DOIP_HIST_SUB_BITS) |
+                      ((us >> (exp - DOIP_HIST_SUB_BITS)) & SUB_MASK);
+
+    return (bucket < DOIP_HIST_BUCKETS) ? bucket : (DOIP_HIST_BUCKETS - 1u);
+}
+
+uint32_t doip_hist_bucket_lower(uint32_t bucket)
+{
+    if (bucket < SUB_COUNT) {
+        return bucket;
+    }
+
+    uint32_t exp = (bucket >> DOIP_HIST_SUB_BITS) + DOIP_HIST_SUB_BITS - 1u;
+    return (SUB_COUNT | (bucket & SUB_MASK)) << (exp - DOIP_HIST_SUB_BITS);
+}
+
+void doip_hist_record(doip_hist_t *hist, uint32_t us)
+{
+    if (hist->count == 0 || us < hist->min_us) {
+        hist->min_us = us;
+    }
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+    hist->count++;
+    hist->sum_us += us;
+    hist->buckets[doip_hist_bucket(us)]++;
+}
+
+uint32_t doip_hist_percentile(const doip_hist_t *hist, uint32_t permille)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    /* Rank of the requested sample, 1-based, rounded up */
+    uint64_t rank = ((uint64_t)hist->count * permille + 999u) / 1000u;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < DOIP_HIST_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            if (b + 1u >= DOIP_HIST_BUCKETS) {
+                return hist->max_us;
+            }
+            uint32_t upper = doip_hist_bucket_lower(b + 1u) - 1u;
+            return (upper < hist->max_us) ? upper : hist->max_us;
+        }
+    }
+
+    return hist->max_us;
+}
+
+void doip_metrics_reset(void)
+{
+    memset(phase_hist, 0, sizeof(phase_hist));
+    memset(did_hist, 0, sizeof(did_hist));
+    did_count = 0;
+    did_overflow = 0;
+}
+
+static doip_hist_t *did_lookup(uint16_t did)
+{
+    for (uint32_t i = 0; i < did_count; i++) {
+        if (did_hist[i].did == did) {
+            return &did_hist[i].hist;
+        }
+    }
+
+    if (did_count >= DOIP_METRICS_MAX_DIDS) {
+        return NULL;
+    }
+
+    did_hist[did_count].did = did;
+    return &did_hist[did_count++].hist;
+}
+
+static void hist_add(doip_hist_t *hist, uint32_t us, bool ok)
+{
+    if (ok) {
+        doip_hist_record(hist, us);
+    } else {
+        hist->failed++;
+    }
+}
+
+void doip_metrics_record_phase(doip_phase_t phase, uint32_t us, bool ok)
+{
+    if (phase < DOIP_PHASE_COUNT) {
+        hist_add(&phase_hist[phase], us, ok);
+    }
+}
+
+void doip_metrics_record_did(uint16_t did, uint32_t us, bool ok)
+{
+    doip_hist_t *hist = did_lookup(did);
+
+    if (hist == NULL) {
+        did_overflow++;
+        return;
+    }
+    hist_add(hist, us, ok);
+}
+
+const doip_hist_t *doip_metrics_phase(doip_phase_t phase)
+{
+    return (phase < DOIP_PHASE_COUNT) ? &phase_hist[phase] : NULL;
+}
+
+const doip_hist_t *doip_metrics_did(uint32_t index, uint16_t *did)
+{
+    if (index >= did_count) {
+        return NULL;
+    }
+    if (did != NULL) {
+        *did = did_hist[index].did;
+    }
+    return &did_hist[index].hist;
+}
+
+uint32_t doip_metrics_did_count(void)
+{
+    return did_count;
+}
+
+/* Serialization */
+
+static uint8_t *put_varint(uint8_t *p, uint64_t value)
+{
+    while (value >= 0x80u) {
+        *p++ = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static uint8_t *put_hist(uint8_t *p, uint8_t kind, uint16_t id, const doip_hist_t *hist)
+{
+    *p++ = kind;
+    *p++ = (uint8_t)(id >> 8);
+    *p++ = (uint8_t)id;
+    p = put_varint(p, hist->count);
+    p = put_varint(p, hist->failed);
+    p = put_varint(p, hist->min_us);
+    p = put_varint(p, hist->max_us);
+    p = put_varint(p, hist->sum_us);
+
+    uint8_t *nz = p++;
+    *nz = 0;
+    for (uint32_t b = 0; b < DOIP_HIST_BUCKETS; b++) {
+        if (hist->buckets[b] != 0) {
+            *p++ = (uint8_t)b;
+            p = put_varint(p, hist->buckets[b]);
+            (*nz)++;
+        }
+    }
+
+    return p;
+}
+
+static bool hist_used(const doip_hist_t *hist)
+{
+    return hist->count != 0 || hist->failed != 0;
+}
+
+static size_t hist_size_max(const doip_hist_t *hist)
+{
+    size_t size = DUMP_HIST_FIXED_MAX;
+
+    for (uint32_t b = 0; b < DOIP_HIST_BUCKETS; b++) {
+        size += (hist->buckets[b] != 0) ? DUMP_BUCKET_MAX : 0;
+    }
+    return size;
+}
+
+size_t doip_metrics_serialize(uint8_t *out, size_t out_size)
+{
+    uint32_t nhist = 0;
+    size_t needed = DUMP_HEADER_MAX;
+
+    /* Sized against the worst-case encoding up front so the writers need no bounds */
+    for (uint32_t i = 0; i < DOIP_PHASE_COUNT; i++) {
+        if (hist_used(&phase_hist[i])) {
+            nhist++;
+            needed += hist_size_max(&phase_hist[i]);
+        }
+    }
+    for (uint32_t i = 0; i < did_count; i++) {
+        if (hist_used(&did_hist[i].hist)) {
+            nhist++;
+            needed += hist_size_max(&did_hist[i].hist);
+        }
+    }
+
+    if (out_size < needed) {
+        return 0;
+    }
+
+    uint8_t *p = out;
+    *p++ = DOIP_METRICS_MAGIC_0;
+    *p++ = DOIP_METRICS_MAGIC_1;
+    *p++ = DOIP_METRICS_VERSION;
+    *p++ = DOIP_HIST_SUB_BITS;
+    *p++ = DOIP_HIST_BUCKETS;
+    *p++ = (uint8_t)nhist;
+    p = put_varint(p, did_overflow);
+
+    for (uint32_t i = 0; i < DOIP_PHASE_COUNT; i++) {
+        if (hist_used(&phase_hist[i])) {
+            p = put_hist(p, DUMP_KIND_PHASE, (uint16_t)i, &phase_hist[i]);
+        }
+    }
+    for (uint32_t i = 0; i < did_count; i++) {
+        if (hist_used(&did_hist[i].hist)) {
+            p = put_hist(p, DUMP_KIND_DID, did_hist[i].did, &did_hist[i].hist);
+        }
+    }
+
+    return (size_t)(p - out);
+}
@@ -0,0 +1,153 @@
+/**
+ * \file doip_metrics.h
+ * \brief Per-phase latency histograms for the DOIP client
+ *
+ * Latencies are accumulated in fixed log-scale histograms (four linear
+ * sub-buckets per power of two of microseconds), one per connection phase
+ * and one per diagnostic DID, so p50/p99 can be computed without keeping
+ * individual samples. Like doip_protocol.c this module has no RTOS or
+ * network stack dependencies; callers serialize access (see
+ * doip_telemetry.c).
+ */
+
+#ifndef DOIP_METRICS_H
+#define DOIP_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Histogram layout: values below 2^DOIP_HIST_SUB_BITS us get their own
+ * bucket, above that each power of two is split into 2^DOIP_HIST_SUB_BITS
+ * buckets. The last bucket also collects everything >= 2^DOIP_HIST_MAX_EXP us. */
+#define DOIP_HIST_SUB_BITS      2
+#define DOIP_HIST_MAX_EXP       25      /* 2^25 us = 33.5 s */
+#define DOIP_HIST_BUCKETS       ((DOIP_HIST_MAX_EXP - DOIP_HIST_SUB_BITS + 1) << DOIP_HIST_SUB_BITS)
+
+/* Distinct DIDs tracked; further DIDs are counted in did_overflow only */
+#ifndef DOIP_METRICS_MAX_DIDS
+#define DOIP_METRICS_MAX_DIDS   16
+#endif
+
+/* Binary dump format (doip_metrics_serialize) */
+#define DOIP_METRICS_MAGIC_0    'D'
+#define DOIP_METRICS_MAGIC_1    'M'
+#define DOIP_METRICS_VERSION    1
+
+/* Connection phases */
+typedef enum {
+    DOIP_PHASE_DISCOVERY,       /* Identification request sent -> first announcement */
+    DOIP_PHASE_CONNECT,         /* TCP SYN -> connection established */
+    DOIP_PHASE_ACTIVATION,      /* Routing activation request -> response */
+    DOIP_PHASE_COUNT
+} doip_phase_t;
+
+/* One latency histogram */
+typedef struct {
+    uint32_t count;             /* Successful samples */
+    uint32_t failed;            /* Timeouts and errors, not in the buckets */
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[DOIP_HIST_BUCKETS];
+} doip_hist_t;
+
+/**
+ * \brief Map a latency to its histogram bucket
+ * \param[in] us Latency in microseconds
+ * \return Bucket index, at most DOIP_HIST_BUCKETS - 1
+ */
+uint32_t doip_hist_bucket(uint32_t us);
+
+/**
+ * \brief Smallest latency that falls into a bucket
+ * \param[in] bucket Bucket index
+ * \return Lower bound in microseconds (inclusive)
+ */
+uint32_t doip_hist_bucket_lower(uint32_t bucket);
+
+/**
+ * \brief Add one sample to a histogram
+ * \param[in,out] hist Histogram
+ * \param[in] us Latency in microseconds
+ */
+void doip_hist_record(doip_hist_t *hist, uint32_t us);
+
+/**
+ * \brief Estimate a percentile from a histogram
+ *
+ * Returns the upper bound of the bucket holding the requested rank,
+ * clamped to the largest recorded sample, so the estimate never
+ * understates the latency.
+ *
+ * \param[in] hist Histogram
+ * \param[in] permille Percentile in tenths of a percent (500 = p50, 990 = p99)
+ * \return Latency in microseconds, 0 if the histogram is empty
+ */
+uint32_t doip_hist_percentile(const doip_hist_t *hist, uint32_t permille);
+
+/**
+ * \brief Clear all histograms
+ */
+void doip_metrics_reset(void);
+
+/**
+ * \brief Record the latency of a connection phase
+ * \param[in] phase Phase
+ * \param[in] us Latency in microseconds
+ * \param[in] ok false if the phase failed or timed out; only counted
+ */
+void doip_metrics_record_phase(doip_phase_t phase, uint32_t us, bool ok);
+
+/**
+ * \brief Record the request-to-response latency of a diagnostic request
+ * \param[in] did Data identifier requested
+ * \param[in] us Latency in microseconds
+ * \param[in] ok false if the request failed or timed out; only counted
+ */
+void doip_metrics_record_did(uint16_t did, uint32_t us, bool ok);
+
+/**
+ * \brief Histogram of a connection phase
+ * \param[in] phase Phase
+ * \return Histogram, NULL if phase is out of range
+ */
+const doip_hist_t *doip_metrics_phase(doip_phase_t phase);
+
+/**
+ * \brief Histogram of the n-th DID seen
+ * \param[in] index 0 .. doip_metrics_did_count() - 1
+ * \param[out] did Data identifier, may be NULL
+ * \return Histogram, NULL if index is out of range
+ */
+const doip_hist_t *doip_metrics_did(uint32_t index, uint16_t *did);
+
+/**
+ * \brief Number of DIDs with a histogram
+ */
+uint32_t doip_metrics_did_count(void);
+
+/**
+ * \brief Serialize all histograms into the compact binary dump format
+ *
+ * Layout (multi-byte fixed fields big-endian, "v" = unsigned LEB128):
+ *   'D' 'M' version sub_bits buckets nhist overflow:v
+ *   per histogram: kind(0 phase, 1 DID) id:u16 count:v failed:v
+ *                  min:v max:v sum:v nz:u8 { bucket:u8 n:v } * nz
+ * Empty histograms are omitted.
+ *
+ * \param[out] out Destination buffer
+ * \param[in] out_size Size of destination buffer
+ * \return Bytes written, 0 if the buffer is too small
+ */
+size_t doip_metrics_serialize(uint8_t *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DOIP_METRICS_H */
@@ -0,0 +1,208 @@
+/**
+ * \file doip_protocol.c
+ * \brief DOIP framing, serialization and UDS response decoding
+ *
+ * Kept free of RTOS and network stack dependencies so it can be built
+ * and benchmarked on the host.
+ */
+
+#include "doip_protocol.h"
+#include <string.h>
+
+/* Positive response SID for ReadDataByIdentifier and size of SID + DID */
+#define UDS_RDBI_POSITIVE_RESPONSE  (UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK)
+#define UDS_RDBI_RESPONSE_HDR_SIZE  3
+
+void doip_create_header(doip_message_t *msg, uint16_t payload_type, uint32_t payload_length)
+{
+    msg->protocol_version = DOIP_PROTOCOL_VERSION;
+    msg->inverse_protocol_version = DOIP_INVERSE_PROTOCOL_VERSION;
+    msg->payload_type = payload_type;
+    msg->payload_length = payload_length;
+}
+
+doip_reasm_status_t doip_decode_header(const uint8_t *data, doip_message_t *msg)
+{
+    msg->protocol_version = data[0];
+    msg->inverse_protocol_version = data[1];
+    msg->payload_type = (uint16_t)((data[2] << 8) | data[3]);
+    msg->payload_length = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) |
+                          ((uint32_t)data[6] << 8) | data[7];
+
+    if (msg->protocol_version != DOIP_PROTOCOL_VERSION ||
+        msg->inverse_protocol_version != DOIP_INVERSE_PROTOCOL_VERSION) {
+        return DOIP_REASM_ERR_VERSION;
+    }
+
+    if (msg->payload_length > DOIP_MAX_PAYLOAD_SIZE) {
+        return DOIP_REASM_ERR_LENGTH;
+    }
+
+    return DOIP_REASM_COMPLETE;
+}
+
+bool doip_parse_header(const uint8_t *data, size_t data_len, doip_message_t *msg)
+{
+    if (data_len < DOIP_HEADER_SIZE) {
+        return false;
+    }
+
+    if (doip_decode_header(data, msg) != DOIP_REASM_COMPLETE) {
+        return false;
+    }
+
+    /* Copy whatever part of the payload is present */
+    if (msg->payload_length > 0 && data_len > DOIP_HEADER_SIZE) {
+        size_t copy_len = data_len - DOIP_HEADER_SIZE;
+        if (copy_len > msg->payload_length) {
+            copy_len = msg->payload_length;
+        }
+        memcpy(msg->payload, &data[DOIP_HEADER_SIZE], copy_len);
+    }
+    /* Don't reset payload_length to 0 - keep the length from header parsing */
+
+    return true;
+}
+
+size_t doip_serialize_header(uint8_t *out, uint16_t payload_type, uint32_t payload_length)
+{
+    out[0] = DOIP_PROTOCOL_VERSION;
+    out[1] = DOIP_INVERSE_PROTOCOL_VERSION;
+    out[2] = (payload_type >> 8) & 0xFF;
+    out[3] = payload_type & 0xFF;
+    out[4] = (payload_length >> 24) & 0xFF;
+    out[5] = (payload_length >> 16) & 0xFF;
+    out[6] = (payload_length >> 8) & 0xFF;
+    out[7] = payload_length & 0xFF;
+
+    return DOIP_HEADER_SIZE;
+}
+
+size_t doip_serialize_message(const doip_message_t *msg, uint8_t *out, size_t out_size)
+{
+    size_t total_length = DOIP_HEADER_SIZE + msg->payload_length;
+
+    if (msg->payload_length > DOIP_MAX_PAYLOAD_SIZE || total_length > out_size) {
+        return 0;
+    }
+
+    out[0] = msg->protocol_version;
+    out[1] = msg->inverse_protocol_version;
+    out[2] = (msg->payload_type >> 8) & 0xFF;
+    out[3] = msg->payload_type & 0xFF;
+    out[4] = (msg->payload_length >> 24) & 0xFF;
+    out[5] = (msg->payload_length >> 16) & 0xFF;
+    out[6] = (msg->payload_length >> 8) & 0xFF;
+    out[7] = msg->payload_length & 0xFF;
+
+    if (msg->payload_length > 0) {
+        memcpy(&out[DOIP_HEADER_SIZE], msg->payload, msg->payload_length);
+    }
+
+    return total_length;
+}
+
+/* UDS response decoders */
+
+bool doip_uds_decode_string(const uint8_t *response, int response_len, char *out, size_t out_size)
+{
+    if (response_len <= UDS_RDBI_RESPONSE_HDR_SIZE || out_size == 0 ||
+        response[0] != UDS_RDBI_POSITIVE_RESPONSE) {
+        return false;
+    }
+
+    size_t data_len = (size_t)response_len - UDS_RDBI_RESPONSE_HDR_SIZE;
+    if (data_len >= out_size) {
+        data_len = out_size - 1;
+    }
+
+    memcpy(out, &response[UDS_RDBI_RESPONSE_HDR_SIZE], data_len);
+    out[data_len] = '\0';
+    return true;
+}
+
+bool doip_uds_decode_u16(const uint8_t *response, int response_len, uint16_t *value)
+{
+    if (response_len <= UDS_RDBI_RESPONSE_HDR_SIZE + 1 ||
+        response[0] != UDS_RDBI_POSITIVE_RESPONSE) {
+        return false;
+    }
+
+    *value = (uint16_t)((response[3] << 8) | response[4]);
+    return true;
+}
+
+bool doip_uds_decode_u8(const uint8_t *response, int response_len, uint8_t *value)
+{
+    if (response_len <= UDS_RDBI_RESPONSE_HDR_SIZE ||
+        response[0] != UDS_RDBI_POSITIVE_RESPONSE) {
+        return false;
+    }
+
+    *value = response[3];
+    return true;
+}
+
+/* Stream reassembly */
+
+void doip_reasm_reset(doip_reassembler_t *reasm, doip_message_t *msg)
+{
+    reasm->msg = msg;
+    reasm->header_len = 0;
+    reasm->payload_len = 0;
+}
+
+size_t doip_reasm_next(doip_reassembler_t *reasm, uint8_t **dst)
+{
+    if (reasm->header_len < DOIP_HEADER_SIZE) {
+        *dst = &reasm->header[reasm->header_len];
+        return DOIP_HEADER_SIZE - reasm->header_len;
+    }
+
+    *dst = &reasm->msg->payload[reasm->payload_len];
+    return reasm->msg->payload_length - reasm->payload_len;
+}
+
+doip_reasm_status_t doip_reasm_commit(doip_reassembler_t *reasm, size_t len)
+{
+    if (reasm->header_len < DOIP_HEADER_SIZE) {
+        reasm->header_len += len;
+        if (reasm->header_len < DOIP_HEADER_SIZE) {
+            return DOIP_REASM_INCOMPLETE;
+        }
+
+        doip_reasm_status_t status = doip_decode_header(reasm->header, reasm->msg);
+        if (status != DOIP_REASM_COMPLETE || reasm->msg->payload_length == 0) {
+            return status;
+        }
+        return DOIP_REASM_INCOMPLETE;
+    }
+
+    reasm->payload_len += len;
+    return (reasm->payload_len == reasm->msg->payload_length) ?
+           DOIP_REASM_COMPLETE : DOIP_REASM_INCOMPLETE;
+}
+
+doip_reasm_status_t doip_reasm_feed(doip_reassembler_t *reasm, const uint8_t *data,
+                                    size_t len, size_t *consumed)
+{
+    doip_reasm_status_t status = DOIP_REASM_INCOMPLETE;
+    size_t used = 0;
+
+    while (used < len) {
+        uint8_t *dst;
+        size_t want = doip_reasm_next(reasm, &dst);
+        size_t chunk = (len - used < want) ? (len - used) : want;
+
+        memcpy(dst, &data[used], chunk);
+        used += chunk;
+
+        status = doip_reasm_commit(reasm, chunk);
+        if (status != DOIP_REASM_INCOMPLETE) {
+            break;
+        }
+    }
+
+    *consumed = used;
+    return status;
+}
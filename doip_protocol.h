@@ -0,0 +1,141 @@
+/**
+ * \file doip_protocol.h
+ * \brief DOIP framing, serialization and UDS response decoding
+ *
+ * Pure protocol helpers shared by the DOIP client and the host benchmark
+ * suite. Nothing in here depends on FreeRTOS or lwIP, so the same object
+ * code can be measured off-target (see pc/bench).
+ */
+
+#ifndef DOIP_PROTOCOL_H
+#define DOIP_PROTOCOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "doip_client.h"
+
+/* Reassembler result codes */
+typedef enum {
+    DOIP_REASM_INCOMPLETE,      /* More bytes are needed */
+    DOIP_REASM_COMPLETE,        /* A full message is available in msg */
+    DOIP_REASM_ERR_VERSION,     /* Protocol version / inverse mismatch */
+    DOIP_REASM_ERR_LENGTH       /* Payload length exceeds DOIP_MAX_PAYLOAD_SIZE */
+} doip_reasm_status_t;
+
+/**
+ * Stream reassembler state.
+ *
+ * The header is collected into a small scratch array; the payload is
+ * written directly into msg->payload so a message is copied exactly once
+ * on its way from the transport to the caller.
+ */
+typedef struct {
+    doip_message_t *msg;
+    uint8_t  header[DOIP_HEADER_SIZE];
+    uint32_t header_len;        /* Header bytes collected so far */
+    uint32_t payload_len;       /* Payload bytes collected so far */
+} doip_reassembler_t;
+
+/**
+ * \brief Decode and validate an 8-byte DOIP generic header
+ * \param[in] data Pointer to at least DOIP_HEADER_SIZE bytes
+ * \param[out] msg Message whose header fields are filled in
+ * \return DOIP_REASM_COMPLETE if valid, otherwise the error code
+ */
+doip_reasm_status_t doip_decode_header(const uint8_t *data, doip_message_t *msg);
+
+/**
+ * \brief Write an 8-byte DOIP generic header
+ * \param[out] out Destination, at least DOIP_HEADER_SIZE bytes
+ * \param[in] payload_type DOIP payload type
+ * \param[in] payload_length Payload length in bytes
+ * \return Number of bytes written (DOIP_HEADER_SIZE)
+ */
+size_t doip_serialize_header(uint8_t *out, uint16_t payload_type, uint32_t payload_length);
+
+/**
+ * \brief Serialize a complete DOIP message (header + payload)
+ * \param[in] msg Message to serialize
+ * \param[out] out Destination buffer
+ * \param[in] out_size Size of destination buffer
+ * \return Number of bytes written, 0 if the buffer is too small
+ */
+size_t doip_serialize_message(const doip_message_t *msg, uint8_t *out, size_t out_size);
+
+/**
+ * \brief Decode a ReadDataByIdentifier positive response carrying a string
+ * \param[in] response UDS response (SID + DID + data)
+ * \param[in] response_len Length of the UDS response
+ * \param[out] out Destination string, always NUL terminated on success
+ * \param[in] out_size Size of destination buffer
+ * \return true if the response was positive and decoded
+ */
+bool doip_uds_decode_string(const uint8_t *response, int response_len, char *out, size_t out_size);
+
+/**
+ * \brief Decode a ReadDataByIdentifier positive response carrying a big-endian u16
+ * \param[in] response UDS response (SID + DID + data)
+ * \param[in] response_len Length of the UDS response
+ * \param[out] value Decoded value
+ * \return true if the response was positive and decoded
+ */
+bool doip_uds_decode_u16(const uint8_t *response, int response_len, uint16_t *value);
+
+/**
+ * \brief Decode a ReadDataByIdentifier positive response carrying a single byte
+ * \param[in] response UDS response (SID + DID + data)
+ * \param[in] response_len Length of the UDS response
+ * \param[out] value Decoded value
+ * \return true if the response was positive and decoded
+ */
+bool doip_uds_decode_u8(const uint8_t *response, int response_len, uint8_t *value);
+
+/**
+ * \brief Reset a reassembler to collect the next message into msg
+ * \param[out] reasm Reassembler state
+ * \param[in] msg Message buffer the payload is written into
+ */
+void doip_reasm_reset(doip_reassembler_t *reasm, doip_message_t *msg);
+
+/**
+ * \brief Get where the next transport bytes should be written
+ *
+ * Lets a transport (stream buffer, socket recv) copy straight into the
+ * reassembler's storage instead of an intermediate buffer.
+ *
+ * \param[in] reasm Reassembler state
+ * \param[out] dst Destination pointer for the next bytes
+ * \return Number of bytes still needed for the current field
+ */
+size_t doip_reasm_next(doip_reassembler_t *reasm, uint8_t **dst);
+
+/**
+ * \brief Account for bytes written to the pointer from doip_reasm_next()
+ * \param[in] reasm Reassembler state
+ * \param[in] len Number of bytes written (must not exceed the value returned)
+ * \return Reassembly status
+ */
+doip_reasm_status_t doip_reasm_commit(doip_reassembler_t *reasm, size_t len);
+
+/**
+ * \brief Feed bytes from an external buffer (e.g. a pbuf) into the reassembler
+ *
+ * Stops after the first complete message so the caller can consume it
+ * before resetting; remaining bytes are left for the next call.
+ *
+ * \param[in] reasm Reassembler state
+ * \param[in] data Input bytes
+ * \param[in] len Number of input bytes
+ * \param[out] consumed Number of input bytes used
+ * \return Reassembly status
+ */
+doip_reasm_status_t doip_reasm_feed(doip_reassembler_t *reasm, const uint8_t *data,
+                                    size_t len, size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DOIP_PROTOCOL_H */
@@ -0,0 +1,387 @@
+/**
+ * \file doip_session.c
+ * \brief Stackless DOIP sessions multiplexed on one task
+ *
+ * The lwIP callbacks (tcpip thread) only record what happened in the
+ * session, mark it pending and notify the scheduler. The scheduler takes
+ * the core lock, runs every session that is pending or whose deadline has
+ * passed, and sleeps until the earliest remaining deadline. Holding the
+ * core lock while a body runs keeps the callbacks out, so the session
+ * fields need no further locking.
+ */
+
+#include "doip_session.h"
+#include "doip_protocol.h"
+#include "dlog.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include "lwip/tcp.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include <string.h>
+
+#define DOIP_SESSION_TASK_PRIORITY      (tskIDLE_PRIORITY + 3)
+#define DOIP_SESSION_TASK_STACK_SIZE    (512)
+
+static doip_session_t *session_list;
+static TaskHandle_t scheduler_task;
+static StaticTask_t scheduler_task_tcb;
+static StackType_t scheduler_task_stack[DOIP_SESSION_TASK_STACK_SIZE];
+
+/* Called with the core lock held */
+static void session_wake(doip_session_t *s)
+{
+    s->pending = true;
+    xTaskNotifyGive(scheduler_task);
+}
+
+static bool session_failed(const doip_session_t *s)
+{
+    return s->error != DOIP_SESSION_OK && s->error != DOIP_SESSION_ERR_TIMEOUT;
+}
+
+/* Raw lwIP callbacks, tcpip thread */
+
+static err_t session_connected(void *arg, struct tcp_pcb *tpcb, err_t err)
+{
+    doip_session_t *s = arg;
+
+    (void)tpcb;
+    (void)err;      /* Always ERR_OK; failures arrive through session_error */
+    s->connected = true;
+    session_wake(s);
+    return ERR_OK;
+}
+
+static err_t session_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    doip_session_t *s = arg;
+
+    (void)tpcb;
+    if (p == NULL) {
+        DLOG_INF(DLOG_MOD_TCP, "DOIP Session %p: closed by peer", (uintptr_t)s);
+        if (!session_failed(s)) {
+            s->error = DOIP_SESSION_ERR_CLOSED;
+        }
+    } else if (err != ERR_OK) {
+        pbuf_free(p);
+        return err;
+    } else if (s->rx_queue == NULL) {
+        s->rx_queue = p;
+    } else {
+        pbuf_cat(s->rx_queue, p);
+    }
+
+    session_wake(s);
+    return ERR_OK;
+}
+
+static err_t session_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+    (void)tpcb;
+    (void)len;
+    /* Send buffer space for a DOIP_SESSION_SEND that found it full */
+    session_wake(arg);
+    return ERR_OK;
+}
+
+static void session_error(void *arg, err_t err)
+{
+    doip_session_t *s = arg;
+
+    DLOG_ERR(DLOG_MOD_TCP, "DOIP Session %p: error %d", (uintptr_t)s, err);
+    /* lwIP has freed the pcb */
+    s->pcb = NULL;
+    s->error = DOIP_SESSION_ERR_ABORTED;
+    session_wake(s);
+}
+
+/* Scheduler task, core lock held */
+
+static void session_close(doip_session_t *s)
+{
+    if (s->pcb != NULL) {
+        tcp_arg(s->pcb, NULL);
+        tcp_recv(s->pcb, NULL);
+        tcp_sent(s->pcb, NULL);
+        tcp_err(s->pcb, NULL);
+        if (tcp_close(s->pcb) != ERR_OK) {
+            tcp_abort(s->pcb);
+        }
+        s->pcb = NULL;
+    }
+    if (s->rx_queue != NULL) {
+        pbuf_free(s->rx_queue);
+        s->rx_queue = NULL;
+    }
+}
+
+/* Copy up to len queued bytes to dst (NULL discards them) and release them
+ * to the peer's window */
+static uint32_t session_take(doip_session_t *s, uint8_t *dst, uint32_t len)
+{
+    uint32_t avail = (s->rx_queue != NULL) ? s->rx_queue->tot_len : 0;
+
+    if (len > avail) {
+        len = avail;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (dst != NULL) {
+        pbuf_copy_partial(s->rx_queue, dst, (u16_t)len, 0);
+    }
+    s->rx_queue = pbuf_free_header(s->rx_queue, (u16_t)len);
+    if (s->pcb != NULL) {
+        tcp_recved(s->pcb, (u16_t)len);
+    }
+    return len;
+}
+
+void doip_session_arm(doip_session_t *s, uint32_t timeout_ms)
+{
+    if (s->error == DOIP_SESSION_ERR_TIMEOUT) {
+        s->error = DOIP_SESSION_OK;
+    }
+    s->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    s->deadline_armed = true;
+}
+
+bool doip_session_expired(doip_session_t *s)
+{
+    if (!s->deadline_armed) {
+        return true;
+    }
+    if ((TickType_t)(xTaskGetTickCount() - s->deadline) < portMAX_DELAY / 2) {
+        s->deadline_armed = false;
+        return true;
+    }
+    return false;
+}
+
+/* End an await: true, with the deadline disarmed */
+static bool session_done(doip_session_t *s)
+{
+    s->deadline_armed = false;
+    return true;
+}
+
+/* Deadline checks for the await conditions; sets ERR_TIMEOUT */
+static bool session_timed_out(doip_session_t *s)
+{
+    if (s->deadline_armed && doip_session_expired(s)) {
+        s->error = DOIP_SESSION_ERR_TIMEOUT;
+        return true;
+    }
+    return false;
+}
+
+void doip_session_connect_start(doip_session_t *s, uint32_t ip, uint16_t port, uint32_t timeout_ms)
+{
+    ip_addr_t addr;
+
+    doip_session_arm(s, timeout_ms);
+    if (session_failed(s)) {
+        return;
+    }
+
+    s->pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (s->pcb == NULL) {
+        s->error = DOIP_SESSION_ERR_CONNECT;
+        return;
+    }
+    tcp_arg(s->pcb, s);
+    tcp_recv(s->pcb, session_recv);
+    tcp_sent(s->pcb, session_sent);
+    tcp_err(s->pcb, session_error);
+    tcp_nagle_disable(s->pcb);
+
+    ip_addr_set_ip4_u32(&addr, ip);
+    if (tcp_connect(s->pcb, &addr, port, session_connected) != ERR_OK) {
+        session_close(s);
+        s->error = DOIP_SESSION_ERR_CONNECT;
+    }
+}
+
+bool doip_session_connect_done(doip_session_t *s)
+{
+    if (s->connected || session_failed(s)) {
+        return session_done(s);
+    }
+    if (session_timed_out(s)) {
+        /* A late SYN-ACK must not find a half-open session */
+        session_close(s);
+        s->error = DOIP_SESSION_ERR_CONNECT;
+        return true;
+    }
+    return false;
+}
+
+bool doip_session_send(doip_session_t *s, uint16_t type, const uint8_t *payload, uint32_t len)
+{
+    uint8_t header[DOIP_HEADER_SIZE];
+    err_t err;
+
+    if (session_failed(s)) {
+        return session_done(s);
+    }
+    if (s->pcb == NULL || !s->connected) {
+        s->error = DOIP_SESSION_ERR_SEND;
+        return session_done(s);
+    }
+    if (tcp_sndbuf(s->pcb) < DOIP_HEADER_SIZE + len || tcp_sndqueuelen(s->pcb) + 2 > TCP_SND_QUEUELEN) {
+        return session_timed_out(s);
+    }
+
+    doip_serialize_header(header, type, len);
+    err = tcp_write(s->pcb, header, DOIP_HEADER_SIZE, TCP_WRITE_FLAG_COPY | (len ? TCP_WRITE_FLAG_MORE : 0));
+    if (err == ERR_OK && len > 0) {
+        err = tcp_write(s->pcb, payload, (u16_t)len, TCP_WRITE_FLAG_COPY);
+    }
+    if (err == ERR_OK) {
+        err = tcp_output(s->pcb);
+    }
+    if (err != ERR_OK) {
+        DLOG_ERR(DLOG_MOD_DOIP, "DOIP Session %p: send of 0x%04X failed - err=%d", (uintptr_t)s, type, err);
+        s->error = DOIP_SESSION_ERR_SEND;
+    }
+    return session_done(s);
+}
+
+void doip_session_receive_start(doip_session_t *s, uint32_t timeout_ms)
+{
+    doip_session_arm(s, timeout_ms);
+
+    /* A message cut off by the last timeout is finished first, so the
+     * stream stays in step */
+    if (s->rx_header_len == DOIP_HEADER_SIZE && s->rx_taken == s->rx_length) {
+        s->rx_header_len = 0;
+        s->rx_type = 0;
+        s->rx_length = 0;
+        s->rx_taken = 0;
+    }
+}
+
+bool doip_session_receive_done(doip_session_t *s)
+{
+    /* Header first, then the payload; what does not fit in rx[] is dropped */
+    if (s->rx_header_len < DOIP_HEADER_SIZE) {
+        s->rx_header_len += session_take(s, &s->rx_header[s->rx_header_len],
+                                         DOIP_HEADER_SIZE - s->rx_header_len);
+        if (s->rx_header_len == DOIP_HEADER_SIZE) {
+            const uint8_t *h = s->rx_header;
+
+            if (h[0] != DOIP_PROTOCOL_VERSION || h[1] != DOIP_INVERSE_PROTOCOL_VERSION) {
+                DLOG_ERR(DLOG_MOD_DOIP, "DOIP Session %p: invalid protocol version 0x%02X", (uintptr_t)s, h[0]);
+                s->error = DOIP_SESSION_ERR_PROTOCOL;
+                return session_done(s);
+            }
+            s->rx_type = (uint16_t)((h[2] << 8) | h[3]);
+            s->rx_length = ((uint32_t)h[4] << 24) | ((uint32_t)h[5] << 16) | ((uint32_t)h[6] << 8) | h[7];
+        }
+    }
+
+    if (s->rx_header_len == DOIP_HEADER_SIZE) {
+        while (s->rx_taken < s->rx_length) {
+            uint32_t want = s->rx_length - s->rx_taken;
+            uint8_t *dst = NULL;
+            uint32_t got;
+
+            if (s->rx_taken < DOIP_SESSION_RX_SIZE) {
+                dst = &s->rx[s->rx_taken];
+                if (want > DOIP_SESSION_RX_SIZE - s->rx_taken) {
+                    want = DOIP_SESSION_RX_SIZE - s->rx_taken;
+                }
+            }
+            got = session_take(s, dst, (want > 0xFFFF) ? 0xFFFF : want);
+            if (got == 0) {
+                break;
+            }
+            s->rx_taken += got;
+        }
+        if (s->rx_taken == s->rx_length) {
+            return session_done(s);
+        }
+    }
+
+    if (session_failed(s)) {
+        return session_done(s);
+    }
+    return session_timed_out(s);
+}
+
+static void doip_session_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        doip_session_t **link;
+
+        LOCK_TCPIP_CORE();
+        link = &session_list;
+        while (*link != NULL) {
+            doip_session_t *s = *link;
+            TickType_t now = xTaskGetTickCount();
+
+            if (s->pending || (s->deadline_armed && (TickType_t)(now - s->deadline) < portMAX_DELAY / 2)) {
+                s->pending = false;
+                if (s->fn(s) == DOIP_PT_EXITED) {
+                    session_close(s);
+                    *link = s->next;
+                    s->next = NULL;
+                    xTaskNotifyGive((TaskHandle_t)s->owner);
+                    continue;
+                }
+            }
+            if (s->pending) {
+                wait = 0;
+            } else if (s->deadline_armed) {
+                TickType_t left = s->deadline - now;
+
+                if (left >= portMAX_DELAY / 2) {
+                    left = 0;
+                }
+                if (left < wait) {
+                    wait = left;
+                }
+            }
+            link = &s->next;
+        }
+        UNLOCK_TCPIP_CORE();
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+bool doip_session_init(void)
+{
+    if (scheduler_task != NULL) {
+        return true;
+    }
+
+    scheduler_task = xTaskCreateStatic(doip_session_task, "DOIPSess", DOIP_SESSION_TASK_STACK_SIZE, NULL,
+                                       DOIP_SESSION_TASK_PRIORITY, scheduler_task_stack, &scheduler_task_tcb);
+    if (scheduler_task == NULL) {
+        printf("DOIP Session: Failed to create task\r\n");
+        return false;
+    }
+
+    return true;
+}
+
+void doip_session_start(doip_session_t *s, doip_session_fn_t fn)
+{
+    memset(s, 0, sizeof(*s));
+    s->fn = fn;
+    s->owner = xTaskGetCurrentTaskHandle();
+    s->pending = true;
+
+    LOCK_TCPIP_CORE();
+    s->next = session_list;
+    session_list = s;
+    UNLOCK_TCPIP_CORE();
+
+    xTaskNotifyGive(scheduler_task);
+}
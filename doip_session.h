@@ -0,0 +1,160 @@
+/**
+ * \file doip_session.h
+ * \brief Stackless DOIP sessions multiplexed on one task
+ *
+ * The blocking client API needs a task, and a 2048-word stack, per
+ * conversation. A session here is instead a resumable function
+ * (protothread): it returns to the scheduler at each await point and is
+ * re-entered there once its condition may have changed. All of a
+ * session's state lives in its doip_session_t, a couple of hundred bytes,
+ * or in a structure that embeds it first; one scheduler task runs every
+ * session, so tens of them cost one stack.
+ *
+ * A session body looks like blocking code:
+ *
+ *   static doip_pt_status_t body(doip_session_t *s)
+ *   {
+ *       DOIP_PT_BEGIN(s);
+ *       DOIP_SESSION_CONNECT(s, ip, DOIP_TCP_DATA_PORT, DOIP_TCP_TIMEOUT_MS);
+ *       ...
+ *       DOIP_SESSION_SEND(s, DOIP_DIAGNOSTIC_MESSAGE, ctx->tx, 7);
+ *       DOIP_SESSION_RECEIVE(s, DOIP_TCP_TIMEOUT_MS);
+ *       if (s->error != DOIP_SESSION_OK) { DOIP_PT_EXIT(s); }
+ *       ...
+ *       DOIP_PT_END(s);
+ *   }
+ *
+ * with the usual protothread rules: local variables do not survive an
+ * await (keep them in the context), an await cannot sit inside a switch
+ * of the body, and only one await may be written per source line.
+ *
+ * Bodies run in the scheduler task with the lwIP core lock held, so they
+ * may call the raw TCP API directly, must not block, and should log with
+ * DLOG_* rather than printf. Received data stays in the pbufs lwIP
+ * delivered until the session takes it, and is only acknowledged to the
+ * peer (tcp_recved) then; a slow session throttles its own connection.
+ */
+
+#ifndef DOIP_SESSION_H
+#define DOIP_SESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "doip_client.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Received payload kept per session; longer payloads are truncated to
+ * this (rx_length still gives the full size) */
+#ifndef DOIP_SESSION_RX_SIZE
+#define DOIP_SESSION_RX_SIZE        64
+#endif
+
+struct tcp_pcb;
+struct pbuf;
+
+typedef enum {
+    DOIP_PT_WAITING,            /* Parked at an await point */
+    DOIP_PT_EXITED              /* Ran to the end or left with DOIP_PT_EXIT */
+} doip_pt_status_t;
+
+/* Outcome of the last await; sticky once the connection has failed */
+typedef enum {
+    DOIP_SESSION_OK = 0,
+    DOIP_SESSION_ERR_TIMEOUT,   /* Deadline passed; the connection is still usable */
+    DOIP_SESSION_ERR_CONNECT,   /* No pcb or tcp_connect() failed */
+    DOIP_SESSION_ERR_CLOSED,    /* Peer closed the connection */
+    DOIP_SESSION_ERR_ABORTED,   /* Reset or aborted by lwIP (tcp_err) */
+    DOIP_SESSION_ERR_PROTOCOL,  /* Bad DOIP header */
+    DOIP_SESSION_ERR_SEND       /* tcp_write() or tcp_output() failed */
+} doip_session_error_t;
+
+typedef struct doip_session doip_session_t;
+typedef doip_pt_status_t (*doip_session_fn_t)(doip_session_t *s);
+
+struct doip_session {
+    doip_session_t *next;       /* Scheduler list */
+    doip_session_fn_t fn;
+    void *owner;                /* Task notified when the session ends */
+    struct tcp_pcb *pcb;
+    struct pbuf *rx_queue;      /* Received, not yet taken */
+    uint32_t deadline;          /* Tick the current await gives up at */
+    uint16_t pt;                /* Resume point, 0 = start */
+    uint8_t error;              /* doip_session_error_t */
+    volatile bool pending;      /* Something changed since the last run */
+    bool deadline_armed;
+    bool connected;
+
+    /* Message being received: header, then up to DOIP_SESSION_RX_SIZE
+     * bytes of payload */
+    uint8_t rx_header_len;
+    uint8_t rx_header[DOIP_HEADER_SIZE];
+    uint16_t rx_type;
+    uint32_t rx_length;         /* Payload length from the header */
+    uint32_t rx_taken;          /* Payload bytes taken so far */
+    uint8_t rx[DOIP_SESSION_RX_SIZE];
+};
+
+/* Protothread control. DOIP_PT_WAIT_UNTIL stores the line as the resume
+ * point and returns while cond is false; the scheduler re-enters there. */
+#define DOIP_PT_BEGIN(s)            switch ((s)->pt) { case 0:
+#define DOIP_PT_WAIT_UNTIL(s, cond) \
+    do { (s)->pt = __LINE__; case __LINE__: if (!(cond)) { return DOIP_PT_WAITING; } } while (0)
+#define DOIP_PT_EXIT(s)             do { (s)->pt = 0; return DOIP_PT_EXITED; } while (0)
+#define DOIP_PT_END(s)              } (s)->pt = 0; return DOIP_PT_EXITED
+
+/* Connect to ip (lwIP byte order) and port; error is OK once connected */
+#define DOIP_SESSION_CONNECT(s, ip, port, timeout_ms) \
+    do { doip_session_connect_start((s), (ip), (port), (timeout_ms)); \
+         DOIP_PT_WAIT_UNTIL((s), doip_session_connect_done(s)); } while (0)
+
+/* Queue a message once the send buffer has room. Re-evaluated at each
+ * resume, so the payload must live in the session context or be static */
+#define DOIP_SESSION_SEND(s, type, payload, len) \
+    do { doip_session_arm((s), DOIP_TCP_TIMEOUT_MS); \
+         DOIP_PT_WAIT_UNTIL((s), doip_session_send((s), (type), (payload), (len))); } while (0)
+
+/* Wait for the next complete message: rx_type, rx_length and rx[] */
+#define DOIP_SESSION_RECEIVE(s, timeout_ms) \
+    do { doip_session_receive_start((s), (timeout_ms)); \
+         DOIP_PT_WAIT_UNTIL((s), doip_session_receive_done(s)); } while (0)
+
+/* Yield for ms without touching the connection */
+#define DOIP_SESSION_SLEEP(s, ms) \
+    do { doip_session_arm((s), (ms)); \
+         DOIP_PT_WAIT_UNTIL((s), doip_session_expired(s)); } while (0)
+
+/**
+ * \brief Create the scheduler task
+ * \return true if the task was created
+ */
+bool doip_session_init(void);
+
+/**
+ * \brief Run a session on the scheduler
+ *
+ * s is owned by the scheduler until it ends, when the connection is
+ * closed and the calling task's notification value is incremented (wait
+ * with ulTaskNotifyTake()). error then holds the last await's outcome.
+ *
+ * \param s Session storage, zeroed here
+ * \param fn Session body
+ */
+void doip_session_start(doip_session_t *s, doip_session_fn_t fn);
+
+/* Await helpers behind the macros above; called in the scheduler task */
+void doip_session_arm(doip_session_t *s, uint32_t timeout_ms);
+bool doip_session_expired(doip_session_t *s);
+void doip_session_connect_start(doip_session_t *s, uint32_t ip, uint16_t port, uint32_t timeout_ms);
+bool doip_session_connect_done(doip_session_t *s);
+bool doip_session_send(doip_session_t *s, uint16_t type, const uint8_t *payload, uint32_t len);
+void doip_session_receive_start(doip_session_t *s, uint32_t timeout_ms);
+bool doip_session_receive_done(doip_session_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DOIP_SESSION_H */
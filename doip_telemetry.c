@@ -0,0 +1,169 @@
+/**
+ * \file doip_telemetry.c
+ * \brief On-demand retrieval of the DOIP latency histograms
+ *
+ * The histograms are only written by the DOIP client task, so reads are
+ * made consistent by suspending the scheduler rather than with a mutex
+ * on the recording path.
+ */
+
+#include "doip_telemetry.h"
+#include "doip_metrics.h"
+#include "sys_stats.h"
+#include "net_stats.h"
+#include "rtos_heap.h"
+#include "mem_copy.h"
+#include "housekeeping.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include "rtt_printf.h"
+
+#ifndef DOIP_TELEMETRY_POLL_MS
+#define DOIP_TELEMETRY_POLL_MS          100
+#endif
+
+/* Dump buffer; typical cycles leave most buckets empty */
+#ifndef DOIP_TELEMETRY_DUMP_SIZE
+#define DOIP_TELEMETRY_DUMP_SIZE        2048
+#endif
+
+static const char *const phase_names[DOIP_PHASE_COUNT] = {
+    "discovery",
+    "connect",
+    "activation",
+};
+
+static uint8_t dump_buffer[DOIP_TELEMETRY_DUMP_SIZE];
+
+
+void doip_telemetry_dump(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t len;
+
+    vTaskSuspendAll();
+    len = doip_metrics_serialize(dump_buffer, sizeof(dump_buffer));
+    xTaskResumeAll();
+
+    if (len == 0) {
+        printf("[METRICS] dump does not fit in %u bytes\r\n", (unsigned)sizeof(dump_buffer));
+        return;
+    }
+
+    rtt_printf_channel_t previous = rtt_printf_select(RTT_PRINTF_CH_METRICS);
+
+    printf("[METRICS] ");
+    for (size_t i = 0; i < len; i++) {
+        _putchar(hex[dump_buffer[i] >> 4]);
+        _putchar(hex[dump_buffer[i] & 0x0F]);
+    }
+    printf("\r\n");
+    rtt_printf_select(previous);
+}
+
+static void print_hist(const char *name, uint16_t did, const doip_hist_t *hist)
+{
+    char label[16];
+
+    if (name == NULL) {
+        snprintf(label, sizeof(label), "DID 0x%04X", did);
+        name = label;
+    }
+
+    printf("[METRICS] %-12s n=%-6lu fail=%-4lu p50=%-8lu p99=%-8lu max=%lu us\r\n", name,
+           (unsigned long)hist->count, (unsigned long)hist->failed,
+           (unsigned long)doip_hist_percentile(hist, 500),
+           (unsigned long)doip_hist_percentile(hist, 990),
+           (unsigned long)hist->max_us);
+}
+
+void doip_telemetry_print_summary(void)
+{
+    static doip_hist_t snapshot;
+    uint16_t did;
+
+    /* One histogram is copied at a time to keep the scheduler lock short */
+    for (uint32_t i = 0; i < DOIP_PHASE_COUNT; i++) {
+        vTaskSuspendAll();
+        snapshot = *doip_metrics_phase((doip_phase_t)i);
+        xTaskResumeAll();
+        print_hist(phase_names[i], 0, &snapshot);
+    }
+
+    for (uint32_t i = 0; ; i++) {
+        const doip_hist_t *hist;
+
+        vTaskSuspendAll();
+        hist = doip_metrics_did(i, &did);
+        if (hist != NULL) {
+            snapshot = *hist;
+        }
+        xTaskResumeAll();
+
+        if (hist == NULL) {
+            break;
+        }
+        print_hist(NULL, did, &snapshot);
+    }
+}
+
+void doip_telemetry_reset(void)
+{
+    vTaskSuspendAll();
+    doip_metrics_reset();
+    xTaskResumeAll();
+    printf("[METRICS] reset\r\n");
+}
+
+static uint32_t doip_telemetry_job(void *arg)
+{
+    int c;
+
+    (void)arg;
+
+    while ((c = rtt_printf_getchar()) >= 0) {
+        switch (c) {
+        case 'm':
+            doip_telemetry_dump();
+            break;
+        case 's':
+            doip_telemetry_print_summary();
+            break;
+        case 'r':
+            doip_telemetry_reset();
+            break;
+        case 't':
+            sys_stats_print();
+            break;
+        case 'h':
+            rtos_heap_report();
+            break;
+        case 'n':
+            net_stats_print();
+            break;
+        case 'p':
+            net_stats_print_pools();
+            break;
+        case 'c':
+            mem_copy_bench();
+            break;
+        case 'k':
+            housekeeping_print();
+            break;
+        default:
+            break;
+        }
+    }
+
+    return DOIP_TELEMETRY_POLL_MS;
+}
+
+bool doip_telemetry_start(void)
+{
+    if (housekeeping_add("Console", doip_telemetry_job, NULL, DOIP_TELEMETRY_POLL_MS) == NULL) {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,52 @@
+/**
+ * \file doip_telemetry.h
+ * \brief On-demand retrieval of the DOIP latency histograms
+ *
+ * A housekeeping job polls the console for single-key commands:
+ *   m - dump all histograms as one "[METRICS] <hex>" line on the
+ *       RTT metrics channel (binary format in doip_metrics.h, decode with
+ *       pc/python/doip_metrics_decode.py)
+ *   s - print a p50/p99 summary
+ *   r - reset the histograms
+ *   t - print per-task CPU load and free stack (sys_stats.h)
+ *   h - print heap use, peak and free block histogram (rtos_heap.h)
+ *   n - print MAC, lwIP protocol and pool counters (net_stats.h)
+ *   p - print peak use of every lwIP pool (net_stats_print_pools())
+ *   k - print run counts and times of the housekeeping jobs (housekeeping.h)
+ */
+
+#ifndef DOIP_TELEMETRY_H
+#define DOIP_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+/**
+ * \brief Schedule the console polling job
+ * \return true if the job was added
+ */
+bool doip_telemetry_start(void);
+
+/**
+ * \brief Write the binary histogram dump to the console
+ */
+void doip_telemetry_dump(void);
+
+/**
+ * \brief Print count, p50, p99 and max for each phase and DID
+ */
+void doip_telemetry_print_summary(void);
+
+/**
+ * \brief Clear all histograms
+ */
+void doip_telemetry_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DOIP_TELEMETRY_H */
@@ -0,0 +1,88 @@
+#ifndef _BSP_DMA_COPY_H_
+#define _BSP_DMA_COPY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * \brief Memory-to-memory copies off the CPU, implemented by each BSP
+ *
+ * SAME54: software-triggered DMAC channels, one per copy in flight.
+ * Linux host and QEMU: copied on the CPU before the call returns, so
+ * callers behave the same and can be run on the host.
+ *
+ * A copy is a chain of descriptors moved as one transaction. Chains
+ * shorter than BSP_DMA_COPY_MIN bytes in total, and any submitted while
+ * every channel is busy, are copied on the CPU: below that size the
+ * channel setup and completion interrupt cost more than the copy.
+ */
+
+#ifndef BSP_DMA_COPY_MIN
+#define BSP_DMA_COPY_MIN            256
+#endif
+
+/* Most descriptors in one chain */
+#define BSP_DMA_COPY_LINKS          4
+
+typedef struct bsp_dma_copy_desc {
+    void *dst;
+    const void *src;
+    uint32_t length;                        ///< Bytes, at most 65535
+    const struct bsp_dma_copy_desc *next;   ///< Next block of the same copy, NULL for the last
+} bsp_dma_copy_desc_t;
+
+/**
+ * \brief Completion of bsp_dma_copy_submit()
+ * \param[in] ok false if the DMAC reported a bus error; the data is then incomplete
+ *
+ * Called from the DMAC interrupt, or from bsp_dma_copy_submit() itself
+ * when the copy was made on the CPU.
+ */
+typedef void (*bsp_dma_copy_done_t)(void *arg, bool ok);
+
+typedef struct {
+    uint32_t dma;               ///< Copies made by the DMAC
+    uint64_t dma_bytes;
+    uint32_t cpu;               ///< Copies made on the CPU (short, or no DMA)
+    uint32_t busy;              ///< Of those, long enough but no channel free
+    uint32_t errors;            ///< DMAC bus errors
+} bsp_dma_copy_stats_t;
+
+/**
+ * \brief Claim the copy channels; call once after init_mcu()
+ */
+void bsp_dma_copy_init(void);
+
+/**
+ * \brief Start a copy and return; task context
+ * \param[in] desc First descriptor; the chain is read before returning,
+ *                 only the buffers must stay valid until \a done
+ * \param[in] done Completion callback, may be NULL
+ * \return false, with nothing copied, if the chain is longer than
+ *         BSP_DMA_COPY_LINKS or a block exceeds 65535 bytes
+ */
+bool bsp_dma_copy_submit(const bsp_dma_copy_desc_t *desc, bsp_dma_copy_done_t done, void *arg);
+
+/**
+ * \brief Copy a chain and wait for it; task context
+ *
+ * The calling task blocks while the DMAC works. Falls back to the CPU
+ * before the scheduler runs, for chains bsp_dma_copy_submit() would
+ * refuse and after a DMAC error, so the data is always copied when this
+ * returns.
+ */
+void bsp_dma_copy(const bsp_dma_copy_desc_t *desc);
+
+/**
+ * \brief memcpy() through bsp_dma_copy(); task context
+ * \return \a dst
+ */
+void *bsp_dma_memcpy(void *dst, const void *src, size_t len);
+
+/**
+ * \brief Copy counters since start-up
+ */
+void bsp_dma_copy_stats(bsp_dma_copy_stats_t *stats);
+
+#endif // _BSP_DMA_COPY_H_
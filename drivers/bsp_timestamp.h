@@ -0,0 +1,37 @@
+#ifndef _BSP_TIMESTAMP_H_
+#define _BSP_TIMESTAMP_H_
+
+#include <stdint.h>
+
+/**
+ * \brief Free-running high resolution timestamp, implemented by each BSP
+ *
+ * SAME54: DWT cycle counter. Linux host: CLOCK_MONOTONIC. QEMU: SysTick
+ * (QEMU does not model the DWT). Differences of two timestamps are valid
+ * across counter wrap as long as the interval is shorter than one wrap
+ * (35 s on the SAME54 at 120 MHz).
+ */
+
+/**
+ * \brief Start the timestamp counter
+ */
+void bsp_timestamp_init(void);
+
+/**
+ * \brief Current timestamp in counter ticks
+ */
+uint32_t bsp_timestamp_now(void);
+
+/**
+ * \brief Convert a timestamp to microseconds
+ * \param[in] ticks Value returned by bsp_timestamp_now()
+ */
+uint32_t bsp_timestamp_to_us(uint32_t ticks);
+
+/**
+ * \brief Microseconds elapsed since a timestamp
+ * \param[in] start Value returned by bsp_timestamp_now()
+ */
+uint32_t bsp_timestamp_elapsed_us(uint32_t start);
+
+#endif // _BSP_TIMESTAMP_H_
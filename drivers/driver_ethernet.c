@@ -203,4 +203,17 @@ drv_eth_status_t hw_eth_stop_link_monitor(drv_eth_t *handle)
     }
     
     return handle->stop_link_monitor(handle->hw_context);
+}
+
+drv_eth_status_t hw_eth_get_stats(drv_eth_t *handle, drv_eth_stats_t *stats)
+{
+    ASSERT(handle != NULL);
+    ASSERT(handle->get_stats != NULL);
+    ASSERT(stats != NULL);
+    
+    if (!handle->is_init) {
+        return DRV_ETH_STATUS_ERROR;
+    }
+    
+    return handle->get_stats(handle->hw_context, stats);
 }
\ No newline at end of file
@@ -18,6 +18,28 @@ typedef enum
     DRV_ETH_CB_TRANSMIT = 1,  ///< Transmit callback
 } drv_eth_cb_type_t;
 
+// MAC level counters, accumulated since start-up
+typedef struct
+{
+    uint32_t rx_frames;       ///< Frames received without error
+    uint64_t rx_bytes;        ///< Octets in frames received without error
+    uint32_t rx_errors;       ///< FCS, alignment, length and symbol errors
+    uint32_t rx_dropped;      ///< Frames lost to overruns or missing receive buffers
+    uint32_t tx_frames;       ///< Frames transmitted without error
+    uint64_t tx_bytes;        ///< Octets in frames transmitted without error
+    uint32_t tx_errors;       ///< Underruns, collisions and carrier sense errors
+    uint32_t rx_wakeups;      ///< Receive task wakeups (0 where the driver does not poll)
+    uint32_t rx_wakeup_frames; ///< Frames taken in those wakeups
+    uint32_t rx_wakeup_max;   ///< Most frames taken in one wakeup
+    uint32_t rx_budget_hits;  ///< Receive polls that used their whole budget
+    uint32_t rx_filtered;     ///< Frames dropped by the driver's receive filter
+    uint32_t rx_priority;     ///< DoIP frames received ahead of other traffic
+    uint32_t rx_shed;         ///< Other frames dropped to keep buffers for DoIP
+    uint32_t rx_ring_peak;    ///< Most receive descriptors found filled at once
+    uint32_t rx_ring_full;    ///< Times the receive ring ran out of descriptors
+    uint32_t rx_overruns;     ///< Times the receive FIFO overflowed
+} drv_eth_stats_t;
+
 typedef void (*drv_eth_callback_t)(void);
 typedef void (*drv_eth_tcpip_init_done_fn)(void *arg);
 
@@ -55,6 +77,9 @@ typedef struct
     // Link monitoring
     drv_eth_status_t (*start_link_monitor)(const void *hw_context);
     drv_eth_status_t (*stop_link_monitor)(const void *hw_context);
+    
+    // Statistics
+    drv_eth_status_t (*get_stats)(const void *hw_context, drv_eth_stats_t *stats);
 } drv_eth_t;
 
 #ifdef __cplusplus
@@ -91,6 +116,9 @@ drv_eth_tcpip_init_done_fn hw_eth_get_tcpip_init_done_fn(drv_eth_t *handle);
 drv_eth_status_t hw_eth_start_link_monitor(drv_eth_t *handle);
 drv_eth_status_t hw_eth_stop_link_monitor(drv_eth_t *handle);
 
+// Statistics
+drv_eth_status_t hw_eth_get_stats(drv_eth_t *handle, drv_eth_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,6 +52,9 @@ typedef struct {
     uint32_t tx_packets;
     uint32_t rx_errors;
     uint32_t tx_errors;
+    uint32_t rx_dropped;    // MAC overruns, missing receive buffers and empty pbuf pool
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
 } drv_net_status_info_t;
 
 // Callback types
@@ -63,6 +66,7 @@ typedef enum {
     DRV_NET_CB_ERROR = 4,
 } drv_net_cb_type_t;
 
+// Called from the network stack's thread on each change; must not block
 typedef void (*drv_net_callback_t)(void);
 
 // Universal network driver structure
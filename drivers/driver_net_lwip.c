@@ -8,6 +8,7 @@
 #include "lwip/netif.h"
 #include "lwip/ip_addr.h"
 #include "lwip/inet.h"
+#include "lwip/stats.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "utils_assert.h"
@@ -31,6 +32,29 @@ static void lwip_ip_addr_to_string(const ip_addr_t *addr, char *str, uint32_t le
              (int)((ip >> 24) & 0xFF));
 }
 
+// Run the registered driver callbacks for a network state change (lwIP thread)
+static void lwip_net_event_handler(uint32_t changed, uint32_t state, void *arg)
+{
+    drv_net_lwip_hw_context_t *context = (drv_net_lwip_hw_context_t*)arg;
+    drv_net_callback_t callback;
+    
+    if (changed & NET_EVENT_LINK_UP) {
+        context->link_up = (state & NET_EVENT_LINK_UP) != 0;
+        callback = context->link_up ? context->link_up_callback : context->link_down_callback;
+        if (callback != NULL) {
+            callback();
+        }
+    }
+    
+    if (changed & NET_EVENT_IP_BOUND) {
+        context->has_ip = (state & NET_EVENT_IP_BOUND) != 0;
+        callback = context->has_ip ? context->ip_acquired_callback : context->ip_lost_callback;
+        if (callback != NULL) {
+            callback();
+        }
+    }
+}
+
 // Format MAC address to string
 static void mac_addr_to_string(const uint8_t *mac, char *str, uint32_t len)
 {
@@ -115,6 +139,14 @@ drv_net_status_t drv_net_lwip_start_impl(const void *hw_context, const drv_net_c
         return DRV_NET_STATUS_ERROR;
     }
     
+    // Deliver link and address changes to the registered callbacks. Made
+    // once, before the stack can report the first change; it outlives stop
+    static bool events_subscribed = false;
+    if (!events_subscribed) {
+        events_subscribed = network_events_subscribe(NET_EVENT_LINK_UP | NET_EVENT_IP_BOUND,
+                                                     lwip_net_event_handler, context);
+    }
+    
     // Initialize TCP/IP stack
     printf("[NET_LWIP] Initializing TCP/IP stack...\r\n");
     tcpip_init(hw_eth_get_tcpip_init_done_fn((drv_eth_t*)context->eth_driver), &context->init_sem);
@@ -198,14 +230,23 @@ drv_net_status_t drv_net_lwip_get_status_impl(const void *hw_context, drv_net_st
         // Check if we have a valid IP address
         status->has_ip = (TCPIP_STACK_INTERFACE_0_desc.ip_addr.addr != 0);
         context->has_ip = status->has_ip;
-        
-        // Network statistics (basic implementation)
-        status->rx_packets = 0; // LwIP doesn't provide easy access to these
-        status->tx_packets = 0;
-        status->rx_errors = 0;
-        status->tx_errors = 0;
     }
     
+    // Interface counters from the MAC, plus frames the netif driver dropped
+    drv_eth_stats_t eth_stats;
+    if (hw_eth_get_stats((drv_eth_t*)context->eth_driver, &eth_stats) == DRV_ETH_STATUS_OK) {
+        status->rx_packets = eth_stats.rx_frames;
+        status->tx_packets = eth_stats.tx_frames;
+        status->rx_errors = eth_stats.rx_errors;
+        status->tx_errors = eth_stats.tx_errors;
+        status->rx_dropped = eth_stats.rx_dropped;
+        status->rx_bytes = eth_stats.rx_bytes;
+        status->tx_bytes = eth_stats.tx_bytes;
+    }
+#if LWIP_STATS && LINK_STATS
+    status->rx_dropped += lwip_stats.link.drop;
+#endif
+    
     // MAC address
     mac_addr_to_string(TCPIP_STACK_INTERFACE_0_desc.hwaddr, status->mac_addr_str, sizeof(status->mac_addr_str));
     
@@ -223,21 +264,12 @@ drv_net_status_t drv_net_lwip_wait_for_link_impl(const void *hw_context, uint32_
     
     printf("[NET_LWIP] Waiting for link (timeout: %lu ms)\r\n", timeout_ms);
     
-    uint32_t elapsed = 0;
-    const uint32_t check_interval = 100;
-    
-    while (elapsed < timeout_ms) {
-        bool link_up;
-        drv_eth_status_t result = hw_eth_get_link_status((drv_eth_t*)context->eth_driver, &link_up);
-        
-        if (result == DRV_ETH_STATUS_OK && link_up) {
-            context->link_up = true;
-            printf("[NET_LWIP] Link established after %lu ms\r\n", elapsed);
-            return DRV_NET_STATUS_OK;
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(check_interval));
-        elapsed += check_interval;
+    TickType_t start = xTaskGetTickCount();
+    if (network_events_wait(NET_EVENT_LINK_UP, true, timeout_ms) & NET_EVENT_LINK_UP) {
+        context->link_up = true;
+        printf("[NET_LWIP] Link established after %lu ms\r\n",
+               (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS));
+        return DRV_NET_STATUS_OK;
     }
     
     printf("[NET_LWIP] Link wait timeout after %lu ms\r\n", timeout_ms);
@@ -255,19 +287,12 @@ drv_net_status_t drv_net_lwip_wait_for_ip_impl(const void *hw_context, uint32_t
     
     printf("[NET_LWIP] Waiting for IP address (timeout: %lu ms)\r\n", timeout_ms);
     
-    uint32_t elapsed = 0;
-    const uint32_t check_interval = 250;
-    
-    while (elapsed < timeout_ms) {
-        if (netif_is_up(&TCPIP_STACK_INTERFACE_0_desc) && 
-            TCPIP_STACK_INTERFACE_0_desc.ip_addr.addr != 0) {
-            context->has_ip = true;
-            printf("[NET_LWIP] IP address acquired after %lu ms\r\n", elapsed);
-            return DRV_NET_STATUS_OK;
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(check_interval));
-        elapsed += check_interval;
+    TickType_t start = xTaskGetTickCount();
+    if (network_events_wait(NET_EVENT_IP_BOUND, true, timeout_ms) & NET_EVENT_IP_BOUND) {
+        context->has_ip = true;
+        printf("[NET_LWIP] IP address acquired after %lu ms\r\n",
+               (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS));
+        return DRV_NET_STATUS_OK;
     }
     
     printf("[NET_LWIP] IP address wait timeout after %lu ms\r\n", timeout_ms);
@@ -309,6 +334,10 @@ drv_net_status_t drv_net_lwip_print_network_info_impl(const void *hw_context)
     }
     
     printf("DHCP Mode     : %s\r\n", context->current_config.use_dhcp ? "ENABLED" : "DISABLED");
+    printf("RX            : %lu packets, %llu bytes, %lu errors, %lu dropped\r\n",
+           status.rx_packets, (unsigned long long)status.rx_bytes, status.rx_errors, status.rx_dropped);
+    printf("TX            : %lu packets, %llu bytes, %lu errors\r\n",
+           status.tx_packets, (unsigned long long)status.tx_bytes, status.tx_errors);
     
     if (context->current_config.hostname) {
         printf("Hostname      : %s\r\n", context->current_config.hostname);
@@ -0,0 +1,236 @@
+/**
+ * \file housekeeping.c
+ * \brief Run-to-completion executor for housekeeping jobs
+ *
+ * The job table is shared with the tasks that add, trigger and cancel
+ * jobs and is only touched in short critical sections; callbacks run
+ * outside them. The executor sleeps on its task notification until the
+ * earliest due time, and adding or triggering a job notifies it so a
+ * new deadline is picked up at once.
+ *
+ * Finished jobs keep their slot, and with it their counters, until the
+ * table has no never-used slot left.
+ */
+
+#include "housekeeping.h"
+#include "bsp_timestamp.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include <stddef.h>
+
+#define HOUSEKEEPING_TASK_PRIORITY      (tskIDLE_PRIORITY + 1)
+#define HOUSEKEEPING_TASK_STACK_SIZE    (512)
+
+typedef enum {
+    JOB_UNUSED = 0,
+    JOB_WAITING,                /* Due at job->due */
+    JOB_PARKED,                 /* Until housekeeping_trigger() */
+    JOB_RUNNING,
+    JOB_DONE,
+} job_state_t;
+
+struct housekeeping_job {
+    const char *name;
+    housekeeping_fn_t fn;
+    void *arg;
+    TickType_t due;
+    uint8_t state;
+    bool triggered;             /* While running: run again straight after */
+    bool cancelled;             /* While running: remove after this run */
+    uint32_t runs;
+    uint64_t total_ticks;
+    uint32_t max_ticks;
+    TickType_t max_late;
+};
+
+static housekeeping_job_t jobs[HOUSEKEEPING_MAX_JOBS];
+static TaskHandle_t executor_task;
+static StaticTask_t executor_task_tcb;
+static StackType_t executor_task_stack[HOUSEKEEPING_TASK_STACK_SIZE];
+
+/* Called in a critical section */
+static void job_schedule(housekeeping_job_t *job, uint32_t delay_ms)
+{
+    if (delay_ms == HOUSEKEEPING_DONE) {
+        job->state = JOB_DONE;
+    } else if (delay_ms == HOUSEKEEPING_WAIT) {
+        job->state = JOB_PARKED;
+    } else {
+        job->due = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+        job->state = JOB_WAITING;
+    }
+}
+
+static void executor_wake(void)
+{
+    if (executor_task != NULL) {
+        xTaskNotifyGive(executor_task);
+    }
+}
+
+/* Earliest job due by now, marked running; otherwise NULL and the ticks
+ * until the next one is due */
+static housekeeping_job_t *job_next(TickType_t now, TickType_t *wait)
+{
+    housekeeping_job_t *next = NULL;
+    TickType_t soonest = portMAX_DELAY;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < HOUSEKEEPING_MAX_JOBS; i++) {
+        housekeeping_job_t *job = &jobs[i];
+        TickType_t late = now - job->due;
+
+        if (job->state != JOB_WAITING) {
+            continue;
+        }
+        if (late <= portMAX_DELAY / 2) {
+            if (next == NULL || late > now - next->due) {
+                next = job;
+            }
+        } else if (job->due - now < soonest) {
+            soonest = job->due - now;
+        }
+    }
+    if (next != NULL) {
+        next->state = JOB_RUNNING;
+    }
+    taskEXIT_CRITICAL();
+
+    *wait = soonest;
+    return next;
+}
+
+static void job_run(housekeeping_job_t *job, TickType_t now)
+{
+    TickType_t late = now - job->due;
+    uint32_t start = bsp_timestamp_now();
+    uint32_t delay_ms = job->fn(job->arg);
+    uint32_t ticks = bsp_timestamp_now() - start;
+
+    taskENTER_CRITICAL();
+    job->runs++;
+    job->total_ticks += ticks;
+    if (ticks > job->max_ticks) {
+        job->max_ticks = ticks;
+    }
+    if (late > job->max_late) {
+        job->max_late = late;
+    }
+
+    if (job->cancelled) {
+        delay_ms = HOUSEKEEPING_DONE;
+    } else if (job->triggered && delay_ms != HOUSEKEEPING_DONE) {
+        delay_ms = 0;
+    }
+    job->cancelled = false;
+    job->triggered = false;
+    job_schedule(job, delay_ms);
+    taskEXIT_CRITICAL();
+}
+
+static void housekeeping_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    for (;;) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait;
+        housekeeping_job_t *job = job_next(now, &wait);
+
+        if (job != NULL) {
+            job_run(job, now);
+        } else {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+    }
+}
+
+bool housekeeping_start(void)
+{
+    executor_task = xTaskCreateStatic(housekeeping_task, "Housekp", HOUSEKEEPING_TASK_STACK_SIZE, NULL,
+                                      HOUSEKEEPING_TASK_PRIORITY, executor_task_stack, &executor_task_tcb);
+    if (executor_task == NULL) {
+        printf("Housekeeping: Failed to create task\r\n");
+        return false;
+    }
+
+    return true;
+}
+
+housekeeping_job_t *housekeeping_add(const char *name, housekeeping_fn_t fn, void *arg, uint32_t delay_ms)
+{
+    housekeeping_job_t *slot = NULL;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < HOUSEKEEPING_MAX_JOBS; i++) {
+        if (jobs[i].state == JOB_UNUSED) {
+            slot = &jobs[i];
+            break;
+        }
+        if (jobs[i].state == JOB_DONE && slot == NULL) {
+            slot = &jobs[i];
+        }
+    }
+    if (slot != NULL) {
+        *slot = (housekeeping_job_t){ .name = name, .fn = fn, .arg = arg };
+        job_schedule(slot, delay_ms);
+    }
+    taskEXIT_CRITICAL();
+
+    if (slot == NULL) {
+        printf("Housekeeping: No slot for %s, raise HOUSEKEEPING_MAX_JOBS\r\n", name);
+        return NULL;
+    }
+
+    executor_wake();
+    return slot;
+}
+
+void housekeeping_trigger(housekeeping_job_t *job)
+{
+    taskENTER_CRITICAL();
+    if (job->state == JOB_RUNNING) {
+        job->triggered = true;
+    } else if (job->state == JOB_WAITING || job->state == JOB_PARKED) {
+        job_schedule(job, 0);
+    }
+    taskEXIT_CRITICAL();
+
+    executor_wake();
+}
+
+void housekeeping_cancel(housekeeping_job_t *job)
+{
+    taskENTER_CRITICAL();
+    if (job->state == JOB_RUNNING) {
+        job->cancelled = true;
+    } else if (job->state == JOB_WAITING || job->state == JOB_PARKED) {
+        job->state = JOB_DONE;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void housekeeping_print(void)
+{
+    static const char state_names[] = "-WPRD";      /* job_state_t order */
+
+    printf("[HOUSEKEEP] %-10s %2s %8s %10s %10s %8s\r\n", "job", "st", "runs", "mean", "max", "late_ms");
+    for (uint32_t i = 0; i < HOUSEKEEPING_MAX_JOBS; i++) {
+        housekeeping_job_t job;
+
+        taskENTER_CRITICAL();
+        job = jobs[i];
+        taskEXIT_CRITICAL();
+
+        if (job.state == JOB_UNUSED) {
+            continue;
+        }
+        printf("[HOUSEKEEP] %-10s  %c %8lu %10lu %10lu %8lu\r\n", job.name, state_names[job.state],
+               (unsigned long)job.runs, (unsigned long)(job.runs ? job.total_ticks / job.runs : 0),
+               (unsigned long)job.max_ticks, (unsigned long)(job.max_late * portTICK_PERIOD_MS));
+    }
+    if (executor_task != NULL) {
+        printf("[HOUSEKEEP] stack_free %lu words\r\n", (unsigned long)uxTaskGetStackHighWaterMark(executor_task));
+    }
+}
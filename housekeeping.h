@@ -0,0 +1,86 @@
+/**
+ * \file housekeeping.h
+ * \brief Run-to-completion executor for housekeeping jobs
+ *
+ * Link monitoring, the LED, the one-shot network start, the console and
+ * the periodic stats records each used to own a task and a stack while
+ * spending nearly all of their time in vTaskDelay(). They are now timed
+ * callbacks run one after another by a single low priority task.
+ *
+ * A job returns the milliseconds until it wants to run again, so periodic
+ * and adaptive intervals need no extra API; HOUSEKEEPING_DONE ends it and
+ * HOUSEKEEPING_WAIT parks it until housekeeping_trigger(). Jobs share one
+ * stack and must not block for long: a job that waits delays every other.
+ *
+ * Each job's run count, mean and longest run (bsp_timestamp ticks: CPU
+ * cycles on SAME54, microseconds on the host and QEMU builds) and the
+ * longest it started late are printed by housekeeping_print(), console
+ * key 'k'.
+ */
+
+#ifndef HOUSEKEEPING_H
+#define HOUSEKEEPING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Job table size; housekeeping_add() fails beyond this */
+#ifndef HOUSEKEEPING_MAX_JOBS
+#define HOUSEKEEPING_MAX_JOBS       8
+#endif
+
+/* Delays with a special meaning, as returned by a job or given to housekeeping_add() */
+#define HOUSEKEEPING_DONE           0xFFFFFFFFu     /* Remove the job */
+#define HOUSEKEEPING_WAIT           0xFFFFFFFEu     /* Run only when triggered */
+
+typedef struct housekeeping_job housekeeping_job_t;
+
+/**
+ * \brief Job callback
+ * \param arg As given to housekeeping_add()
+ * \return Milliseconds until the next run, HOUSEKEEPING_DONE or HOUSEKEEPING_WAIT
+ */
+typedef uint32_t (*housekeeping_fn_t)(void *arg);
+
+/**
+ * \brief Create the executor task
+ *
+ * Jobs may be added before or after; they run once the scheduler starts.
+ * \return true if the task was created
+ */
+bool housekeeping_start(void);
+
+/**
+ * \brief Schedule a job
+ * \param name Shown by housekeeping_print(), not copied
+ * \param delay_ms Until the first run, or HOUSEKEEPING_WAIT
+ * \return The job, or NULL if the table is full
+ */
+housekeeping_job_t *housekeeping_add(const char *name, housekeeping_fn_t fn, void *arg, uint32_t delay_ms);
+
+/**
+ * \brief Run a job as soon as the executor is free
+ *
+ * Safe from any task; a job that is running now runs once more after it.
+ */
+void housekeeping_trigger(housekeeping_job_t *job);
+
+/**
+ * \brief Remove a job; one that is running now finishes its current run
+ */
+void housekeeping_cancel(housekeeping_job_t *job);
+
+/**
+ * \brief Print runs, mean and longest run time and lateness of every job
+ */
+void housekeeping_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOUSEKEEPING_H */
@@ -0,0 +1,39 @@
+/**
+ * \file cc.h
+ * \brief lwIP compiler/platform abstraction for non-SAME54 builds
+ *
+ * Shared by the Linux host and QEMU builds: little-endian, C library
+ * errno, and platform diagnostics routed through the same printf() the
+ * firmware uses.
+ */
+
+#ifndef LWIP_ARCH_CC_H
+#define LWIP_ARCH_CC_H
+
+#include <stdlib.h>
+/* LWIP_TIMEVAL_PRIVATE is 0 in config/lwipopts.h; struct timeval comes
+ * from the C library, which lwIP does not include itself */
+#include <sys/time.h>
+#include "printf.h"
+
+#define LWIP_ERRNO_STDINCLUDE   1
+
+#ifndef BYTE_ORDER
+#define BYTE_ORDER LITTLE_ENDIAN
+#endif
+
+#define LWIP_RAND() ((u32_t)rand())
+
+#define LWIP_PLATFORM_DIAG(x)                                                  \
+    do {                                                                       \
+        printf x;                                                              \
+    } while (0)
+
+#define LWIP_PLATFORM_ASSERT(x)                                                \
+    do {                                                                       \
+        printf("[LWIP] Assertion \"%s\" failed at line %d in %s\r\n",          \
+               x, __LINE__, __FILE__);                                         \
+        abort();                                                               \
+    } while (0)
+
+#endif /* LWIP_ARCH_CC_H */
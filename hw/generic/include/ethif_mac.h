@@ -0,0 +1,40 @@
+/**
+ * \file ethif_mac.h
+ * \brief lwIP netif glue entry points for non-SAME54 Ethernet BSPs
+ *
+ * Same entry points as the ASF4 lwIP port header used on the SAME54, so
+ * eth_ipstack_main.c builds unchanged against every BSP. Each BSP
+ * implements them for its MAC (GMAC, TAP device, LAN9118, ...).
+ */
+
+#ifndef ETHIF_MAC_H_INCLUDED
+#define ETHIF_MAC_H_INCLUDED
+
+#include "lwip/err.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Finish netif setup once eth_ipstack_main.c has filled in hwaddr/mtu
+ */
+void mac_low_level_init(struct netif *netif);
+
+/**
+ * \brief netif->linkoutput: transmit one frame
+ */
+err_t mac_low_level_output(struct netif *netif, struct pbuf *p);
+
+/**
+ * \brief Drain received frames into netif->input
+ */
+void ethernetif_mac_input(struct netif *netif);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ETHIF_MAC_H_INCLUDED */
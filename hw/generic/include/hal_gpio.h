@@ -0,0 +1,21 @@
+/**
+ * \file hal_gpio.h
+ * \brief ASF4 hal_gpio.h replacement for non-SAME54 targets
+ *
+ * Only the pin encoding is provided so shared code that names pins still
+ * compiles; pin control itself belongs to the BSP LED/PHY drivers.
+ */
+
+#ifndef _HAL_GPIO_INCLUDED
+#define _HAL_GPIO_INCLUDED
+
+#include <stdint.h>
+
+#define GPIO_PORTA 0
+#define GPIO_PORTB 1
+#define GPIO_PORTC 2
+#define GPIO_PORTD 3
+
+#define GPIO(port, pin) ((((port)&0x7u) << 5) + ((pin)&0x1Fu))
+
+#endif /* _HAL_GPIO_INCLUDED */
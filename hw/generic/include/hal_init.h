@@ -0,0 +1,25 @@
+/**
+ * \file hal_init.h
+ * \brief ASF4 hal_init.h replacement for non-SAME54 targets
+ *
+ * Each BSP that builds against hw/generic/include provides init_mcu()
+ * to bring up whatever its platform needs before the scheduler starts.
+ */
+
+#ifndef _HAL_INIT_H_INCLUDED
+#define _HAL_INIT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Initialize the platform (clocks, console, simulated peripherals)
+ */
+void init_mcu(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_INIT_H_INCLUDED */
@@ -0,0 +1,28 @@
+/**
+ * \file hal_mac_async.h
+ * \brief ASF4 hal_mac_async.h replacement for non-SAME54 targets
+ *
+ * main.c defines COMMUNICATION_IO and eth_ipstack_main.c hands it to
+ * lwIP as the netif state, so only the descriptor type is needed here.
+ * What it points at is owned by the BSP Ethernet driver.
+ */
+
+#ifndef HAL_MAC_ASYNC_H_INCLUDED
+#define HAL_MAC_ASYNC_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief MAC descriptor
+ */
+struct mac_async_descriptor {
+    void *dev; /*!< BSP MAC device (TAP, LAN9118, ...) */
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_MAC_ASYNC_H_INCLUDED */
@@ -0,0 +1,21 @@
+/**
+ * \file utils.h
+ * \brief ASF4 utils.h replacement for non-SAME54 targets
+ */
+
+#ifndef UTILS_H_INCLUDED
+#define UTILS_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#ifndef CONTAINER_OF
+#define CONTAINER_OF(ptr, type, field_name) ((type *)(((uint8_t *)(ptr)) - offsetof(type, field_name)))
+#endif
+
+#endif /* UTILS_H_INCLUDED */
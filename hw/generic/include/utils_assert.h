@@ -0,0 +1,30 @@
+/**
+ * \file utils_assert.h
+ * \brief ASF4 utils_assert.h replacement for non-SAME54 targets
+ *
+ * Routes ASSERT() to assert_triggered(), the same hook FreeRTOSConfig.h
+ * declares for configASSERT(), which each BSP implements.
+ */
+
+#ifndef _ASSERT_H_INCLUDED
+#define _ASSERT_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void assert_triggered(const char *file, uint32_t line);
+
+#ifdef DEBUG
+#define ASSERT(condition) ((condition) ? (void)0 : assert_triggered(__FILE__, __LINE__))
+#else
+#define ASSERT(condition) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ASSERT_H_INCLUDED */
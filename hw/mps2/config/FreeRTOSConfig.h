@@ -0,0 +1,30 @@
+/**
+ * \file FreeRTOSConfig.h
+ * \brief FreeRTOS configuration overlay for the QEMU mps2-an386 build
+ *
+ * Found ahead of config/FreeRTOSConfig.h on the include path. The kernel,
+ * port (GCC/ARM_CM4F), heap and task settings are the target's; only the
+ * clock and the interrupt priority encoding differ.
+ */
+
+#ifndef MPS2_FREERTOS_CONFIG_H
+#define MPS2_FREERTOS_CONFIG_H
+
+/* AN386 SYSCLK; SysTick runs from the processor clock */
+#define configCPU_CLOCK_HZ                      ((unsigned long)25000000)
+
+/* Priorities are given as register values so they are valid whether QEMU
+ * implements 3 priority bits (as the AN386 does) or all 8. */
+#define configKERNEL_INTERRUPT_PRIORITY         (7 << 5)
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY    (4 << 5)
+
+/* Idle hook executes WFI so QEMU does not burn host time in the idle loop */
+#define configUSE_IDLE_HOOK                     1
+
+#include_next <FreeRTOSConfig.h>
+
+/* Without configPRIO_BITS the port skips its check of the implemented
+ * priority bits, which differs between QEMU versions */
+#undef configPRIO_BITS
+
+#endif /* MPS2_FREERTOS_CONFIG_H */
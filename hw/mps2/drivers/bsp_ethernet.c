@@ -0,0 +1,524 @@
+/**
+ * \file bsp_ethernet.c
+ * \brief Ethernet driver for QEMU mps2-an386, backed by the LAN9118
+ *
+ * Mirrors hw/same54/drivers/bsp_ethernet.c: same drv_eth_t instance name,
+ * same RX interrupt -> semaphore -> GMAC task path and the same TCP/IP
+ * init-done sequence, so the FreeRTOS/lwIP/DOIP code above it runs as on
+ * the board.
+ */
+
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+#include "lwip/dhcp.h"
+#include "network_events.h"
+#include "boot_time.h"
+#include "housekeeping.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "eth_ipstack_main.h"
+#include "ethif_mac.h"
+
+#include "bsp_ethernet.h"
+#include "lan9118.h"
+#include "mps2_an386.h"
+#include <hal_mac_async.h>
+#include "lwip_macif_config.h"
+#include "printf.h"
+#include "utils_assert.h"
+
+/* GMAC task also drains the FIFO after this many ms without an interrupt */
+#ifndef CONF_MPS2_ETH_RX_POLL_MS
+#define CONF_MPS2_ETH_RX_POLL_MS 10
+#endif
+
+/* PHY basic status register and its link bit */
+#define MII_BMCR            0x00
+#define MII_BMSR            0x01
+#define MII_BMCR_ANENABLE   0x1000
+#define MII_BMCR_ANRESTART  0x0200
+#define MII_BMSR_LSTATUS    0x0004
+
+/* Task constants - same values as the SAME54 BSP */
+#define netifINTERFACE_TASK_STACK_SIZE 512
+#define netifINTERFACE_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+
+/* Link polling: quickly until the link first comes up, then relaxed */
+#define LINK_MONITOR_DOWN_POLL_MS 100
+#define LINK_MONITOR_UP_POLL_MS 500
+
+/* External peripheral descriptors */
+extern struct mac_async_descriptor COMMUNICATION_IO;
+
+typedef struct tag_gmac_device {
+    /** Reference to lwIP netif structure. */
+    struct netif *netif;
+
+    /** RX task notification semaphore. */
+    sys_sem_t rx_sem;
+} gmac_device;
+
+typedef struct
+{
+    struct mac_async_descriptor *mac_desc;
+    lan9118_t lan;
+    drv_eth_callback_t receive_callback;
+    drv_eth_callback_t transmit_callback;
+
+    gmac_device gmac_dev;
+
+    // Link status tracking
+    bool link_up;
+    volatile bool netif_ready;      // Set by eth_tcpip_init_done() once the netif is added
+
+    // Link monitoring job
+    housekeeping_job_t *link_monitor_job;
+} drv_eth_hw_context_t;
+
+static drv_eth_hw_context_t drv_eth_hw_context_communication = {
+    .mac_desc = &COMMUNICATION_IO,
+    .receive_callback = NULL,
+    .transmit_callback = NULL,
+    .gmac_dev = {0},
+    .link_up = false,
+    .netif_ready = false,
+    .link_monitor_job = NULL,
+};
+
+static const uint8_t default_mac[6] = {0x00, 0x00, 0x00, 0x00, 0x20, 0x76};
+
+// Forward declarations of static functions
+static void gmac_handler_cb(void);
+static void gmac_task(void *pvParameters);
+static uint32_t link_monitor_job(void *arg);
+static drv_eth_status_t drv_eth_init(const void *hw_context);
+static drv_eth_status_t drv_eth_deinit(const void *hw_context);
+static drv_eth_status_t drv_eth_enable(const void *hw_context);
+static drv_eth_status_t drv_eth_disable(const void *hw_context);
+static drv_eth_status_t drv_eth_phy_init(const void *hw_context);
+static drv_eth_status_t drv_eth_phy_reset(const void *hw_context);
+static drv_eth_status_t drv_eth_get_link_status(const void *hw_context, bool *link_up);
+static drv_eth_status_t drv_eth_restart_autoneg(const void *hw_context);
+static drv_eth_status_t drv_eth_read_phy_reg(const void *hw_context, uint16_t reg, uint16_t *value);
+static drv_eth_status_t drv_eth_write_phy_reg(const void *hw_context, uint16_t reg, uint16_t value);
+static drv_eth_status_t drv_eth_register_callback(const void *hw_context, drv_eth_cb_type_t type, drv_eth_callback_t callback);
+static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *data, uint32_t length);
+static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats);
+
+// Global Ethernet driver instance
+drv_eth_t eth_communication = {
+    .is_init = false,
+    .is_enabled = false,
+    .hw_context = &drv_eth_hw_context_communication,
+    .init = drv_eth_init,
+    .deinit = drv_eth_deinit,
+    .enable = drv_eth_enable,
+    .disable = drv_eth_disable,
+    .phy_init = drv_eth_phy_init,
+    .phy_reset = drv_eth_phy_reset,
+    .get_link_status = drv_eth_get_link_status,
+    .restart_autoneg = drv_eth_restart_autoneg,
+    .read_phy_reg = drv_eth_read_phy_reg,
+    .write_phy_reg = drv_eth_write_phy_reg,
+    .register_callback = drv_eth_register_callback,
+    .write = drv_eth_write,
+    .get_tcpip_init_done_fn = drv_eth_get_tcpip_init_done_fn_impl,
+    .start_link_monitor = drv_eth_start_link_monitor_impl,
+    .stop_link_monitor = drv_eth_stop_link_monitor_impl,
+    .get_stats = drv_eth_get_stats,
+};
+
+static drv_eth_status_t drv_eth_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    printf("[ETH] Initializing LAN9118\r\n");
+
+    if (!lan9118_init(&context->lan, MPS2_ETHERNET_BASE, default_mac)) {
+        printf("[ETH] LAN9118 not responding (run QEMU with -nic ...)\r\n");
+        return DRV_ETH_STATUS_ERROR;
+    }
+
+    context->mac_desc->dev = &context->lan;
+
+    printf("[ETH] MAC initialized successfully\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_deinit(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    NVIC_DisableIRQ(ETHERNET_IRQn);
+    lan9118_enable(&context->lan, false);
+    context->mac_desc->dev = NULL;
+    printf("[ETH] MAC deinitialized\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_enable(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    lan9118_enable(&context->lan, true);
+    printf("[ETH] MAC enabled\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_disable(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    lan9118_enable(&context->lan, false);
+    printf("[ETH] MAC disabled\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_phy_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (!lan9118_phy_write(&context->lan, MII_BMCR, MII_BMCR_ANENABLE | MII_BMCR_ANRESTART)) {
+        printf("[ETH] PHY initialization failed\r\n");
+        return DRV_ETH_STATUS_ERROR;
+    }
+
+    printf("[ETH] PHY initialized successfully\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_phy_reset(const void *hw_context)
+{
+    return drv_eth_phy_init(hw_context);
+}
+
+static drv_eth_status_t drv_eth_get_link_status(const void *hw_context, bool *link_up)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(link_up != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+    uint16_t bmsr;
+
+    if (!lan9118_phy_read(&context->lan, MII_BMSR, &bmsr)) {
+        return DRV_ETH_STATUS_ERROR;
+    }
+
+    *link_up = (bmsr & MII_BMSR_LSTATUS) != 0;
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_restart_autoneg(const void *hw_context)
+{
+    return drv_eth_phy_init(hw_context);
+}
+
+static drv_eth_status_t drv_eth_read_phy_reg(const void *hw_context, uint16_t reg, uint16_t *value)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(value != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    return lan9118_phy_read(&context->lan, (uint8_t)reg, value) ? DRV_ETH_STATUS_OK : DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_write_phy_reg(const void *hw_context, uint16_t reg, uint16_t value)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    return lan9118_phy_write(&context->lan, (uint8_t)reg, value) ? DRV_ETH_STATUS_OK : DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_register_callback(const void *hw_context, drv_eth_cb_type_t type, drv_eth_callback_t callback)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (type == DRV_ETH_CB_RECEIVE) {
+        context->receive_callback = callback;
+        return DRV_ETH_STATUS_OK;
+    } else if (type == DRV_ETH_CB_TRANSMIT) {
+        context->transmit_callback = callback;
+        return DRV_ETH_STATUS_OK;
+    }
+
+    return DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *data, uint32_t length)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(data != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    return lan9118_tx(&context->lan, data, length) ? DRV_ETH_STATUS_OK : DRV_ETH_STATUS_BUSY;
+}
+
+/**
+ * \brief LAN9118 interrupt (IRQ 13 on the AN386)
+ */
+void ETHERNET_IRQHandler(void)
+{
+    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
+
+    lan9118_ack_irq(&context->lan);
+    if (context->receive_callback != NULL) {
+        context->receive_callback();
+    }
+}
+
+/**
+ * \brief Callback for the LAN9118 interrupt.
+ * Give semaphore for which gmac_task waits
+ */
+static void gmac_handler_cb(void)
+{
+    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
+    BaseType_t xGMACTaskWoken = pdFALSE;
+
+    xSemaphoreGiveFromISR(context->gmac_dev.rx_sem.sem, &xGMACTaskWoken);
+    portYIELD_FROM_ISR(xGMACTaskWoken);
+}
+
+/**
+ * \brief Task for GMAC.
+ * Waits for the RX interrupt and drains the RX FIFO into lwIP
+ */
+static void gmac_task(void *pvParameters)
+{
+    gmac_device *ps_gmac_dev = pvParameters;
+
+    while (1) {
+        /* Interrupt driven; the timeout only guards against a lost edge */
+        sys_arch_sem_wait(&ps_gmac_dev->rx_sem, CONF_MPS2_ETH_RX_POLL_MS);
+
+        ethernetif_mac_input(ps_gmac_dev->netif);
+    }
+}
+
+/* Pass a link change to lwIP from outside the tcpip thread */
+static void link_apply(drv_eth_hw_context_t *context, bool link_up)
+{
+    LOCK_TCPIP_CORE();
+    if (link_up) {
+        netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
+    } else {
+        netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
+    }
+    UNLOCK_TCPIP_CORE();
+
+    context->link_up = link_up;
+    if (link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+}
+
+/**
+ * \brief Link monitoring job
+ * Periodically checks the LAN9118 PHY link and notifies lwIP of changes;
+ * start-up does not wait for the link, this job applies it when it comes
+ */
+static uint32_t link_monitor_job(void *arg)
+{
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)arg;
+    bool current_link_state = false;
+
+    /* Parked until eth_tcpip_init_done() adds the interface; from then on
+     * context->link_up is the state last applied to lwIP */
+    if (!context->netif_ready) {
+        return HOUSEKEEPING_WAIT;
+    }
+
+    if (hw_eth_get_link_status(&eth_communication, &current_link_state) == DRV_ETH_STATUS_OK &&
+        current_link_state != context->link_up) {
+        printf("[LINK_MONITOR] Link state change detected: %s -> %s\r\n",
+               context->link_up ? "UP" : "DOWN",
+               current_link_state ? "UP" : "DOWN");
+
+        link_apply(context, current_link_state);
+    }
+
+    return context->link_up ? LINK_MONITOR_UP_POLL_MS : LINK_MONITOR_DOWN_POLL_MS;
+}
+
+/* TCP/IP stack initialization done callback - same sequence as the SAME54 BSP,
+ * which does not wait for the link on the tcpip thread */
+static void eth_tcpip_init_done(void *arg)
+{
+    sys_sem_t *sem;
+    sem = (sys_sem_t *)arg;
+    u8_t mac[6] = {0x00, 0x00, 0x00, 0x00, 0x20, 0x76};
+    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
+
+    /* Initialize network event logging */
+    network_events_init();
+    log_lwip_init(ERR_OK);
+
+    hw_eth_register_callback(&eth_communication, DRV_ETH_CB_RECEIVE, gmac_handler_cb);
+
+    drv_eth_status_t phy_init_status = hw_eth_phy_init(&eth_communication);
+    if (phy_init_status != DRV_ETH_STATUS_OK) {
+        printf("[INIT] PHY initialization failed: %d\r\n", phy_init_status);
+    }
+
+    if (hw_eth_get_link_status(&eth_communication, &context->link_up) != DRV_ETH_STATUS_OK) {
+        context->link_up = false;
+    }
+    printf("[INIT] PHY link %s, not waiting for it\r\n", context->link_up ? "up" : "down");
+
+    printf("[INIT] Initializing network interface...\r\n");
+    TCPIP_STACK_INTERFACE_0_init(mac);
+
+    TCPIP_STACK_INTERFACE_0_desc.input = tcpip_input;
+
+    context->gmac_dev.netif = &TCPIP_STACK_INTERFACE_0_desc;
+
+    /* Incoming packet notification semaphore. */
+    if (sys_sem_new(&context->gmac_dev.rx_sem, 0) != ERR_OK) {
+        LWIP_ASSERT("Failed to create semaphore", 0);
+    }
+
+    sys_thread_t id = sys_thread_new("GMAC", gmac_task, &context->gmac_dev, netifINTERFACE_TASK_STACK_SIZE, netifINTERFACE_TASK_PRIORITY);
+    LWIP_ASSERT("ethernetif_init: GMAC Task allocation ERROR!\n", (id != 0));
+    (void)id;
+
+    /* Enable the RX interrupt only once the semaphore exists. */
+    /* Same priority as the SAME54 GMAC IRQ, below configMAX_SYSCALL_INTERRUPT_PRIORITY. */
+    lan9118_enable_rx_irq(&context->lan);
+    NVIC_SetPriority(ETHERNET_IRQn, 5);
+    NVIC_EnableIRQ(ETHERNET_IRQn);
+    hw_eth_enable(&eth_communication);
+
+    printf("[INIT] Setting up network interface callbacks...\r\n");
+    netif_set_default(&TCPIP_STACK_INTERFACE_0_desc);
+
+    /* Register network event callbacks */
+    netif_set_status_callback(&TCPIP_STACK_INTERFACE_0_desc, netif_status_callback);
+    netif_set_link_callback(&TCPIP_STACK_INTERFACE_0_desc, netif_link_callback);
+
+    log_mac_address(&TCPIP_STACK_INTERFACE_0_desc);
+    log_link_status_change(&TCPIP_STACK_INTERFACE_0_desc, context->link_up);
+
+    if (context->link_up) {
+        netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
+    } else {
+        netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
+    }
+
+#if CONF_TCPIP_STACK_INTERFACE_0_DHCP
+    printf("[INIT] Starting DHCP client...\r\n");
+    if (ERR_OK != dhcp_start(&TCPIP_STACK_INTERFACE_0_desc)) {
+        log_dhcp_error(&TCPIP_STACK_INTERFACE_0_desc, "Failed to start DHCP client");
+        LWIP_ASSERT("ERR_OK != dhcp_start", 0);
+    }
+#else
+    printf("[INIT] Using static IP configuration...\r\n");
+    netif_set_up(&TCPIP_STACK_INTERFACE_0_desc);
+    log_network_config(&TCPIP_STACK_INTERFACE_0_desc);
+#endif
+
+    boot_time_mark(BOOT_MARK_NETIF);
+    if (context->link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+
+    /* Hand link tracking to the monitor job */
+    context->netif_ready = true;
+    if (context->link_monitor_job != NULL) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
+
+    printf("[INIT] Network initialization complete\r\n");
+    sys_sem_signal(sem); /* Signal the waiting thread that the TCP/IP init is done. */
+}
+
+static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void *hw_context)
+{
+    return eth_tcpip_init_done;
+}
+
+/**
+ * \brief Start link monitoring job
+ */
+static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (context->link_monitor_job != NULL) {
+        printf("[ETH] Link monitor already running\r\n");
+        return DRV_ETH_STATUS_OK;
+    }
+
+    /* Runs once the interface is up; eth_tcpip_init_done() triggers it */
+    context->link_monitor_job = housekeeping_add("LinkMon", link_monitor_job, context, HOUSEKEEPING_WAIT);
+    if (context->link_monitor_job == NULL) {
+        printf("[ETH] Failed to schedule link monitor\r\n");
+        return DRV_ETH_STATUS_ERROR;
+    }
+    if (context->netif_ready) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
+
+    printf("[ETH] Link monitor started\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+/**
+ * \brief Stop link monitoring job
+ */
+static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (context->link_monitor_job != NULL) {
+        housekeeping_cancel(context->link_monitor_job);
+        context->link_monitor_job = NULL;
+        printf("[ETH] Link monitor stopped\r\n");
+    }
+
+    return DRV_ETH_STATUS_OK;
+}
+
+/**
+ * \brief Copy the controller frame counters
+ */
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(stats != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    taskENTER_CRITICAL();
+    lan9118_update_stats(&context->lan);
+    stats->rx_frames = context->lan.rx_frames;
+    stats->rx_bytes = context->lan.rx_bytes;
+    stats->rx_errors = context->lan.rx_errors;
+    stats->rx_dropped = context->lan.rx_dropped;
+    stats->tx_frames = context->lan.tx_frames;
+    stats->tx_bytes = context->lan.tx_bytes;
+    stats->tx_errors = context->lan.tx_errors;
+    stats->rx_wakeups = 0;
+    stats->rx_wakeup_frames = 0;
+    stats->rx_wakeup_max = 0;
+    stats->rx_budget_hits = 0;
+    stats->rx_filtered = 0;
+    stats->rx_priority = 0;
+    stats->rx_shed = 0;
+    stats->rx_ring_peak = 0;
+    stats->rx_ring_full = 0;
+    stats->rx_overruns = 0;
+    taskEXIT_CRITICAL();
+
+    return DRV_ETH_STATUS_OK;
+}
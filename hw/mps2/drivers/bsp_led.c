@@ -0,0 +1,80 @@
+/**
+ * \file bsp_led.c
+ * \brief LED driver for QEMU mps2-an386, on the FPGA IO user LEDs
+ *
+ * led_yellow is user LED 0 (FPGAIO LED0 register, bit 0). QEMU keeps the
+ * register state and traces changes with -trace mps2_fpgaio_write.
+ */
+
+#include "bsp_led.h"
+#include "mps2_an386.h"
+#include "utils_assert.h"
+#include <stddef.h>
+
+/* FPGAIO LED0 register: one bit per user LED */
+#define MPS2_FPGAIO_LED0    (*(volatile uint32_t *)(MPS2_FPGAIO_BASE + 0x000))
+
+typedef struct
+{
+    uint32_t mask;
+} drv_led_hw_context_t;
+
+static drv_led_hw_context_t drv_led_hw_context_yellow = {
+    .mask = 1u << 0,
+};
+
+static drv_led_status_t drv_led_init(const void *hw_context);
+static drv_led_status_t drv_led_deinit(const void *hw_context);
+static drv_led_status_t drv_led_on(const void *hw_context);
+static drv_led_status_t drv_led_off(const void *hw_context);
+static drv_led_status_t drv_led_toggle(const void *hw_context);
+
+drv_led_t led_yellow = {
+    .is_init = false,
+    .hw_context = &drv_led_hw_context_yellow,
+    .init = drv_led_init,
+    .deinit = drv_led_deinit,
+    .on = drv_led_on,
+    .off = drv_led_off,
+    .toggle = drv_led_toggle,
+};
+
+static drv_led_status_t drv_led_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    MPS2_FPGAIO_LED0 &= ~context->mask;
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_deinit(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    MPS2_FPGAIO_LED0 &= ~context->mask;
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_on(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    MPS2_FPGAIO_LED0 |= context->mask;
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_off(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    MPS2_FPGAIO_LED0 &= ~context->mask;
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_toggle(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    MPS2_FPGAIO_LED0 ^= context->mask;
+    return DRV_LED_STATUS_OK;
+}
@@ -0,0 +1,44 @@
+/**
+ * \file bsp_timestamp.c
+ * \brief Timestamp counter for QEMU mps2-an386, in microseconds
+ *
+ * QEMU does not implement the DWT cycle counter, so the timestamp is
+ * built from the FreeRTOS tick count and the SysTick down-counter.
+ * Only valid once the scheduler is running.
+ */
+
+#include "bsp_timestamp.h"
+#include "mps2_an386.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TIMESTAMP_TICKS_PER_US (configCPU_CLOCK_HZ / 1000000u)
+
+void bsp_timestamp_init(void)
+{
+}
+
+uint32_t bsp_timestamp_now(void)
+{
+    TickType_t tick;
+    uint32_t val;
+
+    /* Re-read if a tick interrupt was taken between the two reads */
+    do {
+        tick = xTaskGetTickCount();
+        val = SysTick->VAL;
+    } while (tick != xTaskGetTickCount());
+
+    uint32_t sub_us = (SysTick->LOAD - val) / TIMESTAMP_TICKS_PER_US;
+    return (uint32_t)tick * (1000000u / configTICK_RATE_HZ) + sub_us;
+}
+
+uint32_t bsp_timestamp_to_us(uint32_t ticks)
+{
+    return ticks;
+}
+
+uint32_t bsp_timestamp_elapsed_us(uint32_t start)
+{
+    return bsp_timestamp_now() - start;
+}
@@ -0,0 +1,72 @@
+/**
+ * \file ethif_lan9118.c
+ * \brief lwIP netif glue for the MPS2 LAN9118
+ *
+ * netif->state is COMMUNICATION_IO, whose dev field the BSP Ethernet
+ * driver points at its lan9118_t when the controller is initialized.
+ */
+
+#include "ethif_mac.h"
+#include "lan9118.h"
+#include <hal_mac_async.h>
+#include "lwip/etharp.h"
+#include "lwip/stats.h"
+#include "printf.h"
+
+static uint32_t lan_rx_frame[LAN9118_MAX_FRAME / sizeof(uint32_t)];
+static uint8_t lan_tx_frame[LAN9118_MAX_FRAME];
+
+static lan9118_t *netif_lan(struct netif *netif)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+    return (lan9118_t *)desc->dev;
+}
+
+void mac_low_level_init(struct netif *netif)
+{
+    netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+}
+
+err_t mac_low_level_output(struct netif *netif, struct pbuf *p)
+{
+    lan9118_t *lan = netif_lan(netif);
+
+    if (lan == NULL || p->tot_len - ETH_PAD_SIZE > sizeof(lan_tx_frame)) {
+        return ERR_IF;
+    }
+
+    /* Drop the padding word; the FIFO takes a bare Ethernet frame */
+    u16_t len = pbuf_copy_partial(p, lan_tx_frame, p->tot_len - ETH_PAD_SIZE, ETH_PAD_SIZE);
+
+    return lan9118_tx(lan, lan_tx_frame, len) ? ERR_OK : ERR_IF;
+}
+
+void ethernetif_mac_input(struct netif *netif)
+{
+    lan9118_t *lan = netif_lan(netif);
+    int len;
+
+    if (lan == NULL) {
+        return;
+    }
+
+    while ((len = lan9118_rx_read(lan, lan_rx_frame)) != 0) {
+        if (len < 0) {
+            continue;
+        }
+
+        struct pbuf *p = pbuf_alloc(PBUF_RAW, (u16_t)(len + ETH_PAD_SIZE), PBUF_POOL);
+        if (p == NULL) {
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            printf("[LAN9118] RX frame dropped, pbuf pool empty\r\n");
+            continue;
+        }
+
+        pbuf_take_at(p, lan_rx_frame, (u16_t)len, ETH_PAD_SIZE);
+
+        if (netif->input(p, netif) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
@@ -0,0 +1,312 @@
+/**
+ * \file lan9118.c
+ * \brief SMSC LAN9118 Ethernet controller (MPS2 on-board MAC/PHY)
+ */
+
+#include "lan9118.h"
+#include <string.h>
+
+/* System control and status registers (byte offsets from base) */
+#define LAN9118_RX_DATA_FIFO        0x00
+#define LAN9118_TX_DATA_FIFO        0x20
+#define LAN9118_RX_STATUS_FIFO      0x40
+#define LAN9118_RX_STATUS_PEEK      0x44
+#define LAN9118_TX_STATUS_FIFO      0x48
+#define LAN9118_IRQ_CFG             0x54
+#define LAN9118_INT_STS             0x58
+#define LAN9118_INT_EN              0x5C
+#define LAN9118_BYTE_TEST           0x64
+#define LAN9118_FIFO_INT            0x68
+#define LAN9118_TX_CFG              0x70
+#define LAN9118_HW_CFG              0x74
+#define LAN9118_RX_FIFO_INF         0x7C
+#define LAN9118_TX_FIFO_INF         0x80
+#define LAN9118_PMT_CTRL            0x84
+#define LAN9118_RX_DROP             0xA0
+#define LAN9118_MAC_CSR_CMD         0xA4
+#define LAN9118_MAC_CSR_DATA        0xA8
+
+/* MAC CSRs (indirect through MAC_CSR_CMD/DATA) */
+#define LAN9118_MAC_CR              1
+#define LAN9118_MAC_ADDRH           2
+#define LAN9118_MAC_ADDRL           3
+#define LAN9118_MAC_MII_ACC         6
+#define LAN9118_MAC_MII_DATA        7
+
+#define LAN9118_BYTE_TEST_VALUE     0x87654321u
+#define LAN9118_HW_CFG_SRST         (1u << 0)
+#define LAN9118_PMT_CTRL_READY      (1u << 0)
+#define LAN9118_IRQ_CFG_TYPE_PP     (1u << 0)
+#define LAN9118_IRQ_CFG_POL_HIGH    (1u << 4)
+#define LAN9118_IRQ_CFG_EN          (1u << 8)
+#define LAN9118_INT_RSFL            (1u << 3)
+#define LAN9118_TX_CFG_ON           (1u << 1)
+#define LAN9118_TX_CFG_SAO          (1u << 2)
+#define LAN9118_MAC_CR_RXEN         (1u << 2)
+#define LAN9118_MAC_CR_TXEN         (1u << 3)
+#define LAN9118_MAC_CR_FDPX         (1u << 20)
+#define LAN9118_CSR_BUSY            (1u << 31)
+#define LAN9118_CSR_READ            (1u << 30)
+#define LAN9118_MII_BUSY            (1u << 0)
+#define LAN9118_MII_WRITE           (1u << 1)
+#define LAN9118_PHY_ADDR            1u
+#define LAN9118_RX_STS_ERROR        (1u << 15)
+#define LAN9118_TX_STS_ERROR        (1u << 15)
+#define LAN9118_TX_CMD_A_FIRST      (1u << 13)
+#define LAN9118_TX_CMD_A_LAST       (1u << 12)
+#define LAN9118_FCS_LEN             4
+
+/* Bounded busy-waits; the controller answers within a few register reads */
+#define LAN9118_POLL_LIMIT          100000
+
+static inline uint32_t reg_read(const lan9118_t *dev, uint32_t offset)
+{
+    return *(volatile uint32_t *)(dev->base + offset);
+}
+
+static inline void reg_write(const lan9118_t *dev, uint32_t offset, uint32_t value)
+{
+    *(volatile uint32_t *)(dev->base + offset) = value;
+}
+
+static bool wait_clear(const lan9118_t *dev, uint32_t offset, uint32_t mask)
+{
+    for (uint32_t i = 0; i < LAN9118_POLL_LIMIT; i++) {
+        if ((reg_read(dev, offset) & mask) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool mac_csr_read(const lan9118_t *dev, uint8_t index, uint32_t *value)
+{
+    if (!wait_clear(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY)) {
+        return false;
+    }
+    reg_write(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY | LAN9118_CSR_READ | index);
+    if (!wait_clear(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY)) {
+        return false;
+    }
+    *value = reg_read(dev, LAN9118_MAC_CSR_DATA);
+    return true;
+}
+
+static bool mac_csr_write(const lan9118_t *dev, uint8_t index, uint32_t value)
+{
+    if (!wait_clear(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY)) {
+        return false;
+    }
+    reg_write(dev, LAN9118_MAC_CSR_DATA, value);
+    reg_write(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY | index);
+    return wait_clear(dev, LAN9118_MAC_CSR_CMD, LAN9118_CSR_BUSY);
+}
+
+static bool mii_wait_idle(const lan9118_t *dev)
+{
+    uint32_t acc;
+
+    for (uint32_t i = 0; i < LAN9118_POLL_LIMIT; i++) {
+        if (!mac_csr_read(dev, LAN9118_MAC_MII_ACC, &acc)) {
+            return false;
+        }
+        if ((acc & LAN9118_MII_BUSY) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void rx_discard(lan9118_t *dev, uint32_t length)
+{
+    for (uint32_t words = (length + 3) / 4; words > 0; words--) {
+        (void)reg_read(dev, LAN9118_RX_DATA_FIFO);
+    }
+    dev->rx_errors++;
+}
+
+static void tx_drain_status(lan9118_t *dev)
+{
+    uint32_t used = (reg_read(dev, LAN9118_TX_FIFO_INF) >> 16) & 0xFF;
+
+    while (used-- > 0) {
+        if (reg_read(dev, LAN9118_TX_STATUS_FIFO) & LAN9118_TX_STS_ERROR) {
+            dev->tx_errors++;
+        }
+    }
+}
+
+bool lan9118_init(lan9118_t *dev, uintptr_t base, const uint8_t mac[6])
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->base = base;
+
+    if (reg_read(dev, LAN9118_BYTE_TEST) != LAN9118_BYTE_TEST_VALUE) {
+        return false;
+    }
+
+    reg_write(dev, LAN9118_HW_CFG, LAN9118_HW_CFG_SRST);
+    if (!wait_clear(dev, LAN9118_HW_CFG, LAN9118_HW_CFG_SRST)) {
+        return false;
+    }
+    for (uint32_t i = 0; (reg_read(dev, LAN9118_PMT_CTRL) & LAN9118_PMT_CTRL_READY) == 0; i++) {
+        if (i >= LAN9118_POLL_LIMIT) {
+            return false;
+        }
+    }
+
+    reg_write(dev, LAN9118_IRQ_CFG, 0);
+    reg_write(dev, LAN9118_INT_EN, 0);
+    reg_write(dev, LAN9118_INT_STS, 0xFFFFFFFFu);
+
+    mac_csr_write(dev, LAN9118_MAC_ADDRL,
+                  (uint32_t)mac[0] | ((uint32_t)mac[1] << 8) |
+                  ((uint32_t)mac[2] << 16) | ((uint32_t)mac[3] << 24));
+    mac_csr_write(dev, LAN9118_MAC_ADDRH, (uint32_t)mac[4] | ((uint32_t)mac[5] << 8));
+
+    /* Interrupt as soon as one RX status entry is queued */
+    reg_write(dev, LAN9118_FIFO_INT, 0);
+
+    /* TX status overrun allowed: errors are counted, not required reading */
+    reg_write(dev, LAN9118_TX_CFG, LAN9118_TX_CFG_ON | LAN9118_TX_CFG_SAO);
+
+    return true;
+}
+
+void lan9118_enable(lan9118_t *dev, bool enable)
+{
+    uint32_t mac_cr = 0;
+
+    mac_csr_read(dev, LAN9118_MAC_CR, &mac_cr);
+    if (enable) {
+        mac_cr |= LAN9118_MAC_CR_RXEN | LAN9118_MAC_CR_TXEN | LAN9118_MAC_CR_FDPX;
+    } else {
+        mac_cr &= ~(LAN9118_MAC_CR_RXEN | LAN9118_MAC_CR_TXEN);
+    }
+    mac_csr_write(dev, LAN9118_MAC_CR, mac_cr);
+}
+
+void lan9118_enable_rx_irq(lan9118_t *dev)
+{
+    reg_write(dev, LAN9118_INT_STS, LAN9118_INT_RSFL);
+    reg_write(dev, LAN9118_INT_EN, LAN9118_INT_RSFL);
+    reg_write(dev, LAN9118_IRQ_CFG, LAN9118_IRQ_CFG_EN | LAN9118_IRQ_CFG_POL_HIGH | LAN9118_IRQ_CFG_TYPE_PP);
+}
+
+void lan9118_ack_irq(lan9118_t *dev)
+{
+    reg_write(dev, LAN9118_INT_STS, reg_read(dev, LAN9118_INT_STS) & reg_read(dev, LAN9118_INT_EN));
+}
+
+int lan9118_rx_peek(lan9118_t *dev)
+{
+    if (((reg_read(dev, LAN9118_RX_FIFO_INF) >> 16) & 0xFF) == 0) {
+        return 0;
+    }
+
+    uint32_t status = reg_read(dev, LAN9118_RX_STATUS_PEEK);
+    uint32_t length = (status >> 16) & 0x3FFF;
+
+    if ((status & LAN9118_RX_STS_ERROR) || length <= LAN9118_FCS_LEN || length > LAN9118_MAX_FRAME) {
+        (void)reg_read(dev, LAN9118_RX_STATUS_FIFO);
+        rx_discard(dev, length);
+        return -1;
+    }
+
+    return (int)(length - LAN9118_FCS_LEN);
+}
+
+int lan9118_rx_read(lan9118_t *dev, uint32_t *frame)
+{
+    int length = lan9118_rx_peek(dev);
+    if (length <= 0) {
+        return length;
+    }
+
+    uint32_t status = reg_read(dev, LAN9118_RX_STATUS_FIFO);
+    uint32_t words = ((((status >> 16) & 0x3FFF)) + 3) / 4;
+
+    for (uint32_t i = 0; i < words; i++) {
+        frame[i] = reg_read(dev, LAN9118_RX_DATA_FIFO);
+    }
+
+    dev->rx_frames++;
+    dev->rx_bytes += (uint32_t)length;
+    return length;
+}
+
+bool lan9118_tx(lan9118_t *dev, const uint8_t *frame, uint32_t length)
+{
+    tx_drain_status(dev);
+
+    /* Two command words plus the data, rounded up to whole words */
+    uint32_t needed = 8 + ((length + 3) & ~3u);
+    if ((reg_read(dev, LAN9118_TX_FIFO_INF) & 0xFFFF) < needed) {
+        dev->tx_errors++;
+        return false;
+    }
+
+    reg_write(dev, LAN9118_TX_DATA_FIFO, LAN9118_TX_CMD_A_FIRST | LAN9118_TX_CMD_A_LAST | length);
+    reg_write(dev, LAN9118_TX_DATA_FIFO, (length << 16) | length);
+
+    uint32_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        uint32_t word;
+        memcpy(&word, &frame[i], sizeof(word));
+        reg_write(dev, LAN9118_TX_DATA_FIFO, word);
+    }
+    if (i < length) {
+        uint32_t word = 0;
+        memcpy(&word, &frame[i], length - i);
+        reg_write(dev, LAN9118_TX_DATA_FIFO, word);
+    }
+
+    dev->tx_frames++;
+    dev->tx_bytes += length;
+    return true;
+}
+
+void lan9118_update_stats(lan9118_t *dev)
+{
+    dev->rx_dropped += reg_read(dev, LAN9118_RX_DROP);
+}
+
+bool lan9118_phy_read(lan9118_t *dev, uint8_t reg, uint16_t *value)
+{
+    uint32_t data;
+
+    if (!mii_wait_idle(dev)) {
+        return false;
+    }
+
+    if (!mac_csr_write(dev, LAN9118_MAC_MII_ACC, (LAN9118_PHY_ADDR << 11) | ((uint32_t)(reg & 0x1F) << 6) | LAN9118_MII_BUSY)) {
+        return false;
+    }
+
+    if (!mii_wait_idle(dev)) {
+        return false;
+    }
+
+    if (!mac_csr_read(dev, LAN9118_MAC_MII_DATA, &data)) {
+        return false;
+    }
+    *value = (uint16_t)data;
+    return true;
+}
+
+bool lan9118_phy_write(lan9118_t *dev, uint8_t reg, uint16_t value)
+{
+    if (!mii_wait_idle(dev)) {
+        return false;
+    }
+
+    if (!mac_csr_write(dev, LAN9118_MAC_MII_DATA, value)) {
+        return false;
+    }
+    if (!mac_csr_write(dev, LAN9118_MAC_MII_ACC, (LAN9118_PHY_ADDR << 11) | ((uint32_t)(reg & 0x1F) << 6) |
+                       LAN9118_MII_WRITE | LAN9118_MII_BUSY)) {
+        return false;
+    }
+
+    return mii_wait_idle(dev);
+}
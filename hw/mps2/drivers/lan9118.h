@@ -0,0 +1,94 @@
+/**
+ * \file lan9118.h
+ * \brief SMSC LAN9118 Ethernet controller (MPS2 on-board MAC/PHY)
+ *
+ * Register-level access only, no RTOS or lwIP dependencies. Frames move
+ * through the controller's PIO FIFOs one 32-bit word at a time.
+ */
+
+#ifndef _LAN9118_H_
+#define _LAN9118_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LAN9118_MAX_FRAME   1536
+
+typedef struct
+{
+    uintptr_t base;
+    uint32_t rx_frames;
+    uint64_t rx_bytes;
+    uint32_t rx_errors;
+    uint32_t rx_dropped;
+    uint32_t tx_frames;
+    uint64_t tx_bytes;
+    uint32_t tx_errors;
+} lan9118_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * \brief Soft-reset the controller and program the MAC address
+ * \return false if the controller does not respond
+ */
+bool lan9118_init(lan9118_t *dev, uintptr_t base, const uint8_t mac[6]);
+
+/**
+ * \brief Enable or disable the MAC transmitter and receiver
+ */
+void lan9118_enable(lan9118_t *dev, bool enable);
+
+/**
+ * \brief Enable the RX status FIFO level interrupt on the IRQ pin
+ */
+void lan9118_enable_rx_irq(lan9118_t *dev);
+
+/**
+ * \brief Acknowledge pending interrupts, called from the IRQ handler
+ */
+void lan9118_ack_irq(lan9118_t *dev);
+
+/**
+ * \brief Length of the next received frame without FCS
+ * \return 0 if no frame is pending, -1 if the frame had a receive error
+ *         (it has already been discarded)
+ */
+int lan9118_rx_peek(lan9118_t *dev);
+
+/**
+ * \brief Copy the pending frame out of the RX FIFO
+ * \param[out] frame Word-aligned destination, at least LAN9118_MAX_FRAME bytes
+ * \return Frame length without FCS, 0 if none was pending
+ */
+int lan9118_rx_read(lan9118_t *dev, uint32_t *frame);
+
+/**
+ * \brief Queue one frame for transmission
+ * \return false if the TX FIFO has no room for the frame
+ */
+bool lan9118_tx(lan9118_t *dev, const uint8_t *frame, uint32_t length);
+
+/**
+ * \brief Add the controller's clear-on-read RX drop counter to rx_dropped
+ */
+void lan9118_update_stats(lan9118_t *dev);
+
+/**
+ * \brief Read a register of the internal PHY
+ */
+bool lan9118_phy_read(lan9118_t *dev, uint8_t reg, uint16_t *value);
+
+/**
+ * \brief Write a register of the internal PHY
+ */
+bool lan9118_phy_write(lan9118_t *dev, uint8_t reg, uint16_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LAN9118_H_
@@ -0,0 +1,120 @@
+/**
+ * \file mps2_platform.c
+ * \brief Platform hooks for the QEMU mps2-an386 build
+ *
+ * Stands in for the ASF4 init code and the SEGGER RTT console
+ * (rtt_printf.c): printf() goes to CMSDK UART0, which QEMU connects to
+ * stdio with -nographic.
+ *
+ * Asserts end the QEMU process through semihosting so plugin reports are
+ * written. This includes the deliberate assert in the ARM_CM4F port's
+ * vPortEndScheduler(), reached when DOIP_CLIENT_MAX_CYCLES completes.
+ * QEMU must run with -semihosting-config enable=on (Makefile.qemu does).
+ */
+
+#include <hal_init.h>
+#include "mps2_an386.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include "rtt_printf.h"
+
+/* CMSDK APB UART registers */
+typedef struct {
+    volatile uint32_t DATA;
+    volatile uint32_t STATE;
+    volatile uint32_t CTRL;
+    volatile uint32_t INTSTATUS;
+    volatile uint32_t BAUDDIV;
+} cmsdk_uart_t;
+
+#define MPS2_UART0          ((cmsdk_uart_t *)MPS2_UART0_BASE)
+#define UART_STATE_TXFULL   (1u << 0)
+#define UART_STATE_RXFULL   (1u << 1)
+#define UART_CTRL_TXEN      (1u << 0)
+#define UART_CTRL_RXEN      (1u << 1)
+
+/* Semihosting SYS_EXIT and its "runtime error" reason code */
+#define SEMIHOSTING_SYS_EXIT            0x18
+#define ADP_STOPPED_RUNTIME_ERROR       0x20023
+
+/* QEMU ignores the divider, but it must be at least 16 to be accepted */
+#define UART_BAUDDIV        (MPS2_SYSCLK_HZ / 115200)
+
+void init_mcu(void)
+{
+    MPS2_UART0->BAUDDIV = UART_BAUDDIV;
+    MPS2_UART0->CTRL = UART_CTRL_TXEN | UART_CTRL_RXEN;
+}
+
+static void semihosting_exit(uint32_t reason)
+{
+    register uint32_t r0 __asm__("r0") = SEMIHOSTING_SYS_EXIT;
+    register uint32_t r1 __asm__("r1") = reason;
+    __asm__ volatile("bkpt 0xAB" : : "r"(r0), "r"(r1) : "memory");
+}
+
+void assert_triggered(const char *file, uint32_t line)
+{
+    __disable_irq();
+    printf("[ASSERT] %s:%lu\r\n", file, (unsigned long)line);
+    semihosting_exit(ADP_STOPPED_RUNTIME_ERROR);
+    for (;;) {
+    }
+}
+
+/**
+ * \brief Console initialization, replaces the RTT setup in rtt_printf.c
+ */
+void rtt_printf_init(void)
+{
+}
+
+/**
+ * \brief printf() character output to UART0
+ */
+void _putchar(char character)
+{
+    while (MPS2_UART0->STATE & UART_STATE_TXFULL) {
+    }
+    MPS2_UART0->DATA = (uint32_t)(uint8_t)character;
+}
+
+/**
+ * \brief Channel selection; the console is a single stream on this platform
+ */
+rtt_printf_channel_t rtt_printf_select(rtt_printf_channel_t channel)
+{
+    (void)channel;
+    return RTT_PRINTF_CH_LOG;
+}
+
+void rtt_printf_flush(void)
+{
+}
+
+uint32_t rtt_printf_dropped(rtt_printf_channel_t channel)
+{
+    (void)channel;
+    return 0;
+}
+
+/**
+ * \brief Console input from UART0, non-blocking
+ * \return Character, or -1 if none is pending
+ */
+int rtt_printf_getchar(void)
+{
+    if (!(MPS2_UART0->STATE & UART_STATE_RXFULL)) {
+        return -1;
+    }
+    return (int)(MPS2_UART0->DATA & 0xFFu);
+}
+
+/**
+ * \brief Idle hook - WFI so an idle guest does not spin a host core
+ */
+void vApplicationIdleHook(void)
+{
+    __WFI();
+}
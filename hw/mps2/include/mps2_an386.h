@@ -0,0 +1,60 @@
+/**
+ * \file mps2_an386.h
+ * \brief Device definitions for the MPS2 AN386 (Cortex-M4) as emulated by QEMU
+ *
+ * Only what the QEMU BSP uses: interrupt numbers, peripheral base
+ * addresses and the CMSIS core configuration.
+ */
+
+#ifndef MPS2_AN386_H
+#define MPS2_AN386_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum IRQn {
+    /* Cortex-M4 processor exceptions */
+    NonMaskableInt_IRQn   = -14,
+    HardFault_IRQn        = -13,
+    MemoryManagement_IRQn = -12,
+    BusFault_IRQn         = -11,
+    UsageFault_IRQn       = -10,
+    SVCall_IRQn           = -5,
+    DebugMonitor_IRQn     = -4,
+    PendSV_IRQn           = -2,
+    SysTick_IRQn          = -1,
+
+    /* MPS2 peripheral interrupts */
+    UARTRX0_IRQn          = 0,
+    UARTTX0_IRQn          = 1,
+    TIMER0_IRQn           = 8,
+    TIMER1_IRQn           = 9,
+    UARTOVF_IRQn          = 12,
+    ETHERNET_IRQn         = 13,
+
+    PERIPH_COUNT_IRQn     = 32
+} IRQn_Type;
+
+/* CMSIS core configuration */
+#define __CM4_REV              0x0001
+#define __MPU_PRESENT          1
+#define __NVIC_PRIO_BITS       3
+#define __Vendor_SysTickConfig 0
+#define __FPU_PRESENT          1
+
+#include <core_cm4.h>
+
+/* System clock driving the core and SysTick */
+#define MPS2_SYSCLK_HZ         25000000UL
+
+/* Peripheral base addresses */
+#define MPS2_UART0_BASE        0x40004000UL
+#define MPS2_FPGAIO_BASE       0x40028000UL
+#define MPS2_ETHERNET_BASE     0x40200000UL
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPS2_AN386_H */
@@ -0,0 +1,102 @@
+/**
+ * \file startup_mps2.c
+ * \brief Vector table and reset handler for QEMU mps2-an386
+ *
+ * Handler names follow CMSIS, as in the SAME54 startup code, so the
+ * FreeRTOS port handlers map the same way through FreeRTOSConfig.h.
+ */
+
+#include "mps2_an386.h"
+
+/* Symbols from mps2_an386.ld */
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _estack;
+
+extern int main(void);
+
+void Reset_Handler(void);
+void Dummy_Handler(void);
+
+/* Cortex-M4 core handlers */
+void NMI_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void HardFault_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void MemManage_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void BusFault_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void UsageFault_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void SVCall_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void DebugMonitor_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void PendSV_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+void SysTick_Handler(void) __attribute__((weak, alias("Dummy_Handler")));
+
+/* MPS2 peripheral handlers */
+void UARTRX0_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+void UARTTX0_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+void TIMER0_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+void TIMER1_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+void UARTOVF_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+void ETHERNET_IRQHandler(void) __attribute__((weak, alias("Dummy_Handler")));
+
+__attribute__((section(".vectors"), used))
+const void *const exception_table[16 + PERIPH_COUNT_IRQn] = {
+    &_estack,
+    (void *)Reset_Handler,
+    (void *)NMI_Handler,
+    (void *)HardFault_Handler,
+    (void *)MemManage_Handler,
+    (void *)BusFault_Handler,
+    (void *)UsageFault_Handler,
+    (void *)0,
+    (void *)0,
+    (void *)0,
+    (void *)0,
+    (void *)SVCall_Handler,
+    (void *)DebugMonitor_Handler,
+    (void *)0,
+    (void *)PendSV_Handler,
+    (void *)SysTick_Handler,
+
+    [16 + UARTRX0_IRQn]  = (void *)UARTRX0_IRQHandler,
+    [16 + UARTTX0_IRQn]  = (void *)UARTTX0_IRQHandler,
+    [16 + TIMER0_IRQn]   = (void *)TIMER0_IRQHandler,
+    [16 + TIMER1_IRQn]   = (void *)TIMER1_IRQHandler,
+    [16 + UARTOVF_IRQn]  = (void *)UARTOVF_IRQHandler,
+    [16 + ETHERNET_IRQn] = (void *)ETHERNET_IRQHandler,
+};
+
+void Reset_Handler(void)
+{
+    uint32_t *src = &_sidata;
+    uint32_t *dst = &_sdata;
+
+    /* Initialize the relocate segment */
+    if (src != dst) {
+        while (dst < &_edata) {
+            *dst++ = *src++;
+        }
+    }
+
+    /* Clear the zero segment */
+    for (dst = &_sbss; dst < &_ebss;) {
+        *dst++ = 0;
+    }
+
+    /* Enable CP10/CP11 before any FPU instruction, as the port uses lazy stacking */
+    SCB->CPACR |= (0xFu << 20);
+    __DSB();
+    __ISB();
+
+    main();
+
+    for (;;) {
+    }
+}
+
+void Dummy_Handler(void)
+{
+    for (;;) {
+    }
+}
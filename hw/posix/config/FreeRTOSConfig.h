@@ -0,0 +1,43 @@
+/**
+ * \file FreeRTOSConfig.h
+ * \brief FreeRTOS configuration overlay for the Linux host build
+ *
+ * Found ahead of config/FreeRTOSConfig.h on the include path. Only the
+ * settings the POSIX port needs are changed; everything else comes from
+ * the target configuration so both builds schedule the same way.
+ */
+
+#ifndef POSIX_FREERTOS_CONFIG_H
+#define POSIX_FREERTOS_CONFIG_H
+
+/* peripheral_clk_config.h is pulled in by the target config; give the
+ * tick a nominal clock instead of the SAME54 CPU frequency. */
+#define configCPU_CLOCK_HZ                  ((unsigned long)1000000)
+
+/* Every task runs on a pthread. Stacks below PTHREAD_STACK_MIN (16 KB,
+ * less the thread record port.c keeps at the top) fall back to the default
+ * pthread stack with a warning, so the kernel's own tasks get 32 KB. */
+#define configMINIMAL_STACK_SIZE            ((unsigned short)4096)
+#define configTIMER_TASK_STACK_DEPTH        4096
+
+/* Stack words are 8 bytes on x86_64, so the heap is scaled accordingly */
+#define configTOTAL_HEAP_SIZE               ((size_t)(1024 * 1024))
+
+/* Idle hook sleeps so an idle simulator does not spin a host core */
+#define configUSE_IDLE_HOOK                 1
+
+#include_next <FreeRTOSConfig.h>
+
+/* Replace the target's spin-forever assert with one that reports and aborts */
+#undef configASSERT
+#define configASSERT(x)                                                        \
+	if ((x) == 0) {                                                            \
+		assert_triggered(__FILE__, __LINE__);                                  \
+	}
+
+/* Cortex-M handler names are meaningless for the POSIX port */
+#undef vPortSVCHandler
+#undef xPortPendSVHandler
+#undef xPortSysTickHandler
+
+#endif /* POSIX_FREERTOS_CONFIG_H */
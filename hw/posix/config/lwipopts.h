@@ -0,0 +1,17 @@
+/**
+ * \file lwipopts.h
+ * \brief lwIP configuration overlay for the Linux host build
+ *
+ * Found ahead of config/lwipopts.h on the include path; the target
+ * options are used unchanged apart from enabling lwIP's assertions.
+ */
+
+#ifndef POSIX_LWIPOPTS_H
+#define POSIX_LWIPOPTS_H
+
+/* Keep lwIP's internal checks on when running on the host */
+#define LWIP_NOASSERT 0
+
+#include_next <lwipopts.h>
+
+#endif /* POSIX_LWIPOPTS_H */
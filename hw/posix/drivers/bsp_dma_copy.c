@@ -0,0 +1,80 @@
+/**
+ * \file bsp_dma_copy.c
+ * \brief Copy service for the Linux host and QEMU builds
+ *
+ * Neither has a DMA controller to use (QEMU's mps2-an386 models none), so
+ * every copy is made with memcpy() before the call returns and the
+ * completion callback runs in the caller. The chain checks match the
+ * SAME54 DMAC version, so callers see the same results.
+ */
+
+#include "bsp_dma_copy.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#define DMA_BLOCK_MAX               0xFFFFu
+
+static bsp_dma_copy_stats_t copy_stats;
+
+static bool chain_fits(const bsp_dma_copy_desc_t *desc)
+{
+    uint32_t blocks = 0;
+
+    for (; desc != NULL; desc = desc->next) {
+        if (++blocks > BSP_DMA_COPY_LINKS || desc->length > DMA_BLOCK_MAX) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void chain_copy(const bsp_dma_copy_desc_t *desc)
+{
+    for (; desc != NULL; desc = desc->next) {
+        memcpy(desc->dst, desc->src, desc->length);
+    }
+    taskENTER_CRITICAL();
+    copy_stats.cpu++;
+    taskEXIT_CRITICAL();
+}
+
+void bsp_dma_copy_init(void)
+{
+}
+
+bool bsp_dma_copy_submit(const bsp_dma_copy_desc_t *desc, bsp_dma_copy_done_t done, void *arg)
+{
+    if (!chain_fits(desc)) {
+        return false;
+    }
+
+    chain_copy(desc);
+    if (done != NULL) {
+        done(arg, true);
+    }
+    return true;
+}
+
+void bsp_dma_copy(const bsp_dma_copy_desc_t *desc)
+{
+    chain_copy(desc);
+}
+
+void *bsp_dma_memcpy(void *dst, const void *src, size_t len)
+{
+    bsp_dma_copy_desc_t desc = { dst, src, (uint32_t)len, NULL };
+
+    if (len > DMA_BLOCK_MAX) {
+        return memcpy(dst, src, len);
+    }
+    bsp_dma_copy(&desc);
+    return dst;
+}
+
+void bsp_dma_copy_stats(bsp_dma_copy_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = copy_stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,474 @@
+/**
+ * \file bsp_ethernet.c
+ * \brief Ethernet driver for the Linux host build, backed by a TAP device
+ *
+ * Mirrors hw/same54/drivers/bsp_ethernet.c: same drv_eth_t instance name,
+ * same TCP/IP init-done sequence and link monitor. There is no RX
+ * interrupt, so the GMAC task polls the TAP device every tick instead of
+ * waiting on a semaphore given from the ISR.
+ */
+
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+#include "lwip/dhcp.h"
+#include "network_events.h"
+#include "boot_time.h"
+#include "housekeeping.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "eth_ipstack_main.h"
+#include "ethif_mac.h"
+
+#include "bsp_ethernet.h"
+#include "tap_if.h"
+#include <hal_mac_async.h>
+#include "lwip_macif_config.h"
+#include "printf.h"
+#include "utils_assert.h"
+#include <stdlib.h>
+
+/* TAP interface used when DOIP_TAP_IF is not set in the environment */
+#ifndef CONF_POSIX_TAP_IF_NAME
+#define CONF_POSIX_TAP_IF_NAME "tap0"
+#endif
+
+/* RX poll period in ticks (1 tick = 1 ms) */
+#ifndef CONF_POSIX_TAP_POLL_TICKS
+#define CONF_POSIX_TAP_POLL_TICKS 1
+#endif
+
+#define netifINTERFACE_TASK_STACK_SIZE configMINIMAL_STACK_SIZE
+#define netifINTERFACE_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+
+/* Link polling: quickly until the link first comes up, then relaxed */
+#define LINK_MONITOR_DOWN_POLL_MS 100
+#define LINK_MONITOR_UP_POLL_MS 500
+
+/* External peripheral descriptors */
+extern struct mac_async_descriptor COMMUNICATION_IO;
+
+typedef struct
+{
+    struct mac_async_descriptor *mac_desc;
+    tap_if_t tap;
+    drv_eth_callback_t receive_callback;
+    drv_eth_callback_t transmit_callback;
+
+    struct netif *netif;
+    bool enabled;
+
+    // Link status tracking
+    bool link_up;
+    volatile bool netif_ready;      // Set by eth_tcpip_init_done() once the netif is added
+
+    // Link monitoring job
+    housekeeping_job_t *link_monitor_job;
+} drv_eth_hw_context_t;
+
+static drv_eth_hw_context_t drv_eth_hw_context_communication = {
+    .mac_desc = &COMMUNICATION_IO,
+    .tap = { .fd = -1 },
+    .receive_callback = NULL,
+    .transmit_callback = NULL,
+    .netif = NULL,
+    .enabled = false,
+    .link_up = false,
+    .netif_ready = false,
+    .link_monitor_job = NULL,
+};
+
+// Forward declarations of static functions
+static void gmac_task(void *pvParameters);
+static uint32_t link_monitor_job(void *arg);
+static drv_eth_status_t drv_eth_init(const void *hw_context);
+static drv_eth_status_t drv_eth_deinit(const void *hw_context);
+static drv_eth_status_t drv_eth_enable(const void *hw_context);
+static drv_eth_status_t drv_eth_disable(const void *hw_context);
+static drv_eth_status_t drv_eth_phy_init(const void *hw_context);
+static drv_eth_status_t drv_eth_phy_reset(const void *hw_context);
+static drv_eth_status_t drv_eth_get_link_status(const void *hw_context, bool *link_up);
+static drv_eth_status_t drv_eth_restart_autoneg(const void *hw_context);
+static drv_eth_status_t drv_eth_read_phy_reg(const void *hw_context, uint16_t reg, uint16_t *value);
+static drv_eth_status_t drv_eth_write_phy_reg(const void *hw_context, uint16_t reg, uint16_t value);
+static drv_eth_status_t drv_eth_register_callback(const void *hw_context, drv_eth_cb_type_t type, drv_eth_callback_t callback);
+static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *data, uint32_t length);
+static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats);
+
+// Global Ethernet driver instance
+drv_eth_t eth_communication = {
+    .is_init = false,
+    .is_enabled = false,
+    .hw_context = &drv_eth_hw_context_communication,
+    .init = drv_eth_init,
+    .deinit = drv_eth_deinit,
+    .enable = drv_eth_enable,
+    .disable = drv_eth_disable,
+    .phy_init = drv_eth_phy_init,
+    .phy_reset = drv_eth_phy_reset,
+    .get_link_status = drv_eth_get_link_status,
+    .restart_autoneg = drv_eth_restart_autoneg,
+    .read_phy_reg = drv_eth_read_phy_reg,
+    .write_phy_reg = drv_eth_write_phy_reg,
+    .register_callback = drv_eth_register_callback,
+    .write = drv_eth_write,
+    .get_tcpip_init_done_fn = drv_eth_get_tcpip_init_done_fn_impl,
+    .start_link_monitor = drv_eth_start_link_monitor_impl,
+    .stop_link_monitor = drv_eth_stop_link_monitor_impl,
+    .get_stats = drv_eth_get_stats,
+};
+
+static drv_eth_status_t drv_eth_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    const char *name = getenv("DOIP_TAP_IF");
+    if (name == NULL || name[0] == '\0') {
+        name = CONF_POSIX_TAP_IF_NAME;
+    }
+
+    printf("[ETH] Attaching to TAP interface %s\r\n", name);
+
+    if (!tap_if_open(&context->tap, name)) {
+        return DRV_ETH_STATUS_ERROR;
+    }
+
+    context->mac_desc->dev = &context->tap;
+
+    printf("[ETH] MAC initialized successfully\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_deinit(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    context->mac_desc->dev = NULL;
+    tap_if_close(&context->tap);
+    printf("[ETH] MAC deinitialized\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_enable(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    context->enabled = true;
+    printf("[ETH] MAC enabled\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_disable(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    context->enabled = false;
+    printf("[ETH] MAC disabled\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+/* There is no PHY behind a TAP device; link state is the host interface state */
+
+static drv_eth_status_t drv_eth_phy_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_phy_reset(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_get_link_status(const void *hw_context, bool *link_up)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(link_up != NULL);
+    const drv_eth_hw_context_t *context = (const drv_eth_hw_context_t *)hw_context;
+
+    if (context->tap.fd < 0) {
+        return DRV_ETH_STATUS_ERROR;
+    }
+
+    *link_up = tap_if_link_up(&context->tap);
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_restart_autoneg(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    return DRV_ETH_STATUS_OK;
+}
+
+static drv_eth_status_t drv_eth_read_phy_reg(const void *hw_context, uint16_t reg, uint16_t *value)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(value != NULL);
+    (void)reg;
+    return DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_write_phy_reg(const void *hw_context, uint16_t reg, uint16_t value)
+{
+    ASSERT(hw_context != NULL);
+    (void)reg;
+    (void)value;
+    return DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_register_callback(const void *hw_context, drv_eth_cb_type_t type, drv_eth_callback_t callback)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (type == DRV_ETH_CB_RECEIVE) {
+        context->receive_callback = callback;
+        return DRV_ETH_STATUS_OK;
+    } else if (type == DRV_ETH_CB_TRANSMIT) {
+        context->transmit_callback = callback;
+        return DRV_ETH_STATUS_OK;
+    }
+
+    return DRV_ETH_STATUS_ERROR;
+}
+
+static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *data, uint32_t length)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(data != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (!tap_if_write(&context->tap, data, length)) {
+        return DRV_ETH_STATUS_ERROR;
+    }
+    if (context->transmit_callback != NULL) {
+        context->transmit_callback();
+    }
+    return DRV_ETH_STATUS_OK;
+}
+
+/**
+ * \brief Task for the TAP device.
+ * Polls for received frames once per tick and hands them to lwIP
+ */
+static void gmac_task(void *pvParameters)
+{
+    drv_eth_hw_context_t *context = pvParameters;
+
+    while (1) {
+        if (context->enabled) {
+            ethernetif_mac_input(context->netif);
+        }
+        vTaskDelay(CONF_POSIX_TAP_POLL_TICKS);
+    }
+}
+
+/* Pass a link change to lwIP from outside the tcpip thread */
+static void link_apply(drv_eth_hw_context_t *context, bool link_up)
+{
+    LOCK_TCPIP_CORE();
+    if (link_up) {
+        netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
+    } else {
+        netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
+    }
+    UNLOCK_TCPIP_CORE();
+
+    context->link_up = link_up;
+    if (link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+}
+
+/**
+ * \brief Link monitoring job
+ * Periodically checks the TAP interface state and notifies lwIP of changes;
+ * start-up does not wait for the link, this job applies it when it comes
+ */
+static uint32_t link_monitor_job(void *arg)
+{
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)arg;
+    bool current_link_state = false;
+
+    /* Parked until eth_tcpip_init_done() adds the interface; from then on
+     * context->link_up is the state last applied to lwIP */
+    if (!context->netif_ready) {
+        return HOUSEKEEPING_WAIT;
+    }
+
+    if (hw_eth_get_link_status(&eth_communication, &current_link_state) == DRV_ETH_STATUS_OK &&
+        current_link_state != context->link_up) {
+        printf("[LINK_MONITOR] Link state change detected: %s -> %s\r\n",
+               context->link_up ? "UP" : "DOWN",
+               current_link_state ? "UP" : "DOWN");
+
+        link_apply(context, current_link_state);
+    }
+
+    return context->link_up ? LINK_MONITOR_UP_POLL_MS : LINK_MONITOR_DOWN_POLL_MS;
+}
+
+/* TCP/IP stack initialization done callback - same sequence as the SAME54 BSP,
+ * which does not wait for the link on the tcpip thread */
+static void eth_tcpip_init_done(void *arg)
+{
+    sys_sem_t *sem;
+    sem = (sys_sem_t *)arg;
+    u8_t mac[6] = {0x00, 0x00, 0x00, 0x00, 0x20, 0x76};
+    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
+
+    /* Initialize network event logging */
+    network_events_init();
+    log_lwip_init(ERR_OK);
+
+    if (hw_eth_get_link_status(&eth_communication, &context->link_up) != DRV_ETH_STATUS_OK) {
+        context->link_up = false;
+    }
+    if (!context->link_up) {
+        printf("[INIT] %s is not up yet (ip link set %s up), not waiting for it\r\n", context->tap.name,
+               context->tap.name);
+    }
+
+    hw_eth_enable(&eth_communication);
+
+    printf("[INIT] Initializing network interface...\r\n");
+    TCPIP_STACK_INTERFACE_0_init(mac);
+
+    TCPIP_STACK_INTERFACE_0_desc.input = tcpip_input;
+
+    context->netif = &TCPIP_STACK_INTERFACE_0_desc;
+
+    sys_thread_t id = sys_thread_new("GMAC", gmac_task, context, netifINTERFACE_TASK_STACK_SIZE, netifINTERFACE_TASK_PRIORITY);
+    LWIP_ASSERT("ethernetif_init: GMAC Task allocation ERROR!\n", (id != 0));
+    (void)id;
+
+    printf("[INIT] Setting up network interface callbacks...\r\n");
+    netif_set_default(&TCPIP_STACK_INTERFACE_0_desc);
+
+    /* Register network event callbacks */
+    netif_set_status_callback(&TCPIP_STACK_INTERFACE_0_desc, netif_status_callback);
+    netif_set_link_callback(&TCPIP_STACK_INTERFACE_0_desc, netif_link_callback);
+
+    log_mac_address(&TCPIP_STACK_INTERFACE_0_desc);
+    log_link_status_change(&TCPIP_STACK_INTERFACE_0_desc, context->link_up);
+
+    if (context->link_up) {
+        netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
+    } else {
+        netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
+    }
+
+#if CONF_TCPIP_STACK_INTERFACE_0_DHCP
+    printf("[INIT] Starting DHCP client...\r\n");
+    if (ERR_OK != dhcp_start(&TCPIP_STACK_INTERFACE_0_desc)) {
+        log_dhcp_error(&TCPIP_STACK_INTERFACE_0_desc, "Failed to start DHCP client");
+        LWIP_ASSERT("ERR_OK != dhcp_start", 0);
+    }
+#else
+    printf("[INIT] Using static IP configuration...\r\n");
+    netif_set_up(&TCPIP_STACK_INTERFACE_0_desc);
+    log_network_config(&TCPIP_STACK_INTERFACE_0_desc);
+#endif
+
+    boot_time_mark(BOOT_MARK_NETIF);
+    if (context->link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+
+    /* Hand link tracking to the monitor job */
+    context->netif_ready = true;
+    if (context->link_monitor_job != NULL) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
+
+    printf("[INIT] Network initialization complete\r\n");
+    sys_sem_signal(sem); /* Signal the waiting thread that the TCP/IP init is done. */
+}
+
+static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void *hw_context)
+{
+    return eth_tcpip_init_done;
+}
+
+/**
+ * \brief Start link monitoring job
+ */
+static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (context->link_monitor_job != NULL) {
+        printf("[ETH] Link monitor already running\r\n");
+        return DRV_ETH_STATUS_OK;
+    }
+
+    /* Runs once the interface is up; eth_tcpip_init_done() triggers it */
+    context->link_monitor_job = housekeeping_add("LinkMon", link_monitor_job, context, HOUSEKEEPING_WAIT);
+    if (context->link_monitor_job == NULL) {
+        printf("[ETH] Failed to schedule link monitor\r\n");
+        return DRV_ETH_STATUS_ERROR;
+    }
+    if (context->netif_ready) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
+
+    printf("[ETH] Link monitor started\r\n");
+    return DRV_ETH_STATUS_OK;
+}
+
+/**
+ * \brief Stop link monitoring job
+ */
+static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    if (context->link_monitor_job != NULL) {
+        housekeeping_cancel(context->link_monitor_job);
+        context->link_monitor_job = NULL;
+        printf("[ETH] Link monitor stopped\r\n");
+    }
+
+    return DRV_ETH_STATUS_OK;
+}
+
+/**
+ * \brief Copy the TAP frame counters
+ */
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(stats != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+
+    taskENTER_CRITICAL();
+    stats->rx_frames = context->tap.rx_frames;
+    stats->rx_bytes = context->tap.rx_bytes;
+    stats->rx_errors = context->tap.rx_errors;
+    stats->rx_dropped = 0;
+    stats->tx_frames = context->tap.tx_frames;
+    stats->tx_bytes = context->tap.tx_bytes;
+    stats->tx_errors = context->tap.tx_errors;
+    stats->rx_wakeups = 0;
+    stats->rx_wakeup_frames = 0;
+    stats->rx_wakeup_max = 0;
+    stats->rx_budget_hits = 0;
+    stats->rx_filtered = 0;
+    stats->rx_priority = 0;
+    stats->rx_shed = 0;
+    stats->rx_ring_peak = 0;
+    stats->rx_ring_full = 0;
+    stats->rx_overruns = 0;
+    taskEXIT_CRITICAL();
+
+    return DRV_ETH_STATUS_OK;
+}
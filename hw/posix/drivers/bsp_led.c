@@ -0,0 +1,87 @@
+/**
+ * \file bsp_led.c
+ * \brief LED driver for the Linux host build
+ *
+ * The LED state is only tracked; set DOIP_POSIX_LED=1 in the environment
+ * to have state changes printed.
+ */
+
+#include "bsp_led.h"
+#include "utils_assert.h"
+#include "printf.h"
+#include <stdlib.h>
+
+typedef struct
+{
+    const char *name;
+    bool state;
+    bool verbose;
+} drv_led_hw_context_t;
+
+static drv_led_hw_context_t drv_led_hw_context_yellow = {
+    .name = "yellow",
+    .state = false,
+    .verbose = false,
+};
+
+static drv_led_status_t drv_led_init(const void *hw_context);
+static drv_led_status_t drv_led_deinit(const void *hw_context);
+static drv_led_status_t drv_led_on(const void *hw_context);
+static drv_led_status_t drv_led_off(const void *hw_context);
+static drv_led_status_t drv_led_toggle(const void *hw_context);
+
+drv_led_t led_yellow = {
+    .is_init = false,
+    .hw_context = &drv_led_hw_context_yellow,
+    .init = drv_led_init,
+    .deinit = drv_led_deinit,
+    .on = drv_led_on,
+    .off = drv_led_off,
+    .toggle = drv_led_toggle,
+};
+
+static void led_set(drv_led_hw_context_t *context, bool state)
+{
+    context->state = state;
+    if (context->verbose) {
+        printf("[LED] %s %s\r\n", context->name, state ? "on" : "off");
+    }
+}
+
+static drv_led_status_t drv_led_init(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    const char *env = getenv("DOIP_POSIX_LED");
+    context->verbose = (env != NULL && env[0] == '1');
+    led_set(context, context->state);
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_deinit(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_on(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    led_set((drv_led_hw_context_t *)hw_context, true);
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_off(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    led_set((drv_led_hw_context_t *)hw_context, false);
+    return DRV_LED_STATUS_OK;
+}
+
+static drv_led_status_t drv_led_toggle(const void *hw_context)
+{
+    ASSERT(hw_context != NULL);
+    drv_led_hw_context_t *context = (drv_led_hw_context_t *)hw_context;
+    led_set(context, !context->state);
+    return DRV_LED_STATUS_OK;
+}
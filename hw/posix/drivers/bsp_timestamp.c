@@ -0,0 +1,29 @@
+/**
+ * \file bsp_timestamp.c
+ * \brief Timestamp counter for the Linux host build, in microseconds
+ */
+
+#include "bsp_timestamp.h"
+#include <time.h>
+
+void bsp_timestamp_init(void)
+{
+}
+
+uint32_t bsp_timestamp_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+uint32_t bsp_timestamp_to_us(uint32_t ticks)
+{
+    return ticks;
+}
+
+uint32_t bsp_timestamp_elapsed_us(uint32_t start)
+{
+    return bsp_timestamp_now() - start;
+}
@@ -0,0 +1,68 @@
+/**
+ * \file ethif_tap.c
+ * \brief lwIP netif glue for the host TAP driver
+ *
+ * netif->state is COMMUNICATION_IO, whose dev field the BSP Ethernet
+ * driver points at its tap_if_t when the device is opened.
+ */
+
+#include "ethif_mac.h"
+#include "tap_if.h"
+#include <hal_mac_async.h>
+#include "lwip/etharp.h"
+#include "lwip/stats.h"
+#include "printf.h"
+
+static uint8_t tap_rx_frame[TAP_IF_MAX_FRAME];
+static uint8_t tap_tx_frame[TAP_IF_MAX_FRAME];
+
+static tap_if_t *netif_tap(struct netif *netif)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+    return (tap_if_t *)desc->dev;
+}
+
+void mac_low_level_init(struct netif *netif)
+{
+    netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+}
+
+err_t mac_low_level_output(struct netif *netif, struct pbuf *p)
+{
+    tap_if_t *tap = netif_tap(netif);
+
+    if (tap == NULL || p->tot_len - ETH_PAD_SIZE > sizeof(tap_tx_frame)) {
+        return ERR_IF;
+    }
+
+    /* Drop the padding word; the TAP device expects a bare Ethernet frame */
+    u16_t len = pbuf_copy_partial(p, tap_tx_frame, p->tot_len - ETH_PAD_SIZE, ETH_PAD_SIZE);
+
+    return tap_if_write(tap, tap_tx_frame, len) ? ERR_OK : ERR_IF;
+}
+
+void ethernetif_mac_input(struct netif *netif)
+{
+    tap_if_t *tap = netif_tap(netif);
+    int len;
+
+    if (tap == NULL) {
+        return;
+    }
+
+    while ((len = tap_if_read(tap, tap_rx_frame, sizeof(tap_rx_frame))) > 0) {
+        struct pbuf *p = pbuf_alloc(PBUF_RAW, (u16_t)(len + ETH_PAD_SIZE), PBUF_POOL);
+        if (p == NULL) {
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            printf("[TAP] RX frame dropped, pbuf pool empty\r\n");
+            continue;
+        }
+
+        pbuf_take_at(p, tap_rx_frame, (u16_t)len, ETH_PAD_SIZE);
+
+        if (netif->input(p, netif) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * \file posix_platform.c
+ * \brief Platform hooks for the Linux host build
+ *
+ * Stands in for the ASF4 init code, the SEGGER RTT console
+ * (rtt_printf.c) and the FreeRTOS hooks the SAME54 build gets from
+ * hardware.
+ */
+
+#include <hal_init.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtt_printf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+
+void init_mcu(void)
+{
+    /* Console output is line buffered so interleaved task output stays readable */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+void assert_triggered(const char *file, uint32_t line)
+{
+    fprintf(stderr, "[ASSERT] %s:%lu\n", file, (unsigned long)line);
+    fflush(stdout);
+    abort();
+}
+
+/**
+ * \brief Console initialization, replaces the RTT setup in rtt_printf.c
+ */
+void rtt_printf_init(void)
+{
+}
+
+/**
+ * \brief printf() character output to stdout
+ *
+ * Carriage returns from the firmware's "\r\n" line endings are dropped.
+ */
+void _putchar(char character)
+{
+    if (character != '\r') {
+        fputc(character, stdout);
+    }
+}
+
+/**
+ * \brief Channel selection; the console is a single stream on this platform
+ */
+rtt_printf_channel_t rtt_printf_select(rtt_printf_channel_t channel)
+{
+    (void)channel;
+    return RTT_PRINTF_CH_LOG;
+}
+
+void rtt_printf_flush(void)
+{
+    fflush(stdout);
+}
+
+uint32_t rtt_printf_dropped(rtt_printf_channel_t channel)
+{
+    (void)channel;
+    return 0;
+}
+
+/**
+ * \brief Console input from stdin, non-blocking
+ *
+ * Only read while the simulator is the terminal's foreground job, so a
+ * backgrounded run is not stopped by SIGTTIN.
+ *
+ * \return Character, or -1 if none is pending
+ */
+int rtt_printf_getchar(void)
+{
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    unsigned char c;
+
+    if (!isatty(STDIN_FILENO) || tcgetpgrp(STDIN_FILENO) != getpgrp()) {
+        return -1;
+    }
+    if (poll(&pfd, 1, 0) <= 0 || read(STDIN_FILENO, &c, 1) != 1) {
+        return -1;
+    }
+    return c;
+}
+
+/**
+ * \brief Idle hook - sleep briefly so the simulator does not spin a host core
+ */
+void vApplicationIdleHook(void)
+{
+    usleep(1000);
+}
@@ -0,0 +1,106 @@
+/**
+ * \file tap_if.c
+ * \brief Linux TAP device access for the host Ethernet driver
+ *
+ * The interface is expected to exist already (see hw/posix/README.md), so
+ * the simulator itself does not need CAP_NET_ADMIN.
+ */
+
+#include "tap_if.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+bool tap_if_open(tap_if_t *tap, const char *name)
+{
+    struct ifreq ifr;
+
+    tap->fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (tap->fd < 0) {
+        fprintf(stderr, "[TAP] open(/dev/net/tun) failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+
+    if (ioctl(tap->fd, TUNSETIFF, &ifr) < 0) {
+        fprintf(stderr, "[TAP] TUNSETIFF %s failed: %s\n", name, strerror(errno));
+        close(tap->fd);
+        tap->fd = -1;
+        return false;
+    }
+
+    strncpy(tap->name, ifr.ifr_name, TAP_IF_NAME_LEN - 1);
+    tap->name[TAP_IF_NAME_LEN - 1] = '\0';
+    return true;
+}
+
+void tap_if_close(tap_if_t *tap)
+{
+    if (tap->fd >= 0) {
+        close(tap->fd);
+        tap->fd = -1;
+    }
+}
+
+int tap_if_read(tap_if_t *tap, uint8_t *frame, size_t size)
+{
+    ssize_t len = read(tap->fd, frame, size);
+
+    if (len < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        tap->rx_errors++;
+        return -1;
+    }
+    tap->rx_frames++;
+    tap->rx_bytes += (uint64_t)len;
+    return (int)len;
+}
+
+bool tap_if_write(tap_if_t *tap, const uint8_t *frame, size_t length)
+{
+    ssize_t len;
+
+    do {
+        len = write(tap->fd, frame, length);
+    } while (len < 0 && errno == EINTR);
+
+    if (len != (ssize_t)length) {
+        tap->tx_errors++;
+        return false;
+    }
+    tap->tx_frames++;
+    tap->tx_bytes += length;
+    return true;
+}
+
+bool tap_if_link_up(const tap_if_t *tap)
+{
+    struct ifreq ifr;
+    bool up = false;
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    if (sock < 0) {
+        return false;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, tap->name, IFNAMSIZ - 1);
+    if (ioctl(sock, SIOCGIFFLAGS, &ifr) == 0) {
+        up = (ifr.ifr_flags & IFF_UP) && (ifr.ifr_flags & IFF_RUNNING);
+    }
+
+    close(sock);
+    return up;
+}
@@ -0,0 +1,70 @@
+/**
+ * \file tap_if.h
+ * \brief Linux TAP device access for the host Ethernet driver
+ *
+ * Kept free of lwIP headers: lwIP's socket compatibility macros and the
+ * host <sys/socket.h> cannot share a translation unit.
+ */
+
+#ifndef _TAP_IF_H_
+#define _TAP_IF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAP_IF_NAME_LEN     16
+#define TAP_IF_MAX_FRAME    1536
+
+typedef struct
+{
+    int fd;
+    char name[TAP_IF_NAME_LEN];
+    uint32_t rx_frames;
+    uint64_t rx_bytes;
+    uint32_t rx_errors;
+    uint32_t tx_frames;
+    uint64_t tx_bytes;
+    uint32_t tx_errors;
+} tap_if_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * \brief Attach to an existing TAP interface in non-blocking mode
+ * \param[out] tap TAP handle
+ * \param[in] name Interface name, e.g. "tap0"
+ * \return true on success
+ */
+bool tap_if_open(tap_if_t *tap, const char *name);
+
+/**
+ * \brief Detach from the TAP interface
+ */
+void tap_if_close(tap_if_t *tap);
+
+/**
+ * \brief Read one Ethernet frame without blocking
+ * \return Frame length, 0 if nothing is pending, -1 on error
+ */
+int tap_if_read(tap_if_t *tap, uint8_t *frame, size_t size);
+
+/**
+ * \brief Write one Ethernet frame
+ * \return true if the whole frame was written
+ */
+bool tap_if_write(tap_if_t *tap, const uint8_t *frame, size_t length);
+
+/**
+ * \brief Report whether the host side of the TAP interface is up and running
+ */
+bool tap_if_link_up(const tap_if_t *tap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _TAP_IF_H_
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Create the TAP interface used by the Linux host build (Makefile.posix).
+# The host side gets the gateway address the firmware expects, so the ECU
+# emulator can run unmodified on this machine.
+#
+#   sudo hw/posix/setup_tap.sh [ifname] [owner]
+set -e
+
+IFNAME=${1:-tap0}
+OWNER=${2:-${SUDO_USER:-$(id -un)}}
+
+if ! ip link show "$IFNAME" >/dev/null 2>&1; then
+    ip tuntap add dev "$IFNAME" mode tap user "$OWNER"
+fi
+ip addr flush dev "$IFNAME"
+ip addr add 192.168.100.1/24 dev "$IFNAME"
+ip link set "$IFNAME" up
+
+echo "$IFNAME ready (192.168.100.1/24, owner $OWNER)"
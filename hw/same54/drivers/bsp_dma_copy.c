@@ -0,0 +1,270 @@
+/**
+ * \file bsp_dma_copy.c
+ * \brief Memory-to-memory copies on the SAME54 DMAC
+ *
+ * Channels 0 .. BSP_DMA_COPY_CHANNELS-1 are configured in
+ * config/hpl_dmac_config.h for software triggers with one trigger per
+ * transaction, so a single trigger moves a whole chain. The first block
+ * of a chain goes into the channel's descriptor in the hpl_dmac.c
+ * descriptor section, further blocks into the channel's own link
+ * descriptors. Each block uses the widest beat its addresses and length
+ * allow; only the last one raises the completion interrupt.
+ */
+
+#include "bsp_dma_copy.h"
+#include <hpl_dma.h>
+#include <hpl_dmac_config.h>
+#include <utils.h>
+#include <sam.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <string.h>
+
+#define BSP_DMA_COPY_CHANNELS       2
+
+/* Below configMAX_SYSCALL_INTERRUPT_PRIORITY for the FromISR calls, as the GMAC */
+#define BSP_DMA_COPY_IRQ_PRIORITY   5
+
+#define DMA_BLOCK_MAX               0xFFFFu
+
+#if !CONF_DMAC_ENABLE || CONF_DMAC_TRIGACT_0 != 3 || CONF_DMAC_TRIGACT_1 != 3
+#error "bsp_dma_copy.c needs the DMAC enabled and channels 0 and 1 triggered per transaction"
+#endif
+
+typedef struct {
+    bsp_dma_copy_done_t done;
+    void *arg;
+    bool wait;                  /* A bsp_dma_copy() caller waits on the semaphore */
+    uint32_t length;
+    volatile bool busy;
+    volatile bool ok;
+    SemaphoreHandle_t complete;
+    StaticSemaphore_t complete_buffer;
+} dma_copy_channel_t;
+
+/* First descriptor of every channel, in hpl_dmac.c */
+extern DmacDescriptor _descriptor_section[DMAC_CH_NUM];
+
+COMPILER_ALIGNED(16)
+static DmacDescriptor links[BSP_DMA_COPY_CHANNELS][BSP_DMA_COPY_LINKS - 1];
+
+static dma_copy_channel_t channels[BSP_DMA_COPY_CHANNELS];
+static bsp_dma_copy_stats_t copy_stats;
+
+static uint32_t beat_shift(const bsp_dma_copy_desc_t *desc)
+{
+    uint32_t align = (uint32_t)desc->dst | (uint32_t)desc->src | desc->length;
+
+    return ((align & 3u) == 0) ? 2 : ((align & 1u) == 0) ? 1 : 0;
+}
+
+/* Check the chain against the channel's descriptors and sum its length */
+static bool chain_fits(const bsp_dma_copy_desc_t *desc, uint32_t *length)
+{
+    uint32_t blocks = 0;
+
+    *length = 0;
+    for (; desc != NULL; desc = desc->next) {
+        if (++blocks > BSP_DMA_COPY_LINKS || desc->length > DMA_BLOCK_MAX) {
+            return false;
+        }
+        *length += desc->length;
+    }
+    return true;
+}
+
+static void chain_copy_cpu(const bsp_dma_copy_desc_t *desc)
+{
+    for (; desc != NULL; desc = desc->next) {
+        memcpy(desc->dst, desc->src, desc->length);
+    }
+}
+
+static void block_write(DmacDescriptor *hw, const bsp_dma_copy_desc_t *desc, DmacDescriptor *next)
+{
+    uint32_t shift = beat_shift(desc);
+
+    hri_dmacdescriptor_write_BTCTRL_reg(hw, DMAC_BTCTRL_VALID | DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_DSTINC |
+                                                DMAC_BTCTRL_BEATSIZE(shift) |
+                                                ((next == NULL) ? DMAC_BTCTRL_BLOCKACT_INT :
+                                                                  DMAC_BTCTRL_BLOCKACT_NOACT));
+    hri_dmacdescriptor_write_BTCNT_reg(hw, (uint16_t)(desc->length >> shift));
+    /* With incrementing addresses the DMAC wants the end of each block */
+    hri_dmacdescriptor_write_SRCADDR_reg(hw, (uint32_t)desc->src + desc->length);
+    hri_dmacdescriptor_write_DSTADDR_reg(hw, (uint32_t)desc->dst + desc->length);
+    hri_dmacdescriptor_write_DESCADDR_reg(hw, (uint32_t)next);
+}
+
+static int channel_claim(void)
+{
+    int claimed = -1;
+
+    taskENTER_CRITICAL();
+    for (int ch = 0; ch < BSP_DMA_COPY_CHANNELS; ch++) {
+        if (!channels[ch].busy) {
+            channels[ch].busy = true;
+            claimed = ch;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return claimed;
+}
+
+static void channel_start(int ch, const bsp_dma_copy_desc_t *desc, uint32_t length)
+{
+    const bsp_dma_copy_desc_t *blocks[BSP_DMA_COPY_LINKS];
+    uint32_t count = 0;
+    DmacDescriptor *hw = &_descriptor_section[ch];
+
+    /* A zero beat count is not a valid block; empty ones copy nothing anyway */
+    for (; desc != NULL; desc = desc->next) {
+        if (desc->length > 0) {
+            blocks[count++] = desc;
+        }
+    }
+
+    channels[ch].length = length;
+    for (uint32_t i = 0; i < count; i++) {
+        DmacDescriptor *next = (i + 1 < count) ? &links[ch][i] : NULL;
+
+        block_write(hw, blocks[i], next);
+        hw = next;
+    }
+    _dma_enable_transaction((uint8_t)ch, true);
+}
+
+static void channel_finish(dma_copy_channel_t *channel, bool ok)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (ok) {
+        copy_stats.dma++;
+        copy_stats.dma_bytes += channel->length;
+    } else {
+        copy_stats.errors++;
+    }
+
+    if (channel->wait) {
+        /* The waiting task releases the channel */
+        channel->ok = ok;
+        xSemaphoreGiveFromISR(channel->complete, &woken);
+    } else {
+        bsp_dma_copy_done_t done = channel->done;
+        void *arg = channel->arg;
+
+        channel->busy = false;
+        if (done != NULL) {
+            done(arg, ok);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void dma_transfer_done(struct _dma_resource *resource)
+{
+    channel_finish(resource->back, true);
+}
+
+static void dma_transfer_error(struct _dma_resource *resource)
+{
+    channel_finish(resource->back, false);
+}
+
+void bsp_dma_copy_init(void)
+{
+    for (int ch = 0; ch < BSP_DMA_COPY_CHANNELS; ch++) {
+        struct _dma_resource *resource;
+
+        channels[ch].complete = xSemaphoreCreateBinaryStatic(&channels[ch].complete_buffer);
+        _dma_get_channel_resource(&resource, (uint8_t)ch);
+        resource->dma_cb.transfer_done = dma_transfer_done;
+        resource->dma_cb.error = dma_transfer_error;
+        resource->back = &channels[ch];
+        _dma_set_irq_state((uint8_t)ch, DMA_TRANSFER_COMPLETE_CB, true);
+        _dma_set_irq_state((uint8_t)ch, DMA_TRANSFER_ERROR_CB, true);
+        NVIC_SetPriority((IRQn_Type)(DMAC_0_IRQn + ch), BSP_DMA_COPY_IRQ_PRIORITY);
+    }
+}
+
+/* Claim a channel for a chain worth the DMAC, or copy it here; -1 if copied */
+static int copy_claim(const bsp_dma_copy_desc_t *desc, uint32_t length)
+{
+    int ch = (length >= BSP_DMA_COPY_MIN) ? channel_claim() : -1;
+
+    if (ch < 0) {
+        chain_copy_cpu(desc);
+        taskENTER_CRITICAL();
+        copy_stats.cpu++;
+        copy_stats.busy += (length >= BSP_DMA_COPY_MIN) ? 1u : 0u;
+        taskEXIT_CRITICAL();
+    }
+    return ch;
+}
+
+bool bsp_dma_copy_submit(const bsp_dma_copy_desc_t *desc, bsp_dma_copy_done_t done, void *arg)
+{
+    uint32_t length;
+
+    if (!chain_fits(desc, &length)) {
+        return false;
+    }
+
+    int ch = copy_claim(desc, length);
+    if (ch < 0) {
+        if (done != NULL) {
+            done(arg, true);
+        }
+        return true;
+    }
+
+    channels[ch].done = done;
+    channels[ch].arg = arg;
+    channels[ch].wait = false;
+    channel_start(ch, desc, length);
+    return true;
+}
+
+void bsp_dma_copy(const bsp_dma_copy_desc_t *desc)
+{
+    uint32_t length;
+
+    if (!chain_fits(desc, &length) || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        chain_copy_cpu(desc);
+        return;
+    }
+
+    int ch = copy_claim(desc, length);
+    if (ch < 0) {
+        return;
+    }
+
+    channels[ch].wait = true;
+    channel_start(ch, desc, length);
+    xSemaphoreTake(channels[ch].complete, portMAX_DELAY);
+
+    bool ok = channels[ch].ok;
+    channels[ch].busy = false;
+    if (!ok) {
+        chain_copy_cpu(desc);
+    }
+}
+
+void *bsp_dma_memcpy(void *dst, const void *src, size_t len)
+{
+    bsp_dma_copy_desc_t desc = { dst, src, (uint32_t)len, NULL };
+
+    if (len > DMA_BLOCK_MAX) {
+        return memcpy(dst, src, len);
+    }
+    bsp_dma_copy(&desc);
+    return dst;
+}
+
+void bsp_dma_copy_stats(bsp_dma_copy_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = copy_stats;
+    taskEXIT_CRITICAL();
+}
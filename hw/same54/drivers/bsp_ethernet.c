@@ -1,11 +1,14 @@
 #include "lwip/sys.h"
 #include "lwip/tcpip.h"
 #include "network_events.h"
+#include "boot_time.h"
+#include "housekeeping.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 #include "eth_ipstack_main.h"
 #include "ethif_mac.h"
+#include "ethif_gmac.h"
 
 #include "bsp_ethernet.h"
 #include "hal_mac_async.h"
@@ -37,11 +40,13 @@ typedef struct tag_gmac_device {
 } gmac_device;
 
 /* Task constants - replicated from webserver_tasks.h to avoid dependency */
-#define TASK_LED_STACK_SIZE (512 / sizeof(portSTACK_TYPE))
-#define TASK_LED_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
 #define netifINTERFACE_TASK_STACK_SIZE 512
 #define netifINTERFACE_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
 
+/* PHY link polling: quickly until the link first comes up, then relaxed */
+#define LINK_MONITOR_DOWN_POLL_MS 100
+#define LINK_MONITOR_UP_POLL_MS 500
+
 /* Local pin definitions (copied from atmel_start_pins.h to avoid dependency) */
 #define PA12 GPIO(GPIO_PORTA, 12)
 #define PA13 GPIO(GPIO_PORTA, 13)
@@ -124,9 +129,14 @@ typedef struct
     // Link status tracking
     bool link_up;
     volatile bool recv_flag;
+    volatile bool netif_ready;      // Set by eth_tcpip_init_done() once the netif is added
+    
+    // Link monitoring job
+    housekeeping_job_t *link_monitor_job;
+    int phy_error_count;            // Consecutive failed PHY reads
     
-    // Link monitoring task
-    TaskHandle_t link_monitor_task;
+    // Running totals of the clear-on-read GMAC statistics registers
+    drv_eth_stats_t stats;
 } drv_eth_hw_context_t;
 
 static drv_eth_hw_context_t drv_eth_hw_context_communication = {
@@ -137,7 +147,8 @@ static drv_eth_hw_context_t drv_eth_hw_context_communication = {
     .gmac_dev = {0},
     .link_up = false,
     .recv_flag = false,
-    .link_monitor_task = NULL,
+    .netif_ready = false,
+    .link_monitor_job = NULL,
 };
 
 // Forward declarations of static functions
@@ -145,8 +156,9 @@ static void gmac_clock_init(void);
 static void gmac_pin_init(void);
 static void mac_receive_cb(struct mac_async_descriptor *desc);
 static void gmac_handler_cb(void);
+static void gmac_receive_cb(void);
 static void gmac_task(void *pvParameters);
-static void link_monitor_task(void *p);
+static uint32_t link_monitor_job(void *arg);
 static drv_eth_status_t drv_eth_init(const void *hw_context);
 static drv_eth_status_t drv_eth_deinit(const void *hw_context);
 static drv_eth_status_t drv_eth_enable(const void *hw_context);
@@ -162,6 +174,7 @@ static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *dat
 static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void *hw_context);
 static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context);
 static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context);
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats);
 
 // Global Ethernet driver instance
 drv_eth_t eth_communication = {
@@ -183,6 +196,7 @@ drv_eth_t eth_communication = {
     .get_tcpip_init_done_fn = drv_eth_get_tcpip_init_done_fn_impl,
     .start_link_monitor = drv_eth_start_link_monitor_impl,
     .stop_link_monitor = drv_eth_stop_link_monitor_impl,
+    .get_stats = drv_eth_get_stats,
 };
 
 static drv_eth_status_t drv_eth_init(const void *hw_context)
@@ -343,8 +357,59 @@ static drv_eth_status_t drv_eth_write(const void *hw_context, const uint8_t *dat
     ASSERT(data != NULL);
     const drv_eth_hw_context_t *context = (const drv_eth_hw_context_t *)hw_context;
     
-    int32_t result = mac_async_write(context->mac_desc, (uint8_t *)data, length);
-    return convert_error_code(result);
+    /* The HPL transmit buffers are not in use, frames go through the netif's ring */
+    err_t result = ethernetif_gmac_write(context->gmac_dev.netif, data, length);
+    return (result == ERR_OK) ? DRV_ETH_STATUS_OK : DRV_ETH_STATUS_ERROR;
+}
+
+/**
+ * \brief Fold the GMAC statistics registers into the running totals
+ *
+ * The registers clear on read and the error counters saturate at 1023,
+ * so this has to be called every few seconds (net_stats does).
+ */
+static drv_eth_status_t drv_eth_get_stats(const void *hw_context, drv_eth_stats_t *stats)
+{
+    ASSERT(hw_context != NULL);
+    ASSERT(stats != NULL);
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
+    const void *hw = context->mac_desc->dev.hw;
+    
+    taskENTER_CRITICAL();
+    
+    context->stats.rx_frames += hri_gmac_read_FR_reg(hw);
+    context->stats.rx_bytes += hri_gmac_read_ORLO_reg(hw);
+    context->stats.rx_bytes += (uint64_t)hri_gmac_read_ORHI_reg(hw) << 32;
+    context->stats.rx_errors += hri_gmac_read_FCSE_reg(hw) + hri_gmac_read_AE_reg(hw) +
+                                hri_gmac_read_LFFE_reg(hw) + hri_gmac_read_RSE_reg(hw) +
+                                hri_gmac_read_UFR_reg(hw) + hri_gmac_read_OFR_reg(hw) +
+                                hri_gmac_read_JR_reg(hw);
+    context->stats.rx_dropped += hri_gmac_read_ROE_reg(hw) + hri_gmac_read_RRE_reg(hw);
+    
+    context->stats.tx_frames += hri_gmac_read_FT_reg(hw);
+    context->stats.tx_bytes += hri_gmac_read_OTLO_reg(hw);
+    context->stats.tx_bytes += (uint64_t)hri_gmac_read_OTHI_reg(hw) << 32;
+    context->stats.tx_errors += hri_gmac_read_TUR_reg(hw) + hri_gmac_read_EC_reg(hw) +
+                                hri_gmac_read_LC_reg(hw) + hri_gmac_read_CSE_reg(hw);
+    
+    *stats = context->stats;
+    
+    taskEXIT_CRITICAL();
+    
+    ethernetif_gmac_rx_stats_t rx;
+    ethernetif_gmac_rx_stats(&rx);
+    stats->rx_wakeups = rx.wakeups;
+    stats->rx_wakeup_frames = rx.frames;
+    stats->rx_wakeup_max = rx.batch_max;
+    stats->rx_budget_hits = rx.budget_hits;
+    stats->rx_filtered = rx.filtered_broadcast + rx.filtered_arp + rx.filtered_multicast + rx.filtered_type;
+    stats->rx_priority = rx.priority;
+    stats->rx_shed = rx.shed;
+    stats->rx_ring_peak = rx.ring_peak;
+    stats->rx_ring_full = rx.ring_full;
+    stats->rx_overruns = rx.overruns;
+    
+    return DRV_ETH_STATUS_OK;
 }
 
 /* GMAC hardware initialization functions */
@@ -379,6 +444,16 @@ static void mac_receive_cb(struct mac_async_descriptor *desc)
     context->recv_flag = true;
 }
 
+/**
+ * \brief Callback for GMAC receive interrupt.
+ * Masks further receive interrupts until gmac_task has emptied the ring
+ */
+static void gmac_receive_cb(void)
+{
+    hri_gmac_clear_IMR_RCOMP_bit(COMMUNICATION_IO.dev.hw);
+    gmac_handler_cb();
+}
+
 /**
  * \brief Callback for GMAC interrupt.
  * Give semaphore for which gmac_task waits
@@ -407,124 +482,106 @@ static void gmac_task(void *pvParameters)
         /* Wait for the counting RX notification semaphore. */
         sys_sem_wait(&ps_gmac_dev->rx_sem);
 
-        /* Process the incoming packet. */
+        /* Release transmitted frames, then poll the receive ring; this
+         * re-enables the receive interrupt once the ring is empty. */
+        ethernetif_gmac_tx_complete(ps_gmac_dev->netif);
         ethernetif_mac_input(ps_gmac_dev->netif);
     }
 }
 
+/* Pass a link change to lwIP from outside the tcpip thread */
+static void link_apply(drv_eth_hw_context_t *context, bool link_up)
+{
+    LOCK_TCPIP_CORE();
+    if (link_up) {
+        netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
+    } else {
+        netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
+    }
+    UNLOCK_TCPIP_CORE();
+
+    context->link_up = link_up;
+    if (link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+}
+
 /**
- * \brief Link monitoring task
- * Periodically checks PHY link status and notifies lwIP of changes
+ * \brief Link monitoring job
+ * Periodically checks the PHY link status and notifies lwIP of changes;
+ * start-up does not wait for the link, this job applies it when it comes
  */
-static void link_monitor_task(void *p)
+static uint32_t link_monitor_job(void *arg)
 {
-    (void)p;
-    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
+    drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)arg;
     bool current_link_state = false;
-    bool previous_link_state = false;
-    
-    /* Wait for network initialization to complete */
-    vTaskDelay(2000);
-    
-    /* Get initial link state */
-    hw_eth_get_link_status(&eth_communication, &previous_link_state);
-    
-    for (;;) {
-        /* Check current link status */
-        drv_eth_status_t phy_result = hw_eth_get_link_status(&eth_communication, &current_link_state);
-        if (phy_result == DRV_ETH_STATUS_OK) {
-            /* Detect link status changes */
-            if (current_link_state != previous_link_state) {
-                printf("[LINK_MONITOR] Link state change detected: %s -> %s\r\n",
-                       previous_link_state ? "UP" : "DOWN",
-                       current_link_state ? "UP" : "DOWN");
-                
-                /* Update lwIP network interface link status */
-                if (current_link_state) {
-                    netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
-                    printf("[LINK_MONITOR] Notified lwIP: Link UP\r\n");
-                    
-                    /* Don't restart auto-negotiation - let it stabilize naturally */
-                    printf("[LINK_MONITOR] Link UP - allowing stabilization\r\n");
-                } else {
-                    netif_set_link_down(&TCPIP_STACK_INTERFACE_0_desc);
-                    printf("[LINK_MONITOR] Notified lwIP: Link DOWN\r\n");
-                }
-                
-                /* Update context link state */
-                context->link_up = current_link_state;
-                previous_link_state = current_link_state;
-            }
-        } else {
-            printf("[LINK_MONITOR] Failed to read PHY link status (error: %d)\r\n", phy_result);
+    
+    /* Parked until eth_tcpip_init_done() adds the interface; from then on
+     * context->link_up is the state last applied to lwIP */
+    if (!context->netif_ready) {
+        return HOUSEKEEPING_WAIT;
+    }
+    
+    drv_eth_status_t phy_result = hw_eth_get_link_status(&eth_communication, &current_link_state);
+    if (phy_result == DRV_ETH_STATUS_OK) {
+        context->phy_error_count = 0;
+        
+        /* Detect link status changes */
+        if (current_link_state != context->link_up) {
+            printf("[LINK_MONITOR] Link state change detected: %s -> %s\r\n",
+                   context->link_up ? "UP" : "DOWN",
+                   current_link_state ? "UP" : "DOWN");
             
-            /* Try to reinitialize PHY if we can't read it */
-            static int phy_error_count = 0;
-            phy_error_count++;
-            if (phy_error_count >= 10) {  /* After 10 consecutive errors (5 seconds) */
-                printf("[LINK_MONITOR] Attempting PHY re-initialization\r\n");
-                hw_eth_phy_init(&eth_communication);
-                phy_error_count = 0;
-            }
+            /* Update lwIP network interface link status */
+            link_apply(context, current_link_state);
+            printf("[LINK_MONITOR] Notified lwIP: Link %s\r\n", current_link_state ? "UP" : "DOWN");
         }
+    } else {
+        printf("[LINK_MONITOR] Failed to read PHY link status (error: %d)\r\n", phy_result);
         
-        /* Check link status every 500ms */
-        vTaskDelay(500);
+        /* Try to reinitialize PHY if we can't read it */
+        context->phy_error_count++;
+        if (context->phy_error_count >= 10) {  /* After 10 consecutive errors */
+            printf("[LINK_MONITOR] Attempting PHY re-initialization\r\n");
+            hw_eth_phy_init(&eth_communication);
+            context->phy_error_count = 0;
+        }
     }
+    
+    return context->link_up ? LINK_MONITOR_UP_POLL_MS : LINK_MONITOR_DOWN_POLL_MS;
 }
 
-/* TCP/IP stack initialization done callback - moved from webserver_tasks.c */
+/* TCP/IP stack initialization done callback - moved from webserver_tasks.c
+ * Runs on the tcpip thread, so it must not wait for the link: the
+ * interface and the GMAC come up at once, the link monitor job applies the
+ * link state whenever the PHY reports it. */
 static void eth_tcpip_init_done(void *arg)
 {
     sys_sem_t *sem;
     sem = (sys_sem_t *)arg;
     u8_t mac[6] = {0x00, 0x00, 0x00, 0x00, 0x20, 0x76};
+    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
     
     /* Initialize network event logging */
     network_events_init();
     log_lwip_init(ERR_OK);
     
-    hw_eth_register_callback(&eth_communication, DRV_ETH_CB_RECEIVE, gmac_handler_cb);
+    hw_eth_register_callback(&eth_communication, DRV_ETH_CB_RECEIVE, gmac_receive_cb);
     hri_gmac_set_IMR_RCOMP_bit(COMMUNICATION_IO.dev.hw);
+    /* TX complete wakes the same task, which releases the sent pbufs */
+    hw_eth_register_callback(&eth_communication, DRV_ETH_CB_TRANSMIT, gmac_handler_cb);
 
-    printf("[INIT] Waiting for Ethernet link...\r\n");
-    
     /* Initialize PHY before reading its status */
     drv_eth_status_t phy_init_status = hw_eth_phy_init(&eth_communication);
     if (phy_init_status != DRV_ETH_STATUS_OK) {
         printf("[INIT] PHY initialization failed: %d\r\n", phy_init_status);
     }
     
-    /* Give PHY more time to initialize and establish link */
-    int link_attempts = 0;
-    const int max_link_attempts = 100;  /* 10 seconds at 100ms intervals */
-    
-    drv_eth_hw_context_t *context = &drv_eth_hw_context_communication;
-    
-    while (link_attempts < max_link_attempts) {
-        drv_eth_status_t phy_status = hw_eth_get_link_status(&eth_communication, &context->link_up);
-        
-        if (phy_status == DRV_ETH_STATUS_OK && context->link_up) {
-            printf("[INIT] PHY link established after %d attempts\r\n", link_attempts);
-            break;
-        }
-        
-        if (phy_status != DRV_ETH_STATUS_OK) {
-            printf("[INIT] PHY read error: %d (attempt %d)\r\n", phy_status, link_attempts);
-        } else {
-            printf("[INIT] PHY link still down (attempt %d)\r\n", link_attempts);
-        }
-        
-        link_attempts++;
-        vTaskDelay(100);  /* Wait 100ms between attempts */
-    }
-    
-    if (!context->link_up) {
-        printf("[INIT] WARNING: PHY link not established after %d attempts\r\n", max_link_attempts);
-        printf("[INIT] Continuing with network stack initialization...\r\n");
+    /* One read; auto-negotiation usually completes after this */
+    if (hw_eth_get_link_status(&eth_communication, &context->link_up) != DRV_ETH_STATUS_OK) {
+        context->link_up = false;
     }
-
-    printf("[INIT] Ethernet link detected\r\n");
+    printf("[INIT] PHY link %s, not waiting for it\r\n", context->link_up ? "up" : "down");
 
     /* Enable NVIC GMAC interrupt. */
     /* Interrupt priorities. (lowest value = highest priority) */
@@ -564,7 +621,7 @@ static void eth_tcpip_init_done(void *arg)
     /* Log initial link status */
     log_link_status_change(&TCPIP_STACK_INTERFACE_0_desc, context->link_up);
     
-    /* Manually update lwIP link status since link monitoring task hasn't started yet */
+    /* Initial lwIP link status; the link monitor job takes over from here */
     if (context->link_up) {
         printf("[INIT] Setting initial link status to UP in lwIP\r\n");
         netif_set_link_up(&TCPIP_STACK_INTERFACE_0_desc);
@@ -574,7 +631,7 @@ static void eth_tcpip_init_done(void *arg)
     }
 
 #if CONF_TCPIP_STACK_INTERFACE_0_DHCP
-    /* DHCP mode. */
+    /* DHCP mode; with the link down it starts discovering on link up */
     printf("[INIT] Starting DHCP client...\r\n");
     if (ERR_OK != dhcp_start(&TCPIP_STACK_INTERFACE_0_desc)) {
         log_dhcp_error(&TCPIP_STACK_INTERFACE_0_desc, "Failed to start DHCP client");
@@ -588,6 +645,17 @@ static void eth_tcpip_init_done(void *arg)
     log_network_config(&TCPIP_STACK_INTERFACE_0_desc);
 #endif
 
+    boot_time_mark(BOOT_MARK_NETIF);
+    if (context->link_up) {
+        boot_time_mark(BOOT_MARK_LINK);
+    }
+
+    /* Hand link tracking to the monitor job */
+    context->netif_ready = true;
+    if (context->link_monitor_job != NULL) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
+
     printf("[INIT] Network initialization complete\r\n");
     sys_sem_signal(sem); /* Signal the waiting thread that the TCP/IP init is done. */
 }
@@ -598,40 +666,44 @@ static drv_eth_tcpip_init_done_fn drv_eth_get_tcpip_init_done_fn_impl(const void
 }
 
 /**
- * \brief Start link monitoring task
+ * \brief Start link monitoring job
  */
 static drv_eth_status_t drv_eth_start_link_monitor_impl(const void *hw_context)
 {
     ASSERT(hw_context != NULL);
     drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
     
-    if (context->link_monitor_task != NULL) {
-        printf("[ETH] Link monitor task already running\r\n");
+    if (context->link_monitor_job != NULL) {
+        printf("[ETH] Link monitor already running\r\n");
         return DRV_ETH_STATUS_OK;
     }
     
-    /* Create task to monitor link status */
-    if (xTaskCreate(link_monitor_task, "LinkMon", TASK_LED_STACK_SIZE, NULL, TASK_LED_TASK_PRIORITY, &context->link_monitor_task) != pdPASS) {
-        printf("[ETH] Failed to create link monitor task\r\n");
+    /* Runs once the interface is up; eth_tcpip_init_done() triggers it */
+    context->link_monitor_job = housekeeping_add("LinkMon", link_monitor_job, context, HOUSEKEEPING_WAIT);
+    if (context->link_monitor_job == NULL) {
+        printf("[ETH] Failed to schedule link monitor\r\n");
         return DRV_ETH_STATUS_ERROR;
     }
+    if (context->netif_ready) {
+        housekeeping_trigger(context->link_monitor_job);
+    }
     
-    printf("[ETH] Link monitor task started\r\n");
+    printf("[ETH] Link monitor started\r\n");
     return DRV_ETH_STATUS_OK;
 }
 
 /**
- * \brief Stop link monitoring task
+ * \brief Stop link monitoring job
  */
 static drv_eth_status_t drv_eth_stop_link_monitor_impl(const void *hw_context)
 {
     ASSERT(hw_context != NULL);
     drv_eth_hw_context_t *context = (drv_eth_hw_context_t *)hw_context;
     
-    if (context->link_monitor_task != NULL) {
-        vTaskDelete(context->link_monitor_task);
-        context->link_monitor_task = NULL;
-        printf("[ETH] Link monitor task stopped\r\n");
+    if (context->link_monitor_job != NULL) {
+        housekeeping_cancel(context->link_monitor_job);
+        context->link_monitor_job = NULL;
+        printf("[ETH] Link monitor stopped\r\n");
     }
     
     return DRV_ETH_STATUS_OK;
@@ -0,0 +1,27 @@
+#include "bsp_timestamp.h"
+#include <sam.h>
+#include <peripheral_clk_config.h>
+
+#define TIMESTAMP_TICKS_PER_US (CONF_CPU_FREQUENCY / 1000000u)
+
+void bsp_timestamp_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t bsp_timestamp_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+uint32_t bsp_timestamp_to_us(uint32_t ticks)
+{
+    return ticks / TIMESTAMP_TICKS_PER_US;
+}
+
+uint32_t bsp_timestamp_elapsed_us(uint32_t start)
+{
+    return (DWT->CYCCNT - start) / TIMESTAMP_TICKS_PER_US;
+}
@@ -0,0 +1,625 @@
+/**
+ * \file ethif_gmac.c
+ * \brief lwIP netif glue for the SAME54 GMAC with zero-copy receive and transmit
+ *
+ * Replaces the ASF4 lwIP port's ethif_mac.c, which copied every frame out
+ * of the 128-byte HPL receive buffers and then again into a pool pbuf.
+ * mac_low_level_init() takes the receive queue over from the HPL driver:
+ * each descriptor gets a whole-frame buffer (gmac_rx_ring.c) and received
+ * buffers go up to lwIP as pbuf_custom without a copy. The buffer goes
+ * back to the spare pool from the pbuf free callback, whichever task
+ * frees it.
+ *
+ * Transmit bypasses the HPL's two copy buffers the same way: the transmit
+ * ring (gmac_tx_ring.c) points one descriptor at each pbuf of the chain
+ * and holds a reference until the TX-complete interrupt has woken the
+ * GMAC task, which releases it in ethernetif_gmac_tx_complete(). Frames
+ * that find the ring full wait in its queue.
+ *
+ * Receive is polled: the interrupt only wakes the GMAC task and is masked
+ * until ethernetif_mac_input() has emptied the ring, GMAC_RX_BUDGET frames
+ * per tcpip message.
+ *
+ * Frames the GMAC address filter lets through but lwIP would only discard
+ * (broadcast for other hosts and services, multicast hash collisions) are
+ * dropped by gmac_rx_filter.c before they cost a pbuf or a tcpip message.
+ *
+ * DoIP frames (GMAC_RX_PRIORITY_PORT) are passed to lwIP ahead of the
+ * others taken in the same poll, and only they may use the last
+ * GMAC_RX_SPARE_RESERVE spare buffers or fall back to a pool pbuf; other
+ * frames are dropped when the spares run that low.
+ *
+ * With checksum offload configured (CONF_GMAC_NCFGR_RXCOEN,
+ * CONF_GMAC_DCFGR_TXCOEN) the netif turns off lwIP's IP/TCP/UDP checksum
+ * generation and checking; what the GMAC did not check on receive is
+ * verified by gmac_csum.c before lwIP sees the frame.
+ *
+ * netif->state is COMMUNICATION_IO.
+ */
+
+#include "ethif_mac.h"
+#include "ethif_gmac.h"
+#include "gmac_csum.h"
+#include "gmac_rx_filter.h"
+#include "gmac_rx_ring.h"
+#include "gmac_tx_ring.h"
+#include <hal_mac_async.h>
+#include <hpl_gmac_config.h>
+#include "app_libs/asf4/hri/hri_gmac_e54.h"
+#include "lwip/etharp.h"
+#include "lwip/stats.h"
+#include "lwip/tcpip.h"
+#include "netif/ethernet.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include <string.h>
+
+/* Descriptors owned by the GMAC, plus buffers that stand in for those
+ * lent to lwIP. Once every spare is out, frames are copied instead.
+ * The descriptors are what absorbs a burst while the GMAC task is held
+ * off; pc/bench rx_burst_* shows the drop rate per ring size. */
+#ifndef GMAC_RX_DESC_COUNT
+#define GMAC_RX_DESC_COUNT      8
+#endif
+#ifndef GMAC_RX_SPARE_COUNT
+#define GMAC_RX_SPARE_COUNT     8
+#endif
+#define GMAC_RX_BUFFER_COUNT    (GMAC_RX_DESC_COUNT + GMAC_RX_SPARE_COUNT)
+#define GMAC_RX_BUFFER_SIZE     CONF_GMAC_RXBUF_SIZE
+
+/* Output section of the receive descriptors and buffers (24 kB by
+ * default); a .bss.* name keeps them in .bss, a linker script can move
+ * them elsewhere. Must not be loaded from flash. */
+#ifndef GMAC_RX_SECTION
+#define GMAC_RX_SECTION         ".bss.gmac_rx"
+#endif
+
+/* Transmit descriptors (one per pbuf) and frames that may wait for them */
+#ifndef GMAC_TX_DESC_COUNT
+#define GMAC_TX_DESC_COUNT      16
+#endif
+#ifndef GMAC_TX_QUEUE_LEN
+#define GMAC_TX_QUEUE_LEN       16
+#endif
+#define GMAC_TX_RECLAIM_BATCH   8
+
+/* Most frames one poll takes off the receive ring and posts to the tcpip
+ * thread as a single message; two such batches may be in flight */
+#ifndef GMAC_RX_BUDGET
+#define GMAC_RX_BUDGET          16
+#endif
+#define GMAC_RX_BATCHES         2
+
+/* TCP/UDP port whose frames go to lwIP ahead of the rest of a batch and
+ * may use the last GMAC_RX_SPARE_RESERVE spares and the pbuf pool */
+#ifndef GMAC_RX_PRIORITY_PORT
+#define GMAC_RX_PRIORITY_PORT   13400
+#endif
+#ifndef GMAC_RX_SPARE_RESERVE
+#define GMAC_RX_SPARE_RESERVE   2
+#endif
+
+/* UDP ports that broadcast datagrams may reach: DoIP vehicle
+ * identification (ISO 13400) and the DHCP client */
+#ifndef GMAC_RX_BROADCAST_PORTS
+#define GMAC_RX_BROADCAST_PORTS { 13400, 68 }
+#endif
+
+#define GMAC_MAX_FRAME          1518
+
+#if GMAC_RX_BUFFER_SIZE < GMAC_MAX_FRAME + ETH_PAD_SIZE
+#error "CONF_GMAC_DCFGR_DRBS too small: every receive buffer must hold a whole frame"
+#endif
+#if CONF_GMAC_NCFGR_RXBUFO != ETH_PAD_SIZE
+#error "CONF_GMAC_NCFGR_RXBUFO must equal ETH_PAD_SIZE"
+#endif
+#if GMAC_RX_DESC_COUNT < TCP_WND / TCP_MSS
+#error "GMAC_RX_DESC_COUNT must hold a whole TCP receive window of back-to-back segments"
+#endif
+
+typedef struct {
+    struct pbuf_custom pc;      ///< Must stay first, lwIP hands back the pbuf
+    uint8_t *buffer;
+} gmac_rx_pbuf_t;
+
+COMPILER_ALIGNED(8) static gmac_rx_desc_t rx_descs[GMAC_RX_DESC_COUNT] __attribute__((section(GMAC_RX_SECTION)));
+COMPILER_ALIGNED(32) static uint8_t rx_buffers[GMAC_RX_BUFFER_COUNT][GMAC_RX_BUFFER_SIZE]
+    __attribute__((section(GMAC_RX_SECTION)));
+static uint8_t *rx_slots[GMAC_RX_DESC_COUNT];
+static uint8_t *rx_spares[GMAC_RX_SPARE_COUNT];
+static gmac_rx_pbuf_t rx_pbufs[GMAC_RX_BUFFER_COUNT];
+static gmac_rx_ring_t rx_ring;
+static gmac_rx_filter_t rx_filter;
+
+typedef struct {
+    struct pbuf *frames[GMAC_RX_BUDGET];
+    uint32_t count;
+    struct netif *netif;
+    struct tcpip_callback_msg *msg;
+    volatile bool queued;       ///< Posted, not yet processed by the tcpip thread
+} gmac_rx_batch_t;
+
+static gmac_rx_batch_t rx_batches[GMAC_RX_BATCHES];
+static ethernetif_gmac_rx_stats_t rx_stats;
+
+COMPILER_ALIGNED(8) static gmac_tx_desc_t tx_descs[GMAC_TX_DESC_COUNT];
+static void *tx_owners[GMAC_TX_DESC_COUNT];
+static void *tx_pending[GMAC_TX_QUEUE_LEN];
+static gmac_tx_ring_t tx_ring;
+
+/* pbuf_custom free callback: the buffer becomes a spare again */
+static void rx_pbuf_free(struct pbuf *p)
+{
+    gmac_rx_pbuf_t *rx = (gmac_rx_pbuf_t *)p;
+
+    taskENTER_CRITICAL();
+    gmac_rx_ring_free(&rx_ring, rx->buffer);
+    taskEXIT_CRITICAL();
+}
+
+static struct pbuf *rx_pbuf_loan(const gmac_rx_frame_t *frame)
+{
+    gmac_rx_pbuf_t *rx = &rx_pbufs[(frame->buffer - rx_buffers[0]) / GMAC_RX_BUFFER_SIZE];
+
+    rx->buffer = frame->buffer;
+    rx->pc.custom_free_function = rx_pbuf_free;
+
+    /* The GMAC wrote the frame ETH_PAD_SIZE bytes into the buffer (RXBUFO) */
+    return pbuf_alloced_custom(PBUF_RAW, (u16_t)(frame->length + ETH_PAD_SIZE), PBUF_REF,
+                               &rx->pc, frame->buffer, GMAC_RX_BUFFER_SIZE);
+}
+
+/* Hand a frame back without passing it up */
+static void rx_frame_drop(const gmac_rx_frame_t *frame)
+{
+    taskENTER_CRITICAL();
+    if (frame->loaned) {
+        gmac_rx_ring_free(&rx_ring, frame->buffer);
+    } else {
+        gmac_rx_ring_return(&rx_ring, frame);
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void rx_batch_input(void *arg);
+
+/* Hash register for the joined groups; the filter drops collisions */
+static void rx_filter_hash_write(void *hw)
+{
+    uint32_t bottom, top;
+
+    gmac_rx_filter_hash(&rx_filter, &bottom, &top);
+    hri_gmac_write_HRB_reg(hw, bottom);
+    hri_gmac_write_HRT_reg(hw, top);
+}
+
+#if LWIP_IGMP
+static err_t mac_igmp_filter(struct netif *netif, const ip4_addr_t *group, enum netif_mac_filter_action action)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+    uint32_t addr = lwip_ntohl(ip4_addr_get_u32(group));
+    uint8_t mac[6] = { 0x01, 0x00, 0x5E, (uint8_t)((addr >> 16) & 0x7F), (uint8_t)(addr >> 8), (uint8_t)addr };
+    bool ok;
+
+    taskENTER_CRITICAL();
+    ok = (action == NETIF_ADD_MAC_FILTER) ? gmac_rx_filter_join(&rx_filter, mac) : gmac_rx_filter_leave(&rx_filter, mac);
+    rx_filter_hash_write(desc->dev.hw);
+    taskEXIT_CRITICAL();
+
+    return ok ? ERR_OK : ERR_MEM;
+}
+#endif
+
+/* One segment per non-empty pbuf, without the ETH_PAD_SIZE padding */
+static uint32_t tx_pbuf_segments(void *frame, gmac_tx_segment_t *segments, uint32_t max)
+{
+    u16_t skip = ETH_PAD_SIZE;
+    uint32_t n = 0;
+
+    for (struct pbuf *q = (struct pbuf *)frame; q != NULL; q = q->next) {
+        const uint8_t *data = (const uint8_t *)q->payload;
+        u16_t len = q->len;
+        u16_t pad = (len < skip) ? len : skip;
+
+        data += pad;
+        len = (u16_t)(len - pad);
+        skip = (u16_t)(skip - pad);
+        if (len == 0) {
+            continue;
+        }
+        if (n == max) {
+            return 0;
+        }
+        segments[n].data = data;
+        segments[n].length = len;
+        n++;
+    }
+    return n;
+}
+
+static void tx_start(struct netif *netif)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+
+    hri_gmac_set_NCR_reg(desc->dev.hw, GMAC_NCR_TSTART);
+}
+
+void mac_low_level_init(struct netif *netif)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+    struct mac_async_filter filter;
+    void *hw = desc->dev.hw;
+
+    netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+
+    /* lwIP keeps only what the GMAC does not do; ICMP is never offloaded */
+    u16_t checksums = NETIF_CHECKSUM_ENABLE_ALL;
+#if CONF_GMAC_DCFGR_TXCOEN
+    checksums &= (u16_t)~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_UDP | NETIF_CHECKSUM_GEN_TCP);
+#endif
+#if CONF_GMAC_NCFGR_RXCOEN
+    checksums &= (u16_t)~(NETIF_CHECKSUM_CHECK_IP | NETIF_CHECKSUM_CHECK_UDP | NETIF_CHECKSUM_CHECK_TCP);
+#endif
+    NETIF_SET_CHECKSUM_CTRL(netif, checksums);
+
+    memcpy(filter.mac, netif->hwaddr, sizeof(filter.mac));
+    filter.tid_enable = false;
+    mac_async_set_filter(desc, 0, &filter);
+
+    static const uint16_t broadcast_ports[] = GMAC_RX_BROADCAST_PORTS;
+    gmac_rx_filter_init(&rx_filter);
+    for (uint32_t i = 0; i < sizeof(broadcast_ports) / sizeof(broadcast_ports[0]); i++) {
+        gmac_rx_filter_add_port(&rx_filter, broadcast_ports[i]);
+    }
+    rx_filter_hash_write(hw);
+#if LWIP_IGMP
+    netif->igmp_mac_filter = mac_igmp_filter;
+#endif
+
+    /* RBQB and TBQB may only be written while receiver and transmitter are off */
+    hri_gmac_ncr_reg_t enabled = hri_gmac_get_NCR_reg(hw, GMAC_NCR_RXEN | GMAC_NCR_TXEN);
+    hri_gmac_clear_NCR_reg(hw, GMAC_NCR_RXEN | GMAC_NCR_TXEN);
+
+    gmac_rx_ring_init(&rx_ring, rx_descs, rx_slots, GMAC_RX_DESC_COUNT, rx_spares,
+                      &rx_buffers[0][0], GMAC_RX_BUFFER_SIZE, GMAC_RX_BUFFER_COUNT);
+    hri_gmac_write_RBQB_reg(hw, (uint32_t)rx_descs);
+
+    gmac_tx_ring_init(&tx_ring, tx_descs, tx_owners, GMAC_TX_DESC_COUNT,
+                      tx_pending, GMAC_TX_QUEUE_LEN, tx_pbuf_segments);
+    hri_gmac_write_TBQB_reg(hw, (uint32_t)tx_descs);
+
+    hri_gmac_set_NCR_reg(hw, enabled);
+
+    /* Without the messages every frame goes through netif->input on its own */
+    for (uint32_t i = 0; i < GMAC_RX_BATCHES; i++) {
+        rx_batches[i].msg = tcpip_callbackmsg_new(rx_batch_input, &rx_batches[i]);
+        if (rx_batches[i].msg == NULL) {
+            printf("[ETH] RX batching disabled, no tcpip message\r\n");
+            rx_batches[0].msg = NULL;
+            break;
+        }
+    }
+}
+
+err_t mac_low_level_output(struct netif *netif, struct pbuf *p)
+{
+    struct pbuf *frame = p;
+    gmac_tx_result_t result;
+
+    if (p->tot_len - ETH_PAD_SIZE > GMAC_MAX_FRAME) {
+        LINK_STATS_INC(link.lenerr);
+        return ERR_IF;
+    }
+
+    /* Held until ethernetif_gmac_tx_complete(); TCP does not touch a
+     * segment for retransmission while its pbuf is still referenced */
+    pbuf_ref(frame);
+    taskENTER_CRITICAL();
+    result = gmac_tx_ring_send(&tx_ring, frame);
+    taskEXIT_CRITICAL();
+
+    if (result == GMAC_TX_INVALID) {
+        /* More pbufs than GMAC_TX_MAX_SEGMENTS: send a flat copy */
+        pbuf_free(frame);
+        frame = pbuf_clone(PBUF_RAW, PBUF_RAM, p);
+        if (frame == NULL) {
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            return ERR_MEM;
+        }
+        taskENTER_CRITICAL();
+        result = gmac_tx_ring_send(&tx_ring, frame);
+        taskEXIT_CRITICAL();
+    }
+
+    switch (result) {
+        case GMAC_TX_SENT:
+            tx_start(netif);
+            /* fall through */
+        case GMAC_TX_QUEUED:
+            LINK_STATS_INC(link.xmit);
+            return ERR_OK;
+        default:
+            pbuf_free(frame);
+            LINK_STATS_INC(link.drop);
+            return ERR_MEM;
+    }
+}
+
+void ethernetif_gmac_tx_complete(struct netif *netif)
+{
+    void *done[GMAC_TX_RECLAIM_BATCH];
+    uint32_t count;
+
+    do {
+        taskENTER_CRITICAL();
+        count = gmac_tx_ring_reclaim(&tx_ring, done, GMAC_TX_RECLAIM_BATCH);
+        bool restart = gmac_tx_ring_refill(&tx_ring);
+        taskEXIT_CRITICAL();
+
+        if (restart) {
+            tx_start(netif);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            pbuf_free((struct pbuf *)done[i]);
+        }
+    } while (count == GMAC_TX_RECLAIM_BATCH);
+}
+
+err_t ethernetif_gmac_write(struct netif *netif, const uint8_t *data, uint32_t length)
+{
+    if (netif == NULL || length > GMAC_MAX_FRAME) {
+        return ERR_ARG;
+    }
+
+    struct pbuf *p = pbuf_alloc(PBUF_RAW, (u16_t)(length + ETH_PAD_SIZE), PBUF_RAM);
+    if (p == NULL) {
+        return ERR_MEM;
+    }
+    pbuf_take_at(p, data, (u16_t)length, ETH_PAD_SIZE);
+
+    err_t err = mac_low_level_output(netif, p);
+    pbuf_free(p);
+    return err;
+}
+
+/* Take the next frame off the ring as a pbuf. Returns false once the
+ * ring is empty; *out is NULL if the frame was dropped. */
+static bool rx_next(struct netif *netif, struct pbuf **out, bool *priority)
+{
+    gmac_rx_frame_t frame;
+    struct pbuf *p;
+
+    taskENTER_CRITICAL();
+    bool received = gmac_rx_ring_take(&rx_ring, &frame);
+    taskEXIT_CRITICAL();
+
+    *out = NULL;
+    if (!received) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    gmac_rx_filter_result_t filtered = gmac_rx_filter_check(&rx_filter, frame.buffer + ETH_PAD_SIZE, frame.length,
+                                                            ip4_addr_get_u32(netif_ip4_addr(netif)));
+    taskEXIT_CRITICAL();
+    if (filtered != GMAC_RX_FILTER_PASS) {
+        rx_frame_drop(&frame);
+        return true;
+    }
+
+    *priority = gmac_rx_filter_priority(frame.buffer + ETH_PAD_SIZE, frame.length, GMAC_RX_PRIORITY_PORT);
+
+#if CONF_GMAC_NCFGR_RXCOEN
+    /* The GMAC already dropped what it found wrong; check what it skipped */
+    if (gmac_csum_rx_check(frame.buffer + ETH_PAD_SIZE, frame.length, frame.checksum) == GMAC_CSUM_BAD) {
+        rx_frame_drop(&frame);
+        LINK_STATS_INC(link.chkerr);
+        LINK_STATS_INC(link.drop);
+        return true;
+    }
+#endif
+
+    taskENTER_CRITICAL();
+    bool loaned = gmac_rx_ring_lend(&rx_ring, &frame, *priority ? 0 : GMAC_RX_SPARE_RESERVE);
+    taskEXIT_CRITICAL();
+
+    if (loaned) {
+        p = rx_pbuf_loan(&frame);
+        if (p == NULL) {
+            rx_frame_drop(&frame);
+        }
+    } else if (!*priority) {
+        /* The last spares and the pbuf pool are kept for DoIP */
+        rx_frame_drop(&frame);
+        rx_stats.shed++;
+        LINK_STATS_INC(link.drop);
+        return true;
+    } else {
+        /* Every spare is held by lwIP: copy, so the descriptor can go back */
+        p = pbuf_alloc(PBUF_RAW, (u16_t)(frame.length + ETH_PAD_SIZE), PBUF_POOL);
+        if (p != NULL) {
+            pbuf_take(p, frame.buffer, p->tot_len);
+        }
+        taskENTER_CRITICAL();
+        gmac_rx_ring_return(&rx_ring, &frame);
+        taskEXIT_CRITICAL();
+    }
+
+    if (p == NULL) {
+        LINK_STATS_INC(link.memerr);
+        LINK_STATS_INC(link.drop);
+        return true;
+    }
+
+    LINK_STATS_INC(link.recv);
+    if (*priority) {
+        rx_stats.priority++;
+    }
+    *out = p;
+    return true;
+}
+
+/* tcpip thread: feed a whole batch to the stack */
+static void rx_batch_input(void *arg)
+{
+    gmac_rx_batch_t *batch = (gmac_rx_batch_t *)arg;
+
+    for (uint32_t i = 0; i < batch->count; i++) {
+        if (ethernet_input(batch->frames[i], batch->netif) != ERR_OK) {
+            pbuf_free(batch->frames[i]);
+        }
+    }
+    batch->count = 0;
+    batch->queued = false;
+}
+
+static gmac_rx_batch_t *rx_batch_get(void)
+{
+    for (uint32_t i = 0; i < GMAC_RX_BATCHES; i++) {
+        if (!rx_batches[i].queued) {
+            return &rx_batches[i];
+        }
+    }
+    return NULL;
+}
+
+static void rx_deliver(struct netif *netif, gmac_rx_batch_t *batch, struct pbuf *p)
+{
+    if (batch != NULL) {
+        batch->frames[batch->count++] = p;
+    } else if (netif->input(p, netif) != ERR_OK) {
+        pbuf_free(p);
+    }
+}
+
+/* Move up to budget frames off the ring and post them to the tcpip thread
+ * as one message, DoIP frames first. Stops early when the ring is empty
+ * or every batch is still queued. Returns the number of frames taken. */
+static uint32_t rx_poll(struct netif *netif, uint32_t budget)
+{
+    bool batching = rx_batches[0].msg != NULL;
+    gmac_rx_batch_t *batch = NULL;
+    struct pbuf *later[GMAC_RX_BUDGET];
+    uint32_t later_count = 0;
+    uint32_t frames = 0;
+    struct pbuf *p;
+    bool priority;
+
+    if (batching) {
+        batch = rx_batch_get();
+        if (batch == NULL) {
+            return 0;
+        }
+        batch->netif = netif;
+    }
+
+    if (budget > GMAC_RX_BUDGET) {
+        budget = GMAC_RX_BUDGET;
+    }
+    while (frames < budget && rx_next(netif, &p, &priority)) {
+        frames++;
+        if (p == NULL) {
+            continue;
+        }
+        if (priority) {
+            rx_deliver(netif, batch, p);
+        } else {
+            later[later_count++] = p;
+        }
+    }
+    for (uint32_t i = 0; i < later_count; i++) {
+        rx_deliver(netif, batch, later[i]);
+    }
+
+    if (batching && batch->count > 0) {
+        batch->queued = true;
+        if (tcpip_callbackmsg_trycallback(batch->msg) == ERR_OK) {
+            rx_stats.batches++;
+        } else {
+            /* tcpip mailbox full, as a failed tcpip_input() would be */
+            for (uint32_t i = 0; i < batch->count; i++) {
+                pbuf_free(batch->frames[i]);
+                LINK_STATS_INC(link.drop);
+            }
+            batch->count = 0;
+            batch->queued = false;
+        }
+    }
+
+    return frames;
+}
+
+void ethernetif_mac_input(struct netif *netif)
+{
+    struct mac_async_descriptor *desc = (struct mac_async_descriptor *)netif->state;
+    void *hw = desc->dev.hw;
+    uint32_t frames = 0;
+
+    /* BNA: the GMAC found no free descriptor; RXOVR: its FIFO overflowed
+     * while waiting. Sticky flags, so these count wakeups that saw any;
+     * the frames lost are in the ROE and RRE statistics registers. */
+    uint32_t rsr = hri_gmac_read_RSR_reg(hw) & (GMAC_RSR_BNA | GMAC_RSR_RXOVR | GMAC_RSR_HNO);
+    if (rsr != 0) {
+        hri_gmac_write_RSR_reg(hw, rsr);
+        rx_stats.ring_full += (rsr & GMAC_RSR_BNA) ? 1 : 0;
+        rx_stats.overruns += (rsr & GMAC_RSR_RXOVR) ? 1 : 0;
+    }
+    taskENTER_CRITICAL();
+    gmac_rx_ring_occupancy(&rx_ring);
+    taskEXIT_CRITICAL();
+
+    /* Entered with the receive interrupt masked (bsp_ethernet.c). Poll
+     * until the ring is empty, then unmask. */
+    for (;;) {
+        uint32_t polled;
+
+        do {
+            polled = rx_poll(netif, GMAC_RX_BUDGET);
+            frames += polled;
+            if (polled == GMAC_RX_BUDGET) {
+                rx_stats.budget_hits++;
+            }
+        } while (polled == GMAC_RX_BUDGET);
+
+        if (gmac_rx_ring_pending(&rx_ring)) {
+            /* Both batches still queued: give the tcpip thread time to catch up */
+            rx_stats.backlog_waits++;
+            vTaskDelay(1);
+            ethernetif_gmac_tx_complete(netif);
+            continue;
+        }
+
+        hri_gmac_set_IMR_RCOMP_bit(hw);
+        if (!gmac_rx_ring_pending(&rx_ring)) {
+            break;
+        }
+        /* A frame landed while unmasking: keep polling instead of taking the interrupt */
+        hri_gmac_clear_IMR_RCOMP_bit(hw);
+    }
+
+    /* Transmit completions wake the task too */
+    if (frames == 0) {
+        rx_stats.empty++;
+        return;
+    }
+    rx_stats.wakeups++;
+    rx_stats.frames += frames;
+    if (frames > rx_stats.batch_max) {
+        rx_stats.batch_max = frames;
+    }
+}
+
+void ethernetif_gmac_rx_stats(ethernetif_gmac_rx_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = rx_stats;
+    stats->ring_peak = rx_ring.occupancy_max;
+    stats->spare_min = rx_ring.spare_min;
+    stats->filtered_broadcast = rx_filter.counts[GMAC_RX_FILTER_BROADCAST];
+    stats->filtered_arp = rx_filter.counts[GMAC_RX_FILTER_ARP];
+    stats->filtered_multicast = rx_filter.counts[GMAC_RX_FILTER_MULTICAST];
+    stats->filtered_type = rx_filter.counts[GMAC_RX_FILTER_TYPE];
+    taskEXIT_CRITICAL();
+}
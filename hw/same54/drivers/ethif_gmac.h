@@ -0,0 +1,56 @@
+/**
+ * \file ethif_gmac.h
+ * \brief SAME54 GMAC netif entry points beyond the common ethif_mac.h set
+ */
+
+#ifndef _ETHIF_GMAC_H_
+#define _ETHIF_GMAC_H_
+
+#include <stdint.h>
+#include "lwip/err.h"
+#include "lwip/netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t wakeups;           ///< GMAC task wakeups that found frames
+    uint32_t frames;            ///< Frames taken off the ring by them
+    uint32_t batch_max;         ///< Most frames in one wakeup
+    uint32_t empty;             ///< Wakeups that found none (transmit completions)
+    uint32_t budget_hits;       ///< Polls that used the whole GMAC_RX_BUDGET
+    uint32_t backlog_waits;     ///< Pauses for the tcpip thread to take a batch
+    uint32_t batches;           ///< Messages posted to the tcpip thread
+    uint32_t ring_peak;         ///< Most filled descriptors found on a wakeup
+    uint32_t spare_min;         ///< Fewest spare buffers left
+    uint32_t ring_full;         ///< Wakeups after the GMAC found no free descriptor (RSR.BNA)
+    uint32_t overruns;          ///< Wakeups after a receive FIFO overrun (RSR.RXOVR)
+    uint32_t priority;          ///< DoIP frames passed to lwIP
+    uint32_t shed;              ///< Other frames dropped to keep the reserve
+    uint32_t filtered_broadcast; ///< Broadcast not for ARP or a listed UDP port
+    uint32_t filtered_arp;      ///< Broadcast ARP about other hosts
+    uint32_t filtered_multicast; ///< Multicast to groups not joined
+    uint32_t filtered_type;     ///< Unicast neither IPv4 nor ARP
+} ethernetif_gmac_rx_stats_t;
+
+/**
+ * \brief Receive polling counters
+ */
+void ethernetif_gmac_rx_stats(ethernetif_gmac_rx_stats_t *stats);
+
+/**
+ * \brief Release transmitted frames and send queued ones; GMAC task only
+ */
+void ethernetif_gmac_tx_complete(struct netif *netif);
+
+/**
+ * \brief Transmit a raw Ethernet frame from a caller-owned buffer (copied)
+ */
+err_t ethernetif_gmac_write(struct netif *netif, const uint8_t *data, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _ETHIF_GMAC_H_
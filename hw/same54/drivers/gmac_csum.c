@@ -0,0 +1,86 @@
+/**
+ * \file gmac_csum.c
+ * \brief Software side of the GMAC checksum offload
+ */
+
+#include "gmac_csum.h"
+
+#define ETH_HEADER_LEN              14
+#define ETH_TYPE_IPV4               0x0800u
+#define IPV4_HEADER_MIN             20
+#define IPV4_FLAG_MF                0x2000u
+#define IPV4_OFFSET_MASK            0x1FFFu
+#define IP_PROTO_TCP                6
+#define IP_PROTO_UDP                17
+#define UDP_CHECKSUM_OFFSET         6
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+uint32_t gmac_csum_add(uint32_t sum, const uint8_t *data, uint32_t length)
+{
+    /* Frames are far below the 128 kB that could overflow 32 bits */
+    while (length > 1) {
+        sum += get_u16(data);
+        data += 2;
+        length -= 2;
+    }
+    if (length > 0) {
+        sum += (uint32_t)data[0] << 8;
+    }
+    return sum;
+}
+
+uint16_t gmac_csum_fold(uint32_t sum)
+{
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    sum = (sum & 0xFFFFu) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+gmac_csum_result_t gmac_csum_rx_check(const uint8_t *frame, uint32_t length, uint32_t hw_status)
+{
+    if (hw_status == GMAC_RX_CSUM_IP_TCP || hw_status == GMAC_RX_CSUM_IP_UDP) {
+        return GMAC_CSUM_HW;
+    }
+    if (length < ETH_HEADER_LEN + IPV4_HEADER_MIN || get_u16(&frame[12]) != ETH_TYPE_IPV4) {
+        return GMAC_CSUM_NOT_CHECKED;
+    }
+
+    const uint8_t *ip = &frame[ETH_HEADER_LEN];
+    uint32_t header_len = (ip[0] & 0x0Fu) * 4u;
+    uint32_t total_len = get_u16(&ip[2]);
+
+    if ((ip[0] >> 4) != 4 || header_len < IPV4_HEADER_MIN || total_len < header_len ||
+        ETH_HEADER_LEN + total_len > length) {
+        return GMAC_CSUM_BAD;
+    }
+    if (hw_status == GMAC_RX_CSUM_NONE && gmac_csum_fold(gmac_csum_add(0, ip, header_len)) != 0) {
+        return GMAC_CSUM_BAD;
+    }
+
+    uint8_t proto = ip[9];
+    if (proto != IP_PROTO_TCP && proto != IP_PROTO_UDP) {
+        /* lwIP checks ICMP and the rest itself */
+        return (hw_status == GMAC_RX_CSUM_NONE) ? GMAC_CSUM_SW : GMAC_CSUM_HW;
+    }
+    if (get_u16(&ip[6]) & (IPV4_FLAG_MF | IPV4_OFFSET_MASK)) {
+        return GMAC_CSUM_NOT_CHECKED;
+    }
+
+    const uint8_t *segment = &ip[header_len];
+    uint32_t segment_len = total_len - header_len;
+
+    /* A zero UDP checksum means the sender did not compute one */
+    if (proto == IP_PROTO_UDP && segment_len >= 8 && get_u16(&segment[UDP_CHECKSUM_OFFSET]) == 0) {
+        return GMAC_CSUM_SW;
+    }
+
+    /* Pseudo header: addresses, protocol, transport length */
+    uint32_t sum = gmac_csum_add(0, &ip[12], 8) + proto + segment_len;
+    sum = gmac_csum_add(sum, segment, segment_len);
+
+    return (gmac_csum_fold(sum) == 0) ? GMAC_CSUM_SW : GMAC_CSUM_BAD;
+}
@@ -0,0 +1,63 @@
+/**
+ * \file gmac_csum.h
+ * \brief Software side of the GMAC checksum offload
+ *
+ * With receive checksum offload on, the GMAC discards frames whose IPv4
+ * header, TCP or UDP checksum it found wrong and reports in the receive
+ * descriptor which of them it checked. The netif tells lwIP not to check
+ * these itself, so whatever the GMAC left unchecked (IP options it skips,
+ * frames it could not parse) is verified here in software before the
+ * frame goes up. Fragments can only be checked after reassembly and are
+ * passed on unverified.
+ *
+ * Plain buffer code with no hardware access, also built on the host
+ * (pc/bench).
+ */
+
+#ifndef _GMAC_CSUM_H_
+#define _GMAC_CSUM_H_
+
+#include <stdint.h>
+
+/* Receive descriptor checksum status (word 1, bits 23:22) with RXCOEN set */
+#define GMAC_RX_CSUM_NONE           0u  /* Nothing checked */
+#define GMAC_RX_CSUM_IP             1u  /* IPv4 header checksum correct */
+#define GMAC_RX_CSUM_IP_TCP         2u  /* ... and TCP checksum correct */
+#define GMAC_RX_CSUM_IP_UDP         3u  /* ... and UDP checksum correct */
+
+typedef enum
+{
+    GMAC_CSUM_HW = 0,           ///< Checked by the GMAC
+    GMAC_CSUM_SW,               ///< Checked here, correct
+    GMAC_CSUM_NOT_CHECKED,      ///< Not IPv4 TCP/UDP, or a fragment
+    GMAC_CSUM_BAD               ///< Checked here, wrong: drop the frame
+} gmac_csum_result_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * \brief Add \a length bytes to a 32-bit one's complement accumulator
+ */
+uint32_t gmac_csum_add(uint32_t sum, const uint8_t *data, uint32_t length);
+
+/**
+ * \brief Fold an accumulator into the 16-bit Internet checksum (complemented)
+ */
+uint16_t gmac_csum_fold(uint32_t sum);
+
+/**
+ * \brief Verify what the GMAC left unchecked in a received frame
+ * \param[in] frame Ethernet frame, starting at the destination address
+ * \param[in] length Frame length without FCS
+ * \param[in] hw_status GMAC_RX_CSUM_* from the receive descriptor
+ */
+gmac_csum_result_t gmac_csum_rx_check(const uint8_t *frame, uint32_t length, uint32_t hw_status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _GMAC_CSUM_H_
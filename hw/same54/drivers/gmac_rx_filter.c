@@ -0,0 +1,191 @@
+/**
+ * \file gmac_rx_filter.c
+ * \brief Receive frame filter in front of lwIP
+ */
+
+#include "gmac_rx_filter.h"
+#include <string.h>
+
+#define ETH_HEADER_LEN              14
+#define ETH_TYPE_IPV4               0x0800u
+#define ETH_TYPE_ARP                0x0806u
+#define ARP_LEN                     28
+#define ARP_SENDER_IP               14
+#define ARP_TARGET_IP               24
+#define IPV4_HEADER_MIN             20
+#define IPV4_OFFSET_MASK            0x1FFFu
+#define IP_PROTO_TCP                6
+#define IP_PROTO_UDP                17
+#define UDP_HEADER_LEN              8
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/* Destination address hash used by the GMAC: XOR of the eight 6-bit
+ * slices of the address, first bit received first */
+static uint32_t hash_index(const uint8_t mac[6])
+{
+    uint32_t index = 0;
+
+    for (uint32_t bit = 0; bit < 48; bit++) {
+        index ^= (uint32_t)((mac[bit / 8] >> (bit % 8)) & 1u) << (bit % 6);
+    }
+    return index;
+}
+
+static int group_find(const gmac_rx_filter_t *filter, const uint8_t mac[6])
+{
+    for (uint32_t i = 0; i < filter->group_count; i++) {
+        if (memcmp(filter->groups[i], mac, 6) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static gmac_rx_filter_result_t check_broadcast(const gmac_rx_filter_t *filter, const uint8_t *frame,
+                                               uint32_t length, uint32_t ip)
+{
+    uint16_t type = get_u16(&frame[12]);
+    const uint8_t *payload = &frame[ETH_HEADER_LEN];
+
+    if (type == ETH_TYPE_ARP) {
+        if (length < ETH_HEADER_LEN + ARP_LEN || ip == 0) {
+            return GMAC_RX_FILTER_PASS;
+        }
+        /* Requests for us, and announcements that refresh our cache */
+        if (memcmp(&payload[ARP_TARGET_IP], &ip, 4) == 0 ||
+            memcmp(&payload[ARP_TARGET_IP], &payload[ARP_SENDER_IP], 4) == 0) {
+            return GMAC_RX_FILTER_PASS;
+        }
+        return GMAC_RX_FILTER_ARP;
+    }
+
+    if (type != ETH_TYPE_IPV4 || length < ETH_HEADER_LEN + IPV4_HEADER_MIN || payload[9] != IP_PROTO_UDP ||
+        (get_u16(&payload[6]) & IPV4_OFFSET_MASK) != 0) {
+        return GMAC_RX_FILTER_BROADCAST;
+    }
+
+    uint32_t header_len = (payload[0] & 0x0Fu) * 4u;
+    if (length < ETH_HEADER_LEN + header_len + UDP_HEADER_LEN) {
+        return GMAC_RX_FILTER_BROADCAST;
+    }
+
+    uint16_t port = get_u16(&payload[header_len + 2]);
+    for (uint32_t i = 0; i < filter->port_count; i++) {
+        if (filter->ports[i] == port) {
+            return GMAC_RX_FILTER_PASS;
+        }
+    }
+    return GMAC_RX_FILTER_BROADCAST;
+}
+
+void gmac_rx_filter_init(gmac_rx_filter_t *filter)
+{
+    memset(filter, 0, sizeof(*filter));
+}
+
+bool gmac_rx_filter_add_port(gmac_rx_filter_t *filter, uint16_t port)
+{
+    for (uint32_t i = 0; i < filter->port_count; i++) {
+        if (filter->ports[i] == port) {
+            return true;
+        }
+    }
+    if (filter->port_count == GMAC_RX_FILTER_PORTS) {
+        return false;
+    }
+    filter->ports[filter->port_count++] = port;
+    return true;
+}
+
+bool gmac_rx_filter_join(gmac_rx_filter_t *filter, const uint8_t mac[6])
+{
+    int i = group_find(filter, mac);
+
+    if (i >= 0) {
+        filter->group_refs[i]++;
+        return true;
+    }
+    if (filter->group_count == GMAC_RX_FILTER_GROUPS) {
+        return false;
+    }
+    memcpy(filter->groups[filter->group_count], mac, 6);
+    filter->group_refs[filter->group_count] = 1;
+    filter->group_count++;
+    return true;
+}
+
+bool gmac_rx_filter_leave(gmac_rx_filter_t *filter, const uint8_t mac[6])
+{
+    int i = group_find(filter, mac);
+
+    if (i < 0) {
+        return false;
+    }
+    if (--filter->group_refs[i] == 0) {
+        uint32_t last = filter->group_count - 1;
+
+        memcpy(filter->groups[i], filter->groups[last], 6);
+        filter->group_refs[i] = filter->group_refs[last];
+        filter->group_count--;
+    }
+    return true;
+}
+
+void gmac_rx_filter_hash(const gmac_rx_filter_t *filter, uint32_t *bottom, uint32_t *top)
+{
+    *bottom = 0;
+    *top = 0;
+    for (uint32_t i = 0; i < filter->group_count; i++) {
+        uint32_t index = hash_index(filter->groups[i]);
+
+        if (index < 32) {
+            *bottom |= 1u << index;
+        } else {
+            *top |= 1u << (index - 32);
+        }
+    }
+}
+
+gmac_rx_filter_result_t gmac_rx_filter_check(gmac_rx_filter_t *filter, const uint8_t *frame, uint32_t length,
+                                             uint32_t ip)
+{
+    static const uint8_t broadcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    gmac_rx_filter_result_t result;
+
+    if (length < ETH_HEADER_LEN) {
+        /* Runts never pass the GMAC; let lwIP count anything odd */
+        result = GMAC_RX_FILTER_PASS;
+    } else if ((frame[0] & 0x01u) == 0) {
+        uint16_t type = get_u16(&frame[12]);
+        result = (type == ETH_TYPE_IPV4 || type == ETH_TYPE_ARP) ? GMAC_RX_FILTER_PASS : GMAC_RX_FILTER_TYPE;
+    } else if (memcmp(frame, broadcast, 6) == 0) {
+        result = check_broadcast(filter, frame, length, ip);
+    } else if (group_find(filter, frame) < 0) {
+        result = GMAC_RX_FILTER_MULTICAST;
+    } else {
+        result = GMAC_RX_FILTER_PASS;
+    }
+
+    filter->counts[result]++;
+    return result;
+}
+
+bool gmac_rx_filter_priority(const uint8_t *frame, uint32_t length, uint16_t port)
+{
+    const uint8_t *ip = &frame[ETH_HEADER_LEN];
+
+    if (length < ETH_HEADER_LEN + IPV4_HEADER_MIN || get_u16(&frame[12]) != ETH_TYPE_IPV4 ||
+        (ip[9] != IP_PROTO_TCP && ip[9] != IP_PROTO_UDP) || (get_u16(&ip[6]) & IPV4_OFFSET_MASK) != 0) {
+        return false;
+    }
+
+    uint32_t header_len = (ip[0] & 0x0Fu) * 4u;
+    if (length < ETH_HEADER_LEN + header_len + 4) {
+        return false;
+    }
+    return get_u16(&ip[header_len]) == port || get_u16(&ip[header_len + 2]) == port;
+}
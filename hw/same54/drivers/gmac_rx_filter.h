@@ -0,0 +1,99 @@
+/**
+ * \file gmac_rx_filter.h
+ * \brief Receive frame filter in front of lwIP
+ *
+ * The GMAC address filter already passes only our unicast address,
+ * broadcast, and multicast whose 6-bit address hash is set in the hash
+ * register. Broadcast cannot be narrowed in hardware (NBC drops all of
+ * it, ARP included) and the hash lets unrelated groups through, so the
+ * GMAC task runs every frame through this filter before handing it to
+ * lwIP. It keeps:
+ *   - unicast IPv4 and ARP
+ *   - broadcast ARP about our address (or any, while we have none)
+ *   - broadcast IPv4 UDP to one of the configured ports
+ *   - multicast to a joined group
+ * and counts the rest by the rule that dropped it. The joined groups also
+ * give the hash register contents. gmac_rx_filter_priority() picks out
+ * the DoIP frames among those that pass.
+ *
+ * Plain buffer code with no hardware access, also built on the host
+ * (pc/bench).
+ */
+
+#ifndef _GMAC_RX_FILTER_H_
+#define _GMAC_RX_FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GMAC_RX_FILTER_PORTS        4
+#define GMAC_RX_FILTER_GROUPS       8
+
+typedef enum
+{
+    GMAC_RX_FILTER_PASS = 0,
+    GMAC_RX_FILTER_BROADCAST,   ///< Broadcast other than ARP or a listed UDP port
+    GMAC_RX_FILTER_ARP,         ///< Broadcast ARP about another host
+    GMAC_RX_FILTER_MULTICAST,   ///< Group not joined (hash collision)
+    GMAC_RX_FILTER_TYPE,        ///< Neither IPv4 nor ARP
+    GMAC_RX_FILTER_RESULTS
+} gmac_rx_filter_result_t;
+
+typedef struct
+{
+    uint16_t ports[GMAC_RX_FILTER_PORTS];       ///< UDP ports open to broadcast
+    uint32_t port_count;
+    uint8_t groups[GMAC_RX_FILTER_GROUPS][6];   ///< Joined multicast addresses
+    uint8_t group_refs[GMAC_RX_FILTER_GROUPS];
+    uint32_t group_count;
+    uint32_t counts[GMAC_RX_FILTER_RESULTS];    ///< Frames per result
+} gmac_rx_filter_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void gmac_rx_filter_init(gmac_rx_filter_t *filter);
+
+/**
+ * \brief Accept broadcast IPv4 UDP datagrams to \a port
+ * \return false if GMAC_RX_FILTER_PORTS ports are already listed
+ */
+bool gmac_rx_filter_add_port(gmac_rx_filter_t *filter, uint16_t port);
+
+/**
+ * \brief Join or leave a multicast group; joins are counted
+ * \return false if the table is full, or on leave if the group was not joined
+ */
+bool gmac_rx_filter_join(gmac_rx_filter_t *filter, const uint8_t mac[6]);
+bool gmac_rx_filter_leave(gmac_rx_filter_t *filter, const uint8_t mac[6]);
+
+/**
+ * \brief GMAC hash register contents for the joined groups
+ * \param[out] bottom HRB, hash values 0..31
+ * \param[out] top HRT, hash values 32..63
+ */
+void gmac_rx_filter_hash(const gmac_rx_filter_t *filter, uint32_t *bottom, uint32_t *top);
+
+/**
+ * \brief Classify a received frame and count the result
+ * \param[in] frame Ethernet frame, starting at the destination address
+ * \param[in] length Frame length without FCS
+ * \param[in] ip Our IPv4 address as it lies in memory (network order), 0 if none
+ */
+gmac_rx_filter_result_t gmac_rx_filter_check(gmac_rx_filter_t *filter, const uint8_t *frame, uint32_t length,
+                                             uint32_t ip);
+
+/**
+ * \brief Check for IPv4 TCP or UDP from or to \a port
+ * \param[in] frame Ethernet frame, starting at the destination address
+ * \param[in] length Frame length without FCS
+ */
+bool gmac_rx_filter_priority(const uint8_t *frame, uint32_t length, uint16_t port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _GMAC_RX_FILTER_H_
@@ -0,0 +1,133 @@
+/**
+ * \file gmac_rx_ring.c
+ * \brief GMAC receive descriptor ring with loanable buffers
+ */
+
+#include "gmac_rx_ring.h"
+#include <stddef.h>
+
+/* Orders buffer and descriptor accesses against the GMAC's DMA (DMB on Cortex-M) */
+#define GMAC_RX_BARRIER()           __sync_synchronize()
+
+/* Give descriptor \a index, with the buffer in its slot, back to the GMAC */
+static void desc_give(gmac_rx_ring_t *ring, uint32_t index)
+{
+    gmac_rx_desc_t *desc = &ring->descs[index];
+    uint32_t wrap = (index == ring->count - 1) ? GMAC_RX_ADDR_WRAP : 0;
+
+    desc->status = 0;
+    GMAC_RX_BARRIER();
+    /* Ownership bit clear: the GMAC may fill the buffer again */
+    desc->addr = ((uint32_t)(uintptr_t)ring->slots[index] & GMAC_RX_ADDR_MASK) | wrap;
+}
+
+void gmac_rx_ring_init(gmac_rx_ring_t *ring, gmac_rx_desc_t *descs, uint8_t **slots, uint32_t count,
+                       uint8_t **spares, uint8_t *buffers, uint32_t buffer_size, uint32_t buffer_count)
+{
+    ring->descs = descs;
+    ring->slots = slots;
+    ring->count = count;
+    ring->head = 0;
+    ring->spares = spares;
+    ring->spare_count = 0;
+    ring->frames = 0;
+    ring->loaned = 0;
+    ring->errors = 0;
+    ring->occupancy_max = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        slots[i] = &buffers[i * buffer_size];
+        desc_give(ring, i);
+    }
+    for (uint32_t i = count; i < buffer_count; i++) {
+        spares[ring->spare_count++] = &buffers[i * buffer_size];
+    }
+    ring->spare_min = ring->spare_count;
+}
+
+bool gmac_rx_ring_take(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame)
+{
+    for (;;) {
+        uint32_t index = ring->head;
+        gmac_rx_desc_t *desc = &ring->descs[index];
+
+        if ((desc->addr & GMAC_RX_ADDR_OWNERSHIP) == 0) {
+            return false;
+        }
+        GMAC_RX_BARRIER();
+
+        uint32_t status = desc->status;
+        ring->head = (index + 1 == ring->count) ? 0 : index + 1;
+
+        /* Buffers are sized for a whole frame; anything spread over several
+         * descriptors (or the rest of such a frame) is dropped piece by piece */
+        if ((status & (GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF)) != (GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF)) {
+            ring->errors++;
+            desc_give(ring, index);
+            continue;
+        }
+
+        frame->buffer = ring->slots[index];
+        frame->length = status & GMAC_RX_STATUS_LEN_MASK;
+        frame->index = index;
+        frame->checksum = (status & GMAC_RX_STATUS_CSUM_MASK) >> GMAC_RX_STATUS_CSUM_SHIFT;
+        frame->loaned = false;
+        ring->frames++;
+        return true;
+    }
+}
+
+bool gmac_rx_ring_lend(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame, uint32_t keep)
+{
+    if (ring->spare_count <= keep) {
+        return false;
+    }
+
+    ring->slots[frame->index] = ring->spares[--ring->spare_count];
+    if (ring->spare_count < ring->spare_min) {
+        ring->spare_min = ring->spare_count;
+    }
+    desc_give(ring, frame->index);
+    frame->loaned = true;
+    ring->loaned++;
+    return true;
+}
+
+bool gmac_rx_ring_poll(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame)
+{
+    if (!gmac_rx_ring_take(ring, frame)) {
+        return false;
+    }
+    gmac_rx_ring_lend(ring, frame, 0);
+    return true;
+}
+
+bool gmac_rx_ring_pending(const gmac_rx_ring_t *ring)
+{
+    return (ring->descs[ring->head].addr & GMAC_RX_ADDR_OWNERSHIP) != 0;
+}
+
+uint32_t gmac_rx_ring_occupancy(gmac_rx_ring_t *ring)
+{
+    uint32_t filled = 0;
+    uint32_t index = ring->head;
+
+    while (filled < ring->count && (ring->descs[index].addr & GMAC_RX_ADDR_OWNERSHIP)) {
+        filled++;
+        index = (index + 1 == ring->count) ? 0 : index + 1;
+    }
+    if (filled > ring->occupancy_max) {
+        ring->occupancy_max = filled;
+    }
+    return filled;
+}
+
+void gmac_rx_ring_return(gmac_rx_ring_t *ring, const gmac_rx_frame_t *frame)
+{
+    desc_give(ring, frame->index);
+}
+
+void gmac_rx_ring_free(gmac_rx_ring_t *ring, uint8_t *buffer)
+{
+    ring->spares[ring->spare_count++] = buffer;
+}
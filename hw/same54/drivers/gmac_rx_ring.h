@@ -0,0 +1,137 @@
+/**
+ * \file gmac_rx_ring.h
+ * \brief GMAC receive descriptor ring with loanable buffers
+ *
+ * Every receive buffer holds a whole frame. A completed frame's buffer is
+ * lent out as it is (the netif wraps it in a pbuf_custom) and the
+ * descriptor is refilled at once from a pool of spare buffers, so the
+ * GMAC never waits on lwIP. The buffer returns to the spare pool when
+ * lwIP frees the pbuf. With no spare left, the frame stays in the ring
+ * and is handed back after the caller has copied it out.
+ *
+ * gmac_rx_ring_poll() lends whenever it can. gmac_rx_ring_take() and
+ * gmac_rx_ring_lend() split the two steps, so the caller can look at the
+ * frame first and keep the last spares for traffic that matters more.
+ *
+ * No hardware access apart from the descriptors themselves, so the ring
+ * also runs against a simulated GMAC on the host (pc/bench). Calls are
+ * not reentrant; the caller serializes them, including
+ * gmac_rx_ring_free() from pbuf free callbacks.
+ */
+
+#ifndef _GMAC_RX_RING_H_
+#define _GMAC_RX_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Receive descriptor word 0 */
+#define GMAC_RX_ADDR_OWNERSHIP      (1u << 0)   /* Set by the GMAC when the buffer holds data */
+#define GMAC_RX_ADDR_WRAP           (1u << 1)   /* Last descriptor of the ring */
+#define GMAC_RX_ADDR_MASK           0xFFFFFFFCu
+
+/* Receive descriptor word 1 */
+#define GMAC_RX_STATUS_LEN_MASK     0x1FFFu
+#define GMAC_RX_STATUS_SOF          (1u << 14)
+#define GMAC_RX_STATUS_EOF          (1u << 15)
+#define GMAC_RX_STATUS_CSUM_SHIFT   22          /* Checksum offload status, see gmac_csum.h */
+#define GMAC_RX_STATUS_CSUM_MASK    (3u << GMAC_RX_STATUS_CSUM_SHIFT)
+
+typedef struct
+{
+    volatile uint32_t addr;
+    volatile uint32_t status;
+} gmac_rx_desc_t;
+
+typedef struct
+{
+    gmac_rx_desc_t *descs;      ///< Descriptor ring, handed to the GMAC (RBQB)
+    uint8_t **slots;            ///< Buffer currently attached to each descriptor
+    uint32_t count;             ///< Descriptors in the ring
+    uint32_t head;              ///< Next descriptor to inspect
+    uint8_t **spares;           ///< Stack of buffers not attached to a descriptor
+    uint32_t spare_count;
+    uint32_t spare_min;         ///< Lowest spare_count seen
+    uint32_t occupancy_max;     ///< Most filled descriptors seen by gmac_rx_ring_occupancy()
+    uint32_t frames;            ///< Frames returned by gmac_rx_ring_poll()
+    uint32_t loaned;            ///< ... of which were lent out without a copy
+    uint32_t errors;            ///< Descriptors dropped for not holding a whole frame
+} gmac_rx_ring_t;
+
+typedef struct
+{
+    uint8_t *buffer;            ///< Start of the receive buffer
+    uint32_t length;            ///< Frame length reported by the GMAC
+    uint32_t index;             ///< Descriptor the frame was received on
+    uint32_t checksum;          ///< GMAC_RX_CSUM_* checksum offload status
+    bool loaned;                ///< Buffer detached, release with gmac_rx_ring_free()
+} gmac_rx_frame_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * \brief Attach buffers to the descriptors and keep the rest as spares
+ * \param[out] ring Ring state
+ * \param[in] descs Descriptor array, 8-byte aligned for the GMAC
+ * \param[in] slots Array of \a count buffer pointers
+ * \param[in] count Number of descriptors
+ * \param[in] spares Array of \a buffer_count - \a count buffer pointers
+ * \param[in] buffers \a buffer_count contiguous buffers of \a buffer_size bytes
+ */
+void gmac_rx_ring_init(gmac_rx_ring_t *ring, gmac_rx_desc_t *descs, uint8_t **slots, uint32_t count,
+                       uint8_t **spares, uint8_t *buffers, uint32_t buffer_size, uint32_t buffer_count);
+
+/**
+ * \brief Take the next received frame
+ * \param[out] frame Received frame
+ * \return true if a frame was returned. If frame->loaned is false the
+ *         descriptor is still held and must be handed back with
+ *         gmac_rx_ring_return() once the data has been copied.
+ */
+bool gmac_rx_ring_poll(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame);
+
+/**
+ * \brief Take the next received frame without lending it
+ * \return true if a frame was returned; its descriptor is held until
+ *         gmac_rx_ring_lend() succeeds or gmac_rx_ring_return()
+ */
+bool gmac_rx_ring_take(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame);
+
+/**
+ * \brief Lend a taken frame's buffer if more than \a keep spares are left
+ * \return frame->loaned
+ */
+bool gmac_rx_ring_lend(gmac_rx_ring_t *ring, gmac_rx_frame_t *frame, uint32_t keep);
+
+/**
+ * \brief Check for a received frame without taking it
+ */
+bool gmac_rx_ring_pending(const gmac_rx_ring_t *ring);
+
+/**
+ * \brief Count the filled descriptors waiting from the head on, and keep the maximum
+ *
+ * Sampled when the GMAC task wakes up, this is how much of the ring a
+ * burst used while the task was held off; at \a count the GMAC is
+ * dropping frames.
+ */
+uint32_t gmac_rx_ring_occupancy(gmac_rx_ring_t *ring);
+
+/**
+ * \brief Hand a frame that was not lent out back to the GMAC
+ */
+void gmac_rx_ring_return(gmac_rx_ring_t *ring, const gmac_rx_frame_t *frame);
+
+/**
+ * \brief Return a lent buffer to the spare pool
+ */
+void gmac_rx_ring_free(gmac_rx_ring_t *ring, uint8_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _GMAC_RX_RING_H_
@@ -0,0 +1,159 @@
+/**
+ * \file gmac_tx_ring.c
+ * \brief GMAC scatter-gather transmit descriptor ring
+ */
+
+#include "gmac_tx_ring.h"
+#include <stddef.h>
+
+/* Orders buffer and descriptor accesses against the GMAC's DMA (DMB on Cortex-M) */
+#define GMAC_TX_BARRIER()           __sync_synchronize()
+
+static uint32_t ring_next(const gmac_tx_ring_t *ring, uint32_t index)
+{
+    return (index + 1 == ring->count) ? 0 : index + 1;
+}
+
+static uint32_t ring_wrap(const gmac_tx_ring_t *ring, uint32_t index)
+{
+    return (index == ring->count - 1) ? GMAC_TX_STATUS_WRAP : 0;
+}
+
+/* Write the descriptors of one frame; the caller has checked there is room */
+static void ring_put(gmac_tx_ring_t *ring, void *frame, const gmac_tx_segment_t *segments, uint32_t n)
+{
+    uint32_t first = ring->head;
+
+    /* Back to front: the GMAC stops at the still software-owned first
+     * descriptor, so it never sees part of a frame */
+    for (uint32_t i = n; i-- > 0;) {
+        uint32_t index = (first + i) % ring->count;
+        uint32_t status = (segments[i].length & GMAC_TX_STATUS_LEN_MASK) | ring_wrap(ring, index);
+
+        if (i == n - 1) {
+            status |= GMAC_TX_STATUS_LAST;
+        }
+        ring->descs[index].addr = (uint32_t)(uintptr_t)segments[i].data;
+        if (i == 0) {
+            GMAC_TX_BARRIER();
+        }
+        ring->descs[index].status = status;
+    }
+
+    ring->owners[first] = frame;
+    ring->head = (first + n) % ring->count;
+    ring->busy += n;
+    if (ring->busy > ring->busy_max) {
+        ring->busy_max = ring->busy;
+    }
+    ring->frames++;
+}
+
+void gmac_tx_ring_init(gmac_tx_ring_t *ring, gmac_tx_desc_t *descs, void **owners, uint32_t count,
+                       void **pending, uint32_t pending_size, gmac_tx_segments_fn segments)
+{
+    ring->descs = descs;
+    ring->owners = owners;
+    ring->count = count;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->busy = 0;
+    ring->pending = pending;
+    ring->pending_size = pending_size;
+    ring->pending_head = 0;
+    ring->pending_count = 0;
+    ring->segments = segments;
+    ring->frames = 0;
+    ring->queued = 0;
+    ring->overflows = 0;
+    ring->errors = 0;
+    ring->busy_max = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        descs[i].addr = 0;
+        descs[i].status = GMAC_TX_STATUS_USED | ring_wrap(ring, i);
+        owners[i] = NULL;
+    }
+}
+
+gmac_tx_result_t gmac_tx_ring_send(gmac_tx_ring_t *ring, void *frame)
+{
+    gmac_tx_segment_t segments[GMAC_TX_MAX_SEGMENTS];
+    uint32_t n = ring->segments(frame, segments, GMAC_TX_MAX_SEGMENTS);
+
+    if (n == 0 || n > ring->count) {
+        return GMAC_TX_INVALID;
+    }
+
+    /* Frames already waiting go first */
+    if (ring->pending_count == 0 && n <= ring->count - ring->busy) {
+        ring_put(ring, frame, segments, n);
+        return GMAC_TX_SENT;
+    }
+
+    if (ring->pending_count == ring->pending_size) {
+        ring->overflows++;
+        return GMAC_TX_FULL;
+    }
+    ring->pending[(ring->pending_head + ring->pending_count) % ring->pending_size] = frame;
+    ring->pending_count++;
+    ring->queued++;
+    return GMAC_TX_QUEUED;
+}
+
+uint32_t gmac_tx_ring_reclaim(gmac_tx_ring_t *ring, void **done, uint32_t max)
+{
+    uint32_t frames = 0;
+
+    while (frames < max && ring->busy > 0) {
+        uint32_t first = ring->tail;
+        uint32_t status = ring->descs[first].status;
+
+        if ((status & GMAC_TX_STATUS_USED) == 0) {
+            break;
+        }
+        GMAC_TX_BARRIER();
+
+        if (status & GMAC_TX_STATUS_ERRORS) {
+            ring->errors++;
+        }
+
+        /* The GMAC only sets the used bit of the first descriptor of a
+         * frame; mark the rest and find the end from the last-buffer bit */
+        uint32_t index = first;
+        bool last;
+        do {
+            last = (ring->descs[index].status & GMAC_TX_STATUS_LAST) != 0;
+            ring->descs[index].status = GMAC_TX_STATUS_USED | ring_wrap(ring, index);
+            index = ring_next(ring, index);
+            ring->busy--;
+        } while (!last && ring->busy > 0);
+
+        ring->tail = index;
+        done[frames++] = ring->owners[first];
+        ring->owners[first] = NULL;
+    }
+
+    return frames;
+}
+
+bool gmac_tx_ring_refill(gmac_tx_ring_t *ring)
+{
+    gmac_tx_segment_t segments[GMAC_TX_MAX_SEGMENTS];
+    bool written = false;
+
+    while (ring->pending_count > 0) {
+        void *frame = ring->pending[ring->pending_head];
+        uint32_t n = ring->segments(frame, segments, GMAC_TX_MAX_SEGMENTS);
+
+        if (n > ring->count - ring->busy) {
+            break;
+        }
+        ring_put(ring, frame, segments, n);
+        ring->pending_head = (ring->pending_head + 1) % ring->pending_size;
+        ring->pending_count--;
+        written = true;
+    }
+
+    return written;
+}
@@ -0,0 +1,125 @@
+/**
+ * \file gmac_tx_ring.h
+ * \brief GMAC scatter-gather transmit descriptor ring
+ *
+ * Each frame is a list of segments (the payloads of a pbuf chain), one
+ * descriptor per segment with the last-buffer bit on the tail, so frames
+ * go out without being copied. The frame handle stays with the ring
+ * until the GMAC has sent it and gmac_tx_ring_reclaim() hands it back to
+ * be released. A frame that does not fit in the free descriptors waits
+ * in a FIFO and goes out from gmac_tx_ring_refill() once earlier frames
+ * complete.
+ *
+ * No hardware access apart from the descriptors themselves, so the ring
+ * also runs against a simulated GMAC on the host (pc/bench). Calls are
+ * not reentrant; the caller serializes them.
+ */
+
+#ifndef _GMAC_TX_RING_H_
+#define _GMAC_TX_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Transmit descriptor word 1 */
+#define GMAC_TX_STATUS_LEN_MASK     0x3FFFu
+#define GMAC_TX_STATUS_LAST         (1u << 15)  /* Last buffer of the frame */
+#define GMAC_TX_STATUS_LATE_COLL    (1u << 26)
+#define GMAC_TX_STATUS_AHB_ERROR    (1u << 27)
+#define GMAC_TX_STATUS_RETRY_LIMIT  (1u << 29)
+#define GMAC_TX_STATUS_WRAP         (1u << 30)  /* Last descriptor of the ring */
+#define GMAC_TX_STATUS_USED         (1u << 31)  /* Owned by software; set by the GMAC when sent */
+
+#define GMAC_TX_STATUS_ERRORS       (GMAC_TX_STATUS_LATE_COLL | GMAC_TX_STATUS_AHB_ERROR | GMAC_TX_STATUS_RETRY_LIMIT)
+
+/* Most segments one frame may have */
+#define GMAC_TX_MAX_SEGMENTS        8
+
+typedef struct
+{
+    volatile uint32_t addr;
+    volatile uint32_t status;
+} gmac_tx_desc_t;
+
+typedef struct
+{
+    const void *data;
+    uint32_t length;
+} gmac_tx_segment_t;
+
+/**
+ * \brief Describe \a frame as segments
+ * \return Number of segments, 0 if the frame needs more than \a max
+ */
+typedef uint32_t (*gmac_tx_segments_fn)(void *frame, gmac_tx_segment_t *segments, uint32_t max);
+
+typedef enum
+{
+    GMAC_TX_SENT = 0,           ///< Descriptors written, start transmission
+    GMAC_TX_QUEUED,             ///< Waiting for descriptors, the ring keeps the frame
+    GMAC_TX_FULL,               ///< Queue full, the caller keeps the frame
+    GMAC_TX_INVALID             ///< Too many segments, the caller keeps the frame
+} gmac_tx_result_t;
+
+typedef struct
+{
+    gmac_tx_desc_t *descs;      ///< Descriptor ring, handed to the GMAC (TBQB)
+    void **owners;              ///< Frame on each first descriptor, NULL otherwise
+    uint32_t count;             ///< Descriptors in the ring
+    uint32_t head;              ///< Next descriptor to fill
+    uint32_t tail;              ///< Oldest descriptor in flight
+    uint32_t busy;              ///< Descriptors in flight
+    void **pending;             ///< Frames waiting for descriptors
+    uint32_t pending_size;
+    uint32_t pending_head;
+    uint32_t pending_count;
+    gmac_tx_segments_fn segments;
+    uint32_t frames;            ///< Frames handed to the GMAC
+    uint32_t queued;            ///< ... of which waited for descriptors
+    uint32_t overflows;         ///< Frames refused with GMAC_TX_FULL
+    uint32_t errors;            ///< Frames the GMAC reported an error for
+    uint32_t busy_max;          ///< Most descriptors in flight at once
+} gmac_tx_ring_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * \brief Mark every descriptor as software-owned and empty the queue
+ * \param[out] ring Ring state
+ * \param[in] descs Descriptor array, 8-byte aligned for the GMAC
+ * \param[in] owners Array of \a count frame pointers
+ * \param[in] count Number of descriptors
+ * \param[in] pending Array of \a pending_size frame pointers
+ * \param[in] segments Describes a frame as segments
+ */
+void gmac_tx_ring_init(gmac_tx_ring_t *ring, gmac_tx_desc_t *descs, void **owners, uint32_t count,
+                       void **pending, uint32_t pending_size, gmac_tx_segments_fn segments);
+
+/**
+ * \brief Send a frame, or queue it behind frames still waiting
+ * \return GMAC_TX_SENT if the caller has to start transmission
+ */
+gmac_tx_result_t gmac_tx_ring_send(gmac_tx_ring_t *ring, void *frame);
+
+/**
+ * \brief Take back descriptors of frames the GMAC has sent
+ * \param[out] done Frames to release, oldest first
+ * \param[in] max Size of \a done
+ * \return Number of frames in \a done; call again if it equals \a max
+ */
+uint32_t gmac_tx_ring_reclaim(gmac_tx_ring_t *ring, void **done, uint32_t max);
+
+/**
+ * \brief Move queued frames into free descriptors
+ * \return true if any frame was written and transmission has to be started
+ */
+bool gmac_tx_ring_refill(gmac_tx_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _GMAC_TX_RING_H_
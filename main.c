@@ -42,12 +42,19 @@
 #include "eth_ipstack_main.h"
 #include "webserver_tasks.h"
 #include "doip_client.h" 
+#include "doip_telemetry.h"
+#include "dlog.h"
+#include "sys_stats.h"
+#include "net_stats.h"
+#include "housekeeping.h"
+#include "rtos_heap.h"
+#include "rtt_printf.h"
+#include "bsp_timestamp.h"
+#include "bsp_dma_copy.h"
 #include "bsp_net.h"  // New universal network driver
 #include "FreeRTOS.h"
 #include "task.h"
 
-/* RTT printf integration */
-extern void rtt_printf_init(void);
 
 /* Peripheral descriptors */
 struct mac_async_descriptor COMMUNICATION_IO;
@@ -68,12 +75,12 @@ void print_ipaddress(void)
 	printf("GATEWAY_IP : %s\r\n", ipaddr_ntoa_r((const ip_addr_t *)&(TCPIP_STACK_INTERFACE_0_desc.gw), tmp_buff, 16));
 }
 
-// Network initialization task - runs after scheduler starts
-static void network_init_task(void *pvParameters)
+// Network initialization - one-shot housekeeping job, runs after scheduler starts
+static uint32_t network_init_job(void *arg)
 {
-	(void)pvParameters;
+	(void)arg;
 	
-	printf("Network initialization task started\r\n");
+	printf("Network initialization started\r\n");
 	
 	// Configure network parameters
 	drv_net_config_t net_config = {
@@ -91,25 +98,28 @@ static void network_init_task(void *pvParameters)
 	drv_net_status_t net_result = hw_net_init(&lwip_network_0);
 	if (net_result != DRV_NET_STATUS_OK) {
 		printf("Network initialization failed: %d\r\n", net_result);
-		vTaskDelete(NULL);
-		return;
+		rtt_printf_flush();
+		return HOUSEKEEPING_DONE;
 	}
 	
 	net_result = hw_net_start(&lwip_network_0, &net_config);
 	if (net_result != DRV_NET_STATUS_OK) {
 		printf("Network start failed: %d\r\n", net_result);
-		vTaskDelete(NULL);
-		return;
+		rtt_printf_flush();
+		return HOUSEKEEPING_DONE;
 	}
 	
 	printf("Network stack initialized successfully\r\n");
 	
 	// Start DOIP client now that network is ready
 	doip_client_start_task();
+
+	// Heap use once every start-up allocation has been made
+	rtos_heap_report();
 	
-	// This task is done, delete itself
-	printf("Network initialization complete, deleting init task\r\n");
-	vTaskDelete(NULL);
+	printf("Network initialization complete\r\n");
+	rtt_printf_flush();
+	return HOUSEKEEPING_DONE;
 }
 
 /*
@@ -140,24 +150,39 @@ int main(void)
 	/* Initialize SEGGER RTT for debug output */
 	rtt_printf_init();
 
+	/* Start the timestamp counter used for DOIP latency histograms */
+	bsp_timestamp_init();
+
+	/* DMAC channels for large buffer copies (CPU copies on the host and QEMU) */
+	bsp_dma_copy_init();
+
+	/* Drain task for the deferred hot-path log */
+	dlog_start();
+
+	/* One task runs the link monitor, LED, console, stats and network start */
+	housekeeping_start();
+
 	/* Initialize DOIP client */
 	doip_client_init();
 
+	/* Console commands for dumping the latency histograms */
+	doip_telemetry_start();
+
+	/* Periodic per-task CPU load and stack high-water records */
+	sys_stats_start();
+
+	/* Periodic MAC and lwIP counter records */
+	net_stats_start();
+
 	/* Create application tasks */
 	task_led_create();
 	
 	/* Start Ethernet link monitoring through driver API */
 	hw_eth_start_link_monitor(&eth_communication);
 
-	/* Create network initialization task that will start DOIP client */
-	if (xTaskCreate(network_init_task,
-	                "NetInit",
-	                512,  // Stack size
-	                NULL,
-	                (tskIDLE_PRIORITY + 3),  // Higher priority to run first
-	                NULL)
-	    != pdPASS) {
-		printf("Failed to create network initialization task\r\n");
+	/* One-shot network initialization that will start DOIP client */
+	if (housekeeping_add("NetInit", network_init_job, NULL, 0) == NULL) {
+		printf("Failed to schedule network initialization\r\n");
 		while (1);
 	}
 
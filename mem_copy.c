@@ -0,0 +1,232 @@
+/**
+ * \file mem_copy.c
+ * \brief Word-wise memcpy/memmove/memset for the Cortex-M4
+ *
+ * Copies align the destination first; the GMAC and pbuf buffers on the
+ * receiving side of most copies are word aligned already. When the
+ * source then turns out aligned as well, 32-byte blocks go through
+ * LDMIA/STMIA (one cycle per word after the first); otherwise each word
+ * is loaded unaligned and stored aligned. Trailing bytes are copied one
+ * by one.
+ */
+
+#include "mem_copy.h"
+
+/* Blocks below this are not worth aligning for */
+#define MEM_COPY_WORD_MIN           8
+#define MEM_COPY_BLOCK              32
+
+#if defined(__arm__) && defined(__thumb2__)
+#define MEM_COPY_LDM                1
+#else
+#define MEM_COPY_LDM                0
+#endif
+
+/* Word access at any address; the M4 splits unaligned LDR/STR in hardware */
+typedef uint32_t __attribute__((aligned(1), may_alias)) mem_word_unaligned_t;
+typedef uint32_t __attribute__((may_alias)) mem_word_t;
+
+/* Keep GCC from recognising the byte loops as memcpy/memset and calling
+ * them, which with MEM_COPY_LIBC would be these functions again */
+#define MEM_COPY_NO_LIBCALL         __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+static inline uint32_t misalignment(const void *p)
+{
+    return (uint32_t)((uintptr_t)p & 3u);
+}
+
+/* Whole 32-byte blocks between word-aligned buffers */
+static inline void copy_blocks(uint8_t **dst, const uint8_t **src, size_t blocks)
+{
+#if MEM_COPY_LDM
+    uint8_t *d = *dst;
+    const uint8_t *s = *src;
+
+    __asm__ volatile(
+        "1:                                 \n"
+        "   ldmia   %[s]!, {r3, r4, r5, r6} \n"
+        "   stmia   %[d]!, {r3, r4, r5, r6} \n"
+        "   ldmia   %[s]!, {r3, r4, r5, r6} \n"
+        "   stmia   %[d]!, {r3, r4, r5, r6} \n"
+        "   subs    %[n], %[n], #1          \n"
+        "   bne     1b                      \n"
+        : [d] "+r"(d), [s] "+r"(s), [n] "+r"(blocks)
+        :
+        : "r3", "r4", "r5", "r6", "cc", "memory");
+    *dst = d;
+    *src = s;
+#else
+    mem_word_t *d = (mem_word_t *)*dst;
+    const mem_word_t *s = (const mem_word_t *)*src;
+
+    while (blocks-- > 0) {
+        d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+        d[4] = s[4]; d[5] = s[5]; d[6] = s[6]; d[7] = s[7];
+        d += 8;
+        s += 8;
+    }
+    *dst = (uint8_t *)d;
+    *src = (const uint8_t *)s;
+#endif
+}
+
+MEM_COPY_NO_LIBCALL
+void *mem_copy(void *restrict dst, const void *restrict src, size_t len)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if (len >= MEM_COPY_WORD_MIN) {
+        while (misalignment(d) != 0) {
+            *d++ = *s++;
+            len--;
+        }
+
+        if (misalignment(s) == 0) {
+            if (len >= MEM_COPY_BLOCK) {
+                copy_blocks(&d, &s, len / MEM_COPY_BLOCK);
+                len %= MEM_COPY_BLOCK;
+            }
+            while (len >= 4) {
+                *(mem_word_t *)d = *(const mem_word_t *)s;
+                d += 4;
+                s += 4;
+                len -= 4;
+            }
+        } else {
+            while (len >= 16) {
+                uint32_t w0 = ((const mem_word_unaligned_t *)s)[0];
+                uint32_t w1 = ((const mem_word_unaligned_t *)s)[1];
+                uint32_t w2 = ((const mem_word_unaligned_t *)s)[2];
+                uint32_t w3 = ((const mem_word_unaligned_t *)s)[3];
+
+                ((mem_word_t *)d)[0] = w0;
+                ((mem_word_t *)d)[1] = w1;
+                ((mem_word_t *)d)[2] = w2;
+                ((mem_word_t *)d)[3] = w3;
+                d += 16;
+                s += 16;
+                len -= 16;
+            }
+            while (len >= 4) {
+                *(mem_word_t *)d = *(const mem_word_unaligned_t *)s;
+                d += 4;
+                s += 4;
+                len -= 4;
+            }
+        }
+    }
+
+    while (len-- > 0) {
+        *d++ = *s++;
+    }
+    return dst;
+}
+
+MEM_COPY_NO_LIBCALL
+void *mem_move(void *dst, const void *src, size_t len)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    /* Forward copies read every word before the store that could reach it */
+    if ((uintptr_t)d - (uintptr_t)s >= len) {
+        return mem_copy(dst, src, len);
+    }
+
+    /* Destination above an overlapping source: copy from the end down */
+    d += len;
+    s += len;
+    if (len >= MEM_COPY_WORD_MIN) {
+        while (misalignment(d) != 0) {
+            *--d = *--s;
+            len--;
+        }
+        while (len >= 16) {
+            uint32_t w3 = ((const mem_word_unaligned_t *)s)[-1];
+            uint32_t w2 = ((const mem_word_unaligned_t *)s)[-2];
+            uint32_t w1 = ((const mem_word_unaligned_t *)s)[-3];
+            uint32_t w0 = ((const mem_word_unaligned_t *)s)[-4];
+
+            ((mem_word_t *)d)[-1] = w3;
+            ((mem_word_t *)d)[-2] = w2;
+            ((mem_word_t *)d)[-3] = w1;
+            ((mem_word_t *)d)[-4] = w0;
+            d -= 16;
+            s -= 16;
+            len -= 16;
+        }
+        while (len >= 4) {
+            d -= 4;
+            s -= 4;
+            *(mem_word_t *)d = *(const mem_word_unaligned_t *)s;
+            len -= 4;
+        }
+    }
+
+    while (len-- > 0) {
+        *--d = *--s;
+    }
+    return dst;
+}
+
+MEM_COPY_NO_LIBCALL
+void *mem_set(void *dst, int value, size_t len)
+{
+    uint8_t *d = dst;
+    uint8_t byte = (uint8_t)value;
+
+    if (len >= MEM_COPY_WORD_MIN) {
+        uint32_t word = byte * 0x01010101u;
+
+        while (misalignment(d) != 0) {
+            *d++ = byte;
+            len--;
+        }
+#if MEM_COPY_LDM
+        if (len >= 16) {
+            size_t blocks = len / 16;
+
+            __asm__ volatile(
+                "   mov     r3, %[w]                \n"
+                "   mov     r4, %[w]                \n"
+                "   mov     r5, %[w]                \n"
+                "   mov     r6, %[w]                \n"
+                "1:                                 \n"
+                "   stmia   %[d]!, {r3, r4, r5, r6} \n"
+                "   subs    %[n], %[n], #1          \n"
+                "   bne     1b                      \n"
+                : [d] "+r"(d), [n] "+r"(blocks)
+                : [w] "r"(word)
+                : "r3", "r4", "r5", "r6", "cc", "memory");
+            len %= 16;
+        }
+#else
+        while (len >= 16) {
+            ((mem_word_t *)d)[0] = word;
+            ((mem_word_t *)d)[1] = word;
+            ((mem_word_t *)d)[2] = word;
+            ((mem_word_t *)d)[3] = word;
+            d += 16;
+            len -= 16;
+        }
+#endif
+        while (len >= 4) {
+            *(mem_word_t *)d = word;
+            d += 4;
+            len -= 4;
+        }
+    }
+
+    while (len-- > 0) {
+        *d++ = byte;
+    }
+    return dst;
+}
+
+#if MEM_COPY_LIBC
+/* Strong definitions in an object file win over the library members */
+void *memcpy(void *restrict dst, const void *restrict src, size_t len) __attribute__((alias("mem_copy")));
+void *memmove(void *dst, const void *src, size_t len) __attribute__((alias("mem_move")));
+void *memset(void *dst, int value, size_t len) __attribute__((alias("mem_set")));
+#endif
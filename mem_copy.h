@@ -0,0 +1,70 @@
+/**
+ * \file mem_copy.h
+ * \brief Word-wise memcpy/memmove/memset for the Cortex-M4
+ *
+ * newlib-nano (--specs=nano.specs) builds its string functions for size,
+ * copying one byte per loop iteration. Every frame, stream buffer chunk
+ * and DOIP payload in this firmware goes through memcpy, so these
+ * replacements align the destination with at most three byte stores,
+ * move aligned blocks with LDM/STM bursts of 32 bytes and fall back to
+ * word loads from any address (the M4 handles unaligned LDR) when source
+ * and destination are misaligned against each other.
+ *
+ * With MEM_COPY_LIBC=1 (the target default, see the Makefile) mem_copy.c
+ * also defines memcpy, memmove and memset, which the linker then takes
+ * instead of the newlib-nano members; with 0 the library versions stay
+ * and the functions below are only called directly. Compiler-generated
+ * copies (structure assignment) go through memcpy and so follow the same
+ * choice.
+ *
+ * Plain C plus a little inline assembly on ARM; also built on the host
+ * (pc/bench) for the correctness check.
+ */
+
+#ifndef MEM_COPY_H
+#define MEM_COPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MEM_COPY_LIBC
+#define MEM_COPY_LIBC               0
+#endif
+
+/**
+ * \brief memcpy(): copy \a len bytes, regions must not overlap
+ * \return \a dst
+ */
+void *mem_copy(void *restrict dst, const void *restrict src, size_t len);
+
+/**
+ * \brief memmove(): copy \a len bytes, regions may overlap
+ * \return \a dst
+ */
+void *mem_move(void *dst, const void *src, size_t len);
+
+/**
+ * \brief memset(): fill \a len bytes with the low byte of \a value
+ * \return \a dst
+ */
+void *mem_set(void *dst, int value, size_t len);
+
+/**
+ * \brief Time mem_copy() and mem_set() against the C library on the target
+ *
+ * Prints timestamp ticks per call (CPU cycles on the SAME54) for frame
+ * and payload sizes, with source and destination aligned and misaligned,
+ * then the bsp_dma_copy() counters. Each call is timed in a critical
+ * section; takes a few milliseconds.
+ */
+void mem_copy_bench(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_COPY_H
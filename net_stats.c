@@ -0,0 +1,237 @@
+/**
+ * \file net_stats.c
+ * \brief Network interface and lwIP protocol counters
+ *
+ * lwIP's counters are updated by the tcpip thread without locking; they
+ * are only read here, and a value that is one packet stale is fine for
+ * diagnostics.
+ *
+ * net_stats_print_pools() lists every memp pool and the heap by name,
+ * with element size, count, current and peak use and failed allocations;
+ * pc/python/lwip_pools_gen.py turns that table into an lwipopts profile.
+ */
+
+#include "net_stats.h"
+#include "bsp_ethernet.h"
+#include "rtt_printf.h"
+#include "housekeeping.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "printf.h"
+#include <string.h>
+
+#define NET_STATS_COUNTERS          34
+#define NET_STATS_HEADER_SIZE       8
+#define NET_STATS_RECORD_SIZE       (NET_STATS_HEADER_SIZE + NET_STATS_COUNTERS * 4)
+
+#if LWIP_STATS && MEMP_STATS
+/* Pool names in memp_t order, from the list lwIP builds the pools from */
+static const char *const pool_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+static uint8_t record_buffer[NET_STATS_RECORD_SIZE];
+static SemaphoreHandle_t stats_mutex;
+static StaticSemaphore_t stats_mutex_buffer;
+
+void net_stats_get(net_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    /* Also folds the clear-on-read MAC registers into the driver's totals */
+    (void)hw_eth_get_stats(&eth_communication, &stats->eth);
+
+#if LWIP_STATS
+#if LINK_STATS
+    stats->link_drop = lwip_stats.link.drop;
+#endif
+#if IP_STATS
+    stats->ip_recv = lwip_stats.ip.recv;
+    stats->ip_drop = lwip_stats.ip.drop;
+#endif
+#if TCP_STATS
+    stats->tcp_recv = lwip_stats.tcp.recv;
+    stats->tcp_xmit = lwip_stats.tcp.xmit;
+    stats->tcp_drop = lwip_stats.tcp.drop;
+    stats->tcp_chkerr = lwip_stats.tcp.chkerr;
+    stats->tcp_memerr = lwip_stats.tcp.memerr;
+#endif
+#if MIB2_STATS
+    stats->tcp_rexmit = lwip_stats.mib2.tcpretranssegs;
+#endif
+#if UDP_STATS
+    stats->udp_recv = lwip_stats.udp.recv;
+    stats->udp_drop = lwip_stats.udp.drop;
+#endif
+#if MEMP_STATS
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *pool = lwip_stats.memp[i];
+
+        if (pool == NULL) {
+            continue;
+        }
+        if (i == MEMP_PBUF_POOL) {
+            stats->pbuf_pool_used = pool->used;
+            stats->pbuf_pool_max = pool->max;
+            stats->pbuf_pool_avail = pool->avail;
+            stats->pbuf_pool_err = pool->err;
+        } else {
+            stats->memp_err += pool->err;
+        }
+    }
+#endif
+#if MEM_STATS
+    stats->mem_err = lwip_stats.mem.err;
+#endif
+#endif /* LWIP_STATS */
+}
+
+static size_t put_u32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return 4;
+}
+
+static size_t net_stats_serialize(uint8_t *out, const net_stats_t *stats)
+{
+    /* Order is part of the record format, see net_stats_decode.py */
+    const uint32_t counters[NET_STATS_COUNTERS] = {
+        stats->eth.rx_frames, (uint32_t)stats->eth.rx_bytes, stats->eth.rx_errors, stats->eth.rx_dropped,
+        stats->eth.tx_frames, (uint32_t)stats->eth.tx_bytes, stats->eth.tx_errors,
+        stats->link_drop, stats->ip_recv, stats->ip_drop,
+        stats->tcp_recv, stats->tcp_xmit, stats->tcp_drop, stats->tcp_chkerr, stats->tcp_memerr, stats->tcp_rexmit,
+        stats->udp_recv, stats->udp_drop,
+        stats->pbuf_pool_used, stats->pbuf_pool_max, stats->pbuf_pool_avail, stats->pbuf_pool_err,
+        stats->memp_err, stats->mem_err,
+        stats->eth.rx_wakeups, stats->eth.rx_wakeup_frames, stats->eth.rx_wakeup_max, stats->eth.rx_budget_hits,
+        stats->eth.rx_filtered, stats->eth.rx_priority, stats->eth.rx_shed,
+        stats->eth.rx_ring_peak, stats->eth.rx_ring_full, stats->eth.rx_overruns,
+    };
+    size_t pos = 0;
+
+    out[pos++] = 'N';
+    out[pos++] = 'S';
+    out[pos++] = NET_STATS_VERSION;
+    out[pos++] = NET_STATS_COUNTERS;
+    pos += put_u32(&out[pos], (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+
+    for (size_t i = 0; i < NET_STATS_COUNTERS; i++) {
+        pos += put_u32(&out[pos], counters[i]);
+    }
+
+    return pos;
+}
+
+void net_stats_dump(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    net_stats_t stats;
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    net_stats_get(&stats);
+
+    size_t len = net_stats_serialize(record_buffer, &stats);
+    rtt_printf_channel_t previous = rtt_printf_select(RTT_PRINTF_CH_METRICS);
+
+    printf("[NETSTATS] ");
+    for (size_t i = 0; i < len; i++) {
+        _putchar(hex[record_buffer[i] >> 4]);
+        _putchar(hex[record_buffer[i] & 0x0F]);
+    }
+    printf("\r\n");
+    rtt_printf_select(previous);
+    xSemaphoreGive(stats_mutex);
+}
+
+void net_stats_print(void)
+{
+    net_stats_t stats;
+
+    net_stats_get(&stats);
+
+    printf("[NETSTATS] MAC  rx %lu frames %llu bytes, %lu errors, %lu dropped, %lu filtered\r\n",
+           (unsigned long)stats.eth.rx_frames, (unsigned long long)stats.eth.rx_bytes,
+           (unsigned long)stats.eth.rx_errors, (unsigned long)stats.eth.rx_dropped,
+           (unsigned long)stats.eth.rx_filtered);
+    printf("[NETSTATS] MAC  tx %lu frames %llu bytes, %lu errors\r\n",
+           (unsigned long)stats.eth.tx_frames, (unsigned long long)stats.eth.tx_bytes,
+           (unsigned long)stats.eth.tx_errors);
+    printf("[NETSTATS] link drop %lu, IP recv %lu drop %lu, UDP recv %lu drop %lu\r\n",
+           (unsigned long)stats.link_drop, (unsigned long)stats.ip_recv, (unsigned long)stats.ip_drop,
+           (unsigned long)stats.udp_recv, (unsigned long)stats.udp_drop);
+    printf("[NETSTATS] TCP  recv %lu xmit %lu rexmit %lu drop %lu chkerr %lu memerr %lu\r\n",
+           (unsigned long)stats.tcp_recv, (unsigned long)stats.tcp_xmit, (unsigned long)stats.tcp_rexmit,
+           (unsigned long)stats.tcp_drop, (unsigned long)stats.tcp_chkerr, (unsigned long)stats.tcp_memerr);
+    printf("[NETSTATS] pbuf pool %lu/%lu used, max %lu, empty %lu; memp err %lu, mem err %lu\r\n",
+           (unsigned long)stats.pbuf_pool_used, (unsigned long)stats.pbuf_pool_avail,
+           (unsigned long)stats.pbuf_pool_max, (unsigned long)stats.pbuf_pool_err,
+           (unsigned long)stats.memp_err, (unsigned long)stats.mem_err);
+    if (stats.eth.rx_wakeups > 0) {
+        printf("[NETSTATS] rx   %lu wakeups, %lu frames/wakeup, max %lu, budget hit %lu; DoIP %lu, shed %lu\r\n",
+               (unsigned long)stats.eth.rx_wakeups,
+               (unsigned long)(stats.eth.rx_wakeup_frames / stats.eth.rx_wakeups),
+               (unsigned long)stats.eth.rx_wakeup_max, (unsigned long)stats.eth.rx_budget_hits,
+               (unsigned long)stats.eth.rx_priority, (unsigned long)stats.eth.rx_shed);
+        printf("[NETSTATS] ring peak %lu descriptors, full %lu, overrun %lu\r\n",
+               (unsigned long)stats.eth.rx_ring_peak, (unsigned long)stats.eth.rx_ring_full,
+               (unsigned long)stats.eth.rx_overruns);
+    }
+}
+
+void net_stats_print_pools(void)
+{
+    printf("[LWIPMEM] scale %d mss %u wnd %lu snd_queuelen %u\r\n", LWIP_MEM_SCALE, (unsigned)TCP_MSS,
+           (unsigned long)TCP_WND, (unsigned)TCP_SND_QUEUELEN);
+#if LWIP_STATS && MEMP_STATS
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *pool = lwip_stats.memp[i];
+
+        if (pool == NULL) {
+            continue;
+        }
+        printf("[LWIPMEM] %s size %u avail %lu used %lu max %lu err %lu\r\n", pool_names[i],
+               (unsigned)memp_pools[i]->size, (unsigned long)pool->avail, (unsigned long)pool->used,
+               (unsigned long)pool->max, (unsigned long)pool->err);
+    }
+#endif
+#if LWIP_STATS && MEM_STATS && !MEM_USE_POOLS && !MEM_LIBC_MALLOC
+    printf("[LWIPMEM] HEAP size 1 avail %lu used %lu max %lu err %lu\r\n",
+           (unsigned long)lwip_stats.mem.avail, (unsigned long)lwip_stats.mem.used,
+           (unsigned long)lwip_stats.mem.max, (unsigned long)lwip_stats.mem.err);
+#endif
+}
+
+#if NET_STATS_PERIOD_MS > 0
+static uint32_t net_stats_job(void *arg)
+{
+    (void)arg;
+    net_stats_dump();
+    return NET_STATS_PERIOD_MS;
+}
+#endif
+
+bool net_stats_start(void)
+{
+    stats_mutex = xSemaphoreCreateMutexStatic(&stats_mutex_buffer);
+    if (stats_mutex == NULL) {
+        printf("NetStats: Failed to create mutex\r\n");
+        return false;
+    }
+
+#if NET_STATS_PERIOD_MS > 0
+    if (housekeeping_add("NetStats", net_stats_job, NULL, NET_STATS_PERIOD_MS) == NULL) {
+        return false;
+    }
+#endif
+
+    return true;
+}
@@ -0,0 +1,92 @@
+/**
+ * \file net_stats.h
+ * \brief Network interface and lwIP protocol counters
+ *
+ * Combines the MAC counters of the Ethernet driver (GMAC statistics
+ * registers on SAME54) with lwIP's link, IP, TCP, UDP and memory pool
+ * statistics. A housekeeping job folds the clear-on-read MAC registers
+ * into running totals every NET_STATS_PERIOD_MS and writes the totals as
+ * a "[NETSTATS] <hex>" line on the RTT metrics channel; decode with
+ * pc/python/net_stats_decode.py.
+ *
+ * Record format, integers big-endian:
+ *   'N' 'S' version(1) ncounters(u8) uptime_ms(u32)
+ *   then ncounters x u32 in net_stats_t order, byte counts modulo 2^32
+ * Counters are only ever appended; decoders name the ones they know.
+ */
+
+#ifndef NET_STATS_H
+#define NET_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver_ethernet.h"
+
+#define NET_STATS_VERSION       1
+
+/* Sampling and reporting period, 0 = only on request. The GMAC error
+ * registers saturate at 1023, so keep this in the range of seconds. */
+#ifndef NET_STATS_PERIOD_MS
+#define NET_STATS_PERIOD_MS     5000
+#endif
+
+typedef struct {
+    drv_eth_stats_t eth;        /* MAC counters */
+    uint32_t link_drop;         /* Frames dropped by the netif driver */
+    uint32_t ip_recv;
+    uint32_t ip_drop;
+    uint32_t tcp_recv;
+    uint32_t tcp_xmit;
+    uint32_t tcp_drop;
+    uint32_t tcp_chkerr;
+    uint32_t tcp_memerr;
+    uint32_t tcp_rexmit;        /* Retransmitted segments */
+    uint32_t udp_recv;
+    uint32_t udp_drop;
+    uint32_t pbuf_pool_used;
+    uint32_t pbuf_pool_max;
+    uint32_t pbuf_pool_avail;
+    uint32_t pbuf_pool_err;     /* Allocations that found the pbuf pool empty */
+    uint32_t memp_err;          /* Failed allocations from every other pool */
+    uint32_t mem_err;           /* Failed allocations from the lwIP heap */
+} net_stats_t;
+
+/**
+ * \brief Create the mutex and schedule the sampling job
+ * \return true if both succeeded
+ */
+bool net_stats_start(void);
+
+/**
+ * \brief Read the current totals
+ */
+void net_stats_get(net_stats_t *stats);
+
+/**
+ * \brief Write the current totals as a binary record
+ */
+void net_stats_dump(void);
+
+/**
+ * \brief Print the current totals
+ */
+void net_stats_print(void);
+
+/**
+ * \brief Print use of every lwIP pool and the heap as "[LWIPMEM]" lines
+ *
+ * One line per pool: name, element size in bytes, elements, in use, peak
+ * and failed allocations since start-up, after a line with the build's
+ * LWIP_MEM_SCALE and TCP limits. The input of pc/python/lwip_pools_gen.py.
+ */
+void net_stats_print_pools(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_STATS_H */
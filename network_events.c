@@ -5,21 +5,130 @@
  *
  * Provides comprehensive real-time logging for lwIP network events using
  * SEGGER RTT printf output for debugging and monitoring.
+ *
+ * The state bits live in a static event group, created on first use since
+ * waiting tasks may start before the TCP/IP stack. Only the lwIP thread
+ * publishes, from the netif callbacks; the firmware has one interface.
  */
 
 #include "network_events.h"
+#include "boot_time.h"
 #include "printf.h"
 #include "lwip/dhcp.h"
 #include "lwip/netif.h"
 #include "lwip/ip_addr.h"
 #include "lwip/inet.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
 #include <string.h>
 #include <stdbool.h>
 
+typedef struct {
+    uint32_t mask;
+    network_event_handler_t handler;
+    void *arg;
+} network_event_subscriber_t;
+
 /* Static variables for state tracking */
 static bool network_events_initialized = false;
 static u8_t last_dhcp_state[NETIF_MAX_HWADDR_LEN] = {0};
 
+static StaticEventGroup_t net_event_group_buffer;
+static EventGroupHandle_t volatile net_event_group = NULL;
+static network_event_subscriber_t net_subscribers[NETWORK_EVENTS_MAX_SUBSCRIBERS];
+static uint32_t net_subscriber_count = 0;
+static uint32_t net_state = 0;      /* Last published state, lwIP thread only */
+
+static EventGroupHandle_t net_events_group(void)
+{
+    if (net_event_group == NULL) {
+        taskENTER_CRITICAL();
+        if (net_event_group == NULL) {
+            net_event_group = xEventGroupCreateStatic(&net_event_group_buffer);
+        }
+        taskEXIT_CRITICAL();
+    }
+    return net_event_group;
+}
+
+/**
+ * \brief Publish the interface state if it changed; lwIP thread
+ */
+static void network_events_publish(struct netif *netif)
+{
+    uint32_t state = 0;
+
+    if (netif_is_link_up(netif)) {
+        state |= NET_EVENT_LINK_UP;
+    }
+    if (netif_is_up(netif)) {
+        state |= NET_EVENT_NETIF_UP;
+        if (!ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+            state |= NET_EVENT_IP_BOUND;
+        }
+    }
+
+    uint32_t changed = state ^ net_state;
+    if (changed == 0) {
+        return;
+    }
+    net_state = state;
+
+    if (changed & state & NET_EVENT_IP_BOUND) {
+        boot_time_mark(BOOT_MARK_ADDRESS);
+    }
+
+    /* Clear first, so no waiter sees a bit that no longer holds */
+    EventGroupHandle_t group = net_events_group();
+    xEventGroupClearBits(group, changed & ~state);
+    xEventGroupSetBits(group, changed & state);
+
+    /* Entries below the count are complete; subscribe() writes both together */
+    taskENTER_CRITICAL();
+    uint32_t count = net_subscriber_count;
+    taskEXIT_CRITICAL();
+
+    for (uint32_t i = 0; i < count; i++) {
+        const network_event_subscriber_t *sub = &net_subscribers[i];
+
+        if (sub->mask & changed) {
+            sub->handler(sub->mask & changed, state, sub->arg);
+        }
+    }
+}
+
+uint32_t network_events_state(void)
+{
+    return (uint32_t)xEventGroupGetBits(net_events_group());
+}
+
+uint32_t network_events_wait(uint32_t bits, bool wait_all, uint32_t timeout_ms)
+{
+    return (uint32_t)xEventGroupWaitBits(net_events_group(), bits, pdFALSE,
+                                         wait_all ? pdTRUE : pdFALSE, pdMS_TO_TICKS(timeout_ms));
+}
+
+bool network_events_subscribe(uint32_t mask, network_event_handler_t handler, void *arg)
+{
+    bool added = false;
+
+    if (handler == NULL) {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    if (net_subscriber_count < NETWORK_EVENTS_MAX_SUBSCRIBERS) {
+        net_subscribers[net_subscriber_count].mask = mask;
+        net_subscribers[net_subscriber_count].handler = handler;
+        net_subscribers[net_subscriber_count].arg = arg;
+        net_subscriber_count++;
+        added = true;
+    }
+    taskEXIT_CRITICAL();
+    return added;
+}
+
 /**
  * \brief Initialize network event logging system
  */
@@ -203,6 +312,7 @@ void netif_status_callback(struct netif *netif)
     if (netif != NULL) {
         bool is_up = netif_is_up(netif);
         log_netif_status_change(netif, is_up);
+        network_events_publish(netif);
         
         /* Check for DHCP state changes */
         if (1) { /* Always check for DHCP compatibility */
@@ -236,6 +346,7 @@ void netif_link_callback(struct netif *netif)
     if (netif != NULL) {
         bool link_up = netif_is_link_up(netif);
         log_link_status_change(netif, link_up);
+        network_events_publish(netif);
         
         if (!link_up) {
             /* Link down - DHCP will need to restart when link comes back */
@@ -1,7 +1,7 @@
 /**
  * \file network_events.h
  *
- * \brief Network event logging for lwIP stack
+ * \brief Network event logging and state publishing for lwIP stack
  *
  * Provides comprehensive logging for lwIP network events including:
  * - lwIP stack initialization
@@ -9,6 +9,12 @@
  * - Link up/down events
  * - Network interface status changes
  *
+ * The netif status and link callbacks also publish the interface state as
+ * NET_EVENT_* bits: tasks block on them with network_events_wait(), or
+ * register a handler with network_events_subscribe(). The link monitor
+ * task reports PHY changes through netif_set_link_up()/down(), so they
+ * arrive the same way.
+ *
  * Uses SEGGER RTT printf for real-time debug output.
  */
 
@@ -19,11 +25,34 @@
 #include "lwip/dhcp.h"
 #include "lwip/ip_addr.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Network state bits; each is set while its condition holds */
+#define NET_EVENT_LINK_UP           (1u << 0)   ///< PHY link up
+#define NET_EVENT_NETIF_UP          (1u << 1)   ///< Interface up
+#define NET_EVENT_IP_BOUND          (1u << 2)   ///< Interface up with an IPv4 address
+#define NET_EVENT_ALL               (NET_EVENT_LINK_UP | NET_EVENT_NETIF_UP | NET_EVENT_IP_BOUND)
+
+#ifndef NETWORK_EVENTS_MAX_SUBSCRIBERS
+#define NETWORK_EVENTS_MAX_SUBSCRIBERS  4
+#endif
+
+/**
+ * \brief Network state change handler
+ *
+ * Runs in the lwIP thread with the core lock held, so it must not block;
+ * give a semaphore or notify a task for anything longer.
+ *
+ * \param[in] changed Subscribed NET_EVENT_* bits that changed
+ * \param[in] state All NET_EVENT_* bits after the change
+ * \param[in] arg Argument given to network_events_subscribe()
+ */
+typedef void (*network_event_handler_t)(uint32_t changed, uint32_t state, void *arg);
+
 /**
  * \brief Initialize network event logging system
  *
@@ -32,6 +61,37 @@ extern "C" {
  */
 void network_events_init(void);
 
+/**
+ * \brief Current NET_EVENT_* state bits
+ */
+uint32_t network_events_state(void);
+
+/**
+ * \brief Block until network state bits are set; task context
+ *
+ * Returns at once if they are already set, and as soon as the netif
+ * callback sets them otherwise.
+ *
+ * \param[in] bits NET_EVENT_* bits to wait for
+ * \param[in] wait_all true to wait for all of \a bits, false for any of them
+ * \param[in] timeout_ms Longest wait
+ * \return NET_EVENT_* state when the wait ended; check it against \a bits
+ */
+uint32_t network_events_wait(uint32_t bits, bool wait_all, uint32_t timeout_ms);
+
+/**
+ * \brief Call a handler whenever one of the \a mask bits changes
+ *
+ * Handlers cannot be removed. The current state is not reported;
+ * read network_events_state() after subscribing.
+ *
+ * \param[in] mask NET_EVENT_* bits of interest
+ * \param[in] handler Called in the lwIP thread, see network_event_handler_t
+ * \param[in] arg Passed to \a handler
+ * \return false if NETWORK_EVENTS_MAX_SUBSCRIBERS handlers are registered
+ */
+bool network_events_subscribe(uint32_t mask, network_event_handler_t handler, void *arg);
+
 /**
  * \brief Log lwIP stack initialization
  *
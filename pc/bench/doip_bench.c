@@ -0,0 +1,1581 @@
+/**
+ * \file doip_bench.c
+ * \brief Host microbenchmarks for the DOIP protocol hot paths
+ *
+ * Builds doip_protocol.c unmodified on the host and times header
+ * decoding, serialization, UDS response decoding and stream reassembly
+ * over message mixes that mirror one diagnostic cycle of doip_client_task
+ * against the ECU emulator (pc/python/doip_ecu_emulator.py).
+ *
+ * The SAME54 GMAC receive and transmit rings (hw/same54/drivers/
+ * gmac_rx_ring.c, gmac_tx_ring.c) run against a simulated GMAC that
+ * fills and consumes descriptors the way the DMA does; their "messages"
+ * are Ethernet frames carrying the cycle mix. Bursts of full-size
+ * segments against several receive ring sizes give the drop rate per
+ * configuration (printed after the rx_burst_* cases). The checksum offload
+ * fallback (gmac_csum.c) is timed over full-size TCP frames of the bulk
+ * mix, verified in software as lwIP would and as trusted GMAC results.
+ * The receive filter (gmac_rx_filter.c) classifies DoIP traffic mixed
+ * with the broadcast and multicast chatter seen on the bench link.
+ * mem_copy.c, the firmware memcpy, is checked against a byte loop over
+ * every small size, offset and overlap and timed against the C library
+ * on full-size frames (the library calls are not counted as copies).
+ *
+ * Results are reported as ns/message and bytes copied/message and can be
+ * written to a JSON baseline and compared against a previous run.
+ */
+
+#include "doip_protocol.h"
+#include "gmac_csum.h"
+#include "gmac_rx_filter.h"
+#include "gmac_rx_ring.h"
+#include "gmac_tx_ring.h"
+#include "mem_copy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#define BENCH_MAX_CASES         64
+#define BENCH_STREAM_SIZE       (64 * 1024)
+#define BENCH_MAX_FRAMES        256
+#define BENCH_TCP_MSS           1460    /* TCP_MSS from config/lwipopts.h */
+#define BENCH_ECU_ADDRESS       0x1001  /* Emulator logical address */
+
+/* Counter incremented by the memcpy/memmove wrappers in bench_copy_count.h */
+uint64_t bench_bytes_copied;
+
+/* Sink that keeps the optimizer from discarding benchmarked work */
+static volatile uint32_t bench_sink;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    size_t (*run)(void);        /* Runs one batch, returns messages processed */
+} bench_case_t;
+
+typedef struct {
+    const char *name;
+    uint64_t iterations;        /* Messages timed in the best sample */
+    double   ns_per_msg;
+    double   bytes_copied_per_msg;
+} bench_result_t;
+
+/* Serialized message corpus */
+typedef struct {
+    uint8_t  data[BENCH_STREAM_SIZE];
+    size_t   len;
+    size_t   frame_offset[BENCH_MAX_FRAMES];
+    size_t   frame_len[BENCH_MAX_FRAMES];
+    size_t   frames;
+} bench_stream_t;
+
+static bench_stream_t cycle_rx;     /* ECU -> tester, one diagnostic cycle */
+static bench_stream_t bulk_rx;      /* ECU -> tester, max-size payloads */
+static doip_message_t tx_requests[BENCH_MAX_FRAMES];
+static size_t tx_request_count;
+
+/* UDS response bodies (SID + DID + data) for the decoder benchmark */
+typedef enum { UDS_KIND_STRING, UDS_KIND_U16, UDS_KIND_U8 } uds_kind_t;
+typedef struct {
+    uint8_t    data[80];
+    int        len;
+    uds_kind_t kind;
+} uds_sample_t;
+
+static uds_sample_t uds_samples[32];
+static size_t uds_sample_count;
+
+/* Corpus construction */
+
+static void stream_append(bench_stream_t *stream, uint16_t payload_type,
+                          const uint8_t *payload, uint32_t payload_length)
+{
+    size_t offset = stream->len;
+
+    doip_serialize_header(&stream->data[offset], payload_type, payload_length);
+    memcpy(&stream->data[offset + DOIP_HEADER_SIZE], payload, payload_length);
+
+    stream->frame_offset[stream->frames] = offset;
+    stream->frame_len[stream->frames] = DOIP_HEADER_SIZE + payload_length;
+    stream->frames++;
+    stream->len += DOIP_HEADER_SIZE + payload_length;
+}
+
+static void uds_sample_add(uint16_t did, const uint8_t *data, size_t len, uds_kind_t kind)
+{
+    uds_sample_t *sample = &uds_samples[uds_sample_count++];
+
+    sample->data[0] = UDS_READ_DATA_BY_IDENTIFIER + UDS_POSITIVE_RESPONSE_MASK;
+    sample->data[1] = (did >> 8) & 0xFF;
+    sample->data[2] = did & 0xFF;
+    memcpy(&sample->data[3], data, len);
+    sample->len = (int)(3 + len);
+    sample->kind = kind;
+}
+
+static void diag_response_append(bench_stream_t *stream, const uds_sample_t *sample)
+{
+    uint8_t payload[4 + sizeof(sample->data)];
+
+    payload[0] = (BENCH_ECU_ADDRESS >> 8) & 0xFF;
+    payload[1] = BENCH_ECU_ADDRESS & 0xFF;
+    payload[2] = (DOIP_CLIENT_SOURCE_ADDRESS >> 8) & 0xFF;
+    payload[3] = DOIP_CLIENT_SOURCE_ADDRESS & 0xFF;
+    memcpy(&payload[4], sample->data, (size_t)sample->len);
+    stream_append(stream, DOIP_DIAGNOSTIC_MESSAGE, payload, 4 + (uint32_t)sample->len);
+}
+
+static void tx_request_add(uint16_t payload_type, const uint8_t *payload, uint32_t payload_length)
+{
+    doip_message_t *msg = &tx_requests[tx_request_count++];
+
+    doip_create_header(msg, payload_type, payload_length);
+    memcpy(msg->payload, payload, payload_length);
+}
+
+static void build_corpus(void)
+{
+    static const struct {
+        uint16_t    did;
+        const char *text;
+    } string_dids[] = {
+        { DID_VIN,                   "WBAVN31010AE12345" },
+        { DID_ECU_SOFTWARE_VERSION,  "SW_V2.1.4_20241201" },
+        { DID_ECU_HARDWARE_VERSION,  "HW_V1.3.0_REV_C" },
+        { DID_ECU_SERIAL_NUMBER,     "SAME54P20A-SN001234" },
+    };
+    static const struct {
+        uint16_t did;
+        uint16_t value;
+    } u16_dids[] = {
+        { DID_VEHICLE_SPEED_INFORMATION,   72 },
+        { DID_ENGINE_RPM_INFORMATION,      2150 },
+        { DID_BATTERY_VOLTAGE_INFORMATION, 12750 },
+        { DID_TEMPERATURE_SENSOR_DATA,     253 },
+    };
+    static const struct {
+        uint16_t did;
+        uint8_t  value;
+    } u8_dids[] = {
+        { DID_ACTIVE_DIAGNOSTIC_SESSION, 0x01 },
+        { DID_FUEL_LEVEL_INFORMATION,    85 },
+    };
+    uint8_t payload[DOIP_MAX_PAYLOAD_SIZE];
+    size_t i;
+
+    for (i = 0; i < sizeof(string_dids) / sizeof(string_dids[0]); i++) {
+        uds_sample_add(string_dids[i].did, (const uint8_t *)string_dids[i].text,
+                       strlen(string_dids[i].text), UDS_KIND_STRING);
+    }
+    for (i = 0; i < sizeof(u16_dids) / sizeof(u16_dids[0]); i++) {
+        uint8_t value[2] = { (uint8_t)(u16_dids[i].value >> 8), (uint8_t)u16_dids[i].value };
+        uds_sample_add(u16_dids[i].did, value, sizeof(value), UDS_KIND_U16);
+    }
+    for (i = 0; i < sizeof(u8_dids) / sizeof(u8_dids[0]); i++) {
+        uds_sample_add(u8_dids[i].did, &u8_dids[i].value, 1, UDS_KIND_U8);
+    }
+
+    /* Diagnostic cycle as seen by the tester: activation, DID reads, alive check */
+    payload[0] = (DOIP_CLIENT_SOURCE_ADDRESS >> 8) & 0xFF;
+    payload[1] = DOIP_CLIENT_SOURCE_ADDRESS & 0xFF;
+    payload[2] = (BENCH_ECU_ADDRESS >> 8) & 0xFF;
+    payload[3] = BENCH_ECU_ADDRESS & 0xFF;
+    payload[4] = 0x10;
+    memset(&payload[5], 0, 4);
+    stream_append(&cycle_rx, DOIP_ROUTING_ACTIVATION_RESPONSE, payload, 9);
+
+    for (i = 0; i < uds_sample_count; i++) {
+        diag_response_append(&cycle_rx, &uds_samples[i]);
+    }
+
+    payload[0] = (BENCH_ECU_ADDRESS >> 8) & 0xFF;
+    payload[1] = BENCH_ECU_ADDRESS & 0xFF;
+    stream_append(&cycle_rx, DOIP_ALIVE_CHECK_RESPONSE, payload, 2);
+    stream_append(&cycle_rx, DOIP_ALIVE_CHECK_REQUEST, payload, 2);
+
+    /* Upper bound: back-to-back maximum size diagnostic messages */
+    for (i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    for (i = 0; i < 32; i++) {
+        stream_append(&bulk_rx, DOIP_DIAGNOSTIC_MESSAGE, payload, DOIP_MAX_PAYLOAD_SIZE);
+    }
+
+    /* Tester requests: routing activation, one read per DID, alive check, ACK */
+    payload[0] = (DOIP_CLIENT_SOURCE_ADDRESS >> 8) & 0xFF;
+    payload[1] = DOIP_CLIENT_SOURCE_ADDRESS & 0xFF;
+    payload[2] = 0x00;
+    memset(&payload[3], 0, 4);
+    tx_request_add(DOIP_ROUTING_ACTIVATION_REQUEST, payload, 7);
+
+    for (i = 0; i < uds_sample_count; i++) {
+        payload[2] = (BENCH_ECU_ADDRESS >> 8) & 0xFF;
+        payload[3] = BENCH_ECU_ADDRESS & 0xFF;
+        payload[4] = UDS_READ_DATA_BY_IDENTIFIER;
+        payload[5] = uds_samples[i].data[1];
+        payload[6] = uds_samples[i].data[2];
+        tx_request_add(DOIP_DIAGNOSTIC_MESSAGE, payload, 7);
+    }
+
+    tx_request_add(DOIP_ALIVE_CHECK_REQUEST, payload, 2);
+    payload[4] = 0x00;
+    tx_request_add(DOIP_DIAGNOSTIC_MESSAGE_POSITIVE_ACK, payload, 5);
+}
+
+/* Benchmark bodies */
+
+static size_t bench_header_decode(void)
+{
+    doip_message_t msg;
+    size_t i;
+
+    for (i = 0; i < cycle_rx.frames; i++) {
+        doip_decode_header(&cycle_rx.data[cycle_rx.frame_offset[i]], &msg);
+        bench_sink += msg.payload_length;
+    }
+    return cycle_rx.frames;
+}
+
+static size_t bench_parse_header(void)
+{
+    static doip_message_t msg;
+    size_t i;
+
+    /* Datagram-style parse as used for UDP discovery responses */
+    for (i = 0; i < cycle_rx.frames; i++) {
+        doip_parse_header(&cycle_rx.data[cycle_rx.frame_offset[i]], cycle_rx.frame_len[i], &msg);
+        bench_sink += msg.payload[0];
+    }
+    return cycle_rx.frames;
+}
+
+static size_t bench_serialize_header(void)
+{
+    uint8_t out[DOIP_HEADER_SIZE];
+    size_t i;
+
+    for (i = 0; i < tx_request_count; i++) {
+        doip_serialize_header(out, tx_requests[i].payload_type, tx_requests[i].payload_length);
+        bench_sink += out[3];
+    }
+    return tx_request_count;
+}
+
+static size_t bench_serialize_message(void)
+{
+    uint8_t out[DOIP_HEADER_SIZE + DOIP_MAX_PAYLOAD_SIZE];
+    size_t i;
+
+    for (i = 0; i < tx_request_count; i++) {
+        bench_sink += (uint32_t)doip_serialize_message(&tx_requests[i], out, sizeof(out));
+    }
+    return tx_request_count;
+}
+
+static size_t bench_uds_decode(void)
+{
+    char text[64];
+    uint16_t u16;
+    uint8_t u8;
+    size_t i;
+
+    for (i = 0; i < uds_sample_count; i++) {
+        const uds_sample_t *sample = &uds_samples[i];
+
+        switch (sample->kind) {
+            case UDS_KIND_STRING:
+                doip_uds_decode_string(sample->data, sample->len, text, sizeof(text));
+                bench_sink += (uint8_t)text[0];
+                break;
+            case UDS_KIND_U16:
+                doip_uds_decode_u16(sample->data, sample->len, &u16);
+                bench_sink += u16;
+                break;
+            case UDS_KIND_U8:
+                doip_uds_decode_u8(sample->data, sample->len, &u8);
+                bench_sink += u8;
+                break;
+        }
+    }
+    return uds_sample_count;
+}
+
+/*
+ * Reassembly: the stream is delivered to the reassembler in segments the
+ * way the stream buffer / socket would hand it over. seg_len == 0 means
+ * one segment per message; SEG_SPLIT delivers header and payload apart.
+ */
+#define SEG_PER_MESSAGE  0
+#define SEG_SPLIT        ((size_t)-1)
+
+static size_t reassemble_stream(const bench_stream_t *stream, size_t seg_len)
+{
+    static doip_message_t msg;
+    doip_reassembler_t reasm;
+    size_t messages = 0;
+    size_t frame = 0;
+    size_t pos = 0;
+
+    doip_reasm_reset(&reasm, &msg);
+
+    while (pos < stream->len) {
+        size_t seg;
+
+        if (seg_len == SEG_PER_MESSAGE) {
+            seg = stream->frame_len[frame++];
+        } else if (seg_len == SEG_SPLIT) {
+            seg = (reasm.header_len == 0) ? DOIP_HEADER_SIZE : (msg.payload_length - reasm.payload_len);
+        } else {
+            seg = (stream->len - pos < seg_len) ? (stream->len - pos) : seg_len;
+        }
+
+        const uint8_t *data = &stream->data[pos];
+        pos += seg;
+
+        while (seg > 0) {
+            size_t consumed;
+            doip_reasm_status_t status = doip_reasm_feed(&reasm, data, seg, &consumed);
+
+            data += consumed;
+            seg -= consumed;
+            if (status == DOIP_REASM_COMPLETE) {
+                bench_sink += msg.payload_type;
+                messages++;
+                doip_reasm_reset(&reasm, &msg);
+            } else if (status != DOIP_REASM_INCOMPLETE) {
+                fprintf(stderr, "reassembly error %d at offset %zu\n", status, pos);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    return messages;
+}
+
+static size_t bench_reasm_cycle_msg(void)   { return reassemble_stream(&cycle_rx, SEG_PER_MESSAGE); }
+static size_t bench_reasm_cycle_split(void) { return reassemble_stream(&cycle_rx, SEG_SPLIT); }
+static size_t bench_reasm_cycle_mss(void)   { return reassemble_stream(&cycle_rx, BENCH_TCP_MSS); }
+static size_t bench_reasm_cycle_byte(void)  { return reassemble_stream(&cycle_rx, 1); }
+static size_t bench_reasm_bulk_msg(void)    { return reassemble_stream(&bulk_rx, SEG_PER_MESSAGE); }
+static size_t bench_reasm_bulk_mss(void)    { return reassemble_stream(&bulk_rx, BENCH_TCP_MSS); }
+
+/* Receive path end to end: reassemble, strip DOIP addressing, decode UDS */
+static size_t bench_rx_cycle_decode(void)
+{
+    static doip_message_t msg;
+    doip_reassembler_t reasm;
+    size_t messages = 0;
+    size_t pos = 0;
+    size_t sample = 0;
+
+    doip_reasm_reset(&reasm, &msg);
+
+    while (pos < cycle_rx.len) {
+        size_t consumed;
+        doip_reasm_status_t status = doip_reasm_feed(&reasm, &cycle_rx.data[pos],
+                                                     cycle_rx.len - pos, &consumed);
+        pos += consumed;
+        if (status != DOIP_REASM_COMPLETE) {
+            continue;
+        }
+
+        if (msg.payload_type == DOIP_DIAGNOSTIC_MESSAGE && msg.payload_length > 4) {
+            const uint8_t *uds = &msg.payload[4];
+            int uds_len = (int)msg.payload_length - 4;
+            char text[64];
+            uint16_t u16;
+            uint8_t u8;
+
+            switch (uds_samples[sample++].kind) {
+                case UDS_KIND_STRING:
+                    doip_uds_decode_string(uds, uds_len, text, sizeof(text));
+                    bench_sink += (uint8_t)text[0];
+                    break;
+                case UDS_KIND_U16:
+                    doip_uds_decode_u16(uds, uds_len, &u16);
+                    bench_sink += u16;
+                    break;
+                case UDS_KIND_U8:
+                    doip_uds_decode_u8(uds, uds_len, &u8);
+                    bench_sink += u8;
+                    break;
+            }
+        }
+        messages++;
+        doip_reasm_reset(&reasm, &msg);
+    }
+
+    return messages;
+}
+
+/* GMAC receive ring against a simulated GMAC */
+
+#define SIM_RX_DESCS            8
+#define SIM_RX_DESCS_MAX        32
+#define SIM_RX_SPARES           8
+#define SIM_RX_BUFFER_SIZE      1536
+#define SIM_RX_PAD              2       /* CONF_GMAC_NCFGR_RXBUFO / ETH_PAD_SIZE */
+#define SIM_RX_ETH_HEADERS      54      /* Ethernet + IPv4 + TCP */
+#define SIM_RX_HELD             4       /* Frames lwIP holds before freeing the oldest */
+
+typedef struct {
+    gmac_rx_ring_t ring;
+    gmac_rx_desc_t descs[SIM_RX_DESCS_MAX];
+    uint8_t *slots[SIM_RX_DESCS_MAX];
+    uint8_t *spares[SIM_RX_SPARES];
+    uint8_t buffers[SIM_RX_DESCS_MAX + SIM_RX_SPARES][SIM_RX_BUFFER_SIZE];
+    uint32_t hw_pos;            /* Next descriptor the GMAC writes */
+    uint32_t bna;               /* Frames dropped for lack of a free descriptor */
+} sim_gmac_t;
+
+static sim_gmac_t sim_gmac;
+static uint8_t sim_pool_buffer[SIM_RX_BUFFER_SIZE];    /* Stands in for a PBUF_POOL pbuf */
+
+static void sim_gmac_init(sim_gmac_t *gmac, uint32_t descs, uint32_t spares)
+{
+    gmac_rx_ring_init(&gmac->ring, gmac->descs, gmac->slots, descs, gmac->spares,
+                      &gmac->buffers[0][0], SIM_RX_BUFFER_SIZE, descs + spares);
+    gmac->hw_pos = 0;
+    gmac->bna = 0;
+}
+
+/* DMA side: the copy is done by the GMAC, so it bypasses the copy counter */
+static bool sim_gmac_receive(sim_gmac_t *gmac, const uint8_t *frame, uint32_t len, uint32_t sof_eof)
+{
+    gmac_rx_desc_t *desc = &gmac->descs[gmac->hw_pos];
+
+    if (desc->addr & GMAC_RX_ADDR_OWNERSHIP) {
+        gmac->bna++;
+        return false;
+    }
+
+    (memcpy)(gmac->ring.slots[gmac->hw_pos] + SIM_RX_PAD, frame, len);
+    desc->status = sof_eof | len;
+    desc->addr |= GMAC_RX_ADDR_OWNERSHIP;
+    gmac->hw_pos = (desc->addr & GMAC_RX_ADDR_WRAP) ? 0 : gmac->hw_pos + 1;
+    return true;
+}
+
+/* Frames lwIP still holds, freed oldest first */
+typedef struct {
+    uint8_t *buffers[SIM_RX_HELD];
+    size_t   oldest;
+    size_t   count;
+} sim_held_t;
+
+/* Netif side, as ethif_gmac.c: lend the buffer, or copy and hand it back */
+static size_t sim_netif_input(sim_gmac_t *gmac, sim_held_t *held)
+{
+    gmac_rx_frame_t frame;
+    size_t frames = 0;
+
+    while (gmac_rx_ring_poll(&gmac->ring, &frame)) {
+        if (frame.loaned) {
+            bench_sink += frame.buffer[SIM_RX_PAD + SIM_RX_ETH_HEADERS];
+            if (held->count == SIM_RX_HELD) {
+                gmac_rx_ring_free(&gmac->ring, held->buffers[held->oldest]);
+                held->oldest = (held->oldest + 1) % SIM_RX_HELD;
+                held->count--;
+            }
+            held->buffers[(held->oldest + held->count++) % SIM_RX_HELD] = frame.buffer;
+        } else {
+            memcpy(sim_pool_buffer, frame.buffer, frame.length + SIM_RX_PAD);
+            bench_sink += sim_pool_buffer[SIM_RX_PAD + SIM_RX_ETH_HEADERS];
+            gmac_rx_ring_return(&gmac->ring, &frame);
+        }
+        frames++;
+    }
+    return frames;
+}
+
+/* One diagnostic cycle, one DOIP message per frame, polled every four frames */
+static size_t rx_ring_cycle(uint32_t spares)
+{
+    static uint8_t frame[SIM_RX_BUFFER_SIZE];
+    sim_held_t held = { .oldest = 0, .count = 0 };
+    size_t frames = 0;
+
+    sim_gmac_init(&sim_gmac, SIM_RX_DESCS, spares);
+
+    for (size_t f = 0; f < cycle_rx.frames; f++) {
+        uint32_t len = (uint32_t)(SIM_RX_ETH_HEADERS + cycle_rx.frame_len[f]);
+
+        (memcpy)(&frame[SIM_RX_ETH_HEADERS], &cycle_rx.data[cycle_rx.frame_offset[f]], cycle_rx.frame_len[f]);
+        sim_gmac_receive(&sim_gmac, frame, len, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+        if ((f & 3) == 3) {
+            frames += sim_netif_input(&sim_gmac, &held);
+        }
+    }
+    frames += sim_netif_input(&sim_gmac, &held);
+
+    for (; held.count > 0; held.count--, held.oldest = (held.oldest + 1) % SIM_RX_HELD) {
+        gmac_rx_ring_free(&sim_gmac.ring, held.buffers[held.oldest]);
+    }
+    return frames;
+}
+
+static size_t bench_rx_ring_loan(void) { return rx_ring_cycle(SIM_RX_SPARES); }
+static size_t bench_rx_ring_copy(void) { return rx_ring_cycle(0); }
+
+/* Burst absorption: back-to-back full-size segments while the GMAC task
+ * only gets to run every `lag` frame times (about 123 us each at
+ * 100 Mbit/s), for several ring sizes. Frames that find every descriptor
+ * filled are dropped by the GMAC. */
+
+#define BURST_FRAMES            256
+#define BURST_LAG               6
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t peak;              /* Ring occupancy when the task got to run */
+} burst_result_t;
+
+static burst_result_t rx_burst(uint32_t descs, uint32_t spares, uint32_t lag)
+{
+    static uint8_t frame[SIM_RX_BUFFER_SIZE];
+    sim_held_t held = { .oldest = 0, .count = 0 };
+    burst_result_t result;
+    uint32_t len = SIM_RX_ETH_HEADERS + BENCH_TCP_MSS;
+    uint32_t delivered = 0;
+
+    sim_gmac_init(&sim_gmac, descs, spares);
+    for (uint32_t f = 0; f < BURST_FRAMES; f++) {
+        size_t offset = ((size_t)f * BENCH_TCP_MSS) % (bulk_rx.len - BENCH_TCP_MSS);
+
+        (memcpy)(&frame[SIM_RX_ETH_HEADERS], &bulk_rx.data[offset], BENCH_TCP_MSS);
+        sim_gmac_receive(&sim_gmac, frame, len, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+        if (f % lag == lag - 1) {
+            gmac_rx_ring_occupancy(&sim_gmac.ring);
+            delivered += (uint32_t)sim_netif_input(&sim_gmac, &held);
+        }
+    }
+    gmac_rx_ring_occupancy(&sim_gmac.ring);
+    delivered += (uint32_t)sim_netif_input(&sim_gmac, &held);
+
+    for (; held.count > 0; held.count--, held.oldest = (held.oldest + 1) % SIM_RX_HELD) {
+        gmac_rx_ring_free(&sim_gmac.ring, held.buffers[held.oldest]);
+    }
+    result.delivered = delivered;
+    result.dropped = sim_gmac.bna;
+    result.peak = sim_gmac.ring.occupancy_max;
+    return result;
+}
+
+static size_t bench_rx_burst_d4(void)  { return rx_burst(4, SIM_RX_SPARES, BURST_LAG).delivered; }
+static size_t bench_rx_burst_d8(void)  { return rx_burst(8, SIM_RX_SPARES, BURST_LAG).delivered; }
+static size_t bench_rx_burst_d16(void) { return rx_burst(16, SIM_RX_SPARES, BURST_LAG).delivered; }
+
+static void report_rx_burst(void)
+{
+    static const uint32_t descs[] = { 4, 8, 16, 32 };
+    static const uint32_t lags[] = { 2, 4, 6, 8, 12, 16 };
+
+    printf("\nGMAC RX ring drop rate, %u full-size frames, %u spares, task runs every N frames\n",
+           BURST_FRAMES, SIM_RX_SPARES);
+    printf("%-12s", "descriptors");
+    for (size_t l = 0; l < sizeof(lags) / sizeof(lags[0]); l++) {
+        printf(" %8s%-2u", "N=", lags[l]);
+    }
+    printf("\n");
+    for (size_t d = 0; d < sizeof(descs) / sizeof(descs[0]); d++) {
+        printf("%-12u", descs[d]);
+        for (size_t l = 0; l < sizeof(lags) / sizeof(lags[0]); l++) {
+            burst_result_t result = rx_burst(descs[d], SIM_RX_SPARES, lags[l]);
+            printf(" %9.1f%%", 100.0 * result.dropped / BURST_FRAMES);
+        }
+        printf("\n");
+    }
+}
+
+/* GMAC transmit ring against a simulated GMAC */
+
+#define SIM_TX_DESCS            16
+#define SIM_TX_QUEUE            16
+
+/* Stands in for a pbuf chain */
+typedef struct {
+    gmac_tx_segment_t segments[GMAC_TX_MAX_SEGMENTS + 1];
+    uint32_t count;
+} sim_tx_frame_t;
+
+typedef struct {
+    gmac_tx_ring_t ring;
+    gmac_tx_desc_t descs[SIM_TX_DESCS];
+    void *owners[SIM_TX_DESCS];
+    void *pending[SIM_TX_QUEUE];
+    uint32_t hw_pos;            /* Next descriptor the GMAC reads */
+    uint32_t bad;               /* Descriptors that did not match their frame */
+} sim_gmac_tx_t;
+
+static sim_gmac_tx_t sim_gmac_tx;
+static sim_tx_frame_t sim_tx_frames[BENCH_MAX_FRAMES];
+static uint8_t sim_tx_headers[SIM_RX_ETH_HEADERS];
+static uint8_t sim_tx_flat[BENCH_MAX_FRAMES][SIM_RX_BUFFER_SIZE];
+
+static uint32_t sim_tx_segments(void *frame, gmac_tx_segment_t *segments, uint32_t max)
+{
+    const sim_tx_frame_t *tx = (const sim_tx_frame_t *)frame;
+
+    if (tx->count > max) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < tx->count; i++) {
+        segments[i] = tx->segments[i];
+    }
+    return tx->count;
+}
+
+static void sim_gmac_tx_init(sim_gmac_tx_t *gmac, uint32_t descs, uint32_t queue)
+{
+    gmac_tx_ring_init(&gmac->ring, gmac->descs, gmac->owners, descs, gmac->pending, queue, sim_tx_segments);
+    gmac->hw_pos = 0;
+    gmac->bad = 0;
+}
+
+/* DMA side: send up to max frames, setting the used bit of each first
+ * descriptor only, as the GMAC does. The host cannot follow the 32-bit
+ * buffer addresses, so the data is reached through the ring's owner. */
+static uint32_t sim_gmac_transmit(sim_gmac_tx_t *gmac, uint32_t max, uint32_t error)
+{
+    gmac_tx_ring_t *ring = &gmac->ring;
+    uint32_t frames = 0;
+
+    while (frames < max && (ring->descs[gmac->hw_pos].status & GMAC_TX_STATUS_USED) == 0) {
+        uint32_t first = gmac->hw_pos;
+        const sim_tx_frame_t *tx = (const sim_tx_frame_t *)ring->owners[first];
+
+        for (uint32_t i = 0; i < tx->count; i++) {
+            const gmac_tx_desc_t *desc = &ring->descs[gmac->hw_pos];
+            const uint8_t *data = (const uint8_t *)tx->segments[i].data;
+
+            if ((desc->status & GMAC_TX_STATUS_LEN_MASK) != tx->segments[i].length ||
+                ((desc->status & GMAC_TX_STATUS_LAST) != 0) != (i + 1 == tx->count) ||
+                desc->addr != (uint32_t)(uintptr_t)data) {
+                gmac->bad++;
+            }
+            bench_sink += data[0] + data[tx->segments[i].length - 1];
+            gmac->hw_pos = (desc->status & GMAC_TX_STATUS_WRAP) ? 0 : gmac->hw_pos + 1;
+        }
+        ring->descs[first].status |= GMAC_TX_STATUS_USED | error;
+        frames++;
+    }
+    return frames;
+}
+
+/* Netif side, as ethernetif_gmac_tx_complete() */
+static uint32_t sim_tx_complete(sim_gmac_tx_t *gmac)
+{
+    void *done[8];
+    uint32_t released = 0;
+    uint32_t count;
+
+    do {
+        count = gmac_tx_ring_reclaim(&gmac->ring, done, 8);
+        gmac_tx_ring_refill(&gmac->ring);
+        released += count;
+    } while (count == 8);
+    return released;
+}
+
+/* Ethernet/IP/TCP headers and one DOIP message per frame. Scatter-gather
+ * sends them as two segments; flat copies them into one buffer first, as
+ * the ASF4 driver did. */
+static size_t tx_ring_cycle(bool flat)
+{
+    size_t frames = 0;
+
+    sim_gmac_tx_init(&sim_gmac_tx, SIM_TX_DESCS, SIM_TX_QUEUE);
+
+    for (size_t f = 0; f < cycle_rx.frames; f++) {
+        sim_tx_frame_t *tx = &sim_tx_frames[f];
+        const uint8_t *payload = &cycle_rx.data[cycle_rx.frame_offset[f]];
+        uint32_t payload_len = (uint32_t)cycle_rx.frame_len[f];
+
+        if (flat) {
+            memcpy(sim_tx_flat[f], sim_tx_headers, SIM_RX_ETH_HEADERS);
+            memcpy(&sim_tx_flat[f][SIM_RX_ETH_HEADERS], payload, payload_len);
+            tx->segments[0].data = sim_tx_flat[f];
+            tx->segments[0].length = SIM_RX_ETH_HEADERS + payload_len;
+            tx->count = 1;
+        } else {
+            tx->segments[0].data = sim_tx_headers;
+            tx->segments[0].length = SIM_RX_ETH_HEADERS;
+            tx->segments[1].data = payload;
+            tx->segments[1].length = payload_len;
+            tx->count = 2;
+        }
+        gmac_tx_ring_send(&sim_gmac_tx.ring, tx);
+
+        if ((f & 3) == 3) {
+            sim_gmac_transmit(&sim_gmac_tx, 4, 0);
+            frames += sim_tx_complete(&sim_gmac_tx);
+        }
+    }
+    while (sim_gmac_tx.ring.busy > 0) {
+        sim_gmac_transmit(&sim_gmac_tx, SIM_TX_DESCS, 0);
+        frames += sim_tx_complete(&sim_gmac_tx);
+    }
+    return frames;
+}
+
+static size_t bench_tx_ring_sg(void)   { return tx_ring_cycle(false); }
+static size_t bench_tx_ring_flat(void) { return tx_ring_cycle(true); }
+
+/* Checksum offload fallback over full-size TCP frames */
+
+#define CSUM_FRAMES             16
+
+static uint8_t csum_frames[CSUM_FRAMES][SIM_RX_BUFFER_SIZE];
+static uint32_t csum_frame_len[CSUM_FRAMES];
+
+static void put_be16(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+/* Ethernet + IPv4 + TCP around len bytes of payload, checksums filled in */
+static uint32_t build_tcp_frame(uint8_t *frame, const uint8_t *payload, uint32_t len, uint16_t ip_id)
+{
+    static const uint8_t addresses[8] = { 192, 168, 100, 20, 192, 168, 100, 118 };
+    uint8_t *ip = &frame[14];
+    uint8_t *tcp = &ip[20];
+    uint32_t sum;
+
+    memset(frame, 0, 14 + 20 + 20);
+    put_be16(&frame[12], 0x0800);
+    ip[0] = 0x45;
+    put_be16(&ip[2], 20 + 20 + len);
+    put_be16(&ip[4], ip_id);
+    put_be16(&ip[6], 0x4000);           /* DF */
+    ip[8] = 64;
+    ip[9] = 6;
+    memcpy(&ip[12], addresses, sizeof(addresses));
+    put_be16(&ip[10], gmac_csum_fold(gmac_csum_add(0, ip, 20)));
+
+    put_be16(&tcp[0], 13400);
+    put_be16(&tcp[2], 49152);
+    tcp[12] = 0x50;
+    tcp[13] = 0x18;                     /* PSH ACK */
+    put_be16(&tcp[14], 8192);
+    memcpy(&tcp[20], payload, len);
+    sum = gmac_csum_add(0, &ip[12], 8) + 6 + 20 + len;
+    put_be16(&tcp[16], gmac_csum_fold(gmac_csum_add(sum, tcp, 20 + len)));
+
+    return 14 + 20 + 20 + len;
+}
+
+static void build_csum_frames(void)
+{
+    for (uint32_t f = 0; f < CSUM_FRAMES; f++) {
+        size_t offset = ((size_t)f * BENCH_TCP_MSS) % (bulk_rx.len - BENCH_TCP_MSS);
+
+        csum_frame_len[f] = build_tcp_frame(csum_frames[f], &bulk_rx.data[offset], BENCH_TCP_MSS, (uint16_t)f);
+    }
+}
+
+static size_t rx_csum_frames(uint32_t hw_status)
+{
+    for (uint32_t f = 0; f < CSUM_FRAMES; f++) {
+        bench_sink += gmac_csum_rx_check(csum_frames[f], csum_frame_len[f], hw_status);
+    }
+    return CSUM_FRAMES;
+}
+
+static size_t bench_rx_csum_sw(void) { return rx_csum_frames(GMAC_RX_CSUM_NONE); }
+static size_t bench_rx_csum_hw(void) { return rx_csum_frames(GMAC_RX_CSUM_IP_TCP); }
+
+/* Receive filter: DoIP unicast among the broadcast and multicast of the
+ * other hosts on the link (mDNS, SSDP, NetBIOS, ARP probes, MLD) */
+
+#define FILTER_FRAMES           16
+#define FILTER_FRAME_SIZE       128
+
+static uint8_t filter_frames[FILTER_FRAMES][FILTER_FRAME_SIZE];
+static uint32_t filter_frame_len[FILTER_FRAMES];
+static gmac_rx_filter_result_t filter_expected[FILTER_FRAMES];
+static gmac_rx_filter_t bench_filter;
+static const uint8_t filter_ip[4] = { 192, 168, 100, 118 };
+static const uint8_t filter_peer[4] = { 192, 168, 100, 1 };
+
+static uint32_t build_udp_frame(uint8_t *frame, const uint8_t dst[6], const uint8_t ip_dst[4], uint16_t port)
+{
+    uint8_t *ip = &frame[14];
+
+    memset(frame, 0, 14 + 20 + 8 + 32);
+    memcpy(frame, dst, 6);
+    put_be16(&frame[12], 0x0800);
+    ip[0] = 0x45;
+    put_be16(&ip[2], 20 + 8 + 32);
+    ip[8] = 1;
+    ip[9] = 17;
+    memcpy(&ip[12], filter_peer, 4);
+    memcpy(&ip[16], ip_dst, 4);
+    put_be16(&ip[20], 50000);
+    put_be16(&ip[22], port);
+    put_be16(&ip[24], 8 + 32);
+    return 14 + 20 + 8 + 32;
+}
+
+static uint32_t build_arp_frame(uint8_t *frame, const uint8_t sender[4], const uint8_t target[4])
+{
+    memset(frame, 0, 14 + 28);
+    memset(frame, 0xFF, 6);
+    put_be16(&frame[12], 0x0806);
+    put_be16(&frame[14], 1);
+    put_be16(&frame[16], 0x0800);
+    frame[18] = 6;
+    frame[19] = 4;
+    put_be16(&frame[20], 1);
+    memcpy(&frame[14 + 14], sender, 4);
+    memcpy(&frame[14 + 24], target, 4);
+    return 14 + 28;
+}
+
+static void build_filter_frames(void)
+{
+    static const uint8_t unicast[6] = { 0x00, 0x00, 0x00, 0x00, 0x20, 0x76 };
+    static const uint8_t broadcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    static const uint8_t mdns[6] = { 0x01, 0x00, 0x5E, 0x00, 0x00, 0xFB };
+    static const uint8_t ssdp[6] = { 0x01, 0x00, 0x5E, 0x7F, 0xFF, 0xFA };
+    static const uint8_t all_ones[4] = { 255, 255, 255, 255 };
+    static const uint8_t subnet[4] = { 192, 168, 100, 255 };
+    static const uint8_t unset[4] = { 0, 0, 0, 0 };
+    static const uint8_t other[4] = { 192, 168, 100, 77 };
+    static const uint8_t mdns_ip[4] = { 224, 0, 0, 251 };
+    static const uint8_t ssdp_ip[4] = { 239, 255, 255, 250 };
+    uint32_t f = 0;
+
+    gmac_rx_filter_init(&bench_filter);
+    gmac_rx_filter_add_port(&bench_filter, 13400);
+    gmac_rx_filter_add_port(&bench_filter, 68);
+
+    /* Half the link is the diagnostic session */
+    for (; f < FILTER_FRAMES / 2; f++) {
+        filter_frame_len[f] = build_tcp_frame(filter_frames[f], cycle_rx.data, 40, (uint16_t)f);
+        memcpy(filter_frames[f], unicast, 6);
+        filter_expected[f] = GMAC_RX_FILTER_PASS;
+    }
+
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], broadcast, all_ones, 13400);
+    filter_expected[f++] = GMAC_RX_FILTER_PASS;
+    filter_frame_len[f] = build_arp_frame(filter_frames[f], filter_peer, filter_ip);
+    filter_expected[f++] = GMAC_RX_FILTER_PASS;
+    filter_frame_len[f] = build_arp_frame(filter_frames[f], unset, other);
+    filter_expected[f++] = GMAC_RX_FILTER_ARP;
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], broadcast, subnet, 137);
+    filter_expected[f++] = GMAC_RX_FILTER_BROADCAST;
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], broadcast, all_ones, 67);
+    filter_expected[f++] = GMAC_RX_FILTER_BROADCAST;
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], mdns, mdns_ip, 5353);
+    filter_expected[f++] = GMAC_RX_FILTER_MULTICAST;
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], ssdp, ssdp_ip, 1900);
+    filter_expected[f++] = GMAC_RX_FILTER_MULTICAST;
+    /* IPv6 to our MAC, as a stale neighbour cache entry would send it */
+    filter_frame_len[f] = build_udp_frame(filter_frames[f], unicast, other, 546);
+    put_be16(&filter_frames[f][12], 0x86DD);
+    filter_expected[f++] = GMAC_RX_FILTER_TYPE;
+}
+
+static size_t bench_rx_filter(void)
+{
+    uint32_t ip;
+
+    memcpy(&ip, filter_ip, sizeof(ip));
+    for (uint32_t f = 0; f < FILTER_FRAMES; f++) {
+        bench_sink += gmac_rx_filter_check(&bench_filter, filter_frames[f], filter_frame_len[f], ip);
+    }
+    return FILTER_FRAMES;
+}
+
+/* Firmware memcpy against the C library, 1514-byte frames taken from
+ * the bulk mix into a word-aligned buffer */
+
+#define MEM_FRAMES              16
+#define MEM_FRAME_SIZE          1514
+
+static uint8_t mem_frame[SIM_RX_BUFFER_SIZE] __attribute__((aligned(4)));
+
+static size_t mem_copy_frames(void *(*volatile copy)(void *, const void *, size_t), size_t src_offset)
+{
+    for (uint32_t f = 0; f < MEM_FRAMES; f++) {
+        size_t offset = (((size_t)f * BENCH_TCP_MSS) % (bulk_rx.len - MEM_FRAME_SIZE)) & ~(size_t)3;
+
+        copy(mem_frame, &bulk_rx.data[offset + src_offset], MEM_FRAME_SIZE);
+    }
+    bench_sink += mem_frame[MEM_FRAME_SIZE - 1];
+    return MEM_FRAMES;
+}
+
+static size_t bench_mem_copy_aligned(void) { return mem_copy_frames(mem_copy, 0); }
+static size_t bench_libc_copy_aligned(void) { return mem_copy_frames((memcpy), 0); }
+static size_t bench_mem_copy_src2(void)    { return mem_copy_frames(mem_copy, 2); }
+static size_t bench_libc_copy_src2(void)   { return mem_copy_frames((memcpy), 2); }
+
+/* Sanity check run once before timing: every segmentation must reproduce the corpus */
+static bool verify_corpus(const bench_stream_t *stream, size_t seg_len)
+{
+    static doip_message_t msg;
+    doip_reassembler_t reasm;
+    size_t frame = 0;
+    size_t pos = 0;
+
+    doip_reasm_reset(&reasm, &msg);
+
+    while (pos < stream->len) {
+        size_t seg = (stream->len - pos < seg_len) ? (stream->len - pos) : seg_len;
+        size_t done = 0;
+
+        while (done < seg) {
+            size_t consumed;
+            doip_reasm_status_t status = doip_reasm_feed(&reasm, &stream->data[pos + done],
+                                                         seg - done, &consumed);
+            done += consumed;
+            if (status == DOIP_REASM_INCOMPLETE) {
+                continue;
+            }
+
+            const uint8_t *expected = &stream->data[stream->frame_offset[frame]];
+            if (status != DOIP_REASM_COMPLETE ||
+                DOIP_HEADER_SIZE + msg.payload_length != stream->frame_len[frame] ||
+                memcmp(msg.payload, expected + DOIP_HEADER_SIZE, msg.payload_length) != 0) {
+                return false;
+            }
+            frame++;
+            doip_reasm_reset(&reasm, &msg);
+        }
+        pos += seg;
+    }
+
+    return frame == stream->frames;
+}
+
+static bool verify_decoders(void)
+{
+    char text[64];
+    uint16_t u16;
+    uint8_t u8;
+
+    return doip_uds_decode_string(uds_samples[0].data, uds_samples[0].len, text, sizeof(text)) &&
+           strcmp(text, "WBAVN31010AE12345") == 0 &&
+           doip_uds_decode_string(uds_samples[0].data, uds_samples[0].len, text, 5) &&
+           strcmp(text, "WBAV") == 0 &&
+           doip_uds_decode_u16(uds_samples[5].data, uds_samples[5].len, &u16) && u16 == 2150 &&
+           doip_uds_decode_u8(uds_samples[9].data, uds_samples[9].len, &u8) && u8 == 85 &&
+           !doip_uds_decode_u16(uds_samples[9].data, uds_samples[9].len, &u16);
+}
+
+static bool verify_rx_ring(void)
+{
+    sim_gmac_t *gmac = &sim_gmac;
+    gmac_rx_frame_t frames[3];
+    uint8_t frame[64];
+    uint8_t *first;
+
+    /* Four descriptors, two spares: two frames are lent, the third is not */
+    sim_gmac_init(gmac, 4, 2);
+    if (!(gmac->descs[3].addr & GMAC_RX_ADDR_WRAP) || (gmac->descs[2].addr & GMAC_RX_ADDR_WRAP)) {
+        return false;
+    }
+    first = gmac->slots[0];
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(frame, 0xA0 + i, sizeof(frame));
+        sim_gmac_receive(gmac, frame, 60 + i, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+    }
+    if (gmac_rx_ring_occupancy(&gmac->ring) != 3 || gmac->ring.occupancy_max != 3) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        if (!gmac_rx_ring_poll(&gmac->ring, &frames[i]) || frames[i].length != 60u + i ||
+            frames[i].buffer[SIM_RX_PAD] != 0xA0 + i || frames[i].loaned != (i < 2)) {
+            return false;
+        }
+    }
+    if (gmac_rx_ring_poll(&gmac->ring, &frames[0]) || frames[0].buffer != first ||
+        (gmac->descs[0].addr & GMAC_RX_ADDR_OWNERSHIP) || gmac->slots[0] == first ||
+        (gmac->descs[0].addr & GMAC_RX_ADDR_MASK) != ((uint32_t)(uintptr_t)gmac->slots[0] & GMAC_RX_ADDR_MASK) ||
+        !(gmac->descs[2].addr & GMAC_RX_ADDR_OWNERSHIP)) {
+        return false;
+    }
+
+    /* The copied frame's descriptor goes back as it was; lent buffers become spares */
+    gmac_rx_ring_return(&gmac->ring, &frames[2]);
+    gmac_rx_ring_free(&gmac->ring, frames[0].buffer);
+    gmac_rx_ring_free(&gmac->ring, frames[1].buffer);
+    if ((gmac->descs[2].addr & GMAC_RX_ADDR_OWNERSHIP) || gmac->ring.spare_count != 2 ||
+        gmac->ring.spare_min != 0 || gmac->ring.loaned != 2) {
+        return false;
+    }
+
+    /* Frames spread over several descriptors are dropped, the next whole frame is kept */
+    sim_gmac_receive(gmac, frame, 60, GMAC_RX_STATUS_SOF);
+    sim_gmac_receive(gmac, frame, 60, GMAC_RX_STATUS_EOF);
+    sim_gmac_receive(gmac, frame, 61, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+    if (!gmac_rx_ring_poll(&gmac->ring, &frames[0]) || frames[0].length != 61 || gmac->ring.errors != 2) {
+        return false;
+    }
+    gmac_rx_ring_free(&gmac->ring, frames[0].buffer);
+
+    /* A full ring drops at the GMAC until the netif catches up */
+    for (int i = 0; i < 5; i++) {
+        sim_gmac_receive(gmac, frame, 60, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+    }
+    if (gmac->bna != 1 || gmac_rx_ring_occupancy(&gmac->ring) != 4 || gmac->ring.occupancy_max != 4) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (!gmac_rx_ring_poll(&gmac->ring, &frames[0])) {
+            return false;
+        }
+        if (frames[0].loaned) {
+            gmac_rx_ring_free(&gmac->ring, frames[0].buffer);
+        } else {
+            gmac_rx_ring_return(&gmac->ring, &frames[0]);
+        }
+    }
+    if (gmac_rx_ring_poll(&gmac->ring, &frames[0]) ||
+        !sim_gmac_receive(gmac, frame, 60, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF)) {
+        return false;
+    }
+
+    /* Taken frames are lent only while more than the kept spares remain */
+    sim_gmac_init(gmac, 4, 2);
+    for (int i = 0; i < 3; i++) {
+        sim_gmac_receive(gmac, frame, 60, GMAC_RX_STATUS_SOF | GMAC_RX_STATUS_EOF);
+    }
+    if (!gmac_rx_ring_take(&gmac->ring, &frames[0]) || frames[0].loaned ||
+        gmac_rx_ring_lend(&gmac->ring, &frames[0], 2) || !gmac_rx_ring_lend(&gmac->ring, &frames[0], 1) ||
+        !gmac_rx_ring_take(&gmac->ring, &frames[1]) || gmac_rx_ring_lend(&gmac->ring, &frames[1], 1) ||
+        !gmac_rx_ring_lend(&gmac->ring, &frames[1], 0) ||
+        !gmac_rx_ring_take(&gmac->ring, &frames[2]) || gmac_rx_ring_lend(&gmac->ring, &frames[2], 0)) {
+        return false;
+    }
+    gmac_rx_ring_return(&gmac->ring, &frames[2]);
+    gmac_rx_ring_free(&gmac->ring, frames[0].buffer);
+    gmac_rx_ring_free(&gmac->ring, frames[1].buffer);
+    return gmac->ring.spare_count == 2 && gmac->ring.loaned == 2 && !gmac_rx_ring_pending(&gmac->ring);
+}
+
+static bool verify_tx_ring(void)
+{
+    sim_gmac_tx_t *gmac = &sim_gmac_tx;
+    static const uint8_t data[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    sim_tx_frame_t frames[7];
+    void *done[4];
+
+    for (uint32_t f = 0; f < 7; f++) {
+        frames[f].count = (f < 2) ? 2 : 1;
+        for (uint32_t i = 0; i < frames[f].count; i++) {
+            frames[f].segments[i].data = &data[f + i];
+            frames[f].segments[i].length = 4 + f + i;
+        }
+    }
+    frames[5].count = GMAC_TX_MAX_SEGMENTS + 1;
+    frames[6].count = 5;
+    for (uint32_t i = 0; i < GMAC_TX_MAX_SEGMENTS + 1; i++) {
+        frames[5].segments[i] = frames[0].segments[0];
+        frames[6].segments[i] = frames[0].segments[0];
+    }
+
+    /* Four descriptors, two queue slots: A and B fill the ring, C and D wait, E is refused */
+    sim_gmac_tx_init(gmac, 4, 2);
+    if (gmac_tx_ring_send(&gmac->ring, &frames[0]) != GMAC_TX_SENT ||
+        gmac_tx_ring_send(&gmac->ring, &frames[1]) != GMAC_TX_SENT ||
+        gmac_tx_ring_send(&gmac->ring, &frames[2]) != GMAC_TX_QUEUED ||
+        gmac_tx_ring_send(&gmac->ring, &frames[3]) != GMAC_TX_QUEUED ||
+        gmac_tx_ring_send(&gmac->ring, &frames[4]) != GMAC_TX_FULL ||
+        gmac_tx_ring_send(&gmac->ring, &frames[5]) != GMAC_TX_INVALID ||
+        gmac_tx_ring_send(&gmac->ring, &frames[6]) != GMAC_TX_INVALID) {
+        return false;
+    }
+    if ((gmac->descs[0].status & (GMAC_TX_STATUS_LAST | GMAC_TX_STATUS_USED)) ||
+        !(gmac->descs[1].status & GMAC_TX_STATUS_LAST) ||
+        !(gmac->descs[3].status & GMAC_TX_STATUS_WRAP) ||
+        gmac_tx_ring_reclaim(&gmac->ring, done, 4) != 0 || gmac_tx_ring_refill(&gmac->ring)) {
+        return false;
+    }
+
+    /* A completes: its descriptors are taken back and C and D move in */
+    if (sim_gmac_transmit(gmac, 1, 0) != 1 || gmac_tx_ring_reclaim(&gmac->ring, done, 4) != 1 ||
+        done[0] != &frames[0] || !(gmac->descs[1].status & GMAC_TX_STATUS_USED) ||
+        !gmac_tx_ring_refill(&gmac->ring) || gmac->ring.pending_count != 0 || gmac->ring.busy != 4) {
+        return false;
+    }
+
+    /* B, C and D go out in order, C with an error, reclaimed two at a time */
+    if (sim_gmac_transmit(gmac, 1, 0) != 1 || sim_gmac_transmit(gmac, 1, GMAC_TX_STATUS_RETRY_LIMIT) != 1 ||
+        sim_gmac_transmit(gmac, 4, 0) != 1 ||
+        gmac_tx_ring_reclaim(&gmac->ring, done, 2) != 2 || done[0] != &frames[1] || done[1] != &frames[2] ||
+        gmac_tx_ring_reclaim(&gmac->ring, done, 2) != 1 || done[0] != &frames[3]) {
+        return false;
+    }
+
+    return gmac->ring.busy == 0 && gmac->ring.errors == 1 && gmac->ring.frames == 4 &&
+           gmac->ring.queued == 2 && gmac->ring.overflows == 1 && gmac->bad == 0 &&
+           tx_ring_cycle(false) == cycle_rx.frames && tx_ring_cycle(true) == cycle_rx.frames &&
+           gmac->bad == 0;
+}
+
+static bool verify_csum(void)
+{
+    static const uint8_t rfc1071[8] = { 0x00, 0x01, 0xF2, 0x03, 0xF4, 0xF5, 0xF6, 0xF7 };
+    static uint8_t frame[SIM_RX_BUFFER_SIZE];
+    uint32_t len = build_tcp_frame(frame, bulk_rx.data, 101, 7);
+    bool ok = gmac_csum_fold(gmac_csum_add(0, rfc1071, sizeof(rfc1071))) == (uint16_t)~0xDDF2 &&
+              gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_NONE) == GMAC_CSUM_SW &&
+              gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_IP_TCP) == GMAC_CSUM_HW;
+
+    /* Damaged payload: caught in software, trusted when the GMAC checked it */
+    frame[len - 1] ^= 0x01;
+    ok = ok && gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_NONE) == GMAC_CSUM_BAD &&
+         gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_IP) == GMAC_CSUM_BAD &&
+         gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_IP_TCP) == GMAC_CSUM_HW;
+    frame[len - 1] ^= 0x01;
+
+    /* Damaged IP header: only checked when the GMAC did not */
+    frame[14 + 8] ^= 0x01;
+    ok = ok && gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_NONE) == GMAC_CSUM_BAD &&
+         gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_IP) == GMAC_CSUM_SW;
+    frame[14 + 8] ^= 0x01;
+
+    /* Fragments and non-IP frames are left alone; a zero UDP checksum is valid */
+    frame[14 + 6] = 0x20;
+    frame[14 + 10] = frame[14 + 11] = 0;
+    put_be16(&frame[14 + 10], gmac_csum_fold(gmac_csum_add(0, &frame[14], 20)));
+    ok = ok && gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_NONE) == GMAC_CSUM_NOT_CHECKED;
+    frame[14 + 6] = 0x40;
+    frame[14 + 9] = 17;
+    frame[14 + 10] = frame[14 + 11] = 0;
+    put_be16(&frame[14 + 10], gmac_csum_fold(gmac_csum_add(0, &frame[14], 20)));
+    put_be16(&frame[14 + 20 + 6], 0);
+    ok = ok && gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_IP) == GMAC_CSUM_SW;
+    put_be16(&frame[12], 0x0806);
+    ok = ok && gmac_csum_rx_check(frame, len, GMAC_RX_CSUM_NONE) == GMAC_CSUM_NOT_CHECKED;
+
+    for (uint32_t f = 0; f < CSUM_FRAMES; f++) {
+        ok = ok && gmac_csum_rx_check(csum_frames[f], csum_frame_len[f], GMAC_RX_CSUM_NONE) == GMAC_CSUM_SW;
+    }
+    return ok;
+}
+
+/* Hash of _mac_async_set_filter_ex() in the ASF4 GMAC driver, minus its
+ * read past the address for the last slice (masked off there anyway) */
+static uint32_t hpl_gmac_hash(const uint8_t mac[6])
+{
+    uint8_t k = 0;
+
+    for (uint8_t j = 0; j < 48; j += 6) {
+        uint8_t n = j / 8, m = j % 8;
+        uint8_t next = (n < 5) ? mac[n + 1] : 0;
+        k ^= m ? (uint8_t)((mac[n] >> m) | (next << (8 - m))) : mac[n];
+    }
+    return k & 0x3F;
+}
+
+static bool verify_rx_filter(void)
+{
+    static const uint8_t groups[3][6] = {
+        { 0x01, 0x00, 0x5E, 0x00, 0x00, 0x01 },
+        { 0x01, 0x00, 0x5E, 0x00, 0x00, 0xFB },
+        { 0x33, 0x33, 0xFF, 0x12, 0x34, 0x56 },
+    };
+    gmac_rx_filter_t filter;
+    uint32_t ip, bottom, top;
+    bool ok = true;
+
+    memcpy(&ip, filter_ip, sizeof(ip));
+    for (uint32_t f = 0; f < FILTER_FRAMES; f++) {
+        ok = ok && gmac_rx_filter_check(&bench_filter, filter_frames[f], filter_frame_len[f], ip) == filter_expected[f];
+    }
+    /* Until DHCP has given us an address every ARP goes up */
+    ok = ok && gmac_rx_filter_check(&bench_filter, filter_frames[FILTER_FRAMES / 2 + 2],
+                                    filter_frame_len[FILTER_FRAMES / 2 + 2], 0) == GMAC_RX_FILTER_PASS;
+
+    /* DoIP either way round goes first; the broadcast DoIP datagram too */
+    for (uint32_t f = 0; f < FILTER_FRAMES; f++) {
+        bool doip = f < FILTER_FRAMES / 2 || f == FILTER_FRAMES / 2;
+        ok = ok && gmac_rx_filter_priority(filter_frames[f], filter_frame_len[f], 13400) == doip;
+    }
+
+    /* Joined groups pass and set the same hash bits as the ASF4 driver */
+    gmac_rx_filter_init(&filter);
+    for (uint32_t g = 0; g < 3; g++) {
+        uint32_t index = hpl_gmac_hash(groups[g]);
+        ok = ok && gmac_rx_filter_join(&filter, groups[g]);
+        gmac_rx_filter_hash(&filter, &bottom, &top);
+        ok = ok && ((index < 32 ? bottom >> index : top >> (index - 32)) & 1u);
+    }
+    ok = ok && gmac_rx_filter_join(&filter, groups[1]) &&
+         gmac_rx_filter_check(&filter, filter_frames[FILTER_FRAMES - 3], filter_frame_len[FILTER_FRAMES - 3], ip) ==
+             GMAC_RX_FILTER_PASS;
+    /* Joins are counted: the group stays until the last leave */
+    ok = ok && gmac_rx_filter_leave(&filter, groups[1]) && gmac_rx_filter_leave(&filter, groups[0]) &&
+         gmac_rx_filter_check(&filter, filter_frames[FILTER_FRAMES - 3], filter_frame_len[FILTER_FRAMES - 3], ip) ==
+             GMAC_RX_FILTER_PASS &&
+         gmac_rx_filter_leave(&filter, groups[1]) && !gmac_rx_filter_leave(&filter, groups[1]) &&
+         gmac_rx_filter_check(&filter, filter_frames[FILTER_FRAMES - 3], filter_frame_len[FILTER_FRAMES - 3], ip) ==
+             GMAC_RX_FILTER_MULTICAST;
+    gmac_rx_filter_hash(&filter, &bottom, &top);
+    ok = ok && filter.group_count == 1 &&
+         bottom + top == (1u << (hpl_gmac_hash(groups[2]) % 32));
+    return ok;
+}
+
+/* Every size up to a few blocks at every pair of word offsets, with
+ * guard bytes either side; mem_move also in both directions of overlap */
+static bool verify_mem_copy(void)
+{
+    enum { MAX_LEN = 80, GUARD = 8, SPAN = GUARD + 16 + 4 + MAX_LEN + 16 + GUARD };
+    static uint8_t src[SPAN] __attribute__((aligned(4)));
+    static uint8_t dst[SPAN] __attribute__((aligned(4)));
+    static uint8_t expect[SPAN] __attribute__((aligned(4)));
+    bool ok = true;
+
+    for (size_t i = 0; i < SPAN; i++) {
+        src[i] = (uint8_t)(i * 13u + 5u);
+    }
+
+    for (size_t len = 0; len <= MAX_LEN && ok; len++) {
+        for (size_t d = 0; d < 4; d++) {
+            for (size_t so = 0; so < 4; so++) {
+                (memset)(dst, 0xEE, SPAN);
+                (memset)(expect, 0xEE, SPAN);
+                for (size_t i = 0; i < len; i++) {
+                    expect[GUARD + d + i] = src[GUARD + so + i];
+                }
+                ok = ok && mem_copy(&dst[GUARD + d], &src[GUARD + so], len) == &dst[GUARD + d] &&
+                     memcmp(dst, expect, SPAN) == 0;
+
+                (memset)(dst, 0xEE, SPAN);
+                for (size_t i = 0; i < len; i++) {
+                    expect[GUARD + d + i] = 0xA5;
+                }
+                ok = ok && mem_set(&dst[GUARD + d], 0x1A5, len) == &dst[GUARD + d] && memcmp(dst, expect, SPAN) == 0;
+            }
+
+            /* Source and destination within one buffer, up to 16 bytes apart */
+            for (int shift = -16; shift <= 16; shift++) {
+                uint8_t *from = &dst[GUARD + 16 + d];
+
+                for (size_t i = 0; i < SPAN; i++) {
+                    dst[i] = expect[i] = (uint8_t)(i * 7u + 3u);
+                }
+                for (size_t i = 0; i < len; i++) {
+                    expect[GUARD + 16 + d + shift + i] = (uint8_t)((GUARD + 16 + d + i) * 7u + 3u);
+                }
+                ok = ok && mem_move(from + shift, from, len) == from + shift && memcmp(dst, expect, SPAN) == 0;
+            }
+        }
+    }
+
+    /* Full frames at the offsets the firmware sees */
+    for (size_t so = 0; so < 4 && ok; so++) {
+        mem_copy(mem_frame, &bulk_rx.data[so], MEM_FRAME_SIZE);
+        ok = memcmp(mem_frame, &bulk_rx.data[so], MEM_FRAME_SIZE) == 0;
+        mem_move(&mem_frame[so], mem_frame, MEM_FRAME_SIZE - so);
+        ok = ok && memcmp(&mem_frame[so], &bulk_rx.data[so], MEM_FRAME_SIZE - so) == 0;
+    }
+    return ok;
+}
+
+static const bench_case_t bench_cases[] = {
+    { "header_decode",       "8-byte header decode + validate, cycle mix",        bench_header_decode },
+    { "parse_header",        "doip_parse_header on whole datagrams, cycle mix",   bench_parse_header },
+    { "serialize_header",    "8-byte header encode, tester requests",             bench_serialize_header },
+    { "serialize_message",   "header + payload encode, tester requests",          bench_serialize_message },
+    { "uds_decode",          "RDBI positive response decode, string/u16/u8 mix",  bench_uds_decode },
+    { "reasm_cycle_msg",     "reassembly, cycle mix, one segment per message",    bench_reasm_cycle_msg },
+    { "reasm_cycle_split",   "reassembly, cycle mix, header and payload apart",   bench_reasm_cycle_split },
+    { "reasm_cycle_mss",     "reassembly, cycle mix, 1460-byte TCP segments",     bench_reasm_cycle_mss },
+    { "reasm_cycle_byte",    "reassembly, cycle mix, one byte per segment",       bench_reasm_cycle_byte },
+    { "reasm_bulk_msg",      "reassembly, 1024-byte payloads, per message",       bench_reasm_bulk_msg },
+    { "reasm_bulk_mss",      "reassembly, 1024-byte payloads, 1460-byte segments", bench_reasm_bulk_mss },
+    { "rx_cycle_decode",     "reassemble + UDS decode, cycle mix, coalesced",     bench_rx_cycle_decode },
+    { "rx_ring_loan",        "GMAC RX ring, cycle mix frames lent to lwIP",       bench_rx_ring_loan },
+    { "rx_ring_copy",        "GMAC RX ring, no spares, frames copied out",        bench_rx_ring_copy },
+    { "rx_burst_d4",         "GMAC RX ring, 4 descriptors, 1514-byte bursts",     bench_rx_burst_d4 },
+    { "rx_burst_d8",         "GMAC RX ring, 8 descriptors, 1514-byte bursts",     bench_rx_burst_d8 },
+    { "rx_burst_d16",        "GMAC RX ring, 16 descriptors, 1514-byte bursts",    bench_rx_burst_d16 },
+    { "tx_ring_sg",          "GMAC TX ring, headers + payload as two segments",   bench_tx_ring_sg },
+    { "tx_ring_flat",        "GMAC TX ring, frames copied into one buffer first", bench_tx_ring_flat },
+    { "rx_csum_sw",          "IPv4 + TCP checksum in software, 1514-byte frames", bench_rx_csum_sw },
+    { "rx_csum_hw",          "checksums checked by the GMAC, 1514-byte frames",   bench_rx_csum_hw },
+    { "rx_filter",           "receive filter, DoIP among broadcast/multicast",    bench_rx_filter },
+    { "mem_copy_aligned",    "firmware memcpy, 1514-byte frames, aligned",        bench_mem_copy_aligned },
+    { "libc_copy_aligned",   "C library memcpy, 1514-byte frames, aligned",       bench_libc_copy_aligned },
+    { "mem_copy_src2",       "firmware memcpy, 1514-byte frames, source at +2",   bench_mem_copy_src2 },
+    { "libc_copy_src2",      "C library memcpy, 1514-byte frames, source at +2",  bench_libc_copy_src2 },
+};
+
+/* Harness */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void run_case(const bench_case_t *bench, unsigned samples, unsigned min_ms,
+                     bench_result_t *result)
+{
+    uint64_t min_ns = (uint64_t)min_ms * 1000000ULL;
+    uint64_t batches = 1;
+    double best = 0.0;
+    uint64_t best_msgs = 0;
+    size_t msgs_per_batch;
+    unsigned s;
+
+    /* Copy accounting from a single deterministic batch */
+    bench_bytes_copied = 0;
+    msgs_per_batch = bench->run();
+    result->bytes_copied_per_msg = (double)bench_bytes_copied / (double)msgs_per_batch;
+
+    /* Calibrate batch count so one sample lasts at least min_ms */
+    for (;;) {
+        uint64_t start = now_ns();
+        for (uint64_t b = 0; b < batches; b++) {
+            bench->run();
+        }
+        if (now_ns() - start >= min_ns || batches >= (1ULL << 40)) {
+            break;
+        }
+        batches *= 2;
+    }
+
+    /* Best of N samples is the least noisy estimate on a shared host */
+    for (s = 0; s < samples; s++) {
+        uint64_t start = now_ns();
+        for (uint64_t b = 0; b < batches; b++) {
+            bench->run();
+        }
+        uint64_t elapsed = now_ns() - start;
+        double ns = (double)elapsed / (double)(batches * msgs_per_batch);
+
+        if (s == 0 || ns < best) {
+            best = ns;
+            best_msgs = batches * msgs_per_batch;
+        }
+    }
+
+    result->name = bench->name;
+    result->iterations = best_msgs;
+    result->ns_per_msg = best;
+}
+
+static bool write_json(const char *path, const bench_result_t *results, size_t count)
+{
+    FILE *f = fopen(path, "w");
+    size_t i;
+
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+
+    /* One result per line keeps the file diffable and trivially parseable */
+    fprintf(f, "{\n");
+    fprintf(f, "  \"schema\": 1,\n");
+    fprintf(f, "  \"suite\": \"doip_protocol\",\n");
+#ifdef __VERSION__
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+#ifdef BENCH_CFLAGS
+    fprintf(f, "  \"cflags\": \"%s\",\n", BENCH_CFLAGS);
+#endif
+    fprintf(f, "  \"results\": [\n");
+    for (i = 0; i < count; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_msg\": %.3f, "
+                   "\"bytes_copied_per_msg\": %.2f}%s\n",
+                results[i].name, (unsigned long long)results[i].iterations,
+                results[i].ns_per_msg, results[i].bytes_copied_per_msg,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+static bool lookup_baseline(const char *path, const char *name, double *ns, double *copied)
+{
+    char line[512];
+    char key[96];
+    FILE *f = fopen(path, "r");
+    bool found = false;
+
+    if (f == NULL) {
+        return false;
+    }
+
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    while (fgets(line, sizeof(line), f) != NULL) {
+        const char *p = strstr(line, key);
+        const char *q;
+
+        if (p == NULL) {
+            continue;
+        }
+        q = strstr(line, "\"ns_per_msg\":");
+        if (q == NULL || sscanf(q, "\"ns_per_msg\": %lf", ns) != 1) {
+            continue;
+        }
+        q = strstr(line, "\"bytes_copied_per_msg\":");
+        if (q == NULL || sscanf(q, "\"bytes_copied_per_msg\": %lf", copied) != 1) {
+            continue;
+        }
+        found = true;
+        break;
+    }
+
+    fclose(f);
+    return found;
+}
+
+static void usage(const char *argv0)
+{
+    printf("Usage: %s [options]\n", argv0);
+    printf("  --samples N      timed samples per case, best is reported (default 7)\n");
+    printf("  --min-ms M       minimum duration of one sample in ms (default 50)\n");
+    printf("  --filter STR     only run cases whose name contains STR\n");
+    printf("  --out FILE       write results as JSON\n");
+    printf("  --compare FILE   compare against a JSON baseline\n");
+    printf("  --max-regress P  exit non-zero if any case is more than P%% slower\n                   or copies more bytes per message\n");
+    printf("  --list           list cases and exit\n");
+}
+
+int main(int argc, char **argv)
+{
+    static bench_result_t results[BENCH_MAX_CASES];
+    const char *out_path = NULL;
+    const char *compare_path = NULL;
+    const char *filter = NULL;
+    unsigned samples = 7;
+    unsigned min_ms = 50;
+    double max_regress = -1.0;
+    size_t count = 0;
+    bool burst_ran = false;
+    int status = EXIT_SUCCESS;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            min_ms = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            compare_path = argv[++i];
+        } else if (strcmp(argv[i], "--max-regress") == 0 && i + 1 < argc) {
+            max_regress = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--list") == 0) {
+            for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+                printf("%-20s %s\n", bench_cases[c].name, bench_cases[c].description);
+            }
+            return EXIT_SUCCESS;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (samples == 0) {
+        samples = 1;
+    }
+
+    build_corpus();
+    build_csum_frames();
+    build_filter_frames();
+
+    static const size_t verify_segments[] = { 1, 3, DOIP_HEADER_SIZE, 61, BENCH_TCP_MSS, BENCH_STREAM_SIZE };
+    for (size_t v = 0; v < sizeof(verify_segments) / sizeof(verify_segments[0]); v++) {
+        if (!verify_corpus(&cycle_rx, verify_segments[v]) || !verify_corpus(&bulk_rx, verify_segments[v])) {
+            fprintf(stderr, "reassembly self-check failed (segment size %zu)\n", verify_segments[v]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!verify_decoders()) {
+        fprintf(stderr, "UDS decoder self-check failed\n");
+        return EXIT_FAILURE;
+    }
+    if (!verify_rx_ring()) {
+        fprintf(stderr, "GMAC RX ring self-check failed\n");
+        return EXIT_FAILURE;
+    }
+    if (!verify_tx_ring()) {
+        fprintf(stderr, "GMAC TX ring self-check failed\n");
+        return EXIT_FAILURE;
+    }
+    if (!verify_csum()) {
+        fprintf(stderr, "checksum offload self-check failed\n");
+        return EXIT_FAILURE;
+    }
+    if (!verify_rx_filter()) {
+        fprintf(stderr, "receive filter self-check failed\n");
+        return EXIT_FAILURE;
+    }
+    if (!verify_mem_copy()) {
+        fprintf(stderr, "mem_copy self-check failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-20s %12s %14s", "case", "ns/msg", "copied B/msg");
+    if (compare_path != NULL) {
+        printf(" %12s %10s", "base ns/msg", "delta");
+    }
+    printf("\n");
+
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        bench_result_t *result = &results[count];
+        double base_ns, base_copied;
+
+        if (filter != NULL && strstr(bench_cases[c].name, filter) == NULL) {
+            continue;
+        }
+
+        run_case(&bench_cases[c], samples, min_ms, result);
+        count++;
+        burst_ran |= strncmp(result->name, "rx_burst", 8) == 0;
+
+        printf("%-20s %12.2f %14.2f", result->name, result->ns_per_msg, result->bytes_copied_per_msg);
+        if (compare_path != NULL) {
+            if (lookup_baseline(compare_path, result->name, &base_ns, &base_copied) && base_ns > 0.0) {
+                double delta = (result->ns_per_msg - base_ns) * 100.0 / base_ns;
+
+                printf(" %12.2f %+9.1f%%", base_ns, delta);
+                if (fabs(result->bytes_copied_per_msg - base_copied) >= 0.01) {
+                    printf("  (copied %.2f -> %.2f)", base_copied, result->bytes_copied_per_msg);
+                }
+                /* Copy counts are deterministic, so any increase is a regression */
+                if (max_regress >= 0.0 &&
+                    (delta > max_regress || result->bytes_copied_per_msg > base_copied + 0.01)) {
+                    printf("  REGRESSION");
+                    status = EXIT_FAILURE;
+                }
+            } else {
+                printf(" %12s %10s", "-", "new");
+            }
+        }
+        printf("\n");
+    }
+
+    if (burst_ran) {
+        report_rx_burst();
+    }
+
+    if (out_path != NULL) {
+        if (!write_json(out_path, results, count)) {
+            return EXIT_FAILURE;
+        }
+        printf("Results written to %s\n", out_path);
+    }
+
+    return status;
+}
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+DOIP Deferred Log Decoder
+Decodes the "[DLOG] <hex>" lines written by dlog.c when it is built with
+DLOG_DRAIN_BINARY=1. Entries carry only the address of their format
+string and raw argument words; the strings are read back from the ELF
+the firmware was built from, so the image must match the log.
+
+Usage:
+    python3 dlog_decode.py build/doip_client.elf rtt_log.txt
+    make -f Makefile.posix run | python3 dlog_decode.py build_posix/doip_posix
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+DLOG_LINE = re.compile(r"\[DLOG\] ([0-9a-fA-F]{4,})\s*$")
+
+ANCHOR_SYMBOL = "dlog_anchor"
+
+LEVEL_NAMES = {1: "ERR", 2: "WRN", 3: "INF", 4: "DBG"}
+MODULE_NAMES = {0: "doip", 1: "tcp", 2: "net", 3: "eth"}
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+# printf conversion: flags, width, precision, length, conversion
+FORMAT_SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class Elf:
+    """Minimal ELF32/ELF64 reader: allocated sections and the symbol table"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+
+        if self.is64:
+            shoff, = struct.unpack_from(self.endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(self.endian + "HH", self.data, 0x3A)
+            sh_fmt = "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(self.endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(self.endian + "HH", self.data, 0x2E)
+            sh_fmt = "IIIIIIIIII"
+
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size, link, _, _, entsize) = \
+                struct.unpack_from(self.endian + sh_fmt, self.data, shoff + i * shentsize)
+            self.sections.append((sh_type, flags, addr, offset, size, link, entsize))
+
+    def symbol(self, name):
+        wanted = name.encode()
+        for sh_type, _, _, offset, size, link, entsize in self.sections:
+            if sh_type != SHT_SYMTAB:
+                continue
+            strtab = self.sections[link][3]
+            for pos in range(offset, offset + size, entsize):
+                if self.is64:
+                    st_name, _, _, _, value, _ = struct.unpack_from(self.endian + "IBBHQQ", self.data, pos)
+                else:
+                    st_name, value, _, _, _, _ = struct.unpack_from(self.endian + "IIIBBH", self.data, pos)
+                end = self.data.index(b"\0", strtab + st_name)
+                if self.data[strtab + st_name:end] == wanted:
+                    return value
+        return None
+
+    def string(self, addr):
+        for sh_type, flags, sh_addr, offset, size, _, _ in self.sections:
+            if not (flags & SHF_ALLOC) or sh_type == SHT_NOBITS:
+                continue
+            if sh_addr <= addr < sh_addr + size:
+                start = offset + addr - sh_addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode(errors="replace")
+        return None
+
+
+class Reader:
+    """Cursor over one line's bytes, little-endian"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def remaining(self):
+        return len(self.data) - self.pos
+
+    def uint(self, size):
+        value = int.from_bytes(self.data[self.pos:self.pos + size], "little")
+        self.pos += size
+        return value
+
+
+def format_entry(elf, relocate, fmt, args, ptr_size):
+    """Apply a C printf format to raw argument words"""
+    words = iter(args)
+
+    def convert(match):
+        flags, width, precision, length, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = next(words, 0)
+
+        if conv == "s":
+            text = elf.string(relocate(value))
+            return ("%" + flags + width + "s") % (text if text is not None else "<0x%x>" % value)
+        if conv == "p":
+            return "0x%0*x" % (ptr_size * 2, value)
+
+        bits = {"hh": 8, "h": 16}.get(length, 32)
+        if length in ("l", "ll", "z", "j", "t"):
+            bits = 64 if (length == "ll" or ptr_size == 8) else 32
+        value &= (1 << bits) - 1
+        if conv in "di" and value >> (bits - 1):
+            value -= 1 << bits
+
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        return (spec + ("d" if conv in "diu" else conv)) % value
+
+    return FORMAT_SPEC.sub(convert, fmt)
+
+
+def decode_line(elf, anchor_sym, data, out):
+    reader = Reader(data)
+    if reader.uint(1) != ord("L"):
+        raise ValueError("bad magic")
+    ptr_size = reader.uint(1)
+    anchor = reader.uint(ptr_size)
+    dropped = reader.uint(4)
+
+    # Position independent images are loaded at an offset from their link address
+    delta = anchor - anchor_sym
+
+    def relocate(addr):
+        return addr - delta
+
+    while reader.remaining() > 0:
+        fmt_addr = reader.uint(ptr_size)
+        ts_us = reader.uint(4)
+        level = reader.uint(1)
+        module = reader.uint(1)
+        argc = reader.uint(1)
+        args = [reader.uint(ptr_size) for _ in range(argc)]
+
+        fmt = elf.string(relocate(fmt_addr))
+        if fmt is None:
+            text = "<unknown format 0x%x> %s" % (fmt_addr, " ".join("0x%x" % a for a in args))
+        else:
+            text = format_entry(elf, relocate, fmt, args, ptr_size)
+
+        out.write("%6u.%06u %s %-4s %s\n" % (ts_us // 1000000, ts_us % 1000000,
+                                            LEVEL_NAMES.get(level, str(level)),
+                                            MODULE_NAMES.get(module, str(module)), text))
+
+    return dropped
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DOIP deferred binary log lines")
+    parser.add_argument("elf", help="firmware or host image the log was produced by")
+    parser.add_argument("logfile", nargs="?", help="console/RTT log (default: stdin)")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    anchor_sym = elf.symbol(ANCHOR_SYMBOL)
+    if anchor_sym is None:
+        print("%s: symbol %s not found (built without dlog.c?)" % (args.elf, ANCHOR_SYMBOL),
+              file=sys.stderr)
+        return 1
+
+    stream = open(args.logfile, errors="replace") if args.logfile else sys.stdin
+    dropped = 0
+    with stream:
+        for line in stream:
+            match = DLOG_LINE.search(line)
+            if match:
+                dropped = decode_line(elf, anchor_sym, bytes.fromhex(match.group(1)), sys.stdout)
+            else:
+                sys.stdout.write(line)
+
+    if dropped:
+        print("dlog: %u entries dropped (ring full)" % dropped, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
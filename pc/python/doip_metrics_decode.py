@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+DOIP Latency Histogram Decoder
+Decodes the "[METRICS] <hex>" dumps written by doip_telemetry.c (console
+key 'm', or automatically at the end of a DOIP_CYCLES run) and prints
+count, p50, p90, p99 and max per phase and per DID.
+
+Usage:
+    python3 doip_metrics_decode.py rtt_log.txt          # last dump in a log
+    python3 doip_metrics_decode.py --all rtt_log.txt    # every dump
+    make -f Makefile.posix run | python3 doip_metrics_decode.py --json
+"""
+
+import argparse
+import json
+import re
+import sys
+
+METRICS_LINE = re.compile(r"\[METRICS\] ([0-9a-fA-F]{12,})\s*$")
+
+PHASE_NAMES = {0: "discovery", 1: "connect", 2: "activation"}
+
+DID_NAMES = {
+    0xF190: "VIN",
+    0xF1A0: "ECU_SW_VERSION",
+    0xF1A1: "ECU_HW_VERSION",
+    0xF186: "ACTIVE_SESSION",
+    0xF18C: "ECU_SERIAL_NUMBER",
+    0xF1A7: "VEHICLE_SPEED",
+    0xF1A8: "ENGINE_RPM",
+    0xF1A9: "BATTERY_VOLTAGE",
+    0xF1AA: "TEMPERATURE",
+    0xF1AB: "FUEL_LEVEL",
+}
+
+
+class Reader:
+    """Cursor over the dump bytes"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def u8(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def u16(self):
+        return (self.u8() << 8) | self.u8()
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.u8()
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+
+
+def bucket_lower(bucket, sub_bits):
+    """Mirror of doip_hist_bucket_lower() in doip_metrics.c"""
+    sub_count = 1 << sub_bits
+    if bucket < sub_count:
+        return bucket
+    exp = (bucket >> sub_bits) + sub_bits - 1
+    return (sub_count | (bucket & (sub_count - 1))) << (exp - sub_bits)
+
+
+def percentile(hist, permille, sub_bits, nbuckets):
+    """Mirror of doip_hist_percentile(): upper bound of the rank's bucket"""
+    if hist["count"] == 0:
+        return 0
+    rank = max(1, (hist["count"] * permille + 999) // 1000)
+    seen = 0
+    for bucket, count in sorted(hist["buckets"].items()):
+        seen += count
+        if seen >= rank:
+            if bucket + 1 >= nbuckets:
+                return hist["max_us"]
+            return min(bucket_lower(bucket + 1, sub_bits) - 1, hist["max_us"])
+    return hist["max_us"]
+
+
+def decode(data):
+    """Decode one binary dump into a dict"""
+    r = Reader(data)
+    if r.u8() != ord("D") or r.u8() != ord("M"):
+        raise ValueError("bad magic")
+    version = r.u8()
+    if version != 1:
+        raise ValueError(f"unsupported version {version}")
+    sub_bits = r.u8()
+    nbuckets = r.u8()
+    nhist = r.u8()
+    dump = {"sub_bits": sub_bits, "buckets": nbuckets, "did_overflow": r.varint(), "histograms": []}
+
+    for _ in range(nhist):
+        kind = r.u8()
+        ident = r.u16()
+        hist = {
+            "kind": "phase" if kind == 0 else "did",
+            "id": ident,
+            "count": r.varint(),
+            "failed": r.varint(),
+            "min_us": r.varint(),
+            "max_us": r.varint(),
+            "sum_us": r.varint(),
+            "buckets": {},
+        }
+        for _ in range(r.u8()):
+            bucket = r.u8()
+            hist["buckets"][bucket] = r.varint()
+
+        if kind == 0:
+            hist["name"] = PHASE_NAMES.get(ident, f"phase{ident}")
+        else:
+            hist["name"] = f"0x{ident:04X} {DID_NAMES.get(ident, '')}".rstrip()
+        for label, permille in (("p50_us", 500), ("p90_us", 900), ("p99_us", 990)):
+            hist[label] = percentile(hist, permille, sub_bits, nbuckets)
+        hist["mean_us"] = hist["sum_us"] // hist["count"] if hist["count"] else 0
+        dump["histograms"].append(hist)
+
+    if r.pos != len(data):
+        raise ValueError(f"{len(data) - r.pos} trailing bytes")
+    return dump
+
+
+def print_table(dump):
+    print(f"{'histogram':<26} {'count':>7} {'fail':>5} {'min':>9} {'p50':>9} "
+          f"{'p90':>9} {'p99':>9} {'max':>9} {'mean':>9}  (us)")
+    for h in dump["histograms"]:
+        print(f"{h['name']:<26} {h['count']:>7} {h['failed']:>5} {h['min_us']:>9} "
+              f"{h['p50_us']:>9} {h['p90_us']:>9} {h['p99_us']:>9} {h['max_us']:>9} {h['mean_us']:>9}")
+    if dump["did_overflow"]:
+        print(f"{dump['did_overflow']} samples dropped: more DIDs than DOIP_METRICS_MAX_DIDS")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DOIP latency histogram dumps")
+    parser.add_argument("logfile", nargs="?", help="console/RTT log (default: stdin)")
+    parser.add_argument("--all", action="store_true", help="decode every dump, not only the last")
+    parser.add_argument("--json", action="store_true", help="print JSON instead of a table")
+    args = parser.parse_args()
+
+    stream = open(args.logfile, errors="replace") if args.logfile else sys.stdin
+    dumps = []
+    with stream:
+        for line in stream:
+            match = METRICS_LINE.search(line)
+            if match:
+                dumps.append(bytes.fromhex(match.group(1)))
+
+    if not dumps:
+        print("No [METRICS] dump found", file=sys.stderr)
+        return 1
+    if not args.all:
+        dumps = dumps[-1:]
+
+    decoded = [decode(d) for d in dumps]
+    if args.json:
+        for d in decoded:
+            for h in d["histograms"]:
+                h["buckets"] = {str(k): v for k, v in h["buckets"].items()}
+        print(json.dumps(decoded if args.all else decoded[0], indent=2))
+    else:
+        for i, d in enumerate(decoded):
+            if i:
+                print()
+            print_table(d)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
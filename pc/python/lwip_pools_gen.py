@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+lwIP Pool Profile Generator
+Reads the "[LWIPMEM]" pool table printed by net_stats_print_pools() (console
+key 'p', and the end of a DOIP_CYCLES run) and writes an lwipopts profile:
+each pool sized to its peak plus headroom, and the RAM this frees from the
+configuration that was measured spent on extra pool pbufs and a wider TCP
+window. Best measured with LWIP_MEM_PROFILE=1, whose doubled pools record
+demand rather than the configured limits.
+
+Usage:
+    python3 lwip_pools_gen.py rtt_log.txt                          # profile to stdout
+    python3 lwip_pools_gen.py -o config/lwipopts_doip.h rtt_log.txt
+    make LWIP_PROFILE=lwipopts_doip.h                              # build with it
+"""
+
+import argparse
+import datetime
+import os
+import re
+import sys
+
+HEADER_LINE = re.compile(r"\[LWIPMEM\] scale (\d+) mss (\d+) wnd (\d+) snd_queuelen (\d+)")
+POOL_LINE = re.compile(r"\[LWIPMEM\] (\w+) size (\d+) avail (\d+) used (\d+) max (\d+) err (\d+)")
+DOIP_POOL = re.compile(r"POOL_(DOIP_POOL_\w+)_SIZE$")
+
+# lwipopts.h option behind each memp pool; pools lwIP sizes from other
+# options (SYS_TIMEOUT, API_MSG, ...) are left alone
+POOL_OPTIONS = {
+    "PBUF_POOL": "PBUF_POOL_SIZE",
+    "PBUF": "MEMP_NUM_PBUF",
+    "TCP_SEG": "MEMP_NUM_TCP_SEG",
+    "TCP_PCB": "MEMP_NUM_TCP_PCB",
+    "TCP_PCB_LISTEN": "MEMP_NUM_TCP_PCB_LISTEN",
+    "UDP_PCB": "MEMP_NUM_UDP_PCB",
+    "RAW_PCB": "MEMP_NUM_RAW_PCB",
+    "REASSDATA": "MEMP_NUM_REASSDATA",
+    "FRAG_PBUF": "MEMP_NUM_FRAG_PBUF",
+    "ARP_QUEUE": "MEMP_NUM_ARP_QUEUE",
+    "NETBUF": "MEMP_NUM_NETBUF",
+    "NETCONN": "MEMP_NUM_NETCONN",
+    "TCPIP_MSG_API": "MEMP_NUM_TCPIP_MSG_API",
+    "TCPIP_MSG_INPKT": "MEMP_NUM_TCPIP_MSG_INPKT",
+    "HEAP": "MEM_SIZE",
+}
+
+# Pools lwipopts.h multiplies by LWIP_MEM_SCALE in a LWIP_MEM_PROFILE=1 build
+SCALED = {"PBUF_POOL", "PBUF", "TCP_SEG", "REASSDATA", "FRAG_PBUF", "ARP_QUEUE", "HEAP"}
+
+# tcp_alloc() recycles TIME_WAIT pcbs when this pool is empty, so failures
+# there are expected after every closed connection and not a shortage
+RECYCLED = {"TCP_PCB"}
+
+# Pool pbufs per TCP_MSS of receive window, as in the default lwipopts.h
+PBUFS_PER_WND_MSS = 4
+HEAP_ROUNDING = 256
+
+
+def read_table(stream):
+    """Last complete table in the log: (header, [pool, ...])"""
+    header, pools = None, []
+    for line in stream:
+        match = HEADER_LINE.search(line)
+        if match:
+            header = dict(zip(("scale", "mss", "wnd", "snd_queuelen"), map(int, match.groups())))
+            pools = []
+            continue
+        match = POOL_LINE.search(line)
+        if match and header is not None:
+            name = match.group(1)
+            size, avail, used, peak, err = map(int, match.groups()[1:])
+            pools.append({"name": name, "size": size, "avail": avail, "used": used, "max": peak, "err": err})
+    return header, pools
+
+
+def pool_option(name):
+    match = DOIP_POOL.match(name)
+    if match:
+        return match.group(1) + "_NUM"
+    return POOL_OPTIONS.get(name)
+
+
+def configured(pool, scale):
+    """Elements of the pool outside a LWIP_MEM_PROFILE=1 build"""
+    if pool["name"] in SCALED or DOIP_POOL.match(pool["name"]):
+        return pool["avail"] // scale
+    return pool["avail"]
+
+
+def sized(pool, headroom, header):
+    """Elements (bytes for the heap) for the peak plus headroom"""
+    peak = pool["max"]
+    count = peak + max(1, -(-peak * headroom // 100)) if peak else 1
+
+    if pool["name"] in RECYCLED:
+        count = min(count, configured(pool, header["scale"]))
+    elif pool["err"]:
+        # Ran out, so the peak is the limit and not the demand
+        count = max(count, pool["avail"] + pool["avail"] // 2)
+    if pool["name"] == "TCP_SEG":
+        count = max(count, header["snd_queuelen"])
+    if pool["name"] == "HEAP":
+        count = -(-count // HEAP_ROUNDING) * HEAP_ROUNDING
+    return count
+
+
+def generate(header, pools, headroom, budget):
+    scale = header["scale"]
+    rows, warnings = [], []
+    configured_bytes = 0
+    sized_bytes = 0
+    pbuf_row = None
+
+    for pool in pools:
+        option = pool_option(pool["name"])
+        if option is None:
+            continue
+        count = sized(pool, headroom, header)
+        configured_bytes += configured(pool, scale) * pool["size"]
+        sized_bytes += count * pool["size"]
+        row = {"option": option, "count": count, "pool": pool}
+        rows.append(row)
+        if pool["name"] == "PBUF_POOL":
+            pbuf_row = row
+        if pool["err"] and pool["name"] not in RECYCLED:
+            warnings.append("%s ran out %u times; sized from its limit, measure again with LWIP_MEM_PROFILE=1"
+                            % (pool["name"], pool["err"]))
+
+    if budget is None:
+        budget = configured_bytes
+    surplus = budget - sized_bytes
+    wnd_mul = max(header["wnd"] // header["mss"], 2)
+
+    if pbuf_row is not None:
+        if surplus > 0:
+            extra = surplus // pbuf_row["pool"]["size"]
+            pbuf_row["count"] += extra
+            surplus -= extra * pbuf_row["pool"]["size"]
+        pbufs = pbuf_row["count"]
+        wnd_mul = max(wnd_mul, pbufs // PBUFS_PER_WND_MSS)
+        wnd_mul = min(wnd_mul, pbufs, 0xFFFF // header["mss"])
+    if surplus < 0:
+        warnings.append("profile needs %d bytes more than the budget of %d" % (-surplus, budget))
+
+    return rows, wnd_mul, budget, budget - surplus, warnings
+
+
+def write_profile(out, name, source, header, rows, wnd_mul, budget, used, headroom):
+    out.write("/**\n")
+    out.write(" * \\file %s\n" % name)
+    out.write(" * \\brief lwIP pool sizes from measured peaks\n")
+    out.write(" *\n")
+    out.write(" * Generated by pc/python/lwip_pools_gen.py from %s on %s,\n" % (source, datetime.date.today()))
+    out.write(" * %u%% headroom over each peak. Pool RAM %d of %d bytes.\n" % (headroom, used, budget))
+    out.write(" * Build with LWIP_PROFILE=<this file>; regenerate rather than edit.\n")
+    out.write(" */\n\n")
+    out.write("#ifndef LWIPOPTS_PROFILE_H\n#define LWIPOPTS_PROFILE_H\n\n")
+    for row in rows:
+        pool = row["pool"]
+        out.write("#define %-28s %-6u /* peak %u of %u, %u failed */\n" % (
+            row["option"], row["count"], pool["max"], pool["avail"], pool["err"]))
+    out.write("#define %-28s %-6u /* measured with %u */\n" % ("TCP_WND_MUL", wnd_mul, header["wnd"] // header["mss"]))
+    out.write("\n#endif /* LWIPOPTS_PROFILE_H */\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate an lwipopts profile from [LWIPMEM] pool peaks")
+    parser.add_argument("logfile", nargs="?", help="console/RTT log (default: stdin)")
+    parser.add_argument("-o", "--output", help="profile header to write (default: stdout)")
+    parser.add_argument("--headroom", type=int, default=25, help="percent above each peak (default 25)")
+    parser.add_argument("--budget", type=int,
+                        help="pool RAM in bytes to fill (default: that of the measured configuration)")
+    args = parser.parse_args()
+
+    stream = open(args.logfile, errors="replace") if args.logfile else sys.stdin
+    with stream:
+        header, pools = read_table(stream)
+
+    if header is None or not pools:
+        print("No [LWIPMEM] table found", file=sys.stderr)
+        return 1
+
+    rows, wnd_mul, budget, used, warnings = generate(header, pools, args.headroom, args.budget)
+    for warning in warnings:
+        print("warning: %s" % warning, file=sys.stderr)
+
+    source = args.logfile or "stdin"
+    if args.output:
+        with open(args.output, "w") as out:
+            write_profile(out, os.path.basename(args.output), source, header, rows, wnd_mul,
+                          budget, used, args.headroom)
+    else:
+        write_profile(sys.stdout, "lwipopts_profile.h", source, header, rows, wnd_mul,
+                      budget, used, args.headroom)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+DOIP Network Counter Decoder
+Decodes the "[NETSTATS] <hex>" records written periodically by net_stats.c
+(RTT channel 1, or the console on the host and QEMU builds): MAC frame,
+byte and error counters plus lwIP protocol and memory pool statistics.
+
+Usage:
+    python3 net_stats_decode.py rtt_log.txt             # last record in a log
+    python3 net_stats_decode.py --rates rtt_log.txt     # per-second rates between records
+    python3 net_stats_decode.py --csv rtt_log.txt       # every record as CSV
+"""
+
+import argparse
+import re
+import sys
+
+NETSTATS_LINE = re.compile(r"\[NETSTATS\] ([0-9a-fA-F]{16,})\s*$")
+
+# Record order, see net_stats_serialize() in net_stats.c
+COUNTERS = [
+    "eth_rx_frames", "eth_rx_bytes", "eth_rx_errors", "eth_rx_dropped",
+    "eth_tx_frames", "eth_tx_bytes", "eth_tx_errors",
+    "link_drop", "ip_recv", "ip_drop",
+    "tcp_recv", "tcp_xmit", "tcp_drop", "tcp_chkerr", "tcp_memerr", "tcp_rexmit",
+    "udp_recv", "udp_drop",
+    "pbuf_pool_used", "pbuf_pool_max", "pbuf_pool_avail", "pbuf_pool_err",
+    "memp_err", "mem_err",
+    "rx_wakeups", "rx_wakeup_frames", "rx_wakeup_max", "rx_budget_hits",
+    "rx_filtered", "rx_priority", "rx_shed",
+    "rx_ring_peak", "rx_ring_full", "rx_overruns",
+]
+
+# Current levels rather than running totals; no rate is computed for these
+GAUGES = {"pbuf_pool_used", "pbuf_pool_max", "pbuf_pool_avail", "rx_wakeup_max", "rx_ring_peak"}
+
+# Counters that indicate lost or damaged traffic
+LOSS = ["eth_rx_errors", "eth_rx_dropped", "eth_tx_errors", "link_drop", "ip_drop",
+        "tcp_drop", "tcp_chkerr", "tcp_memerr", "tcp_rexmit", "udp_drop",
+        "pbuf_pool_err", "memp_err", "mem_err", "rx_shed",
+        "rx_ring_full", "rx_overruns"]
+
+
+def decode(data):
+    if data[0:2] != b"NS":
+        raise ValueError("bad magic")
+    if data[2] != 1:
+        raise ValueError("unsupported version %d" % data[2])
+
+    count = data[3]
+    record = {"uptime_ms": int.from_bytes(data[4:8], "big")}
+    for i in range(count):
+        value = int.from_bytes(data[8 + i * 4:12 + i * 4], "big")
+        name = COUNTERS[i] if i < len(COUNTERS) else "counter%d" % i
+        record[name] = value
+    return record
+
+
+def delta(new, old):
+    """Difference of two running u32 totals; byte counts wrap"""
+    return (new - old) & 0xFFFFFFFF
+
+
+def print_record(record):
+    print("t=%.1f s" % (record["uptime_ms"] / 1000.0))
+    print("  MAC rx %u frames %u bytes, %u errors, %u dropped, %u filtered" % (
+        record["eth_rx_frames"], record["eth_rx_bytes"], record["eth_rx_errors"], record["eth_rx_dropped"],
+        record.get("rx_filtered", 0)))
+    print("  MAC tx %u frames %u bytes, %u errors" % (
+        record["eth_tx_frames"], record["eth_tx_bytes"], record["eth_tx_errors"]))
+    print("  TCP recv %u xmit %u rexmit %u drop %u chkerr %u memerr %u" % (
+        record["tcp_recv"], record["tcp_xmit"], record["tcp_rexmit"], record["tcp_drop"],
+        record["tcp_chkerr"], record["tcp_memerr"]))
+    print("  pbuf pool %u/%u used, max %u, empty %u times" % (
+        record["pbuf_pool_used"], record["pbuf_pool_avail"], record["pbuf_pool_max"], record["pbuf_pool_err"]))
+    if record.get("rx_wakeups"):
+        print("  rx %u wakeups, %.1f frames/wakeup, max %u, budget hit %u; DoIP %u, shed %u" % (
+            record["rx_wakeups"], record["rx_wakeup_frames"] / record["rx_wakeups"],
+            record["rx_wakeup_max"], record["rx_budget_hits"],
+            record.get("rx_priority", 0), record.get("rx_shed", 0)))
+    if "rx_ring_peak" in record:
+        print("  rx ring peak %u descriptors, full %u, overrun %u" % (
+            record["rx_ring_peak"], record["rx_ring_full"], record["rx_overruns"]))
+    lost = ["%s=%u" % (name, record[name]) for name in LOSS if record.get(name)]
+    print("  losses: %s" % (", ".join(lost) if lost else "none"))
+
+
+def print_rates(records):
+    print("%8s %9s %9s %10s %10s  %s" % ("t_s", "rx_fps", "tx_fps", "rx_kB/s", "tx_kB/s", "new losses"))
+    for old, new in zip(records, records[1:]):
+        seconds = (new["uptime_ms"] - old["uptime_ms"]) / 1000.0
+        if seconds <= 0:
+            continue
+        lost = ["%s+%u" % (name, delta(new.get(name, 0), old.get(name, 0)))
+                for name in LOSS if delta(new.get(name, 0), old.get(name, 0))]
+        print("%8.1f %9.1f %9.1f %10.1f %10.1f  %s" % (
+            new["uptime_ms"] / 1000.0,
+            delta(new["eth_rx_frames"], old["eth_rx_frames"]) / seconds,
+            delta(new["eth_tx_frames"], old["eth_tx_frames"]) / seconds,
+            delta(new["eth_rx_bytes"], old["eth_rx_bytes"]) / seconds / 1000.0,
+            delta(new["eth_tx_bytes"], old["eth_tx_bytes"]) / seconds / 1000.0,
+            " ".join(lost)))
+
+
+def print_csv(records):
+    print(",".join(["uptime_ms"] + COUNTERS))
+    for record in records:
+        print(",".join(str(record.get(name, "")) for name in ["uptime_ms"] + COUNTERS))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode network interface counter records")
+    parser.add_argument("logfile", nargs="?", help="console/RTT log (default: stdin)")
+    parser.add_argument("--all", action="store_true", help="decode every record, not only the last")
+    parser.add_argument("--rates", action="store_true", help="print rates and new losses between records")
+    parser.add_argument("--csv", action="store_true", help="print every record as CSV")
+    args = parser.parse_args()
+
+    stream = open(args.logfile, errors="replace") if args.logfile else sys.stdin
+    records = []
+    with stream:
+        for line in stream:
+            match = NETSTATS_LINE.search(line)
+            if match:
+                records.append(decode(bytes.fromhex(match.group(1))))
+
+    if not records:
+        print("No [NETSTATS] record found", file=sys.stderr)
+        return 1
+
+    if args.csv:
+        print_csv(records)
+    elif args.rates:
+        print_rates(records)
+    else:
+        for record in (records if args.all else records[-1:]):
+            print_record(record)
+            print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
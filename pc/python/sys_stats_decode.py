@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+DOIP Task Load Decoder
+Decodes the "[SYSSTATS] <hex>" records written periodically by sys_stats.c
+(RTT channel 1, or the console on the host and QEMU builds) and prints the
+CPU share and free stack of every task per window.
+
+Usage:
+    python3 sys_stats_decode.py rtt_log.txt             # last record in a log
+    python3 sys_stats_decode.py --all rtt_log.txt       # every record
+    python3 sys_stats_decode.py --csv rtt_log.txt       # busy % and per-task % over time
+"""
+
+import argparse
+import re
+import sys
+
+SYSSTATS_LINE = re.compile(r"\[SYSSTATS\] ([0-9a-fA-F]{32,})\s*$")
+
+STATE_NAMES = "XRBSD"   # Running, Ready, Blocked, Suspended, Deleted
+IDLE_TASK = "IDLE"
+
+
+class Reader:
+    """Cursor over the record bytes, big-endian"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def u8(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def u16(self):
+        return (self.u8() << 8) | self.u8()
+
+    def u32(self):
+        return (self.u16() << 16) | self.u16()
+
+    def text(self, length):
+        value = self.data[self.pos:self.pos + length].decode(errors="replace")
+        self.pos += length
+        return value
+
+
+def decode(data):
+    reader = Reader(data)
+    if reader.u8() != ord("S") or reader.u8() != ord("T"):
+        raise ValueError("bad magic")
+    version = reader.u8()
+    if version != 1:
+        raise ValueError("unsupported version %d" % version)
+
+    count = reader.u8()
+    record = {
+        "uptime_ms": reader.u32(),
+        "window_ms": reader.u32(),
+        "heap_free": reader.u32(),
+        "tasks": [],
+    }
+    for _ in range(count):
+        task = {
+            "number": reader.u8(),
+            "priority": reader.u8(),
+            "state": reader.u8(),
+            "cpu_permille": reader.u16(),
+            "stack_free_words": reader.u16(),
+        }
+        task["name"] = reader.text(reader.u8())
+        record["tasks"].append(task)
+
+    record["busy_permille"] = sum(t["cpu_permille"] for t in record["tasks"] if t["name"] != IDLE_TASK)
+    return record
+
+
+def print_record(record):
+    print("t=%.1f s  window %u ms  busy %.1f%%  heap free %u" % (
+        record["uptime_ms"] / 1000.0, record["window_ms"],
+        record["busy_permille"] / 10.0, record["heap_free"]))
+    print("  %-16s %4s %2s %7s %10s" % ("task", "prio", "st", "cpu", "stack_free"))
+    for task in sorted(record["tasks"], key=lambda t: -t["cpu_permille"]):
+        state = STATE_NAMES[task["state"]] if task["state"] < len(STATE_NAMES) else "?"
+        print("  %-16s %4u %2s %6.1f%% %10u" % (task["name"], task["priority"], state,
+                                              task["cpu_permille"] / 10.0, task["stack_free_words"]))
+
+
+def print_csv(records):
+    names = []
+    for record in records:
+        for task in record["tasks"]:
+            if task["name"] not in names:
+                names.append(task["name"])
+
+    print(",".join(["uptime_ms", "busy_pct"] + names))
+    for record in records:
+        load = {t["name"]: t["cpu_permille"] / 10.0 for t in record["tasks"]}
+        row = [str(record["uptime_ms"]), "%.1f" % (record["busy_permille"] / 10.0)]
+        row += ["%.1f" % load[name] if name in load else "" for name in names]
+        print(",".join(row))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode per-task CPU load records")
+    parser.add_argument("logfile", nargs="?", help="console/RTT log (default: stdin)")
+    parser.add_argument("--all", action="store_true", help="decode every record, not only the last")
+    parser.add_argument("--csv", action="store_true", help="print a CSV time series of every record")
+    args = parser.parse_args()
+
+    stream = open(args.logfile, errors="replace") if args.logfile else sys.stdin
+    records = []
+    with stream:
+        for line in stream:
+            match = SYSSTATS_LINE.search(line)
+            if match:
+                records.append(decode(bytes.fromhex(match.group(1))))
+
+    if not records:
+        print("No [SYSSTATS] record found", file=sys.stderr)
+        return 1
+
+    if args.csv:
+        print_csv(records)
+    else:
+        for record in (records if args.all else records[-1:]):
+            print_record(record)
+            print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,338 @@
+/**
+ * \file rtos_heap.c
+ * \brief Coalescing FreeRTOS heap with usage statistics and leak tracing
+ *
+ * First fit over a free list sorted by address. Every block starts with
+ * a header holding its size; allocated blocks have the top size bit set,
+ * so the whole heap can also be walked block by block for the leak
+ * report. Like the FreeRTOS heaps, the allocator is made thread safe by
+ * suspending the scheduler and must not be called from interrupts.
+ */
+
+#include "rtos_heap.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include <string.h>
+
+typedef struct heap_block {
+    struct heap_block *next;    /* Next free block by address, NULL while allocated */
+    size_t size;                /* Including this header; HEAP_ALLOCATED set while in use */
+#if RTOS_HEAP_TRACE
+    void *caller;
+#endif
+} heap_block_t;
+
+#define HEAP_HEADER_SIZE    ((sizeof(heap_block_t) + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK))
+#define HEAP_MIN_BLOCK      (HEAP_HEADER_SIZE * 2)
+#define HEAP_ALLOCATED      ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+/* Call sites listed by the leak report */
+#define HEAP_TRACE_SITES    16
+
+static uint8_t heap_area[configTOTAL_HEAP_SIZE] __attribute__((aligned(portBYTE_ALIGNMENT)));
+
+static heap_block_t free_head;          /* List sentinel, size 0 */
+static uint8_t *heap_start;
+static uint8_t *heap_end;
+static size_t heap_total;
+static size_t heap_free;
+static size_t heap_min_free;
+static uint32_t heap_allocs;
+static uint32_t heap_frees;
+static uint32_t heap_failed;
+
+static void heap_init(void)
+{
+    heap_block_t *first = (heap_block_t *)heap_area;
+
+    heap_start = heap_area;
+    heap_total = sizeof(heap_area) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+    heap_end = heap_start + heap_total;
+
+    first->next = NULL;
+    first->size = heap_total;
+    free_head.next = first;
+    free_head.size = 0;
+
+    heap_free = heap_total;
+    heap_min_free = heap_total;
+}
+
+/* Insert a block into the address-ordered free list, merging with its neighbours */
+static void heap_insert_free(heap_block_t *block)
+{
+    heap_block_t *prev = &free_head;
+
+    while (prev->next != NULL && prev->next < block) {
+        prev = prev->next;
+    }
+
+    if (prev->next != NULL && (uint8_t *)block + block->size == (uint8_t *)prev->next) {
+        block->size += prev->next->size;
+        block->next = prev->next->next;
+    } else {
+        block->next = prev->next;
+    }
+
+    if (prev != &free_head && (uint8_t *)prev + prev->size == (uint8_t *)block) {
+        prev->size += block->size;
+        prev->next = block->next;
+    } else {
+        prev->next = block;
+    }
+}
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    void *result = NULL;
+    size_t size;
+
+    if (xWantedSize == 0 || xWantedSize > SIZE_MAX / 2) {
+        return NULL;
+    }
+    size = (xWantedSize + HEAP_HEADER_SIZE + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+
+    vTaskSuspendAll();
+    {
+        heap_block_t *prev = &free_head;
+        heap_block_t *block;
+
+        if (heap_start == NULL) {
+            heap_init();
+        }
+
+        for (block = free_head.next; block != NULL && block->size < size; block = block->next) {
+            prev = block;
+        }
+
+        if (block != NULL) {
+            if (block->size - size >= HEAP_MIN_BLOCK) {
+                heap_block_t *rest = (heap_block_t *)((uint8_t *)block + size);
+
+                rest->size = block->size - size;
+                rest->next = block->next;
+                block->size = size;
+                prev->next = rest;
+            } else {
+                prev->next = block->next;
+            }
+
+            heap_free -= block->size;
+            if (heap_free < heap_min_free) {
+                heap_min_free = heap_free;
+            }
+            heap_allocs++;
+
+            block->size |= HEAP_ALLOCATED;
+            block->next = NULL;
+#if RTOS_HEAP_TRACE
+            block->caller = __builtin_return_address(0);
+#endif
+            result = (uint8_t *)block + HEAP_HEADER_SIZE;
+        } else {
+            heap_failed++;
+        }
+
+        traceMALLOC(result, xWantedSize);
+    }
+    (void)xTaskResumeAll();
+
+#if configUSE_MALLOC_FAILED_HOOK
+    if (result == NULL) {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif
+
+    return result;
+}
+
+void vPortFree(void *pv)
+{
+    heap_block_t *block;
+
+    if (pv == NULL) {
+        return;
+    }
+
+    block = (heap_block_t *)((uint8_t *)pv - HEAP_HEADER_SIZE);
+    configASSERT((uint8_t *)block >= heap_start && (uint8_t *)block < heap_end);
+    configASSERT((block->size & HEAP_ALLOCATED) != 0 && block->next == NULL);
+
+    vTaskSuspendAll();
+    {
+        block->size &= ~HEAP_ALLOCATED;
+        heap_free += block->size;
+        heap_frees++;
+        traceFREE(pv, block->size);
+        heap_insert_free(block);
+    }
+    (void)xTaskResumeAll();
+}
+
+void *pvPortCalloc(size_t xNum, size_t xSize)
+{
+    void *result = NULL;
+
+    if (xSize == 0 || xNum <= SIZE_MAX / xSize) {
+        result = pvPortMalloc(xNum * xSize);
+        if (result != NULL) {
+            memset(result, 0, xNum * xSize);
+        }
+    }
+
+    return result;
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    return (heap_start == NULL) ? sizeof(heap_area) : heap_free;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return (heap_start == NULL) ? sizeof(heap_area) : heap_min_free;
+}
+
+void vPortInitialiseBlocks(void)
+{
+    /* Initialized on the first allocation */
+}
+
+static uint32_t heap_hist_bucket(size_t size)
+{
+    uint32_t bucket = 0;
+
+    for (size >>= 5; size != 0 && bucket < RTOS_HEAP_HIST_BUCKETS - 1; size >>= 1) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void rtos_heap_get_stats(rtos_heap_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    vTaskSuspendAll();
+    {
+        if (heap_start == NULL) {
+            heap_init();
+        }
+
+        for (const heap_block_t *block = free_head.next; block != NULL; block = block->next) {
+            stats->free_blocks++;
+            stats->hist[heap_hist_bucket(block->size)]++;
+            if (block->size > stats->largest_free) {
+                stats->largest_free = block->size;
+            }
+        }
+
+        stats->total = heap_total;
+        stats->free = heap_free;
+        stats->min_free = heap_min_free;
+        stats->allocs = heap_allocs;
+        stats->frees = heap_frees;
+        stats->failed = heap_failed;
+    }
+    (void)xTaskResumeAll();
+}
+
+void vPortGetHeapStats(HeapStats_t *pxHeapStats)
+{
+    rtos_heap_stats_t stats;
+    size_t smallest = SIZE_MAX;
+
+    rtos_heap_get_stats(&stats);
+
+    vTaskSuspendAll();
+    for (const heap_block_t *block = free_head.next; block != NULL; block = block->next) {
+        if (block->size < smallest) {
+            smallest = block->size;
+        }
+    }
+    (void)xTaskResumeAll();
+
+    pxHeapStats->xAvailableHeapSpaceInBytes = stats.free;
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = stats.largest_free;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = (stats.free_blocks > 0) ? smallest : 0;
+    pxHeapStats->xNumberOfFreeBlocks = stats.free_blocks;
+    pxHeapStats->xMinimumEverFreeBytesRemaining = stats.min_free;
+    pxHeapStats->xNumberOfSuccessfulAllocations = stats.allocs;
+    pxHeapStats->xNumberOfSuccessfulFrees = stats.frees;
+}
+
+#if RTOS_HEAP_TRACE
+typedef struct {
+    void *caller;
+    uint32_t blocks;
+    size_t bytes;
+} heap_site_t;
+
+static heap_site_t heap_sites[HEAP_TRACE_SITES];
+
+static void heap_report_sites(void)
+{
+    uint32_t sites = 0;
+    uint32_t other = 0;
+
+    /* Walk every block in address order; sizes chain from one header to the next */
+    vTaskSuspendAll();
+    for (uint8_t *p = heap_start; p < heap_end; p += ((heap_block_t *)p)->size & ~HEAP_ALLOCATED) {
+        const heap_block_t *block = (const heap_block_t *)p;
+        uint32_t i;
+
+        if (!(block->size & HEAP_ALLOCATED)) {
+            continue;
+        }
+        for (i = 0; i < sites && heap_sites[i].caller != block->caller; i++) {
+        }
+        if (i == sites) {
+            if (sites == HEAP_TRACE_SITES) {
+                other++;
+                continue;
+            }
+            heap_sites[sites].caller = block->caller;
+            heap_sites[sites].blocks = 0;
+            heap_sites[sites].bytes = 0;
+            sites++;
+        }
+        heap_sites[i].blocks++;
+        heap_sites[i].bytes += block->size & ~HEAP_ALLOCATED;
+    }
+    (void)xTaskResumeAll();
+
+    for (uint32_t i = 0; i < sites; i++) {
+        printf("[HEAP] live from 0x%08lx: %lu blocks, %lu bytes\r\n", (unsigned long)(uintptr_t)heap_sites[i].caller,
+               (unsigned long)heap_sites[i].blocks, (unsigned long)heap_sites[i].bytes);
+    }
+    if (other > 0) {
+        printf("[HEAP] %lu blocks from further call sites\r\n", (unsigned long)other);
+    }
+}
+#endif /* RTOS_HEAP_TRACE */
+
+void rtos_heap_report(void)
+{
+    rtos_heap_stats_t stats;
+
+    rtos_heap_get_stats(&stats);
+
+    printf("[HEAP] used %lu of %lu bytes, peak %lu, largest free block %lu\r\n",
+           (unsigned long)(stats.total - stats.free), (unsigned long)stats.total,
+           (unsigned long)(stats.total - stats.min_free), (unsigned long)stats.largest_free);
+    printf("[HEAP] %lu allocs, %lu frees, %lu failed, %lu free blocks\r\n",
+           (unsigned long)stats.allocs, (unsigned long)stats.frees,
+           (unsigned long)stats.failed, (unsigned long)stats.free_blocks);
+
+    for (uint32_t i = 0; i < RTOS_HEAP_HIST_BUCKETS; i++) {
+        if (stats.hist[i] > 0) {
+            printf("[HEAP]   free %6lu+ bytes: %lu\r\n", (unsigned long)(i == 0 ? 0 : (16ul << i)),
+                   (unsigned long)stats.hist[i]);
+        }
+    }
+
+#if RTOS_HEAP_TRACE
+    heap_report_sites();
+#endif
+}
@@ -0,0 +1,63 @@
+/**
+ * \file rtos_heap.h
+ * \brief Coalescing FreeRTOS heap with usage statistics and leak tracing
+ *
+ * Replaces FreeRTOS heap_2.c. Free blocks are kept in address order and
+ * merged with their neighbours when freed, so memory returned by
+ * transient tasks and lwIP can satisfy larger requests later. Provides
+ * the standard pvPortMalloc()/vPortFree() interface plus
+ * xPortGetMinimumEverFreeHeapSize() and vPortGetHeapStats().
+ *
+ * Built with RTOS_HEAP_TRACE=1 every block also records the address it
+ * was allocated from, and rtos_heap_report() lists the live allocations
+ * per call site (resolve with addr2line) to find leaks.
+ */
+
+#ifndef RTOS_HEAP_H
+#define RTOS_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef RTOS_HEAP_TRACE
+#define RTOS_HEAP_TRACE             0
+#endif
+
+/* Free block histogram: bucket n holds blocks of 2^(n+4) .. 2^(n+5)-1 bytes,
+ * the first and last buckets are open-ended */
+#define RTOS_HEAP_HIST_BUCKETS      12
+
+typedef struct {
+    size_t total;               /* Usable heap size */
+    size_t free;                /* Bytes currently free */
+    size_t min_free;            /* Lowest free since start-up (peak use = total - min_free) */
+    size_t largest_free;        /* Largest single free block */
+    uint32_t free_blocks;
+    uint32_t allocs;            /* Successful allocations */
+    uint32_t frees;
+    uint32_t failed;            /* Allocations that could not be satisfied */
+    uint32_t hist[RTOS_HEAP_HIST_BUCKETS];
+} rtos_heap_stats_t;
+
+/**
+ * \brief Walk the free list and fill in the heap statistics
+ * \param[out] stats Statistics
+ */
+void rtos_heap_get_stats(rtos_heap_stats_t *stats);
+
+/**
+ * \brief Print heap use, peak use and the free block histogram
+ *
+ * With RTOS_HEAP_TRACE also lists live allocations grouped by caller.
+ */
+void rtos_heap_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTOS_HEAP_H */
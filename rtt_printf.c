@@ -5,10 +5,62 @@
  *
  * This file provides the bridge between the embedded printf library and
  * SEGGER RTT for real-time debugging output.
+ *
+ * Task output is collected per task in a line buffer (found through a
+ * FreeRTOS thread local storage pointer) and handed to SEGGER_RTT_Write()
+ * one line at a time. Interrupts, code running before the scheduler and
+ * tasks that find the buffer pool empty write each character directly
+ * to the log channel as before.
  */
 
+#include "rtt_printf.h"
 #include "SEGGER_RTT.h"
 #include "printf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+
+/* Thread local storage slot holding the task's line buffer */
+#define RTT_PRINTF_TLS_INDEX            0
+
+#ifndef RTT_PRINTF_LINE_SIZE
+#define RTT_PRINTF_LINE_SIZE            128
+#endif
+
+#ifndef RTT_PRINTF_LINE_BUFFERS
+#define RTT_PRINTF_LINE_BUFFERS         8
+#endif
+
+/* Up-buffer sizes; the log channel (0) is sized by BUFFER_SIZE_UP in SEGGER_RTT_Conf.h */
+#ifndef RTT_PRINTF_METRICS_BUFFER_SIZE
+#define RTT_PRINTF_METRICS_BUFFER_SIZE  4096
+#endif
+#ifndef RTT_PRINTF_TRACE_BUFFER_SIZE
+#define RTT_PRINTF_TRACE_BUFFER_SIZE    4096
+#endif
+
+#if RTT_PRINTF_TLS_INDEX >= configNUM_THREAD_LOCAL_STORAGE_POINTERS
+#error "rtt_printf needs a thread local storage pointer (configNUM_THREAD_LOCAL_STORAGE_POINTERS)"
+#endif
+
+#if RTT_PRINTF_CH_COUNT > SEGGER_RTT_MAX_NUM_UP_BUFFERS
+#error "SEGGER_RTT_MAX_NUM_UP_BUFFERS is too small for the rtt_printf channels"
+#endif
+
+typedef struct {
+    volatile uint32_t in_use;
+    uint8_t channel;
+    uint16_t len;
+    char data[RTT_PRINTF_LINE_SIZE];
+} rtt_line_t;
+
+static rtt_line_t line_pool[RTT_PRINTF_LINE_BUFFERS];
+
+static char metrics_buffer[RTT_PRINTF_METRICS_BUFFER_SIZE];
+static char trace_buffer[RTT_PRINTF_TRACE_BUFFER_SIZE];
+
+static uint32_t dropped_total[RTT_PRINTF_CH_COUNT];
+static uint32_t dropped_pending[RTT_PRINTF_CH_COUNT];   /* Not yet reported in-band */
 
 /**
  * \brief Initialize SEGGER RTT system
@@ -19,17 +71,134 @@
 void rtt_printf_init(void)
 {
     SEGGER_RTT_Init();
+    SEGGER_RTT_ConfigUpBuffer(RTT_PRINTF_CH_METRICS, "Metrics", metrics_buffer, sizeof(metrics_buffer),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    SEGGER_RTT_ConfigUpBuffer(RTT_PRINTF_CH_TRACE, "Trace", trace_buffer, sizeof(trace_buffer),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+/* Write a block to a channel, all or nothing, reporting earlier losses first */
+static void rtt_write(unsigned channel, const char *data, unsigned len)
+{
+    uint32_t pending = __atomic_load_n(&dropped_pending[channel], __ATOMIC_RELAXED);
+
+    if (pending > 0) {
+        char notice[40];
+        int n = snprintf(notice, sizeof(notice), "[RTT] %lu bytes dropped\r\n", (unsigned long)pending);
+
+        if (SEGGER_RTT_Write(channel, notice, (unsigned)n) == (unsigned)n) {
+            __atomic_fetch_sub(&dropped_pending[channel], pending, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (SEGGER_RTT_Write(channel, data, len) != len) {
+        __atomic_fetch_add(&dropped_total[channel], len, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&dropped_pending[channel], len, __ATOMIC_RELAXED);
+    }
+}
+
+/* Line buffer of the calling task, claimed from the pool on first use */
+static rtt_line_t *rtt_line_get(bool claim)
+{
+    rtt_line_t *line;
+
+    if (xPortIsInsideInterrupt() || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return NULL;
+    }
+
+    line = pvTaskGetThreadLocalStoragePointer(NULL, RTT_PRINTF_TLS_INDEX);
+    if (line != NULL || !claim) {
+        return line;
+    }
+
+    for (uint32_t i = 0; i < RTT_PRINTF_LINE_BUFFERS; i++) {
+        if (__atomic_exchange_n(&line_pool[i].in_use, 1, __ATOMIC_ACQUIRE) == 0) {
+            line = &line_pool[i];
+            line->channel = RTT_PRINTF_CH_LOG;
+            line->len = 0;
+            vTaskSetThreadLocalStoragePointer(NULL, RTT_PRINTF_TLS_INDEX, line);
+            break;
+        }
+    }
+
+    return line;
+}
+
+static void rtt_line_flush(rtt_line_t *line)
+{
+    if (line->len > 0) {
+        rtt_write(line->channel, line->data, line->len);
+        line->len = 0;
+    }
 }
 
 /**
  * \brief Output a character via SEGGER RTT
  * 
  * This function is called by the printf library to output each character.
- * It sends the character to RTT buffer 0 (default terminal buffer).
+ * Task output is buffered until the end of the line or until the line
+ * buffer is full.
  * 
  * \param character Character to output
  */
 void _putchar(char character)
 {
-    SEGGER_RTT_PutChar(0, character);
-}
\ No newline at end of file
+    rtt_line_t *line = rtt_line_get(true);
+
+    if (line == NULL) {
+        rtt_write(RTT_PRINTF_CH_LOG, &character, 1);
+        return;
+    }
+
+    line->data[line->len++] = character;
+    if (character == '\n' || line->len == RTT_PRINTF_LINE_SIZE) {
+        rtt_line_flush(line);
+    }
+}
+
+rtt_printf_channel_t rtt_printf_select(rtt_printf_channel_t channel)
+{
+    rtt_line_t *line = rtt_line_get(true);
+    rtt_printf_channel_t previous;
+
+    /* Unbuffered output always goes to the log channel */
+    if (line == NULL) {
+        return RTT_PRINTF_CH_LOG;
+    }
+
+    previous = (rtt_printf_channel_t)line->channel;
+    if (channel != previous) {
+        rtt_line_flush(line);
+        line->channel = (uint8_t)channel;
+    }
+
+    return previous;
+}
+
+void rtt_printf_flush(void)
+{
+    rtt_line_t *line = rtt_line_get(false);
+
+    if (line != NULL) {
+        rtt_line_flush(line);
+        vTaskSetThreadLocalStoragePointer(NULL, RTT_PRINTF_TLS_INDEX, NULL);
+        __atomic_store_n(&line->in_use, 0, __ATOMIC_RELEASE);
+    }
+}
+
+uint32_t rtt_printf_dropped(rtt_printf_channel_t channel)
+{
+    return __atomic_load_n(&dropped_total[channel], __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Read a character sent by the host on RTT down-buffer 0
+ *
+ * Non-blocking; used for single-key console commands.
+ *
+ * \return Character, or -1 if none is pending
+ */
+int rtt_printf_getchar(void)
+{
+    return SEGGER_RTT_GetKey();
+}
@@ -0,0 +1,75 @@
+/**
+ * \file rtt_printf.h
+ * \brief Console backend for the printf library
+ *
+ * On the SAME54 target output goes to SEGGER RTT. Each task collects
+ * its output in a line buffer that is written to RTT in one piece at the
+ * end of a line, so the RTT lock is taken once per line rather than once
+ * per character and lines from different tasks do not interleave.
+ *
+ * Output is split over three RTT up-channels so bulk data does not
+ * crowd out the log:
+ *   0 - log (terminal)
+ *   1 - metrics dumps ("[METRICS]" lines)
+ *   2 - trace data ("[DLOG]" binary log lines)
+ * Bytes dropped because a channel was full are counted and reported on
+ * the same channel as "[RTT] <n> bytes dropped" once it has room again.
+ *
+ * The host and QEMU builds provide the same functions on a single
+ * console stream (see hw/posix and hw/mps2).
+ */
+
+#ifndef RTT_PRINTF_H
+#define RTT_PRINTF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+    RTT_PRINTF_CH_LOG = 0,
+    RTT_PRINTF_CH_METRICS,
+    RTT_PRINTF_CH_TRACE,
+    RTT_PRINTF_CH_COUNT
+} rtt_printf_channel_t;
+
+/**
+ * \brief Initialize the console; call before the scheduler starts
+ */
+void rtt_printf_init(void);
+
+/**
+ * \brief Read a character sent by the host, non-blocking
+ * \return Character, or -1 if none is pending
+ */
+int rtt_printf_getchar(void);
+
+/**
+ * \brief Route the calling task's printf output to a channel
+ *
+ * Any partial line is flushed to the previous channel first.
+ *
+ * \param[in] channel Channel for subsequent output
+ * \return The previously selected channel
+ */
+rtt_printf_channel_t rtt_printf_select(rtt_printf_channel_t channel);
+
+/**
+ * \brief Write out the calling task's partial line and release its buffer
+ *
+ * Call before a task deletes itself so its line buffer is returned.
+ */
+void rtt_printf_flush(void);
+
+/**
+ * \brief Total bytes dropped on a channel since start-up
+ */
+uint32_t rtt_printf_dropped(rtt_printf_channel_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTT_PRINTF_H */
@@ -0,0 +1,262 @@
+/**
+ * \file sys_stats.c
+ * \brief Per-task CPU load and stack high-water reporting
+ *
+ * Load is the share of the run-time counter each task accumulated since
+ * the previous snapshot, matched by task number, so every report covers
+ * one window rather than the time since boot.
+ */
+
+#include "sys_stats.h"
+#include "bsp_timestamp.h"
+#include "rtt_printf.h"
+#include "housekeeping.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "printf.h"
+#include <string.h>
+
+#define SYS_STATS_HEADER_SIZE       16
+#define SYS_STATS_TASK_SIZE         8      /* Fixed part of a task entry */
+#define SYS_STATS_RECORD_SIZE       (SYS_STATS_HEADER_SIZE + \
+                                     SYS_STATS_MAX_TASKS * (SYS_STATS_TASK_SIZE + configMAX_TASK_NAME_LEN))
+
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    uint8_t number;
+    uint8_t priority;
+    uint8_t state;
+    uint16_t cpu_permille;
+    uint16_t stack_free;        /* Minimum free stack so far, in words */
+} sys_task_load_t;
+
+typedef struct {
+    UBaseType_t number;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} sys_task_prev_t;
+
+static TaskStatus_t task_status[SYS_STATS_MAX_TASKS];
+static sys_task_prev_t prev_tasks[SYS_STATS_MAX_TASKS];
+static UBaseType_t prev_count;
+static configRUN_TIME_COUNTER_TYPE prev_total;
+static TickType_t prev_tick;
+
+static sys_task_load_t report[SYS_STATS_MAX_TASKS];
+static UBaseType_t report_count;
+static uint32_t report_window_ms;
+
+static uint8_t record_buffer[SYS_STATS_RECORD_SIZE];
+static SemaphoreHandle_t stats_mutex;
+static StaticSemaphore_t stats_mutex_buffer;
+
+/* Run-time counter, extended from bsp_timestamp to 64 bits */
+static uint64_t counter_base;
+static uint32_t counter_last;
+
+void vConfigureTimerForRunTimeStats(void)
+{
+    bsp_timestamp_init();
+    counter_last = bsp_timestamp_now();
+}
+
+uint64_t vGetRunTimeCounterValue(void)
+{
+    UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t now = bsp_timestamp_now();
+    uint32_t delta = now - counter_last;
+    uint64_t value;
+
+    /* Called on every context switch, far more often than the counter
+     * wraps. A small step back (the QEMU timestamp read just before its
+     * tick is counted) is ignored rather than taken as a wrap. */
+    if (delta < 0x80000000u) {
+        counter_base += delta;
+        counter_last = now;
+    }
+    value = counter_base;
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return value;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    (void)xTask;
+    printf("[STACK] Overflow in task %s\r\n", pcTaskName);
+    assert_triggered(__FILE__, __LINE__);
+}
+
+static configRUN_TIME_COUNTER_TYPE prev_runtime(UBaseType_t number)
+{
+    for (UBaseType_t i = 0; i < prev_count; i++) {
+        if (prev_tasks[i].number == number) {
+            return prev_tasks[i].runtime;
+        }
+    }
+    return 0;
+}
+
+/* Take a snapshot and turn it into per-task load over the window since the last one */
+static void sys_stats_sample(void)
+{
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t count = uxTaskGetSystemState(task_status, SYS_STATS_MAX_TASKS, &total);
+    configRUN_TIME_COUNTER_TYPE window = total - prev_total;
+    TickType_t now = xTaskGetTickCount();
+
+    report_window_ms = (uint32_t)((now - prev_tick) * portTICK_PERIOD_MS);
+    report_count = count;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *status = &task_status[i];
+        sys_task_load_t *load = &report[i];
+        configRUN_TIME_COUNTER_TYPE busy = status->ulRunTimeCounter - prev_runtime(status->xTaskNumber);
+        size_t n;
+
+        for (n = 0; n < sizeof(load->name) - 1 && status->pcTaskName[n] != '\0'; n++) {
+            load->name[n] = status->pcTaskName[n];
+        }
+        load->name[n] = '\0';
+        load->number = (uint8_t)status->xTaskNumber;
+        load->priority = (uint8_t)status->uxCurrentPriority;
+        load->state = (uint8_t)status->eCurrentState;
+        load->cpu_permille = (window > 0) ? (uint16_t)((busy * 1000u) / window) : 0;
+        load->stack_free = (status->usStackHighWaterMark > 0xFFFFu) ?
+                           0xFFFFu : (uint16_t)status->usStackHighWaterMark;
+    }
+
+    /* A full snapshot array returns no tasks; keep the previous baseline then */
+    if (count > 0) {
+        for (UBaseType_t i = 0; i < count; i++) {
+            prev_tasks[i].number = task_status[i].xTaskNumber;
+            prev_tasks[i].runtime = task_status[i].ulRunTimeCounter;
+        }
+        prev_count = count;
+        prev_total = total;
+        prev_tick = now;
+    }
+}
+
+static size_t put_u16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)(value >> 8);
+    out[1] = (uint8_t)value;
+    return 2;
+}
+
+static size_t put_u32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return 4;
+}
+
+static size_t sys_stats_serialize(uint8_t *out)
+{
+    size_t pos = 0;
+
+    out[pos++] = 'S';
+    out[pos++] = 'T';
+    out[pos++] = SYS_STATS_VERSION;
+    out[pos++] = (uint8_t)report_count;
+    pos += put_u32(&out[pos], (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+    pos += put_u32(&out[pos], report_window_ms);
+    pos += put_u32(&out[pos], (uint32_t)xPortGetFreeHeapSize());
+
+    for (UBaseType_t i = 0; i < report_count; i++) {
+        const sys_task_load_t *load = &report[i];
+        size_t name_len = strlen(load->name);
+
+        out[pos++] = load->number;
+        out[pos++] = load->priority;
+        out[pos++] = load->state;
+        pos += put_u16(&out[pos], load->cpu_permille);
+        pos += put_u16(&out[pos], load->stack_free);
+        out[pos++] = (uint8_t)name_len;
+        memcpy(&out[pos], load->name, name_len);
+        pos += name_len;
+    }
+
+    return pos;
+}
+
+void sys_stats_dump(void)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    sys_stats_sample();
+
+    size_t len = sys_stats_serialize(record_buffer);
+    rtt_printf_channel_t previous = rtt_printf_select(RTT_PRINTF_CH_METRICS);
+
+    printf("[SYSSTATS] ");
+    for (size_t i = 0; i < len; i++) {
+        _putchar(hex[record_buffer[i] >> 4]);
+        _putchar(hex[record_buffer[i] & 0x0F]);
+    }
+    printf("\r\n");
+    rtt_printf_select(previous);
+    xSemaphoreGive(stats_mutex);
+}
+
+void sys_stats_print(void)
+{
+    static const char state_names[] = "XRBSD";      /* eTaskState order, as vTaskList() */
+    uint32_t busy = 0;
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    sys_stats_sample();
+
+    if (report_count == 0) {
+        printf("[SYSSTATS] More than %u tasks, raise SYS_STATS_MAX_TASKS\r\n", (unsigned)SYS_STATS_MAX_TASKS);
+        xSemaphoreGive(stats_mutex);
+        return;
+    }
+
+    printf("[SYSSTATS] %-16s %4s %2s %7s %10s\r\n", "task", "prio", "st", "cpu", "stack_free");
+    for (UBaseType_t i = 0; i < report_count; i++) {
+        const sys_task_load_t *load = &report[i];
+        char state = (load->state < sizeof(state_names) - 1) ? state_names[load->state] : '?';
+
+        printf("[SYSSTATS] %-16s %4u  %c %3u.%u%% %10u\r\n", load->name, (unsigned)load->priority, state,
+               (unsigned)(load->cpu_permille / 10), (unsigned)(load->cpu_permille % 10),
+               (unsigned)load->stack_free);
+        if (strcmp(load->name, configIDLE_TASK_NAME) != 0) {
+            busy += load->cpu_permille;
+        }
+    }
+    printf("[SYSSTATS] busy %lu.%lu%% over %lu ms, heap free %lu\r\n",
+           (unsigned long)(busy / 10), (unsigned long)(busy % 10),
+           (unsigned long)report_window_ms, (unsigned long)xPortGetFreeHeapSize());
+    xSemaphoreGive(stats_mutex);
+}
+
+#if SYS_STATS_PERIOD_MS > 0
+static uint32_t sys_stats_job(void *arg)
+{
+    (void)arg;
+    sys_stats_dump();
+    return SYS_STATS_PERIOD_MS;
+}
+#endif
+
+bool sys_stats_start(void)
+{
+    stats_mutex = xSemaphoreCreateMutexStatic(&stats_mutex_buffer);
+    if (stats_mutex == NULL) {
+        printf("SysStats: Failed to create mutex\r\n");
+        return false;
+    }
+
+#if SYS_STATS_PERIOD_MS > 0
+    if (housekeeping_add("SysStats", sys_stats_job, NULL, SYS_STATS_PERIOD_MS) == NULL) {
+        return false;
+    }
+#endif
+
+    return true;
+}
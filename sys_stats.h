@@ -0,0 +1,59 @@
+/**
+ * \file sys_stats.h
+ * \brief Per-task CPU load and stack high-water reporting
+ *
+ * FreeRTOS run-time stats are driven by bsp_timestamp (DWT cycle counter
+ * on SAME54, microseconds on the host and QEMU builds), extended to 64
+ * bits. A housekeeping job takes a snapshot every SYS_STATS_PERIOD_MS
+ * and writes the load of each task over that window as a
+ * "[SYSSTATS] <hex>" line on the RTT metrics channel; decode with
+ * pc/python/sys_stats_decode.py.
+ *
+ * Record format, integers big-endian:
+ *   'S' 'T' version(1) ntasks(u8) uptime_ms(u32) window_ms(u32) heap_free(u32)
+ *   then per task: number(u8) priority(u8) state(u8) cpu_permille(u16)
+ *                  stack_free_words(u16) name_len(u8) name
+ */
+
+#ifndef SYS_STATS_H
+#define SYS_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#define SYS_STATS_VERSION       1
+
+/* Snapshot size; tasks beyond this are not reported */
+#ifndef SYS_STATS_MAX_TASKS
+#define SYS_STATS_MAX_TASKS     16
+#endif
+
+/* Reporting window, 0 = only on request */
+#ifndef SYS_STATS_PERIOD_MS
+#define SYS_STATS_PERIOD_MS     5000
+#endif
+
+/**
+ * \brief Create the mutex and schedule the sampling job
+ * \return true if both succeeded
+ */
+bool sys_stats_start(void);
+
+/**
+ * \brief Close the current window and write it as a binary record
+ */
+void sys_stats_dump(void);
+
+/**
+ * \brief Close the current window and print it as a table
+ */
+void sys_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_STATS_H */
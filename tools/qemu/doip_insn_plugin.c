@@ -0,0 +1,264 @@
+/**
+ * \file doip_insn_plugin.c
+ * \brief QEMU TCG plugin: guest instructions executed per DOIP message
+ *
+ * Counts instructions executed by the firmware outside the idle task and
+ * splits the count at "marker" functions, one per DOIP message boundary
+ * (doip_serialize_message for requests, doip_decode_header for responses
+ * by default). Each window between two marker hits is reported by its
+ * (previous -> current) marker pair, so "tx -> rx" is the request send
+ * plus the response receive path, and "rx -> tx" is response handling
+ * plus building the next request.
+ *
+ * Plugin arguments (comma separated, markers/idle may repeat):
+ *   marker=<name>@<addr>   function entry that ends a message window
+ *   idle=<start>-<end>     address range excluded from the count
+ *   csv=<path>             optional per-message CSV output
+ *
+ * tools/qemu/run_qemu.sh resolves the addresses from the ELF. Counts are
+ * taken per executed translation block, so a block that straddles an
+ * idle range boundary is attributed by its first instruction.
+ *
+ * Uses only the plugin API available since QEMU 4.2.
+ */
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define MAX_MARKERS     8
+#define MAX_IDLE        8
+
+typedef struct {
+    char name[48];
+    uint64_t addr;
+    uint64_t hits;
+} marker_t;
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} range_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} window_stats_t;
+
+static marker_t markers[MAX_MARKERS];
+static int marker_count;
+static range_t idle_ranges[MAX_IDLE];
+static int idle_count;
+static FILE *csv_file;
+
+/* The AN386 has a single vCPU, so plain counters are sufficient */
+static uint64_t insns_total;
+static uint64_t insns_idle;
+static uint64_t window_start;
+static int last_marker = -1;
+static uint64_t messages;
+static window_stats_t windows[MAX_MARKERS][MAX_MARKERS];
+
+static bool addr_is_idle(uint64_t addr)
+{
+    for (int i = 0; i < idle_count; i++) {
+        if (addr >= idle_ranges[i].start && addr < idle_ranges[i].end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void tb_exec(unsigned int vcpu_index, void *udata)
+{
+    insns_total += (uintptr_t)udata;
+}
+
+static void tb_exec_idle(unsigned int vcpu_index, void *udata)
+{
+    insns_idle += (uintptr_t)udata;
+}
+
+static void marker_exec(unsigned int vcpu_index, void *udata)
+{
+    int id = (int)(uintptr_t)udata;
+    uint64_t len = insns_total - window_start;
+
+    markers[id].hits++;
+    messages++;
+
+    if (last_marker >= 0) {
+        window_stats_t *w = &windows[last_marker][id];
+        if (w->count == 0 || len < w->min) {
+            w->min = len;
+        }
+        if (len > w->max) {
+            w->max = len;
+        }
+        w->count++;
+        w->sum += len;
+
+        if (csv_file != NULL) {
+            fprintf(csv_file, "%" PRIu64 ",%s,%s,%" PRIu64 ",%" PRIu64 "\n",
+                    messages, markers[last_marker].name, markers[id].name,
+                    len, insns_total);
+        }
+    }
+
+    last_marker = id;
+    window_start = insns_total;
+}
+
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    uint64_t pc = qemu_plugin_tb_vaddr(tb);
+
+    qemu_plugin_register_vcpu_tb_exec_cb(tb, addr_is_idle(pc) ? tb_exec_idle : tb_exec,
+                                         QEMU_PLUGIN_CB_NO_REGS, (void *)(uintptr_t)n);
+
+    if (marker_count == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        uint64_t vaddr = qemu_plugin_insn_vaddr(insn);
+
+        for (int m = 0; m < marker_count; m++) {
+            if (vaddr == markers[m].addr) {
+                qemu_plugin_register_vcpu_insn_exec_cb(insn, marker_exec, QEMU_PLUGIN_CB_NO_REGS,
+                                                       (void *)(uintptr_t)m);
+            }
+        }
+    }
+}
+
+/* qemu_plugin_outs() takes whole strings; format each report line first */
+static void report(const char *fmt, ...)
+{
+    char line[160];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    qemu_plugin_outs(line);
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *p)
+{
+    report("[DOIP_INSN] instructions: %" PRIu64 " active, %" PRIu64 " idle\n",
+           insns_total, insns_idle);
+    for (int m = 0; m < marker_count; m++) {
+        report("[DOIP_INSN] marker %-24s 0x%08" PRIx64 " hits %" PRIu64 "\n",
+               markers[m].name, markers[m].addr, markers[m].hits);
+    }
+    if (messages > 0) {
+        report("[DOIP_INSN] messages: %" PRIu64 ", %.0f active insns/message\n",
+               messages, (double)insns_total / (double)messages);
+    }
+
+    report("[DOIP_INSN] %-40s %10s %11s %11s %11s\n", "window", "count", "mean", "min", "max");
+    for (int a = 0; a < marker_count; a++) {
+        for (int b = 0; b < marker_count; b++) {
+            window_stats_t *w = &windows[a][b];
+            if (w->count == 0) {
+                continue;
+            }
+            char label[112];
+            snprintf(label, sizeof(label), "%s -> %s", markers[a].name, markers[b].name);
+            report("[DOIP_INSN] %-40s %10" PRIu64 " %11.0f %11" PRIu64 " %11" PRIu64 "\n",
+                   label, w->count, (double)w->sum / (double)w->count, w->min, w->max);
+        }
+    }
+
+    if (csv_file != NULL) {
+        fclose(csv_file);
+        csv_file = NULL;
+    }
+}
+
+static bool parse_marker(const char *value)
+{
+    const char *at = strchr(value, '@');
+    if (at == NULL || marker_count >= MAX_MARKERS) {
+        return false;
+    }
+
+    marker_t *m = &markers[marker_count];
+    size_t len = (size_t)(at - value);
+    if (len == 0 || len >= sizeof(m->name)) {
+        return false;
+    }
+    memcpy(m->name, value, len);
+    m->name[len] = '\0';
+    /* Thumb function symbols have bit 0 set; instruction addresses do not */
+    m->addr = strtoull(at + 1, NULL, 0) & ~1ULL;
+    marker_count++;
+    return true;
+}
+
+static bool parse_idle(const char *value)
+{
+    char *end;
+    if (idle_count >= MAX_IDLE) {
+        return false;
+    }
+
+    range_t *r = &idle_ranges[idle_count];
+    r->start = strtoull(value, &end, 0) & ~1ULL;
+    if (*end != '-') {
+        return false;
+    }
+    r->end = strtoull(end + 1, NULL, 0);
+    if (r->end <= r->start) {
+        return false;
+    }
+    idle_count++;
+    return true;
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        char *opt = argv[i];
+        char *eq = strchr(opt, '=');
+        bool ok = false;
+
+        if (eq != NULL) {
+            *eq = '\0';
+            if (strcmp(opt, "marker") == 0) {
+                ok = parse_marker(eq + 1);
+            } else if (strcmp(opt, "idle") == 0) {
+                ok = parse_idle(eq + 1);
+            } else if (strcmp(opt, "csv") == 0) {
+                csv_file = fopen(eq + 1, "w");
+                ok = (csv_file != NULL);
+                if (ok) {
+                    fprintf(csv_file, "message,from,to,insns,total_insns\n");
+                }
+            }
+            *eq = '=';
+        }
+
+        if (!ok) {
+            fprintf(stderr, "doip_insn_plugin: bad option '%s'\n", opt);
+            return -1;
+        }
+    }
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Run the QEMU build under the instruction-count plugin and print the
+# per-message report (see doip_insn_plugin.c).
+#
+#   tools/qemu/run_qemu.sh [elf]
+#
+# Environment:
+#   QEMU               qemu-system-arm binary (default qemu-system-arm)
+#   QEMU_TAP_IF        TAP interface (default tap0, see hw/posix/setup_tap.sh)
+#   DOIP_INSN_MARKERS  "label@symbol ..." message boundaries
+#   DOIP_INSN_IDLE     symbols whose code is excluded from the count
+#   DOIP_INSN_CSV      per-message CSV output (default build_qemu/doip_insn.csv)
+set -e
+
+ELF=${1:-build_qemu/doip_qemu.elf}
+QEMU=${QEMU:-qemu-system-arm}
+QEMU_TAP_IF=${QEMU_TAP_IF:-tap0}
+NM=${NM:-arm-none-eabi-nm}
+PLUGIN_DIR=$(dirname "$0")
+PLUGIN=$PLUGIN_DIR/build/libdoipinsn.so
+REPORT=$(dirname "$ELF")/doip_insn.txt
+DOIP_INSN_MARKERS=${DOIP_INSN_MARKERS:-"tx@doip_serialize_message tx_hdr@doip_serialize_header rx@doip_decode_header"}
+DOIP_INSN_IDLE=${DOIP_INSN_IDLE:-"prvIdleTask vApplicationIdleHook"}
+DOIP_INSN_CSV=${DOIP_INSN_CSV:-$(dirname "$ELF")/doip_insn.csv}
+
+[ -f "$PLUGIN" ] || make -C "$PLUGIN_DIR"
+
+# Symbol value and size ("addr size") from the ELF
+sym() {
+    $NM -S "$ELF" | awk -v s="$1" '$4 == s { print "0x" $1, "0x" $2; exit }'
+}
+
+ARGS=""
+for m in $DOIP_INSN_MARKERS; do
+    label=${m%@*}
+    set -- $(sym "${m#*@}")
+    if [ -z "$1" ]; then
+        echo "marker symbol ${m#*@} not found in $ELF" >&2
+        exit 1
+    fi
+    ARGS="$ARGS,marker=$label@$1"
+done
+for s in $DOIP_INSN_IDLE; do
+    set -- $(sym "$s")
+    [ -n "$1" ] || continue
+    ARGS="$ARGS,idle=$1-$(printf '0x%x' $(($1 + $2)))"
+done
+ARGS="$ARGS,csv=$DOIP_INSN_CSV"
+
+# The firmware ends QEMU through its assert path once DOIP_CYCLES complete
+# (see hw/mps2/drivers/mps2_platform.c), which is a non-zero exit status
+$QEMU -M mps2-an386 -nographic -kernel "$ELF" \
+    -nic tap,ifname="$QEMU_TAP_IF",script=no,downscript=no \
+    -semihosting-config enable=on,target=native \
+    -plugin "$PLUGIN$ARGS" -d plugin -D "$REPORT" || true
+
+cat "$REPORT"
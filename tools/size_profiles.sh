@@ -0,0 +1,38 @@
+#!/bin/sh
+# Compare the flash and RAM of the default build with the LWIP_SOCKETS=0
+# profile and list the largest symbols only the socket build links
+# (sockets, netconn, api_msg and their memp pools).
+#
+#   tools/size_profiles.sh [sockets.elf] [raw.elf]
+#
+# Environment:
+#   SIZE   size binary (default arm-none-eabi-size)
+#   NM     nm binary (default arm-none-eabi-nm)
+#   TOP    symbols listed (default 20)
+set -e
+
+SOCKETS_ELF=${1:-build/AtmelStart.elf}
+RAW_ELF=${2:-build_raw/AtmelStart.elf}
+SIZE=${SIZE:-arm-none-eabi-size}
+NM=${NM:-arm-none-eabi-nm}
+TOP=${TOP:-20}
+
+# "flash ram": text and initialised data are programmed, data and bss take RAM
+usage() {
+    $SIZE -B "$1" | awk 'NR == 2 { print $1 + $2, $2 + $3 }'
+}
+
+set -- $(usage "$SOCKETS_ELF") $(usage "$RAW_ELF")
+printf '%-10s %8s %8s\n' "" flash ram
+printf '%-10s %8d %8d\n' sockets "$1" "$2"
+printf '%-10s %8d %8d\n' raw "$3" "$4"
+printf '%-10s %8d %8d\n' reclaimed $(($1 - $3)) $(($2 - $4))
+
+echo
+echo "Largest symbols only in $SOCKETS_ELF (b/d = RAM):"
+{
+    $NM -S -t d "$RAW_ELF" | sed 's/^/raw /'
+    $NM -S -t d "$SOCKETS_ELF" | sed 's/^/sockets /'
+} | awk 'NF == 5 && $1 == "raw" { raw[$5] = 1; next }
+         NF == 5 && $1 == "sockets" && !($5 in raw) { printf "%8d %s %s\n", $3, $4, $5 }' |
+    sort -rn | head -n "$TOP"
@@ -41,37 +41,30 @@
 #include "bsp_led.h"
 #include "bsp_ethernet.h"
 #include "eth_ipstack_main.h"
-#include <hal_mac_async.h>
-#include "app_libs/asf4/hri/hri_gmac_e54.h"
-#include "ethif_mac.h"
+#include "housekeeping.h"
 
 uint16_t led_blink_rate = BLINK_NORMAL;
 
-static TaskHandle_t xLed_Task;
-
 /**
- * OS task that blinks LED
+ * Housekeeping job that blinks LED
  */
-static void led_task(void *p)
+static uint32_t led_job(void *p)
 {
 	(void)p;
-	for (;;) {
-		hw_led_toggle(&led_yellow);
-		vTaskDelay(led_blink_rate);
-	}
+	hw_led_toggle(&led_yellow);
+	return led_blink_rate;
 }
 
 
 /**
- * \brief Create OS task for LED blinking
+ * \brief Schedule LED blinking on the housekeeping executor
  */
 void task_led_create(void)
 {
-	/* Create task to make led blink */
-	if (xTaskCreate(led_task, "Led", TASK_LED_STACK_SIZE, NULL, TASK_LED_TASK_PRIORITY, &xLed_Task) != pdPASS) {
+	/* Make led blink */
+	if (housekeeping_add("Led", led_job, NULL, 0) == NULL) {
 		while (1) {
 			;
 		}
 	}
 }
-
@@ -39,9 +39,6 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
-#define TASK_LED_STACK_SIZE (512 / sizeof(portSTACK_TYPE))
-#define TASK_LED_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
-
 #define TASK_ETHERNETBASIC_STACK_SIZE (1024 / sizeof(portSTACK_TYPE))
 #define TASK_ETHERNETBASIC_STACK_PRIORITY (tskIDLE_PRIORITY + 2)
 